@@ -0,0 +1,481 @@
+/**
+ * @file test_alloc_budget.cpp
+ * @brief Host driver that checks steady-state cycles against their allocation budgets
+ *
+ * Runs WebInkController through complete wake cycles with the network and
+ * display mocked, so the allocation tracer (webink_alloc_trace.h) sees the
+ * same code paths the device runs:
+ *
+ * 1. Warm-up: first image download (not checked, WARMUP_CYCLES)
+ * 2. Hash unchanged: the server returns the same hash, nothing is drawn
+ * 3. Image: the server returns a new hash, the image is downloaded and drawn
+ * 4. Image and hash unchanged again with a server hostname longer than
+ *    std::string's inline buffer, resolved through the host resolver hook
+ * 5. Image and hash unchanged again in socket mode, against a loopback
+ *    server the driver pumps between controller.loop() calls
+ * 6. Image in socket mode behind a server race: the primary refuses
+ *    connections, the fallback wins and its connection carries the image
+ *
+ * record_wake_telemetry() closes each cycle with WebInkAllocTrace::end_cycle().
+ * Built by `make test-alloc` with WEBINK_ALLOC_ENFORCE=1, so a cycle over its
+ * budget ends the process with a failure exit code; the checks at the end
+ * catch a cycle that did not run at all or ran the wrong path.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink.h"
+#include "webink_alloc_trace.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace esphome::webink;
+
+#if !WEBINK_ALLOC_TRACE
+#error "test_alloc_budget.cpp needs -DWEBINK_ALLOC_TRACE=1 (use make test-alloc)"
+#endif
+
+//=============================================================================
+// HOST PLATFORM (webink_state.h, webink_log.h)
+//=============================================================================
+
+namespace {
+
+unsigned long host_time_ms = 0;             // Advanced by the driver, not by the wall clock
+const int WIDTH = 800;
+const int HEIGHT = 480;
+const int MAX_LOOPS_PER_CYCLE = 20000;      // Far above a cycle's loop() count
+const int ROW_BYTES = (WIDTH + 7) / 8;      // PBM row
+
+void log_line(const char* level, const char* tag, const char* format, va_list args) {
+    // vprintf, not iostreams: logging must not count against the budgets
+    printf("[%s][%s] ", level, tag);
+    vprintf(format, args);
+    printf("\n");
+}
+
+} // namespace
+
+unsigned long millis() { return host_time_ms; }
+unsigned long micros() { return host_time_ms * 1000; }
+
+#define WEBINK_HOST_LOG(name, level)                                \
+    void name(const char* tag, const char* format, ...) {           \
+        va_list args;                                               \
+        va_start(args, format);                                     \
+        log_line(level, tag, format, args);                         \
+        va_end(args);                                               \
+    }
+
+WEBINK_HOST_LOG(ESP_LOGE, "E")
+WEBINK_HOST_LOG(ESP_LOGW, "W")
+WEBINK_HOST_LOG(ESP_LOGI, "I")
+
+// Debug and verbose output would bury the [ALLOC] lines
+void ESP_LOGD(const char*, const char*, ...) {}
+void ESP_LOGV(const char*, const char*, ...) {}
+
+//=============================================================================
+// MOCK SERVER
+//=============================================================================
+
+namespace {
+
+const char* server_hash = "hash-1";         // Content hash the mock server reports
+int image_requests = 0;                     // Slice requests served
+int hash_requests = 0;                      // /get_hash requests served
+
+/**
+ * @brief Integer value of a query parameter (0 if absent)
+ */
+int query_int(const char* url, const char* name) {
+    const char* p = strstr(url, name);
+    return p != nullptr ? atoi(p + strlen(name)) : 0;
+}
+
+/**
+ * @brief Answers the requests WebInkController makes, per SERVER_PROTOCOL.md
+ */
+void serve(const char* url, const char* body, size_t body_length, NetworkResult& result) {
+    char text[128];
+    int length = 0;
+    result.status_code = 200;
+    result.success = true;
+
+    if (strstr(url, "/get_hash") != nullptr) {
+        hash_requests++;
+        length = snprintf(text, sizeof(text), "{\"hash\":\"%s\",\"sleep_seconds\":300,\"next_change_seconds\":300}",
+                          server_hash);
+        result.data.assign(text, length);
+    } else if (strstr(url, "/get_image") != nullptr) {
+        image_requests++;
+        int h = query_int(url, "&h=");
+        int y = query_int(url, "&y=");
+        length = snprintf(text, sizeof(text), "P4\n%d %d\n", WIDTH, h);
+        result.data.reserve(length + ROW_BYTES * h);
+        result.data.assign(text, length);
+        for (int row = y; row < y + h; row++) {
+            result.data.append(ROW_BYTES, static_cast<char>(row & 1 ? 0xAA : 0x55));
+        }
+    } else if (strstr(url, "/get_sleep") != nullptr) {
+        result.data.assign("{\"sleep_seconds\":300}");
+    } else if (strstr(url, "/post_log_batch") != nullptr) {
+        result.success = body != nullptr && body_length > 0;
+        result.status_code = result.success ? 200 : 400;
+        result.data.assign(result.success ? "ok" : "empty");
+    } else {
+        result.status_code = 404;
+        result.success = false;
+    }
+}
+
+//=============================================================================
+// MOCK NAME RESOLUTION
+//=============================================================================
+
+const char* LONG_HOST_URL = "http://webink-server.example.lan:8090";  // Host past the inline buffer
+int host_resolves = 0;                      // Names resolved through the hook
+
+/**
+ * @brief Resolves the long test hostname to loopback
+ */
+bool resolve(const char* host, uint32_t& ipv4) {
+    if (strcmp(host, "webink-server.example.lan") != 0) {
+        return false;
+    }
+    host_resolves++;
+    ipv4 = htonl(INADDR_LOOPBACK);
+    return true;
+}
+
+//=============================================================================
+// MOCK SOCKET SERVER
+//=============================================================================
+
+/**
+ * @brief Loopback server for socket mode, per SERVER_PROTOCOL.md
+ *
+ * Non-blocking and pumped between controller.loop() calls, so the
+ * controller's connect, request and streamed reads run on real sockets.
+ * Serves one connection at a time; rows are written from a fixed buffer.
+ */
+class SocketServer {
+public:
+    int requests = 0;                       // Requests answered
+
+    ~SocketServer() {
+        close_client();
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+        }
+    }
+
+    /**
+     * @brief Listen on an ephemeral loopback port
+     * @return Port, or 0 if the socket could not be opened
+     */
+    int start() {
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            listen(listen_fd_, 4) != 0 || getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+            return 0;
+        }
+        fcntl(listen_fd_, F_SETFL, fcntl(listen_fd_, F_GETFL, 0) | O_NONBLOCK);
+        return ntohs(addr.sin_port);
+    }
+
+    /**
+     * @brief Accept, read the request line and write what the socket takes
+     */
+    void pump() {
+        if (listen_fd_ < 0) {
+            return;
+        }
+        if (client_fd_ < 0) {
+            client_fd_ = accept(listen_fd_, nullptr, nullptr);
+            if (client_fd_ < 0) {
+                return;
+            }
+            fcntl(client_fd_, F_SETFL, fcntl(client_fd_, F_GETFL, 0) | O_NONBLOCK);
+            request_length_ = 0;
+            responding_ = false;
+        }
+
+        if (!responding_) {
+            ssize_t n = read(client_fd_, request_ + request_length_, sizeof(request_) - 1 - request_length_);
+            if (n == 0) {
+                close_client();             // Warm-up connection dropped without a request
+                return;
+            }
+            if (n < 0) {
+                return;
+            }
+            request_length_ += n;
+            request_[request_length_] = '\0';
+            if (strchr(request_, '\n') == nullptr) {
+                return;
+            }
+            start_response();
+        }
+
+        if (send_pending()) {
+            close_client();
+        }
+    }
+
+private:
+    int listen_fd_ = -1;
+    int client_fd_ = -1;
+    char request_[256];
+    int request_length_ = 0;
+    bool responding_ = false;
+    char head_[64];                         // Status line of a webInkV2 answer
+    int head_length_ = 0;
+    int head_sent_ = 0;
+    int row_ = 0;                           // Next row to write
+    int end_row_ = 0;
+    int row_sent_ = 0;                      // Bytes of row_ already written
+    uint8_t row_data_[ROW_BYTES];
+
+    /**
+     * @brief Parse "webInkV1 key device mode x y w h format[ if_none_match]"
+     */
+    void start_response() {
+        char version[16] = "";
+        char if_none_match[17] = "";
+        int x = 0, y = 0, w = 0, h = 0;
+        sscanf(request_, "%15s %*s %*s %*s %d %d %d %d %*s %16s", version, &x, &y, &w, &h, if_none_match);
+
+        requests++;
+        responding_ = true;
+        head_length_ = 0;
+        head_sent_ = 0;
+        row_ = y;
+        end_row_ = y + h;
+        row_sent_ = 0;
+
+        if (strcmp(version, "webInkV2") == 0) {
+            bool unchanged = strcmp(if_none_match, server_hash) == 0;
+            head_length_ = snprintf(head_, sizeof(head_), "%s %s 300 300\n", unchanged ? "UNCHANGED" : "OK",
+                                    server_hash);
+            if (unchanged) {
+                end_row_ = row_;
+            }
+        }
+    }
+
+    /**
+     * @brief Write until the socket buffer is full
+     * @return True once the whole answer is written
+     */
+    bool send_pending() {
+        while (head_sent_ < head_length_) {
+            ssize_t n = write(client_fd_, head_ + head_sent_, head_length_ - head_sent_);
+            if (n <= 0) {
+                return false;
+            }
+            head_sent_ += n;
+        }
+        while (row_ < end_row_) {
+            memset(row_data_, row_ & 1 ? 0xAA : 0x55, sizeof(row_data_));
+            ssize_t n = write(client_fd_, row_data_ + row_sent_, sizeof(row_data_) - row_sent_);
+            if (n <= 0) {
+                return false;
+            }
+            row_sent_ += n;
+            if (row_sent_ == ROW_BYTES) {
+                row_++;
+                row_sent_ = 0;
+            }
+        }
+        return true;
+    }
+
+    void close_client() {
+        if (client_fd_ >= 0) {
+            close(client_fd_);
+        }
+        client_fd_ = -1;
+        responding_ = false;
+    }
+};
+
+SocketServer socket_server;
+
+//=============================================================================
+// MOCK DISPLAY
+//=============================================================================
+
+/**
+ * @brief Display that counts rows, refreshes and calls instead of drawing
+ */
+class CountingDisplay : public WebInkDisplayManager {
+public:
+    int rows_drawn = 0;
+    int refreshes = 0;
+    int calls = 0;                                        ///< Any use of the display at all
+
+    void clear_display() override { calls++; }
+    void draw_pixel(int, int, uint32_t) override { calls++; }
+    void update_display() override {
+        calls++;
+        refreshes++;
+    }
+    void get_display_size(int& width, int& height) override {
+        calls++;
+        width = WIDTH;
+        height = HEIGHT;
+    }
+    void draw_progressive_pixels(int, int, int, int height, const uint8_t*, ColorMode) override {
+        calls++;
+        rows_drawn += height;
+    }
+
+protected:
+    void draw_text(int, int, const std::string&, bool, int) override { calls++; }
+};
+
+bool wifi_connected() { return true; }
+bool boot_button_released() { return false; }
+int wifi_rssi() { return -55; }
+
+bool error_seen = false;
+
+/**
+ * @brief Run one manual update cycle to COMPLETE
+ * @return False if the cycle did not finish
+ */
+bool run_cycle(WebInkController& controller, const char* name) {
+    printf("\n=== Cycle: %s (server hash %s) ===\n", name, server_hash);
+    if (!controller.trigger_manual_update()) {
+        printf("FAIL: %s cycle did not start\n", name);
+        return false;
+    }
+    for (int i = 0; i < MAX_LOOPS_PER_CYCLE; i++) {
+        host_time_ms += 10;
+        controller.loop();
+        socket_server.pump();
+        if (controller.consume_cycle_complete()) {
+            return true;
+        }
+    }
+    printf("FAIL: %s cycle did not complete in %d loops (state %s)\n", name, MAX_LOOPS_PER_CYCLE,
+           controller.get_current_state_string());
+    return false;
+}
+
+/**
+ * @brief Report a failed expectation
+ */
+bool expect(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+    }
+    return condition;
+}
+
+} // namespace
+
+//=============================================================================
+// DRIVER
+//=============================================================================
+
+int main() {
+    WebInkNetworkClient::set_host_http_handler(serve);
+    WebInkNetworkClient::set_host_resolver(resolve);
+
+    auto config = std::make_shared<WebInkConfig>();
+    config->set_server_url("http://127.0.0.1:8090");     // An address: no name resolution
+    config->set_device_id("alloc-budget");
+    config->set_api_key("test-key");
+    config->set_display_mode("800x480x1xB");
+    config->set_socket_port(0);                           // HTTP sliced mode
+
+    auto display = std::make_shared<CountingDisplay>();
+
+    WebInkController controller;
+    controller.set_config(config);
+    controller.set_display(display);
+    controller.get_wifi_status = wifi_connected;
+    controller.get_boot_button_status = boot_button_released;
+    controller.get_wifi_rssi = wifi_rssi;
+    controller.on_error_occurred = [](ErrorType, const std::string&) { error_seen = true; };
+    controller.setup();
+
+    bool ok = expect(display->calls == 0, "setup touched the display");
+    ok = run_cycle(controller, "warm-up") && ok;
+    ok = expect(display->refreshes == 1, "warm-up cycle did not refresh the display") && ok;
+
+    int images_before = image_requests;
+    int display_calls = display->calls;
+    ok = run_cycle(controller, "hash unchanged") && ok;
+    ok = expect(image_requests == images_before, "hash-unchanged cycle downloaded the image") && ok;
+    ok = expect(display->calls == display_calls, "hash-unchanged cycle touched the display") && ok;
+
+    server_hash = "hash-2";
+    display->rows_drawn = 0;
+    ok = run_cycle(controller, "image") && ok;
+    ok = expect(display->refreshes == 2, "image cycle did not refresh the display") && ok;
+    ok = expect(display->rows_drawn == HEIGHT, "image cycle did not draw every row") && ok;
+
+    ok = expect(hash_requests == 3, "expected one hash request per cycle") && ok;
+
+    // Same cycles with a hostname std::string could not hold inline
+    config->set_server_url(LONG_HOST_URL);
+    server_hash = "hash-3";
+    ok = run_cycle(controller, "long hostname image") && ok;
+    ok = expect(display->refreshes == 3, "long hostname image cycle did not refresh the display") && ok;
+    images_before = image_requests;
+    ok = run_cycle(controller, "long hostname hash unchanged") && ok;
+    ok = expect(image_requests == images_before, "long hostname hash-unchanged cycle downloaded the image") && ok;
+    ok = expect(host_resolves > 0, "long hostname was never resolved") && ok;
+
+    // Socket mode: rows stream from the loopback server instead of HTTP slices
+    int port = socket_server.start();
+    ok = expect(port > 0, "socket server did not start") && ok;
+    config->set_socket_port(port);
+    server_hash = "hash-4";
+    display->rows_drawn = 0;
+    images_before = image_requests;
+    ok = run_cycle(controller, "socket image") && ok;
+    ok = expect(display->refreshes == 4, "socket image cycle did not refresh the display") && ok;
+    ok = expect(display->rows_drawn == HEIGHT, "socket image cycle did not draw every row") && ok;
+    ok = expect(socket_server.requests > 0, "socket image cycle did not use the socket") && ok;
+    ok = expect(image_requests == images_before, "socket image cycle fell back to HTTP slices") && ok;
+    display_calls = display->calls;
+    ok = run_cycle(controller, "socket hash unchanged") && ok;
+    ok = expect(display->calls == display_calls, "socket hash-unchanged cycle touched the display") && ok;
+
+    // Server race: nothing listens on 127.0.0.2, so the fallback wins
+    config->set_server_url("http://127.0.0.2:8090");
+    config->add_server_url(LONG_HOST_URL);
+    server_hash = "hash-5";
+    display->rows_drawn = 0;
+    int socket_requests_before = socket_server.requests;
+    ok = run_cycle(controller, "server race image") && ok;
+    ok = expect(config->get_active_server() == 1, "server race did not pick the fallback") && ok;
+    ok = expect(display->rows_drawn == HEIGHT, "server race image cycle did not draw every row") && ok;
+    ok = expect(socket_server.requests == socket_requests_before + 1,
+                "server race image cycle did not send one socket request") && ok;
+
+    ok = expect(!error_seen, "a cycle reported an error") && ok;
+
+    uint32_t violations = WebInkAllocTrace::get_violations();
+    printf("\n%s: %u budget violations\n", ok && violations == 0 ? "PASS" : "FAIL", (unsigned) violations);
+    return ok && violations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_units.cpp
+ * @brief Host checks of component pieces that need no server or display
+ *
+ * Each check prints what failed and the run exits non-zero if any did.
+ * Built and run by `make test-units`.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_json.h"
+#include "webink_memory.h"
+
+#include <climits>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace esphome::webink;
+
+// Component logging (webink_log.h); only errors and warnings are shown
+void ESP_LOGE(const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    printf("[E][%s] ", tag);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+void ESP_LOGW(const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    printf("[W][%s] ", tag);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+void ESP_LOGI(const char*, const char*, ...) {}
+void ESP_LOGD(const char*, const char*, ...) {}
+void ESP_LOGV(const char*, const char*, ...) {}
+
+namespace {
+
+int failures = 0;
+
+/**
+ * @brief Report a failed expectation
+ */
+void expect(bool condition, const char* what) {
+    if (!condition) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+//=============================================================================
+// JSON
+//=============================================================================
+
+/**
+ * @brief get_int() clamps numbers that do not fit an int
+ *
+ * long is 32 bits on the ESP32, so the clamp must not rely on a wider
+ * accumulator; the 64-bit host would hide an overflow there.
+ */
+void check_json_integers() {
+    WebInkJsonParser json;
+    const char* body = "{\"sleep_seconds\": 9999999999, \"next_change_seconds\": -99999999999999999999,"
+                       " \"exact\": 2147483647, \"small\": 1800, \"flag\": true}";
+    expect(json.parse(body, strlen(body)), "json: document parses");
+
+    int value = 0;
+    expect(json.get_int("sleep_seconds", value) && value == INT_MAX, "json: over-long number clamps to INT_MAX");
+    expect(json.get_int("next_change_seconds", value) && value == -INT_MAX,
+           "json: over-long negative number clamps to -INT_MAX");
+    expect(json.get_int("exact", value) && value == INT_MAX, "json: INT_MAX parses exactly");
+    expect(json.get_int("small", value) && value == 1800, "json: ordinary number parses");
+
+    value = 7;
+    expect(!json.get_int("flag", value) && value == 7, "json: literal is not a number and leaves value unchanged");
+}
+
+//=============================================================================
+// MEMORY PLACEMENT
+//=============================================================================
+
+/**
+ * @brief Placements under a tight internal SRAM, and their access costs
+ *
+ * 16 KiB of internal SRAM: a second PIXEL_ROWS buffer (INTERNAL_ONLY) must
+ * fail rather than land in PSRAM, while PREFER_* roles fall back to the
+ * other region. The same walk over each placement then costs five times as
+ * much in PSRAM as in SRAM.
+ */
+void check_memory_placement() {
+    const size_t KIB = 1024;
+    WebInkMemory::emulate_regions({16 * KIB, 2500}, {64 * KIB, 12500});
+    uint32_t failures = WebInkMemory::get_failures();
+    uint32_t fallbacks = WebInkMemory::get_fallbacks();
+    MemoryRegion region = MemoryRegion::EXTERNAL;
+
+    void* rows = WebInkMemory::allocate(12 * KIB, MemoryRole::PIXEL_ROWS);
+    expect(rows != nullptr && WebInkMemory::find_region(rows, region) && region == MemoryRegion::INTERNAL,
+           "memory: PIXEL_ROWS placed in internal SRAM");
+
+    void* more_rows = WebInkMemory::allocate(8 * KIB, MemoryRole::PIXEL_ROWS);
+    expect(more_rows == nullptr && WebInkMemory::get_failures() == failures + 1,
+           "memory: INTERNAL_ONLY fails when internal SRAM is full");
+    WebInkMemory::release(more_rows);
+
+    void* slice = WebInkMemory::allocate(8 * KIB, MemoryRole::SLICE);
+    expect(slice != nullptr && WebInkMemory::find_region(slice, region) && region == MemoryRegion::EXTERNAL &&
+           WebInkMemory::get_fallbacks() == fallbacks + 1,
+           "memory: PREFER_INTERNAL falls back to PSRAM");
+
+    // One 4 KiB walk over each placement: 4 x 2500 ns in SRAM, 4 x 12500 ns in PSRAM
+    WebInkMemory::reset_access_counters();
+    WebInkMemory::record_access(rows, 4 * KIB);
+    WebInkMemory::record_access(slice, 4 * KIB);
+    expect(WebInkMemory::get_access_bytes(MemoryRegion::INTERNAL) == 4 * KIB &&
+           WebInkMemory::get_access_bytes(MemoryRegion::EXTERNAL) == 4 * KIB,
+           "memory: accesses charged to the buffer's region");
+    expect(WebInkMemory::get_access_ns(MemoryRegion::INTERNAL) == 10000 &&
+           WebInkMemory::get_access_ns(MemoryRegion::EXTERNAL) == 50000,
+           "memory: PSRAM walk costs five times the SRAM walk");
+
+    WebInkMemory::release(rows);
+    WebInkMemory::release(slice);
+    expect(WebInkMemory::get_used(MemoryRegion::INTERNAL) == 0 && WebInkMemory::get_used(MemoryRegion::EXTERNAL) == 0,
+           "memory: released buffers leave both regions empty");
+
+    // A board without PSRAM: cold buffers fall back to internal SRAM
+    WebInkMemory::emulate_regions({16 * KIB, 2500}, {0, 12500});
+    void* cache = WebInkMemory::allocate(4 * KIB, MemoryRole::CACHE);
+    expect(cache != nullptr && WebInkMemory::find_region(cache, region) && region == MemoryRegion::INTERNAL &&
+           WebInkMemory::get_fallbacks() == fallbacks + 2,
+           "memory: PREFER_EXTERNAL falls back to internal SRAM without PSRAM");
+    WebInkMemory::release(cache);
+}
+
+} // namespace
+
+int main() {
+    check_json_integers();
+    check_memory_placement();
+
+    printf("%s: %d failed checks\n", failures == 0 ? "PASS" : "FAIL", failures);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -4,6 +4,8 @@ WebInk ESPHome Component
 This module provides ESPHome integration for the WebInk e-ink display component.
 """
 
+import re
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import display, font, deep_sleep, binary_sensor
@@ -13,16 +15,59 @@ from esphome.const import CONF_ID
 webink_ns = cg.esphome_ns.namespace("webink")
 WebInkESPHomeComponent = webink_ns.class_("WebInkESPHomeComponent", cg.Component)
 
+# Component log levels (WEBINK_LOG_LEVEL_* in webink_log.h)
+LOG_LEVELS = {
+    "NONE": 0,
+    "ERROR": 1,
+    "WARN": 2,
+    "INFO": 3,
+    "CONFIG": 4,
+    "DEBUG": 5,
+    "VERBOSE": 6,
+}
+
+# Display mode color characters -> ColorMode values (webink_types.h)
+DISPLAY_COLORS = {"B": 0, "G": 1, "R": 2, "C": 3}
+DISPLAY_MODE_RE = re.compile(r"^(\d+)x(\d+)x(1|2|8|24)x([BGRC])$")
+DEFAULT_MAX_DISPLAY_WIDTH = 800
+# What update_interval: never compiles to (SCHEDULER_DONT_RUN, uint32_t max)
+UPDATE_INTERVAL_NEVER = 4294967295
+
+
+def parse_display_mode(value):
+    """Split "800x480x1xB" into (width, height, bits, ColorMode value)."""
+    match = DISPLAY_MODE_RE.match(value)
+    if not match or int(match.group(1)) == 0 or int(match.group(2)) == 0:
+        raise cv.Invalid(f"display_mode must look like 800x480x1xB, got '{value}'")
+    return (int(match.group(1)), int(match.group(2)), int(match.group(3)),
+            DISPLAY_COLORS[match.group(4)])
+
+
+def validate_display_mode(value):
+    value = cv.string(value)
+    parse_display_mode(value)
+    return value
+
+
 # Configuration schema
 CONFIG_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(WebInkESPHomeComponent),
         cv.Required("server_url"): cv.string,
+        cv.Optional("fallback_servers", default=[]): cv.All(
+            cv.ensure_list(cv.string), cv.Length(max=2)
+        ),
         cv.Required("device_id"): cv.string, 
         cv.Required("api_key"): cv.string,
-        cv.Optional("display_mode", default="800x480x1xB"): cv.string,
+        cv.Optional("display_mode", default="800x480x1xB"): validate_display_mode,
+        cv.Optional("fixed_geometry", default=True): cv.boolean,
         cv.Optional("socket_port", default=8091): cv.int_,
         cv.Optional("rows_per_slice", default=8): cv.int_range(min=1, max=64),
+        cv.Optional("sleep_schedule", default=False): cv.boolean,
+        cv.Optional("network_stats", default=True): cv.boolean,
+        cv.Optional("trace", default=False): cv.boolean,
+        cv.Optional("log_level"): cv.one_of(*LOG_LEVELS, upper=True),
+        cv.Optional("arena_size"): cv.int_range(min=2048, max=131072),
         cv.Required("display_id"): cv.use_id(display.Display),
         cv.Optional("normal_font"): cv.use_id(font.Font),
         cv.Optional("large_font"): cv.use_id(font.Font),
@@ -39,15 +84,43 @@ async def to_code(config):
 
     # Set configuration values
     cg.add(var.set_server_url(config["server_url"]))
+    for url in config["fallback_servers"]:
+        cg.add(var.add_fallback_server(url))
     cg.add(var.set_device_id(config["device_id"]))
     cg.add(var.set_api_key(config["api_key"]))
     cg.add(var.set_display_mode(config["display_mode"]))
     cg.add(var.set_socket_port(config["socket_port"]))
     cg.add(var.set_rows_per_slice(config["rows_per_slice"]))
+    cg.add(var.set_sleep_schedule(config["sleep_schedule"]))
+    if not config["network_stats"]:
+        # Compiles WebInkNetStats out entirely
+        cg.add_build_flag("-DWEBINK_NET_STATS=0")
+    if config["trace"]:
+        # Records a timeline of each cycle for server/trace_to_chrome.py
+        cg.add_build_flag("-DWEBINK_TRACE=1")
+    if "log_level" in config:
+        # Levels above this are compiled out of the component (default: logger level)
+        cg.add_build_flag(f"-DWEBINK_LOG_LEVEL={LOG_LEVELS[config['log_level']]}")
+    if "arena_size" in config:
+        # Static per-wake arena for response bodies and slices (default 16384)
+        cg.add_build_flag(f"-DWEBINK_ARENA_SIZE={config['arena_size']}")
+    width, height, bits, color = parse_display_mode(config["display_mode"])
+    if config["fixed_geometry"]:
+        # Constexpr DisplayGeometry: constant strides, exactly sized row buffers
+        cg.add_build_flag(f"-DWEBINK_DISPLAY_WIDTH={width}")
+        cg.add_build_flag(f"-DWEBINK_DISPLAY_HEIGHT={height}")
+        cg.add_build_flag(f"-DWEBINK_DISPLAY_BITS={bits}")
+        cg.add_build_flag(f"-DWEBINK_DISPLAY_COLOR={color}")
+    elif width > DEFAULT_MAX_DISPLAY_WIDTH:
+        # Runtime geometry: row buffers must hold the widest mode
+        cg.add_build_flag(f"-DWEBINK_MAX_DISPLAY_WIDTH={width}")
 
     # Link to required components
     display_component = await cg.get_variable(config["display_id"])
     cg.add(var.set_display_component(display_component))
+    # WebInk decides when the panel refreshes; a poller would redraw and
+    # refresh it on every wake, including the unchanged ones
+    cg.add(display_component.set_update_interval(UPDATE_INTERVAL_NEVER))
 
     # Optional components
     if "normal_font" in config:
@@ -14,12 +14,30 @@
 // Core WebInk types and enums
 #include "webink_types.h"
 
+// Per-wake arena allocator
+#include "webink_arena.h"
+
+// Memory-region placement policy
+#include "webink_memory.h"
+
+// Pooled pixel buffers
+#include "webink_pixel_pool.h"
+
+// Compile-time display geometry
+#include "webink_geometry.h"
+
 // Configuration management
 #include "webink_config.h"
 
 // State management
 #include "webink_state.h"
 
+// Log level gating and rate limiting
+#include "webink_log.h"
+
+// Network statistics
+#include "webink_net_stats.h"
+
 // Network communication
 #include "webink_network.h"
 
@@ -29,6 +47,24 @@
 // Display management
 #include "webink_display.h"
 
+// Coroutine tasks and executor
+#include "webink_coroutine.h"
+
+// JSON response parsing
+#include "webink_json.h"
+
+// Batched log upload
+#include "webink_log_buffer.h"
+
+// Per-wake telemetry
+#include "webink_telemetry.h"
+
+// Wake cycle tracing
+#include "webink_trace.h"
+
+// Host allocation tracing and budgets
+#include "webink_alloc_trace.h"
+
 // Main controller
 #include "webink_controller.h"
 
@@ -0,0 +1,278 @@
+/**
+ * @file webink_alloc_trace.cpp
+ * @brief Implementation of WebInkAllocTrace and the traced operator new/delete
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_alloc_trace.h"
+#include "webink_log.h"
+
+#if WEBINK_ALLOC_TRACE
+
+#include <cstdlib>
+#include <new>
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkAllocTrace::TAG = "webink.alloc";
+
+namespace {
+
+const int PHASE_COUNT = static_cast<int>(TelemetryPhase::COUNT);
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "boot", "wifi", "hash", "download", "refresh", "error", "sleep"
+};
+const char* const CYCLE_NAMES[ALLOC_CYCLE_COUNT] = {
+    "hash unchanged", "image", "error"
+};
+const char* const UNTAGGED = "(untagged)";
+
+struct AllocSite {
+    const char* tag;            // String literal; compared by address
+    AllocCounters counters;
+};
+
+// Plain zero-initialized statics: operator new may run before main()
+int current_phase = 0;
+AllocCounters phase_counters[PHASE_COUNT] = {};
+AllocSite sites[WebInkAllocTrace::MAX_SITES] = {};
+int site_count = 0;
+uint32_t untracked_sites = 0;
+const char* tag_stack[WebInkAllocTrace::MAX_TAG_DEPTH] = {};
+int tag_depth = 0;
+int cycles_ended = 0;
+uint32_t violations = 0;
+
+uint32_t budget_allocations[ALLOC_CYCLE_COUNT] = {
+    WEBINK_ALLOC_BUDGET_HASH, WEBINK_ALLOC_BUDGET_IMAGE, 0
+};
+uint64_t budget_bytes[ALLOC_CYCLE_COUNT] = {UINT64_MAX, UINT64_MAX, UINT64_MAX};
+
+AllocSite* site_for(const char* tag) {
+    for (int i = 0; i < site_count; i++) {
+        if (sites[i].tag == tag) {
+            return &sites[i];
+        }
+    }
+    if (site_count == WebInkAllocTrace::MAX_SITES) {
+        return nullptr;
+    }
+    sites[site_count] = {tag, {0, 0, 0}};
+    return &sites[site_count++];
+}
+
+void* traced_allocate(size_t size, size_t align) {
+    WebInkAllocTrace::record_allocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    if (align <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, align, size) == 0 ? ptr : nullptr;
+}
+
+void traced_free(void* ptr) {
+    if (ptr != nullptr) {
+        WebInkAllocTrace::record_free();
+        std::free(ptr);
+    }
+}
+
+} // namespace
+
+//=============================================================================
+// RECORDING
+//=============================================================================
+
+void WebInkAllocTrace::set_phase(TelemetryPhase phase) {
+    current_phase = static_cast<int>(phase);
+}
+
+void WebInkAllocTrace::push_tag(const char* tag) {
+    if (tag_depth < MAX_TAG_DEPTH) {
+        tag_stack[tag_depth] = tag;
+    }
+    tag_depth++;  // Deeper levels keep the tag at MAX_TAG_DEPTH - 1
+}
+
+void WebInkAllocTrace::pop_tag() {
+    if (tag_depth > 0) {
+        tag_depth--;
+    }
+}
+
+void WebInkAllocTrace::record_allocation(size_t bytes) {
+    AllocCounters& phase = phase_counters[current_phase];
+    phase.allocations++;
+    phase.bytes += bytes;
+
+    const char* tag = tag_depth == 0 ? UNTAGGED
+                    : tag_stack[(tag_depth < MAX_TAG_DEPTH ? tag_depth : MAX_TAG_DEPTH) - 1];
+    AllocSite* site = site_for(tag);
+    if (site == nullptr) {
+        untracked_sites++;
+        return;
+    }
+    site->counters.allocations++;
+    site->counters.bytes += bytes;
+}
+
+void WebInkAllocTrace::record_free() {
+    phase_counters[current_phase].frees++;
+}
+
+//=============================================================================
+// BUDGETS
+//=============================================================================
+
+void WebInkAllocTrace::set_budget(AllocCycle cycle, uint32_t allocations, uint64_t bytes) {
+    budget_allocations[static_cast<int>(cycle)] = allocations;
+    budget_bytes[static_cast<int>(cycle)] = bytes;
+}
+
+bool WebInkAllocTrace::end_cycle(AllocCycle cycle) {
+    int index = static_cast<int>(cycle);
+    AllocCounters total = get_cycle();
+    bool checked = cycle != AllocCycle::ERROR && cycles_ended >= WARMUP_CYCLES;
+    bool within = !checked ||
+                  (total.allocations <= budget_allocations[index] && total.bytes <= budget_bytes[index]);
+    cycles_ended++;
+
+    if (within) {
+        WEBINK_LOGI(TAG, "[ALLOC] %s cycle: %u allocations, %u bytes%s", CYCLE_NAMES[index],
+                    (unsigned) total.allocations, (unsigned) total.bytes,
+                    checked ? " (within budget)" : " (not checked)");
+        if (!checked && total.allocations > 0) {
+            log_cycle();
+        }
+    } else {
+        violations++;
+        WEBINK_LOGE(TAG, "[ALLOC] %s cycle: %u allocations, %u bytes - budget is %u allocations",
+                    CYCLE_NAMES[index], (unsigned) total.allocations, (unsigned) total.bytes,
+                    (unsigned) budget_allocations[index]);
+        log_cycle();
+    }
+
+    for (AllocCounters& phase : phase_counters) {
+        phase = {0, 0, 0};
+    }
+    site_count = 0;
+    untracked_sites = 0;
+
+#if WEBINK_ALLOC_ENFORCE
+    if (!within) {
+        WEBINK_LOGE(TAG, "[ALLOC] Budget exceeded - exiting (WEBINK_ALLOC_ENFORCE)");
+        std::exit(EXIT_FAILURE);
+    }
+#endif
+    return within;
+}
+
+void WebInkAllocTrace::log_cycle() {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        const AllocCounters& phase = phase_counters[i];
+        if (phase.allocations > 0) {
+            WEBINK_LOGI(TAG, "[ALLOC]   phase %-8s %5u allocations %8u bytes %5u frees", PHASE_NAMES[i],
+                        (unsigned) phase.allocations, (unsigned) phase.bytes, (unsigned) phase.frees);
+        }
+    }
+    for (int i = 0; i < site_count; i++) {
+        WEBINK_LOGI(TAG, "[ALLOC]   site  %-16s %5u allocations %8u bytes", sites[i].tag,
+                    (unsigned) sites[i].counters.allocations, (unsigned) sites[i].counters.bytes);
+    }
+    if (untracked_sites > 0) {
+        WEBINK_LOGW(TAG, "[ALLOC]   %u allocations under tags beyond MAX_SITES", (unsigned) untracked_sites);
+    }
+}
+
+//=============================================================================
+// STATISTICS
+//=============================================================================
+
+AllocCounters WebInkAllocTrace::get_phase(TelemetryPhase phase) {
+    return phase_counters[static_cast<int>(phase)];
+}
+
+AllocCounters WebInkAllocTrace::get_cycle() {
+    AllocCounters total = {0, 0, 0};
+    for (const AllocCounters& phase : phase_counters) {
+        total.allocations += phase.allocations;
+        total.bytes += phase.bytes;
+        total.frees += phase.frees;
+    }
+    return total;
+}
+
+uint32_t WebInkAllocTrace::get_violations() {
+    return violations;
+}
+
+} // namespace webink
+} // namespace esphome
+
+//=============================================================================
+// GLOBAL OPERATOR NEW / DELETE
+//=============================================================================
+
+using esphome::webink::traced_allocate;
+using esphome::webink::traced_free;
+
+void* operator new(size_t size) {
+    void* ptr = traced_allocate(size, 0);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return traced_allocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return traced_allocate(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    void* ptr = traced_allocate(size, static_cast<size_t>(align));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return traced_allocate(size, static_cast<size_t>(align));
+}
+
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return traced_allocate(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr) noexcept { traced_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { traced_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { traced_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { traced_free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { traced_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { traced_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { traced_free(ptr); }
+
+#endif
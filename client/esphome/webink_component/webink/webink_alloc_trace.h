@@ -0,0 +1,182 @@
+/**
+ * @file webink_alloc_trace.h
+ * @brief Host-build heap allocation tracer with per-cycle budgets
+ *
+ * MEMORY_OPTIMIZATIONS.md sets the goal that a steady-state cycle does not
+ * touch the heap. WebInkAllocTrace turns that into something a host run can
+ * check: with WEBINK_ALLOC_TRACE=1 the global operator new/delete are
+ * replaced (webink_alloc_trace.cpp) by versions that count every allocation
+ * and its bytes against
+ *
+ * - the current wake-cycle phase (TelemetryPhase, set on each transition)
+ * - the innermost WebInkAllocScope tag, so hot spots show up by name
+ *
+ * At the end of every cycle the controller calls end_cycle() with the kind
+ * of cycle it was. Hash-unchanged and image cycles are compared with their
+ * budget (allocations and bytes); error cycles are only reported. The first
+ * WARMUP_CYCLES cycles after boot size pools and caches and are not checked.
+ * An exceeded budget logs the per-phase counts and the hot spots; with
+ * WEBINK_ALLOC_ENFORCE=1 it also ends the process with a failure exit code,
+ * so a scripted host run fails.
+ *
+ * Build flags (host builds only):
+ * @code
+ * -DWEBINK_ALLOC_TRACE=1            // Replace operator new/delete and count
+ * -DWEBINK_ALLOC_ENFORCE=1          // Exit with failure on an exceeded budget
+ * -DWEBINK_ALLOC_BUDGET_HASH=0      // Allocations allowed in a hash-unchanged cycle
+ * -DWEBINK_ALLOC_BUDGET_IMAGE=0     // Allocations allowed in an image cycle
+ * @endcode
+ *
+ * Without WEBINK_ALLOC_TRACE every call is an empty inline function. The
+ * counters are not thread-safe; host integration runs are single-threaded.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "webink_telemetry.h"
+
+#ifndef WEBINK_ALLOC_TRACE
+#define WEBINK_ALLOC_TRACE 0
+#endif
+
+#ifndef WEBINK_ALLOC_ENFORCE
+#define WEBINK_ALLOC_ENFORCE 0
+#endif
+
+#ifndef WEBINK_ALLOC_BUDGET_HASH
+#define WEBINK_ALLOC_BUDGET_HASH 0
+#endif
+
+#ifndef WEBINK_ALLOC_BUDGET_IMAGE
+#define WEBINK_ALLOC_BUDGET_IMAGE 0
+#endif
+
+#if WEBINK_ALLOC_TRACE && !defined(WEBINK_MAC_INTEGRATION_TEST)
+#error "WEBINK_ALLOC_TRACE replaces operator new and is for host builds only"
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum AllocCycle
+ * @brief Kind of cycle end_cycle() checks
+ */
+enum class AllocCycle : uint8_t {
+    HASH_UNCHANGED = 0,     ///< Hash matched, nothing downloaded
+    IMAGE = 1,              ///< New image downloaded and drawn
+    ERROR = 2               ///< Ended in an error - reported, never checked
+};
+
+static const int ALLOC_CYCLE_COUNT = 3;
+
+/**
+ * @struct AllocCounters
+ * @brief Heap activity in one phase or at one hot spot
+ */
+struct AllocCounters {
+    uint32_t allocations;   ///< operator new calls
+    uint64_t bytes;         ///< Bytes requested
+    uint32_t frees;         ///< operator delete calls (non-null)
+};
+
+/**
+ * @class WebInkAllocTrace
+ * @brief Process-wide allocation counters (static; one per process)
+ *
+ * @example Tagging a hot spot and checking a cycle
+ * @code
+ * {
+ *     WebInkAllocScope scope("json");
+ *     parse_hash_response(body);           // Allocations counted under "json"
+ * }
+ * WebInkAllocTrace::end_cycle(AllocCycle::HASH_UNCHANGED);  // Logs, checks budget
+ * @endcode
+ */
+class WebInkAllocTrace {
+public:
+    static const int MAX_SITES = 32;                            ///< Distinct tags tracked per cycle
+    static const int MAX_TAG_DEPTH = 8;                         ///< Nested WebInkAllocScope levels
+    static const int WARMUP_CYCLES = 1;                         ///< Cycles after boot that are not checked
+    static const bool ENABLED = WEBINK_ALLOC_TRACE != 0;        ///< False when compiled out
+
+#if WEBINK_ALLOC_TRACE
+    /**
+     * @brief Charge following allocations to a phase
+     */
+    static void set_phase(TelemetryPhase phase);
+
+    /**
+     * @brief Tag following allocations (innermost tag wins)
+     * @param tag String literal naming the hot spot
+     */
+    static void push_tag(const char* tag);
+    static void pop_tag();                                      ///< Drop the innermost tag
+
+    /**
+     * @brief Count one allocation (called by operator new)
+     */
+    static void record_allocation(size_t bytes);
+    static void record_free();                                  ///< Count one free (operator delete)
+
+    /**
+     * @brief Set the budget of a cycle kind
+     * @param cycle HASH_UNCHANGED or IMAGE
+     * @param allocations Allocations allowed per cycle
+     * @param bytes Bytes allowed per cycle
+     */
+    static void set_budget(AllocCycle cycle, uint32_t allocations, uint64_t bytes);
+
+    /**
+     * @brief Close the current cycle: log it, check its budget, reset the counters
+     * @param cycle What kind of cycle it was
+     * @return False if the budget was exceeded (never returns with WEBINK_ALLOC_ENFORCE)
+     */
+    static bool end_cycle(AllocCycle cycle);
+
+    static AllocCounters get_phase(TelemetryPhase phase);       ///< This cycle's counters of a phase
+    static AllocCounters get_cycle();                           ///< This cycle's totals
+    static uint32_t get_violations();                           ///< Budgets exceeded since boot
+
+private:
+    static const char* TAG;                                     ///< Logging tag
+
+    /**
+     * @brief Log per-phase counters and hot spots of the current cycle
+     */
+    static void log_cycle();
+#else
+    static void set_phase(TelemetryPhase) {}
+    static void push_tag(const char*) {}
+    static void pop_tag() {}
+    static void record_allocation(size_t) {}
+    static void record_free() {}
+    static void set_budget(AllocCycle, uint32_t, uint64_t) {}
+    static bool end_cycle(AllocCycle) { return true; }
+    static AllocCounters get_phase(TelemetryPhase) { return {0, 0, 0}; }
+    static AllocCounters get_cycle() { return {0, 0, 0}; }
+    static uint32_t get_violations() { return 0; }
+#endif
+};
+
+/**
+ * @class WebInkAllocScope
+ * @brief Tag allocations for the lifetime of the scope
+ */
+class WebInkAllocScope {
+public:
+    explicit WebInkAllocScope(const char* tag) { WebInkAllocTrace::push_tag(tag); }
+    ~WebInkAllocScope() { WebInkAllocTrace::pop_tag(); }
+
+    WebInkAllocScope(const WebInkAllocScope&) = delete;
+    WebInkAllocScope& operator=(const WebInkAllocScope&) = delete;
+};
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,109 @@
+/**
+ * @file webink_arena.cpp
+ * @brief Implementation of WebInkArena
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_arena.h"
+
+namespace esphome {
+namespace webink {
+
+namespace {
+
+alignas(std::max_align_t) uint8_t arena_buffer[WebInkArena::CAPACITY];
+size_t arena_used = 0;
+size_t arena_cycle_peak = 0;
+size_t arena_high_water = 0;
+uint32_t arena_failures = 0;
+uint32_t arena_heap_fallbacks = 0;
+
+} // namespace
+
+//=============================================================================
+// ALLOCATION
+//=============================================================================
+
+void* WebInkArena::allocate(size_t size, size_t align) {
+    size_t start = (arena_used + align - 1) & ~(align - 1);
+    if (size == 0 || start > CAPACITY || size > CAPACITY - start) {
+        arena_failures++;
+        return nullptr;
+    }
+
+    arena_used = start + size;
+    if (arena_used > arena_cycle_peak) {
+        arena_cycle_peak = arena_used;
+    }
+    return arena_buffer + start;
+}
+
+void WebInkArena::deallocate(void* ptr, size_t size) {
+    // Most recent block - give it back so a growing string reuses the space
+    uint8_t* block = static_cast<uint8_t*>(ptr);
+    if (block + size == arena_buffer + arena_used) {
+        arena_used = block - arena_buffer;
+    }
+}
+
+bool WebInkArena::contains(const void* ptr) {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    return p >= arena_buffer && p < arena_buffer + CAPACITY;
+}
+
+const void* WebInkArena::get_storage() {
+    return arena_buffer;
+}
+
+size_t WebInkArena::mark() {
+    return arena_used;
+}
+
+void WebInkArena::rewind(size_t mark) {
+    if (mark <= arena_used) {
+        arena_used = mark;
+    }
+}
+
+void WebInkArena::reset() {
+    if (arena_cycle_peak > arena_high_water) {
+        arena_high_water = arena_cycle_peak;
+    }
+    arena_used = 0;
+    arena_cycle_peak = 0;
+    arena_failures = 0;
+    arena_heap_fallbacks = 0;
+}
+
+//=============================================================================
+// STATISTICS
+//=============================================================================
+
+size_t WebInkArena::get_used() {
+    return arena_used;
+}
+
+size_t WebInkArena::get_high_water() {
+    return arena_cycle_peak > arena_high_water ? arena_cycle_peak : arena_high_water;
+}
+
+size_t WebInkArena::get_cycle_peak() {
+    return arena_cycle_peak;
+}
+
+uint32_t WebInkArena::get_failures() {
+    return arena_failures;
+}
+
+uint32_t WebInkArena::get_heap_fallbacks() {
+    return arena_heap_fallbacks;
+}
+
+void WebInkArena::record_heap_fallback() {
+    arena_heap_fallbacks++;
+}
+
+} // namespace webink
+} // namespace esphome
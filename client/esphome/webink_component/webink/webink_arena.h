@@ -0,0 +1,159 @@
+/**
+ * @file webink_arena.h
+ * @brief Per-wake bump arena for transient allocations
+ *
+ * A wake cycle used to allocate and free many short-lived heap blocks:
+ * response bodies copied into NetworkResult and the queued image slice.
+ * Over long uptimes that fragments the ESP32-C3 heap.
+ * WebInkArena serves these from one static buffer instead:
+ *
+ * - allocate() bumps a pointer; deallocate() only gives memory back when it
+ *   is the most recent block (strings growing in place, LIFO temporaries)
+ * - mark() / rewind() release everything allocated after a mark; the
+ *   controller rewinds once per image slice
+ * - reset() empties the arena; the controller calls it when a cycle ends,
+ *   so every cycle starts with the full capacity
+ *
+ * ArenaAllocator<T> routes standard containers here (ArenaString for text
+ * and bodies). When the arena is full it falls back to the heap and counts
+ * the fallback, so get_heap_fallbacks() reading 0 confirms that a cycle ran
+ * without touching the general heap for these buffers.
+ *
+ * Nothing allocated from the arena may outlive the cycle; long-lived
+ * members that hold ArenaString must release it before reset().
+ *
+ * The capacity is WEBINK_ARENA_SIZE bytes (the `arena_size` YAML option).
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#ifndef WEBINK_ARENA_SIZE
+#define WEBINK_ARENA_SIZE 16384
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @class WebInkArena
+ * @brief Process-wide bump allocator (static; one per device)
+ *
+ * Main loop only - not safe to use from other tasks.
+ *
+ * @example Scoped temporaries
+ * @code
+ * size_t mark = WebInkArena::mark();
+ * ArenaString body;
+ * body.assign(data, length);
+ * // ... use body ...
+ * body = ArenaString();
+ * WebInkArena::rewind(mark);   // Space of everything since mark is reusable
+ * @endcode
+ */
+class WebInkArena {
+public:
+    static const size_t CAPACITY = WEBINK_ARENA_SIZE;           ///< Arena size in bytes
+
+    /**
+     * @brief Allocate from the arena
+     * @param size Bytes to allocate
+     * @param align Alignment (power of two)
+     * @return Block, or nullptr if it does not fit (counted as a failure)
+     */
+    static void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    /**
+     * @brief Return a block to the arena
+     * @param ptr Block from allocate()
+     * @param size Its size
+     *
+     * Only the most recent block is actually reclaimed; others are
+     * reclaimed by rewind() or reset().
+     */
+    static void deallocate(void* ptr, size_t size);
+
+    /**
+     * @brief Check whether a pointer lies inside the arena
+     * @param ptr Pointer to test
+     * @return True for arena memory
+     */
+    static bool contains(const void* ptr);
+
+    static const void* get_storage();                           ///< Start of the static buffer
+
+    static size_t mark();                                       ///< Current fill level, for rewind()
+
+    /**
+     * @brief Release everything allocated since mark()
+     * @param mark Fill level from mark(); ignored if above the current level
+     */
+    static void rewind(size_t mark);
+
+    /**
+     * @brief Empty the arena and start the per-cycle statistics over
+     */
+    static void reset();
+
+    static size_t get_used();                                   ///< Bytes in use
+    static size_t get_high_water();                             ///< Peak bytes in use since boot
+    static size_t get_cycle_peak();                             ///< Peak bytes in use since reset()
+    static uint32_t get_failures();                             ///< allocate() misses since reset()
+    static uint32_t get_heap_fallbacks();                       ///< ArenaAllocator heap blocks since reset()
+
+    /**
+     * @brief Count a block that had to go to the heap instead
+     */
+    static void record_heap_fallback();
+};
+
+/**
+ * @class ArenaAllocator
+ * @brief Standard allocator backed by WebInkArena, heap when full
+ *
+ * Stateless, so containers using it move and swap freely.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* ptr = WebInkArena::allocate(n * sizeof(T), alignof(T));
+        if (ptr == nullptr) {
+            WebInkArena::record_heap_fallback();
+            ptr = ::operator new(n * sizeof(T));
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (WebInkArena::contains(ptr)) {
+            WebInkArena::deallocate(ptr, n * sizeof(T));
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>&) const noexcept { return false; }
+};
+
+/// String whose buffer lives in the wake arena
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+} // namespace webink
+} // namespace esphome
@@ -7,14 +7,42 @@
  */
 
 #include "webink_config.h"
+#include "webink_log.h"
 #include <algorithm>
+#include <cstdarg>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 namespace esphome {
 namespace webink {
 
 const char* WebInkConfig::TAG = "webink.config";
 
+namespace {
+
+/// snprintf into a caller buffer; returns the length, or 0 and "" if truncated
+size_t format_into(char* out, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+size_t format_into(char* out, size_t size, const char* format, ...) {
+    if (out == nullptr || size == 0) {
+        return 0;
+    }
+    
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(out, size, format, args);
+    va_end(args);
+    
+    if (written < 0 || static_cast<size_t>(written) >= size) {
+        out[0] = '\0';
+        return 0;
+    }
+    return static_cast<size_t>(written);
+}
+
+} // namespace
+
 //=============================================================================
 // CONSTRUCTOR
 //=============================================================================
@@ -25,12 +53,17 @@ WebInkConfig::WebInkConfig() {
     strcpy(device_id, "default");
     strcpy(api_key, "myapikey");
     strcpy(display_mode, "800x480x1xB");
-    
-    ESP_LOGD(TAG, "WebInkConfig initialized with fixed arrays (no dynamic allocation)");
-    ESP_LOGD(TAG, "Server URL: %s", base_url);
-    ESP_LOGD(TAG, "Device ID: %s", device_id);
-    ESP_LOGD(TAG, "Display mode: %s", display_mode);
-    ESP_LOGD(TAG, "Socket port: %d", socket_mode_port);
+    server_address_[0] = '\0';
+    request_base_url_[0] = '\0';
+    strcpy(server_urls_[0], base_url);
+    server_count_ = 1;
+    active_server_ = 0;
+    
+    WEBINK_LOGD(TAG, "WebInkConfig initialized with fixed arrays (no dynamic allocation)");
+    WEBINK_LOGD(TAG, "Server URL: %s", base_url);
+    WEBINK_LOGD(TAG, "Device ID: %s", device_id);
+    WEBINK_LOGD(TAG, "Display mode: %s", display_mode);
+    WEBINK_LOGD(TAG, "Socket port: %d", socket_mode_port);
 }
 
 //=============================================================================
@@ -39,33 +72,61 @@ WebInkConfig::WebInkConfig() {
 
 bool WebInkConfig::set_server_url(const char* url) {
     if (!url || !validate_url(url)) {
-        ESP_LOGW(TAG, "Invalid server URL format: %s", url ? url : "NULL");
+        WEBINK_LOGW(TAG, "Invalid server URL format: %s", url ? url : "NULL");
         return false;
     }
     
     if (strlen(url) >= sizeof(base_url)) {
-        ESP_LOGW(TAG, "Server URL too long (max %zu chars): %s", sizeof(base_url)-1, url);
+        WEBINK_LOGW(TAG, "Server URL too long (max %zu chars): %s", sizeof(base_url)-1, url);
         return false;
     }
     
     char old_url[sizeof(base_url)];
     strcpy(old_url, base_url);
     strcpy(base_url, url);
+    strcpy(server_urls_[0], url);
+    active_server_ = 0;
+    set_server_address(nullptr);  // Resolved for the old host
     
-    ESP_LOGI(TAG, "Server URL updated: %s -> %s", old_url, base_url);
+    WEBINK_LOGI(TAG, "Server URL updated: %s -> %s", old_url, base_url);
     notify_change("server_url");
     
     return true;
 }
 
+bool WebInkConfig::add_server_url(const char* url) {
+    if (!url || !validate_url(url)) {
+        WEBINK_LOGW(TAG, "Invalid fallback server URL format: %s", url ? url : "NULL");
+        return false;
+    }
+    
+    if (strlen(url) >= sizeof(server_urls_[0])) {
+        WEBINK_LOGW(TAG, "Fallback server URL too long (max %zu chars): %s", sizeof(server_urls_[0])-1, url);
+        return false;
+    }
+    
+    if (server_count_ >= MAX_SERVERS) {
+        WEBINK_LOGW(TAG, "Too many servers (max %d) - ignoring %s", MAX_SERVERS, url);
+        return false;
+    }
+    
+    strcpy(server_urls_[server_count_], url);
+    server_count_++;
+    
+    WEBINK_LOGI(TAG, "Fallback server %d: %s", server_count_ - 1, url);
+    notify_change("server_urls");
+    
+    return true;
+}
+
 bool WebInkConfig::set_device_id(const char* id) {
     if (!id || !validate_device_id(id)) {
-        ESP_LOGW(TAG, "Invalid device ID format: %s", id ? id : "NULL");
+        WEBINK_LOGW(TAG, "Invalid device ID format: %s", id ? id : "NULL");
         return false;
     }
     
     if (strlen(id) >= sizeof(device_id)) {
-        ESP_LOGW(TAG, "Device ID too long (max %zu chars): %s", sizeof(device_id)-1, id);
+        WEBINK_LOGW(TAG, "Device ID too long (max %zu chars): %s", sizeof(device_id)-1, id);
         return false;
     }
     
@@ -73,7 +134,7 @@ bool WebInkConfig::set_device_id(const char* id) {
     strcpy(old_id, device_id);
     strcpy(device_id, id);
     
-    ESP_LOGI(TAG, "Device ID updated: %s -> %s", old_id, device_id);
+    WEBINK_LOGI(TAG, "Device ID updated: %s -> %s", old_id, device_id);
     notify_change("device_id");
     
     return true;
@@ -82,30 +143,43 @@ bool WebInkConfig::set_device_id(const char* id) {
 void WebInkConfig::set_api_key(const char* key) {
     if (!key) {
         api_key[0] = '\0';
-        ESP_LOGI(TAG, "API key cleared");
+        WEBINK_LOGI(TAG, "API key cleared");
         return;
     }
     
     if (strlen(key) >= sizeof(api_key)) {
-        ESP_LOGW(TAG, "API key too long (max %zu chars), truncating", sizeof(api_key)-1);
+        WEBINK_LOGW(TAG, "API key too long (max %zu chars), truncating", sizeof(api_key)-1);
         strncpy(api_key, key, sizeof(api_key) - 1);
         api_key[sizeof(api_key) - 1] = '\0';
     } else {
         strcpy(api_key, key);
     }
     
-    ESP_LOGI(TAG, "API key updated (length: %zu characters)", strlen(api_key));
+    WEBINK_LOGI(TAG, "API key updated (length: %zu characters)", strlen(api_key));
     notify_change("api_key");
 }
 
 bool WebInkConfig::set_display_mode(const char* mode) {
     if (!mode || !validate_display_mode(mode)) {
-        ESP_LOGW(TAG, "Invalid display mode format: %s", mode ? mode : "NULL");
+        WEBINK_LOGW(TAG, "Invalid display mode format: %s", mode ? mode : "NULL");
+        return false;
+    }
+    
+#if WEBINK_FIXED_GEOMETRY
+    if (DisplayGeometry::parse(mode) != COMPILED_GEOMETRY) {
+        WEBINK_LOGW(TAG, "Display mode %s differs from the compiled geometry %dx%d (fixed_geometry)",
+                    mode, COMPILED_GEOMETRY.width, COMPILED_GEOMETRY.height);
         return false;
     }
+#else
+    if (DisplayGeometry::parse(mode).width > WEBINK_MAX_DISPLAY_WIDTH) {
+        WEBINK_LOGW(TAG, "Display mode %s is wider than %d pixels", mode, WEBINK_MAX_DISPLAY_WIDTH);
+        return false;
+    }
+#endif
     
     if (strlen(mode) >= sizeof(display_mode)) {
-        ESP_LOGW(TAG, "Display mode too long (max %zu chars): %s", sizeof(display_mode)-1, mode);
+        WEBINK_LOGW(TAG, "Display mode too long (max %zu chars): %s", sizeof(display_mode)-1, mode);
         return false;
     }
     
@@ -113,7 +187,7 @@ bool WebInkConfig::set_display_mode(const char* mode) {
     strcpy(old_mode, display_mode);
     strcpy(display_mode, mode);
     
-    ESP_LOGI(TAG, "Display mode updated: %s -> %s", old_mode, display_mode);
+    WEBINK_LOGI(TAG, "Display mode updated: %s -> %s", old_mode, display_mode);
     notify_change("display_mode");
     
     return true;
@@ -121,7 +195,7 @@ bool WebInkConfig::set_display_mode(const char* mode) {
 
 bool WebInkConfig::set_socket_port(int port) {
     if (port < 0 || port > 65535) {
-        ESP_LOGW(TAG, "Invalid socket port: %d (must be 0-65535)", port);
+        WEBINK_LOGW(TAG, "Invalid socket port: %d (must be 0-65535)", port);
         return false;
     }
     
@@ -129,9 +203,9 @@ bool WebInkConfig::set_socket_port(int port) {
     socket_mode_port = port;
     
     if (port == 0) {
-        ESP_LOGI(TAG, "Socket mode DISABLED - using HTTP mode");
+        WEBINK_LOGI(TAG, "Socket mode DISABLED - using HTTP mode");
     } else {
-        ESP_LOGI(TAG, "Socket port updated: %d -> %d", old_port, port);
+        WEBINK_LOGI(TAG, "Socket port updated: %d -> %d", old_port, port);
     }
     
     notify_change("socket_port");
@@ -140,14 +214,14 @@ bool WebInkConfig::set_socket_port(int port) {
 
 bool WebInkConfig::set_rows_per_slice(int rows) {
     if (rows < 1 || rows > 64) {
-        ESP_LOGW(TAG, "Invalid rows per slice: %d (must be 1-64)", rows);
+        WEBINK_LOGW(TAG, "Invalid rows per slice: %d (must be 1-64)", rows);
         return false;
     }
     
     int old_rows = rows_per_slice;
     rows_per_slice = rows;
     
-    ESP_LOGI(TAG, "Rows per slice updated: %d -> %d", old_rows, rows);
+    WEBINK_LOGI(TAG, "Rows per slice updated: %d -> %d", old_rows, rows);
     notify_change("rows_per_slice");
     
     return true;
@@ -158,62 +232,30 @@ bool WebInkConfig::set_rows_per_slice(int rows) {
 //=============================================================================
 
 bool WebInkConfig::parse_display_mode(int& width, int& height, int& bits, ColorMode& mode) const {
-    // Parse format: "800x480x1xB" using manual parsing (no regex - avoids stack overflow)
-    const char* str = display_mode;
-    char* endptr;
-    
-    // Parse width
-    width = strtol(str, &endptr, 10);
-    if (str == endptr || *endptr != 'x') {
-        ESP_LOGW(TAG, "Display mode parse failed at width: %s", display_mode);
-        return false;
-    }
-    str = endptr + 1;  // Skip 'x'
-    
-    // Parse height  
-    height = strtol(str, &endptr, 10);
-    if (str == endptr || *endptr != 'x') {
-        ESP_LOGW(TAG, "Display mode parse failed at height: %s", display_mode);
+    // One parser for both modes: the constant with a fixed geometry, else DisplayGeometry::parse()
+    DisplayGeometry geometry = get_geometry();
+    if (!geometry.is_valid()) {
+        WEBINK_LOGW(TAG, "Display mode parse failed: %s", display_mode);
         return false;
     }
-    str = endptr + 1;  // Skip 'x'
-    
-    // Parse bits
-    bits = strtol(str, &endptr, 10);
-    if (str == endptr || *endptr != 'x') {
-        ESP_LOGW(TAG, "Display mode parse failed at bits: %s", display_mode);
-        return false;
-    }
-    str = endptr + 1;  // Skip 'x'
-    
-    // Parse color mode character
-    char mode_char = *str;
-    if (mode_char == '\0' || *(str + 1) != '\0') {
-        ESP_LOGW(TAG, "Display mode parse failed at color mode: %s", display_mode);
-        return false;
-    }
-    
-    if (!parse_color_mode_char(mode_char, mode)) {
-        return false;
-    }
-    
-    // Validate parsed values
-    if (width <= 0 || height <= 0 || 
-        (bits != 1 && bits != 2 && bits != 8 && bits != 24)) {
-        ESP_LOGW(TAG, "Invalid display mode values: %dx%dx%d", width, height, bits);
-        return false;
-    }
-    
-    ESP_LOGD(TAG, "Parsed display mode: %dx%d, %d bits, mode=%s",
-             width, height, bits, color_mode_to_string(mode));
     
+    width = geometry.width;
+    height = geometry.height;
+    bits = geometry.bits;
+    mode = geometry.mode;
     return true;
 }
 
 bool WebInkConfig::validate_display_mode(const std::string& mode) const {
-    int width, height, bits;
-    ColorMode color_mode;
-    return parse_display_mode(width, height, bits, color_mode);
+    return DisplayGeometry::parse(mode.c_str()).is_valid();
+}
+
+DisplayGeometry WebInkConfig::get_geometry() const {
+#if WEBINK_FIXED_GEOMETRY
+    return COMPILED_GEOMETRY;
+#else
+    return DisplayGeometry::parse(display_mode);
+#endif
 }
 
 NetworkMode WebInkConfig::get_network_mode() const {
@@ -224,22 +266,30 @@ NetworkMode WebInkConfig::get_network_mode() const {
 // URL BUILDING UTILITIES
 //=============================================================================
 
-std::string WebInkConfig::build_hash_url() const {
-    // Use static buffer to avoid stack allocation (thread-safe in single-threaded ESP32 context)
-    static char buffer[256];  // Much smaller, still sufficient for URLs
-    snprintf(buffer, sizeof(buffer), 
-             "%s/get_hash?api_key=%s&device=%s&mode=%s",
-             base_url,     // Now char arrays, no .c_str() needed
-             api_key, 
-             device_id, 
-             display_mode);
-    
-    return std::string(buffer);
+size_t WebInkConfig::build_hash_url(char* out, size_t size) const {
+    return format_into(out, size,
+                       "%s/get_hash?api_key=%s&device=%s&mode=%s",
+                       get_request_base_url(),
+                       api_key,
+                       device_id,
+                       display_mode);
+}
+
+size_t WebInkConfig::build_image_url_prefix(char* out, size_t size, const char* format) const {
+    return format_into(out, size,
+                       "%s/get_image?api_key=%s&device=%s&mode=%s&format=%s",
+                       get_request_base_url(),
+                       api_key,
+                       device_id,
+                       display_mode,
+                       format);
 }
 
-std::string WebInkConfig::build_image_url(const ImageRequest& request) const {
-    // Use static buffer to avoid stack allocation - reduced from 1024 to 384 bytes!
-    static char buffer[384];  // Still enough for longest URLs but much more memory-efficient
+size_t WebInkConfig::build_image_url_slice(char* out, size_t size, size_t prefix_length,
+                                           const ImageRequest& request) const {
+    if (out == nullptr || prefix_length == 0 || prefix_length >= size) {
+        return 0;
+    }
     
     // Use slice-based parameters if available, otherwise use rect parameters
     int x = request.rect.x;
@@ -247,116 +297,202 @@ std::string WebInkConfig::build_image_url(const ImageRequest& request) const {
     int w = request.rect.width;
     int h = request.num_rows > 0 ? request.num_rows : request.rect.height;  // Use num_rows if specified
     
-    snprintf(buffer, sizeof(buffer),
-             "%s/get_image?api_key=%s&device=%s&mode=%s&x=%d&y=%d&w=%d&h=%d&format=%s",
-             base_url,
-             api_key,
-             device_id,
-             display_mode,
-             x, y, w, h,
-             request.format.c_str());
+    char* tail = out + prefix_length;
+    size_t tail_size = size - prefix_length;
+    size_t length;
+    if (request.is_conditional()) {
+        // Conditional fetch: server answers 304 if its hash still matches
+        length = format_into(tail, tail_size, "&x=%d&y=%d&w=%d&h=%d&if_none_match=%s",
+                             x, y, w, h, request.if_none_match);
+    } else {
+        length = format_into(tail, tail_size, "&x=%d&y=%d&w=%d&h=%d", x, y, w, h);
+    }
     
-    return std::string(buffer);
+    if (length == 0) {
+        out[0] = '\0';
+        return 0;
+    }
+    return prefix_length + length;
 }
 
-std::string WebInkConfig::build_log_url() const {
-    // Use static buffer to avoid stack allocation
-    static char buffer[192];  // Reduced from 512 to 192 bytes
-    snprintf(buffer, sizeof(buffer),
-             "%s/post_log?api_key=%s&device=%s",
-             base_url,
-             api_key,
-             device_id);
-    
-    return std::string(buffer);
+size_t WebInkConfig::build_image_url(char* out, size_t size, const ImageRequest& request) const {
+    size_t prefix_length = build_image_url_prefix(out, size, request.format);
+    return build_image_url_slice(out, size, prefix_length, request);
 }
 
-std::string WebInkConfig::build_sleep_url() const {
-    // Use static buffer to avoid stack allocation
-    static char buffer[192];  // Reduced from 512 to 192 bytes
-    snprintf(buffer, sizeof(buffer),
-             "%s/get_sleep?api_key=%s&device=%s",
-             base_url,
-             api_key,
-             device_id);
-    
-    return std::string(buffer);
+size_t WebInkConfig::build_log_url(char* out, size_t size) const {
+    return format_into(out, size,
+                       "%s/post_log?api_key=%s&device=%s",
+                       get_request_base_url(),
+                       api_key,
+                       device_id);
 }
 
-std::string WebInkConfig::build_socket_request(const ImageRequest& request) const {
-    // Use static buffer to avoid stack allocation
-    static char buffer[128];  // Reduced from 256 to 128 bytes
-    snprintf(buffer, sizeof(buffer),
-             "webInkV1 %s %s %s %d %d %d %d %s\n",
-             api_key,
-             device_id,
-             display_mode,
-             request.rect.x,
-             request.rect.y,
-             request.rect.width,
-             request.rect.height,
-             request.format.c_str());
-    
-    return std::string(buffer);
+size_t WebInkConfig::build_log_batch_url(char* out, size_t size) const {
+    return format_into(out, size,
+                       "%s/post_log_batch?api_key=%s&device=%s",
+                       get_request_base_url(),
+                       api_key,
+                       device_id);
+}
+
+size_t WebInkConfig::build_sleep_url(char* out, size_t size) const {
+    return format_into(out, size,
+                       "%s/get_sleep?api_key=%s&device=%s",
+                       get_request_base_url(),
+                       api_key,
+                       device_id);
+}
+
+size_t WebInkConfig::build_socket_request(char* out, size_t size, const ImageRequest& request) const {
+    // webInkV2 appends if_none_match; the server then prefixes a status line
+    if (request.is_conditional()) {
+        return format_into(out, size,
+                           "webInkV2 %s %s %s %d %d %d %d %s %s\n",
+                           api_key,
+                           device_id,
+                           display_mode,
+                           request.rect.x,
+                           request.rect.y,
+                           request.rect.width,
+                           request.rect.height,
+                           request.format,
+                           request.if_none_match);
+    }
+    
+    return format_into(out, size,
+                       "webInkV1 %s %s %s %d %d %d %d %s\n",
+                       api_key,
+                       device_id,
+                       display_mode,
+                       request.rect.x,
+                       request.rect.y,
+                       request.rect.width,
+                       request.rect.height,
+                       request.format);
 }
 
 //=============================================================================
 // NETWORK PARSING UTILITIES
 //=============================================================================
 
-bool WebInkConfig::parse_server_host(std::string& host, int& port) const {
-    std::string url = base_url;
-    
-    // Remove protocol if present
-    size_t proto_pos = url.find("://");
-    if (proto_pos != std::string::npos) {
-        url = url.substr(proto_pos + 3);
-    }
-    
-    // Find port delimiter
-    size_t port_pos = url.find(":");
-    if (port_pos != std::string::npos) {
-        host = url.substr(0, port_pos);
-        
-        // Extract port number
-        size_t path_pos = url.find("/", port_pos);
-        std::string port_str;
-        if (path_pos != std::string::npos) {
-            port_str = url.substr(port_pos + 1, path_pos - port_pos - 1);
-        } else {
-            port_str = url.substr(port_pos + 1);
-        }
-        
-        try {
-            port = std::stoi(port_str);
-        } catch (const std::exception& e) {
-            ESP_LOGW(TAG, "Invalid port in URL: %s", port_str.c_str());
+bool WebInkConfig::parse_server_host(char* host, size_t host_size, int& port) const {
+    return parse_url_host(base_url, host, host_size, port);
+}
+
+bool WebInkConfig::parse_url_host(const char* url_text, char* host, size_t host_size, int& port) {
+    // Scan in place: every hash request resolves the host, and substr()
+    // copies of a full URL would put it on the heap each time
+    const char* start = strstr(url_text, "://");
+    start = start != nullptr ? start + 3 : url_text;
+    size_t host_length = strcspn(start, ":/");
+    if (host_size == 0) {
+        return false;
+    }
+    host[0] = '\0';
+    if (host_length >= host_size) {
+        WEBINK_LOGW(TAG, "Host too long (max %zu chars): %s", host_size - 1, url_text);
+        return false;
+    }
+    memcpy(host, start, host_length);
+    host[host_length] = '\0';
+    
+    port = 80; // Default HTTP port
+    const char* port_text = start + host_length;
+    if (*port_text == ':') {
+        char* port_end = nullptr;
+        long value = strtol(port_text + 1, &port_end, 10);
+        if (port_end == port_text + 1 || (*port_end != '\0' && *port_end != '/')) {
+            WEBINK_LOGW(TAG, "Invalid port in URL: %s", url_text);
             return false;
         }
-    } else {
-        // No port specified, find end of hostname
-        size_t path_pos = url.find("/");
-        if (path_pos != std::string::npos) {
-            host = url.substr(0, path_pos);
-        } else {
-            host = url;
-        }
-        port = 80; // Default HTTP port
+        port = value > 0 && value <= 65535 ? static_cast<int>(value) : 0;
     }
     
-    return !host.empty() && port > 0 && port <= 65535;
+    return host_length > 0 && port > 0;
 }
 
-std::string WebInkConfig::get_server_hostname() const {
-    std::string host;
+bool WebInkConfig::get_server_hostname(char* host, size_t host_size) const {
     int port;
+    return parse_server_host(host, host_size, port);
+}
+
+//=============================================================================
+// SERVER LIST
+//=============================================================================
+
+const char* WebInkConfig::get_server_url(int index) const {
+    if (index < 0 || index >= server_count_) {
+        return nullptr;
+    }
+    return server_urls_[index];
+}
+
+bool WebInkConfig::parse_server_host(int index, char* host, size_t host_size, int& port) const {
+    const char* url = get_server_url(index);
+    return url && parse_url_host(url, host, host_size, port);
+}
+
+bool WebInkConfig::select_server(int index) {
+    const char* url = get_server_url(index);
+    if (!url) {
+        return false;
+    }
+    
+    if (index != active_server_) {
+        WEBINK_LOGI(TAG, "Switching to server %d: %s", index, url);
+    }
+    strcpy(base_url, url);
+    active_server_ = index;
+    set_server_address(nullptr);  // Resolved for the previous server
+    
+    return true;
+}
+
+//=============================================================================
+// RESOLVED SERVER ADDRESS
+//=============================================================================
+
+bool WebInkConfig::set_server_address(const char* ip) {
+    server_address_[0] = '\0';
+    request_base_url_[0] = '\0';
     
-    if (parse_server_host(host, port)) {
-        return host;
+    if (!ip || !ip[0]) {
+        return false;
+    }
+    if (strncmp(base_url, "https://", 8) == 0) {
+        WEBINK_LOGD(TAG, "HTTPS server - keeping hostname in URLs");
+        return false;
+    }
+    
+    // Split base_url into "scheme://" + host + ":port/path" and swap the host
+    const char* host_start = strstr(base_url, "://");
+    host_start = host_start ? host_start + 3 : base_url;
+    const char* host_end = host_start + strcspn(host_start, ":/");
+    
+    int written = snprintf(request_base_url_, sizeof(request_base_url_), "%.*s%s%s",
+                           static_cast<int>(host_start - base_url), base_url, ip, host_end);
+    if (written < 0 || written >= static_cast<int>(sizeof(request_base_url_)) ||
+        strlen(ip) >= sizeof(server_address_)) {
+        request_base_url_[0] = '\0';
+        return false;
     }
     
-    // Fallback: return base_url as-is
-    return base_url;
+    strcpy(server_address_, ip);
+    WEBINK_LOGD(TAG, "Requests go to %s", request_base_url_);
+    return true;
+}
+
+const char* WebInkConfig::get_request_base_url() const {
+    return request_base_url_[0] ? request_base_url_ : base_url;
+}
+
+bool WebInkConfig::get_server_connect_host(char* host, size_t host_size) const {
+    if (server_address_[0]) {
+        int written = snprintf(host, host_size, "%s", server_address_);
+        return written > 0 && written < static_cast<int>(host_size);
+    }
+    return get_server_hostname(host, host_size);
 }
 
 //=============================================================================
@@ -364,26 +500,12 @@ std::string WebInkConfig::get_server_hostname() const {
 //=============================================================================
 
 int WebInkConfig::calculate_bytes_per_row() const {
-    int width, height, bits;
-    ColorMode mode;
-    
-    if (!parse_display_mode(width, height, bits, mode)) {
-        ESP_LOGW(TAG, "Cannot calculate bytes per row - invalid display mode");
+    DisplayGeometry geometry = get_geometry();
+    if (!geometry.is_valid()) {
+        WEBINK_LOGW(TAG, "Cannot calculate bytes per row - invalid display mode");
         return 0;
     }
-    
-    switch (mode) {
-        case ColorMode::MONO_BLACK_WHITE:
-            return (width + 7) / 8;  // 1-bit packed
-        case ColorMode::GRAYSCALE_8BIT:
-            return width;            // 1 byte per pixel
-        case ColorMode::RGBB_4COLOR:
-            return (width + 3) / 4;  // 2-bits per pixel
-        case ColorMode::RGB_FULL_COLOR:
-            return width * 3;        // 3 bytes per pixel
-        default:
-            return width;            // Conservative fallback
-    }
+    return webink_row_bytes<FIXED_ROW_BYTES>(geometry.bytes_per_row());
 }
 
 int WebInkConfig::calculate_optimal_rows_per_slice(int available_bytes) const {
@@ -396,31 +518,24 @@ int WebInkConfig::calculate_optimal_rows_per_slice(int available_bytes) const {
     max_rows = std::max(1, max_rows); // Always allow at least 1 row
     max_rows = std::min(max_rows, 64); // Cap at reasonable maximum
     
-    ESP_LOGD(TAG, "Optimal rows for %d bytes: %d (bytes_per_row=%d)",
-             available_bytes, max_rows, bytes_per_row);
+    WEBINK_LOGD(TAG, "Optimal rows for %d bytes: %d (bytes_per_row=%d)",
+                available_bytes, max_rows, bytes_per_row);
     
     return max_rows;
 }
 
 int WebInkConfig::calculate_total_image_bytes() const {
-    int width, height, bits;
-    ColorMode mode;
-    
-    if (!parse_display_mode(width, height, bits, mode)) {
-        return 0;
-    }
-    
-    int bytes_per_row = calculate_bytes_per_row();
-    return bytes_per_row * height;
+    DisplayGeometry geometry = get_geometry();
+    return geometry.is_valid() ? geometry.image_bytes() : 0;
 }
 
 //=============================================================================
 // CHANGE NOTIFICATION
 //=============================================================================
 
-void WebInkConfig::set_change_callback(std::function<void(const std::string&)> callback) {
+void WebInkConfig::set_change_callback(WebInkDelegate<void(const std::string&)> callback) {
     on_config_changed = callback;
-    ESP_LOGD(TAG, "Change callback registered");
+    WEBINK_LOGD(TAG, "Change callback registered");
 }
 
 //=============================================================================
@@ -499,8 +614,12 @@ void WebInkConfig::reset_to_defaults() {
     strcpy(display_mode, "800x480x1xB");
     socket_mode_port = 8091;
     rows_per_slice = 8;
+    strcpy(server_urls_[0], base_url);
+    server_count_ = 1;
+    active_server_ = 0;
+    set_server_address(nullptr);
     
-    ESP_LOGI(TAG, "Configuration reset to defaults");
+    WEBINK_LOGI(TAG, "Configuration reset to defaults");
     notify_change("reset_to_defaults");
 }
 
@@ -514,15 +633,15 @@ void WebInkConfig::notify_change(const std::string& parameter) {
     }
 }
 
-bool WebInkConfig::validate_url(const std::string& url) const {
-    if (url.empty()) return false;
+bool WebInkConfig::validate_url(const char* url) const {
+    if (!url) return false;
     
     // Basic URL validation - should start with http:// or https://
-    if (url.length() < 10) {
+    if (strlen(url) < 10) {
         return false;
     }
     
-    if (url.substr(0, 7) != "http://" && url.substr(0, 8) != "https://") {
+    if (strncmp(url, "http://", 7) != 0 && strncmp(url, "https://", 8) != 0) {
         return false;
     }
     
@@ -547,25 +666,5 @@ bool WebInkConfig::validate_device_id(const std::string& id) const {
     return true;
 }
 
-bool WebInkConfig::parse_color_mode_char(char mode_char, ColorMode& mode) const {
-    switch (mode_char) {
-        case 'B':
-            mode = ColorMode::MONO_BLACK_WHITE;
-            return true;
-        case 'G':
-            mode = ColorMode::GRAYSCALE_8BIT;
-            return true;
-        case 'R':
-            mode = ColorMode::RGBB_4COLOR;
-            return true;
-        case 'C':
-            mode = ColorMode::RGB_FULL_COLOR;
-            return true;
-        default:
-            ESP_LOGW(TAG, "Unknown color mode character: %c", mode_char);
-            return false;
-    }
-}
-
 } // namespace webink
 } // namespace esphome
@@ -22,7 +22,6 @@
 
 #include <string>
 #include <cstdint>
-#include <functional>
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
 // Mac integration test mode - use local declarations
@@ -36,6 +35,7 @@ void ESP_LOGD(const char* tag, const char* format, ...);
 #include "esphome/components/wifi/wifi_component.h"
 #endif
 
+#include "webink_geometry.h"
 #include "webink_types.h"
 
 namespace esphome {
@@ -66,9 +66,11 @@ namespace webink {
  * config.set_display_mode("800x480x1xB");
  * 
  * // Build URLs for server communication
- * std::string hash_url = config.build_hash_url();
+ * char hash_url[URL_BUFFER_SIZE];
+ * config.build_hash_url(hash_url, sizeof(hash_url));
  * ImageRequest request;
- * std::string image_url = config.build_image_url(request);
+ * char image_url[URL_BUFFER_SIZE];
+ * config.build_image_url(image_url, sizeof(image_url), request);
  * @endcode
  */
 class WebInkConfig {
@@ -119,6 +121,16 @@ public:
      */
     bool set_server_url(const char* url);
 
+    /**
+     * @brief Add a fallback server
+     * @param url Server URL (e.g., "http://backup:8090")
+     * @return True if URL is valid and there was room (MAX_SERVERS total)
+     * 
+     * The server set with set_server_url() is server 0; fallbacks follow in
+     * the order they are added. All servers must serve the same content.
+     */
+    bool add_server_url(const char* url);
+
     /**
      * @brief Set device identifier with validation
      * @param id Device ID string (alphanumeric, hyphens, underscores allowed)
@@ -175,6 +187,13 @@ public:
      */
     bool parse_display_mode(int& width, int& height, int& bits, ColorMode& mode) const;
 
+    /**
+     * @brief Current display geometry
+     * @return COMPILED_GEOMETRY with a fixed geometry, else the parsed
+     *         display mode (invalid if it does not parse)
+     */
+    DisplayGeometry get_geometry() const;
+
     /**
      * @brief Validate display mode string without parsing
      * @param mode Display mode string to validate
@@ -192,48 +211,102 @@ public:
     // URL BUILDING UTILITIES
     //=========================================================================
 
+    // Each builder writes a NUL-terminated string into the caller's buffer
+    // and returns its length, or 0 (with out set to "") if it did not fit.
+    // Nothing is allocated and no state is kept between calls.
+
     /**
      * @brief Build URL for hash request
-     * @return Complete URL for hash endpoint
+     * @param out Destination buffer (URL_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
+     * @return Length of the URL, 0 if it did not fit
      * 
      * Builds URL: {base_url}/get_hash?api_key={key}&device={id}&mode={mode}
      */
-    std::string build_hash_url() const;
+    size_t build_hash_url(char* out, size_t size) const;
 
     /**
-     * @brief Build URL for image request
+     * @brief Build the constant part of the image URL
+     * @param out Destination buffer, later passed to build_image_url_slice()
+     * @param size Size of out in bytes
+     * @param format Image format ("pbm", "pgm", "ppm")
+     * @return Length of the prefix, 0 if it did not fit
+     * 
+     * Builds: {base_url}/get_image?api_key={key}&device={id}&mode={mode}&format={format}
+     * 
+     * Everything but the slice position is fixed for a download, so the
+     * controller builds this once and patches only the numbers per slice.
+     */
+    size_t build_image_url_prefix(char* out, size_t size, const char* format) const;
+
+    /**
+     * @brief Complete an image URL after its prefix
+     * @param out Buffer holding the prefix from build_image_url_prefix()
+     * @param size Size of out in bytes
+     * @param prefix_length Length returned by build_image_url_prefix()
+     * @param request Slice to request (request.format is taken from the prefix)
+     * @return Length of the complete URL, 0 if it did not fit
+     * 
+     * Overwrites everything after the prefix with
+     * &x={x}&y={y}&w={w}&h={h}, plus &if_none_match={hash} when
+     * request.if_none_match is set.
+     */
+    size_t build_image_url_slice(char* out, size_t size, size_t prefix_length,
+                                 const ImageRequest& request) const;
+
+    /**
+     * @brief Build URL for image request in one step
+     * @param out Destination buffer (URL_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
      * @param request Image request parameters
-     * @return Complete URL for image endpoint
+     * @return Length of the URL, 0 if it did not fit
      * 
-     * Builds URL: {base_url}/get_image?api_key={key}&device={id}&mode={mode}&
-     *             x={x}&y={y}&w={w}&h={h}&format={format}
+     * Same result as build_image_url_prefix() followed by build_image_url_slice()
      */
-    std::string build_image_url(const ImageRequest& request) const;
+    size_t build_image_url(char* out, size_t size, const ImageRequest& request) const;
 
     /**
      * @brief Build URL for log posting
-     * @return Complete URL for log endpoint
+     * @param out Destination buffer (URL_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
+     * @return Length of the URL, 0 if it did not fit
      * 
      * Builds URL: {base_url}/post_log?api_key={key}&device={id}
      */
-    std::string build_log_url() const;
+    size_t build_log_url(char* out, size_t size) const;
+
+    /**
+     * @brief Build URL for batched log upload
+     * @param out Destination buffer (URL_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
+     * @return Length of the URL, 0 if it did not fit
+     * 
+     * Builds URL: {base_url}/post_log_batch?api_key={key}&device={id}
+     */
+    size_t build_log_batch_url(char* out, size_t size) const;
 
     /**
      * @brief Build URL for sleep interval request
-     * @return Complete URL for sleep endpoint
+     * @param out Destination buffer (URL_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
+     * @return Length of the URL, 0 if it did not fit
      * 
      * Builds URL: {base_url}/get_sleep?api_key={key}&device={id}
      */
-    std::string build_sleep_url() const;
+    size_t build_sleep_url(char* out, size_t size) const;
 
     /**
      * @brief Build socket request string for TCP mode
+     * @param out Destination buffer (SOCKET_REQUEST_BUFFER_SIZE is always enough)
+     * @param size Size of out in bytes
      * @param request Image request parameters
-     * @return Socket protocol request string
+     * @return Length of the request line, 0 if it did not fit
      * 
      * Builds request: "webInkV1 {api_key} {device} {mode} {x} {y} {w} {h} {format}\n"
+     * or, when request.if_none_match is set, the webInkV2 form with the hash
+     * appended as a tenth field
      */
-    std::string build_socket_request(const ImageRequest& request) const;
+    size_t build_socket_request(char* out, size_t size, const ImageRequest& request) const;
 
     //=========================================================================
     // NETWORK PARSING UTILITIES
@@ -241,7 +314,8 @@ public:
 
     /**
      * @brief Parse server host and port from base URL
-     * @param[out] host Hostname or IP address
+     * @param[out] host Buffer for the hostname or IP address
+     * @param host_size Size of host (HOST_BUFFER_SIZE always fits)
      * @param[out] port Port number (HTTP port from URL or 80 default)
      * @return True if parsing was successful
      * 
@@ -249,13 +323,86 @@ public:
      * - "http://server:8090" -> host="server", port=8090
      * - "http://192.168.1.100" -> host="192.168.1.100", port=80
      */
-    bool parse_server_host(std::string& host, int& port) const;
+    bool parse_server_host(char* host, size_t host_size, int& port) const;
 
     /**
      * @brief Extract hostname for socket connections
-     * @return Hostname or IP address from base_url
+     * @param[out] host Buffer for the hostname or IP address from base_url
+     * @param host_size Size of host (HOST_BUFFER_SIZE always fits)
+     * @return True if base_url has a host
      */
-    std::string get_server_hostname() const;
+    bool get_server_hostname(char* host, size_t host_size) const;
+
+    //=========================================================================
+    // SERVER LIST
+    //=========================================================================
+
+    /**
+     * @brief Get number of configured servers
+     * @return 1 + number of fallback servers
+     */
+    int get_server_count() const { return server_count_; }
+
+    /**
+     * @brief Get a configured server URL
+     * @param index Server index (0 = primary)
+     * @return Server URL, or nullptr if index is out of range
+     */
+    const char* get_server_url(int index) const;
+
+    /**
+     * @brief Parse host and port of a configured server
+     * @param index Server index (0 = primary)
+     * @param[out] host Buffer for the hostname or IP address
+     * @param host_size Size of host (HOST_BUFFER_SIZE always fits)
+     * @param[out] port Port number from the URL (80 default)
+     * @return True if the index is valid and parsing succeeded
+     */
+    bool parse_server_host(int index, char* host, size_t host_size, int& port) const;
+
+    /**
+     * @brief Get index of the server requests currently go to
+     * @return Active server index
+     */
+    int get_active_server() const { return active_server_; }
+
+    /**
+     * @brief Send requests to another configured server
+     * @param index Server index (0 = primary)
+     * @return True if the server exists
+     * 
+     * Copies the server URL into base_url and drops the resolved address.
+     * Not a configuration change, so no change notification is sent.
+     */
+    bool select_server(int index);
+
+    //=========================================================================
+    // RESOLVED SERVER ADDRESS
+    //=========================================================================
+
+    /**
+     * @brief Send requests to a resolved IPv4 address instead of the hostname
+     * @param ip Dotted-quad address, or nullptr/empty to use the hostname again
+     * @return True if the address is in use
+     * 
+     * HTTP URLs and socket connects then skip name resolution. HTTPS URLs
+     * keep the hostname (certificate validation needs it).
+     */
+    bool set_server_address(const char* ip);
+
+    /**
+     * @brief Get base URL used for requests
+     * @return base_url with the host replaced by the resolved address, if set
+     */
+    const char* get_request_base_url() const;
+
+    /**
+     * @brief Get host for socket connections
+     * @param[out] host Buffer for the resolved address if set, otherwise the hostname from base_url
+     * @param host_size Size of host (HOST_BUFFER_SIZE always fits)
+     * @return True if there is a host to connect to
+     */
+    bool get_server_connect_host(char* host, size_t host_size) const;
 
     //=========================================================================
     // MEMORY CALCULATION UTILITIES
@@ -285,13 +432,13 @@ public:
     //=========================================================================
 
     /// Callback function called when configuration changes
-    std::function<void(const std::string& parameter)> on_config_changed;
+    WebInkDelegate<void(const std::string& parameter)> on_config_changed;
 
     /**
      * @brief Register callback for configuration changes
      * @param callback Function to call when any configuration value changes
      */
-    void set_change_callback(std::function<void(const std::string&)> callback);
+    void set_change_callback(WebInkDelegate<void(const std::string&)> callback);
 
     //=========================================================================
     // VALIDATION UTILITIES
@@ -319,6 +466,23 @@ public:
 private:
     static const char* TAG;  ///< Logging tag for this class
 
+    char server_address_[16];       ///< Resolved IPv4 address ("" = use hostname)
+    char request_base_url_[64];     ///< base_url with host replaced by server_address_
+
+    char server_urls_[MAX_SERVERS][64];  ///< Primary (index 0) and fallback server URLs
+    int server_count_;              ///< Number of entries in server_urls_
+    int active_server_;             ///< Server copied into base_url
+
+    /**
+     * @brief Parse host and port from a URL
+     * @param url URL like "http://server:8090/path"
+     * @param[out] host Buffer for the hostname or IP address
+     * @param host_size Size of host
+     * @param[out] port Port number (80 default)
+     * @return True if parsing was successful and the host fit
+     */
+    static bool parse_url_host(const char* url, char* host, size_t host_size, int& port);
+
     /**
      * @brief Notify change callback if registered
      * @param parameter Name of parameter that changed
@@ -330,7 +494,7 @@ private:
      * @param url URL string to validate
      * @return True if URL format is valid
      */
-    bool validate_url(const std::string& url) const;
+    bool validate_url(const char* url) const;
 
     /**
      * @brief Validate device ID format
@@ -338,14 +502,6 @@ private:
      * @return True if device ID format is valid
      */
     bool validate_device_id(const std::string& id) const;
-
-    /**
-     * @brief Parse color mode character to enum
-     * @param mode_char Color mode character (B, G, R, C)
-     * @param[out] mode Parsed color mode enum
-     * @return True if character is valid
-     */
-    bool parse_color_mode_char(char mode_char, ColorMode& mode) const;
 };
 
 } // namespace webink
@@ -7,8 +7,15 @@
  */
 
 #include "webink_controller.h"
+#include "webink_alloc_trace.h"
+#include "webink_log.h"
+#include "webink_memory.h"
+#ifndef WEBINK_MAC_INTEGRATION_TEST
 #include <esp_system.h>
 #include <esp_sleep.h>
+#endif
+#include <ctime>
+#include <cstdlib>
 
 namespace esphome {
 namespace webink {
@@ -22,24 +29,62 @@ const char* WebInkController::TAG = "webink.controller";
 WebInkController::WebInkController()
     : config_(std::make_shared<WebInkConfig>()),
       deep_sleep_(nullptr),
+      display_prepared_(false),
       current_state_(UpdateState::IDLE),
       state_start_time_(0),
-      last_yield_time_(0),
       manual_update_requested_(false),
+      cycle_complete_pending_(false),
+      cycle_complete_time_(0),
+      image_url_{},
+      image_url_prefix_length_(0),
+      request_buffer_{},
       total_image_rows_(0),
       rows_completed_(0),
-      current_progress_(0.0f) {
-    
-    ESP_LOGI(TAG, "WebInkController initializing...");
+      current_progress_(0.0f),
+      slice_offset_(0),
+      slice_arena_mark_(0),
+      slice_start_row_(0),
+      slice_rows_pending_(0),
+      short_slices_(0),
+      loop_budget_us_(LOOP_BUDGET_US),
+      loop_start_us_(0),
+      quanta_this_loop_(0),
+      quantum_progress_(false),
+      loop_latency_last_us_(0),
+      loop_latency_max_us_(0),
+      loop_latency_avg_us_(0),
+      loop_count_(0),
+      loop_over_budget_count_(0),
+      download_task_(this),
+      race_task_(this),
+      hash_task_(this),
+      refresh_task_(this),
+      sleep_task_(this),
+      warmup_active_(false),
+      warmup_hits_(0),
+      warmup_misses_(0),
+      hash_policy_(HashPolicy::HASH_CHECK),
+      content_unchanged_(false),
+      server_address_ready_(false),
+      using_cached_address_(false),
+      servers_tried_mask_(0),
+      server_failovers_(0),
+      server_race_checked_(false),
+      race_winner_(-1),
+      race_winner_ip_(0),
+      last_log_flush_time_(0),
+      telemetry_time_(0) {
+    
+    WEBINK_LOGI(TAG, "WebInkController initializing...");
     
     // Initialize sub-components
     initialize_components();
     
-    ESP_LOGI(TAG, "WebInkController initialized");
+    WEBINK_LOGI(TAG, "WebInkController initialized");
 }
 
 WebInkController::~WebInkController() {
-    ESP_LOGD(TAG, "WebInkController destructor");
+    WEBINK_LOGD(TAG, "WebInkController destructor");
 }
 
 //=============================================================================
@@ -47,102 +92,79 @@ WebInkController::~WebInkController() {
 //=============================================================================
 
 void WebInkController::setup() {
-    ESP_LOGI(TAG, "[SETUP] WebInk Controller starting setup...");
+    WEBINK_LOGI(TAG, "[SETUP] WebInk Controller starting setup...");
     
     if (!validate_configuration()) {
-        ESP_LOGE(TAG, "[SETUP] Configuration validation failed");
+        WEBINK_LOGE(TAG, "[SETUP] Configuration validation failed");
         return;
     }
     
+    WebInkTrace::begin(TraceEvent::STATE, static_cast<uint32_t>(current_state_));
+    
+    // Decode buffers are allocated once here, never per slice
+    WebInkMemory::register_static(WebInkArena::get_storage(), WebInkArena::CAPACITY, MemoryRole::SLICE);
+    calculate_image_parameters();
+    configure_pixel_pool();
+    WebInkMemory::log_summary();
+    
     // Initialize state
     state_.record_boot_time(millis());
     state_.clear_error_flags();
     
     // Log boot information
     if (state_.is_deep_sleep_wake()) {
-        ESP_LOGI(TAG, "[SETUP] Woke from deep sleep");
+        WEBINK_LOGI(TAG, "[SETUP] Woke from deep sleep");
     } else {
-        ESP_LOGI(TAG, "[SETUP] Power-on boot detected");
+        WEBINK_LOGI(TAG, "[SETUP] Power-on boot detected");
     }
     
-    ESP_LOGI(TAG, "[SETUP] Boot time recorded: %lu ms", state_.boot_time);
-    ESP_LOGI(TAG, "[SETUP] Configuration: %s", config_->get_config_summary().c_str());
-    
-    // Set up network info for display
-    if (display_) {
-        std::string host;
-        int port;
-        if (config_->parse_server_host(host, port)) {
-            display_->set_network_info(config_->base_url, ""); // IP will be set later
-        }
-    }
+    WEBINK_LOGI(TAG, "[SETUP] Boot time recorded: %lu ms", state_.boot_time);
+    WEBINK_LOGI(TAG, "[SETUP] Configuration: %s", config_->get_config_summary().c_str());
     
-    ESP_LOGI(TAG, "[SETUP] WebInk Controller setup complete");
+    WEBINK_LOGI(TAG, "[SETUP] WebInk Controller setup complete");
 }
 
 void WebInkController::loop() {
-    // Yield control regularly to ESPHome main loop
-    if (should_yield_control()) {
-        return;
-    }
-    
-    // Update network operations
-    if (network_) {
-        network_->update();
-    }
-    
-    // Check for state timeout (skip IDLE and COMPLETE - they are waiting states)
-    if (current_state_ != UpdateState::IDLE && 
-        current_state_ != UpdateState::COMPLETE &&
-        has_state_timed_out()) {
-        ESP_LOGW(TAG, "[TIMEOUT] State %s timed out after %lu ms",
-                 update_state_to_string(current_state_), STATE_TIMEOUT_MS);
-        handle_error(ErrorType::SERVER_UNREACHABLE, "State machine timeout");
-        return;
-    }
-    
-    // Execute current state
-    switch (current_state_) {
-        case UpdateState::IDLE:
-            handle_idle_state();
-            break;
-        case UpdateState::WIFI_WAIT:
-            handle_wifi_wait_state();
-            break;
-        case UpdateState::HASH_CHECK:
-            handle_hash_check_state();
-            break;
-        case UpdateState::HASH_REQUEST:
-            handle_hash_request_state();
-            break;
-        case UpdateState::HASH_PARSE:
-            handle_hash_parse_state();
-            break;
-        case UpdateState::IMAGE_REQUEST:
-            handle_image_request_state();
-            break;
-        case UpdateState::IMAGE_DOWNLOAD:
-            handle_image_download_state();
-            break;
-        case UpdateState::IMAGE_PARSE:
-            handle_image_parse_state();
-            break;
-        case UpdateState::IMAGE_DISPLAY:
-            handle_image_display_state();
-            break;
-        case UpdateState::DISPLAY_UPDATE:
-            handle_display_update_state();
-            break;
-        case UpdateState::ERROR_DISPLAY:
-            handle_error_display_state();
-            break;
-        case UpdateState::SLEEP_PREPARE:
-            handle_sleep_prepare_state();
+    loop_start_us_ = micros();
+    quanta_this_loop_ = 0;
+    
+    // Run the state machine one quantum at a time until the budget is spent
+    // or the current state has nothing more to do right now (waiting on WiFi,
+    // network data, a timer, or a blocking operation deferred to next loop)
+    while (true) {
+        UpdateState state_before = current_state_;
+        quantum_progress_ = false;
+        
+        // Update network operations (socket mode reads one chunk per call)
+        if (network_) {
+            network_->update();
+        }
+        
+        // Resume coroutine tasks once each
+        if (executor_.run_once()) {
+            quantum_progress_ = true;
+        }
+        
+        // Check for state timeout (skip IDLE and COMPLETE - they are waiting states)
+        if (current_state_ != UpdateState::IDLE && 
+            current_state_ != UpdateState::COMPLETE &&
+            has_state_timed_out()) {
+            WEBINK_LOGW(TAG, "[TIMEOUT] State %s timed out after %lu ms",
+                        update_state_to_string(current_state_), STATE_TIMEOUT_MS);
+            handle_error(ErrorType::SERVER_UNREACHABLE, "State machine timeout");
             break;
-        case UpdateState::COMPLETE:
-            handle_complete_state();
+        }
+        
+        run_state_handler();
+        quanta_this_loop_++;
+        
+        bool progressed = quantum_progress_ || current_state_ != state_before;
+        if (!progressed || !has_loop_budget()) {
             break;
+        }
     }
+    
+    record_loop_latency(micros() - loop_start_us_);
 }
 
 //=============================================================================
@@ -154,34 +176,35 @@ void WebInkController::set_config(std::shared_ptr<WebInkConfig> config) {
     
     if (config_) {
         config_->set_change_callback([this](const std::string& param) {
-            ESP_LOGI(TAG, "[CONFIG] Parameter changed: %s", param.c_str());
+            WEBINK_LOGI(TAG, "[CONFIG] Parameter changed: %s", param.c_str());
             if (on_log_message) {
-                on_log_message("Configuration updated: " + param);
+                on_log_message(log_format("Configuration updated: %s", param.c_str()));
             }
         });
     }
     
-    ESP_LOGD(TAG, "Configuration manager set");
+    WEBINK_LOGD(TAG, "Configuration manager set");
 }
 
 void WebInkController::set_display(std::shared_ptr<WebInkDisplayManager> display) {
     display_ = display;
-    ESP_LOGD(TAG, "Display manager set");
+    display_prepared_ = false;
+    WEBINK_LOGD(TAG, "Display manager set");
 }
 
 void WebInkController::set_deep_sleep_component(deep_sleep::DeepSleepComponent* deep_sleep) {
     deep_sleep_ = deep_sleep;
-    ESP_LOGD(TAG, "Deep sleep component set");
+    WEBINK_LOGD(TAG, "Deep sleep component set");
 }
 
 void WebInkController::set_network_client(std::shared_ptr<WebInkNetworkClient> network) {
     network_ = network;
-    ESP_LOGD(TAG, "Network client set");
+    WEBINK_LOGD(TAG, "Network client set");
 }
 
 void WebInkController::set_image_processor(std::shared_ptr<WebInkImageProcessor> image_processor) {
     image_processor_ = image_processor;
-    ESP_LOGD(TAG, "Image processor set");
+    WEBINK_LOGD(TAG, "Image processor set");
 }
 
 //=============================================================================
@@ -190,14 +213,15 @@ void WebInkController::set_image_processor(std::shared_ptr<WebInkImageProcessor>
 
 bool WebInkController::trigger_manual_update() {
     if (current_state_ != UpdateState::IDLE) {
-        ESP_LOGW(TAG, "[MANUAL] Update already in progress: %s", 
-                 update_state_to_string(current_state_));
+        WEBINK_LOGW(TAG, "[MANUAL] Update already in progress: %s", 
+                    update_state_to_string(current_state_));
         return false;
     }
     
-    ESP_LOGI(TAG, "[MANUAL] Manual update triggered");
+    // handle_idle_state() starts the cycle on the next loop, with the same
+    // per-cycle setup as a scheduled one
+    WEBINK_LOGI(TAG, "[MANUAL] Manual update triggered");
     manual_update_requested_ = true;
-    transition_to_state(UpdateState::WIFI_WAIT);
     
     if (on_log_message) {
         on_log_message("Manual update started");
@@ -208,11 +232,11 @@ bool WebInkController::trigger_manual_update() {
 
 bool WebInkController::trigger_deep_sleep() {
     if (!should_enter_deep_sleep()) {
-        ESP_LOGW(TAG, "[MANUAL] Deep sleep conditions not met");
+        WEBINK_LOGW(TAG, "[MANUAL] Deep sleep conditions not met");
         return false;
     }
     
-    ESP_LOGI(TAG, "[MANUAL] Manual deep sleep triggered");
+    WEBINK_LOGI(TAG, "[MANUAL] Manual deep sleep triggered");
     transition_to_state(UpdateState::SLEEP_PREPARE);
     
     return true;
@@ -220,7 +244,7 @@ bool WebInkController::trigger_deep_sleep() {
 
 void WebInkController::clear_hash_force_update() {
     state_.clear_hash_force_update();
-    ESP_LOGI(TAG, "[MANUAL] Hash cleared - next update will refresh display");
+    WEBINK_LOGI(TAG, "[MANUAL] Hash cleared - next update will refresh display");
     
     if (on_log_message) {
         on_log_message("Hash cleared for forced refresh");
@@ -229,10 +253,10 @@ void WebInkController::clear_hash_force_update() {
 
 void WebInkController::enable_deep_sleep(bool enabled) {
     state_.deep_sleep_enabled = enabled;
-    ESP_LOGI(TAG, "[CONFIG] Deep sleep %s", enabled ? "ENABLED" : "DISABLED");
+    WEBINK_LOGI(TAG, "[CONFIG] Deep sleep %s", enabled ? "ENABLED" : "DISABLED");
     
     if (on_log_message) {
-        on_log_message(std::string("Deep sleep ") + (enabled ? "enabled" : "disabled"));
+        on_log_message(enabled ? "Deep sleep enabled" : "Deep sleep disabled");
     }
 }
 
@@ -241,8 +265,8 @@ bool WebInkController::cancel_current_operation() {
         return false;
     }
     
-    ESP_LOGI(TAG, "[CANCEL] Cancelling current operation: %s", 
-             update_state_to_string(current_state_));
+    WEBINK_LOGI(TAG, "[CANCEL] Cancelling current operation: %s", 
+                update_state_to_string(current_state_));
     
     if (network_) {
         network_->cancel_all_operations();
@@ -266,6 +290,10 @@ bool WebInkController::is_update_in_progress() const {
     return current_state_ != UpdateState::IDLE;
 }
 
+void WebInkController::save_state() {
+    state_.save_to_rtc();
+}
+
 const WebInkState& WebInkController::get_state() const {
     return state_;
 }
@@ -302,36 +330,44 @@ unsigned long WebInkController::get_time_in_current_state() const {
     return millis() - state_start_time_;
 }
 
+bool WebInkController::consume_cycle_complete() {
+    if (!cycle_complete_pending_) {
+        return false;
+    }
+    cycle_complete_pending_ = false;
+    return true;
+}
+
 //=============================================================================
 // ESPHOME INTEGRATION HELPERS
 //=============================================================================
 
 void WebInkController::set_server_url(const std::string& url) {
     if (config_->set_server_url(url.c_str())) {
-        ESP_LOGI(TAG, "[CONFIG] Server URL updated to: %s", url.c_str());
+        WEBINK_LOGI(TAG, "[CONFIG] Server URL updated to: %s", url.c_str());
     }
 }
 
 void WebInkController::set_device_id(const std::string& device_id) {
     if (config_->set_device_id(device_id.c_str())) {
-        ESP_LOGI(TAG, "[CONFIG] Device ID updated to: %s", device_id.c_str());
+        WEBINK_LOGI(TAG, "[CONFIG] Device ID updated to: %s", device_id.c_str());
     }
 }
 
 void WebInkController::set_api_key(const std::string& api_key) {
     config_->set_api_key(api_key.c_str());
-    ESP_LOGI(TAG, "[CONFIG] API key updated");
+    WEBINK_LOGI(TAG, "[CONFIG] API key updated");
 }
 
 void WebInkController::set_display_mode(const std::string& display_mode) {
     if (config_->set_display_mode(display_mode.c_str())) {
-        ESP_LOGI(TAG, "[CONFIG] Display mode updated to: %s", display_mode.c_str());
+        WEBINK_LOGI(TAG, "[CONFIG] Display mode updated to: %s", display_mode.c_str());
     }
 }
 
 void WebInkController::set_socket_port(int port) {
     if (config_->set_socket_port(port)) {
-        ESP_LOGI(TAG, "[CONFIG] Socket port updated to: %d", port);
+        WEBINK_LOGI(TAG, "[CONFIG] Socket port updated to: %d", port);
     }
 }
 
@@ -342,27 +378,175 @@ void WebInkController::set_socket_port(int port) {
 void WebInkController::transition_to_state(UpdateState new_state) {
     if (current_state_ != new_state) {
         UpdateState old_state = current_state_;
+        unsigned long now = millis();
+        unsigned long phase_start = state_start_time_ > telemetry_time_ ? state_start_time_ : telemetry_time_;
+        telemetry_.add_phase_time(WebInkTelemetry::phase_for_state(old_state), now - phase_start);
+        state_.record_state_time(old_state, now - state_start_time_);
+        uint8_t memory_warnings = telemetry_.sample_state_memory(old_state);
+        if (memory_warnings) {
+            report_memory_warnings(old_state, memory_warnings);
+        }
+        WebInkTrace::end(TraceEvent::STATE, static_cast<uint32_t>(old_state));
+        WebInkTrace::begin(TraceEvent::STATE, static_cast<uint32_t>(new_state));
+        WebInkAllocTrace::set_phase(WebInkTelemetry::phase_for_state(new_state));
         current_state_ = new_state;
-        state_start_time_ = millis();
+        state_start_time_ = now;
         
         log_state_transition(old_state, new_state);
+        start_state_task(new_state);
+        
+        // Raise the cycle complete event immediately so the sleep decision
+        // does not have to wait for handle_complete_state() on a later loop
+        if (new_state == UpdateState::COMPLETE) {
+            cycle_complete_pending_ = true;
+            cycle_complete_time_ = state_start_time_;
+            WEBINK_LOGI(TAG, "[COMPLETE] Cycle finished %lu ms after boot", cycle_complete_time_);
+            report_loop_latency();
+            state_.save_to_rtc();
+            WebInkTrace::dump();
+        }
         
-        // DISABLED: std::function callback causes stack overflow on ESP32C3
-        // if (on_state_change) {
-        //     on_state_change(old_state, new_state);
-        // }
+        // An inline delegate: no allocation, one indirect call
+        if (on_state_change) {
+            on_state_change(old_state, new_state);
+        }
     }
 }
 
-bool WebInkController::should_yield_control() {
-    unsigned long now = millis();
+void WebInkController::start_state_task(UpdateState state) {
+    WebInkTask* task = nullptr;
+    switch (state) {
+        case UpdateState::HASH_REQUEST:
+            task = &hash_task_;
+            break;
+        case UpdateState::DISPLAY_UPDATE:
+            task = &refresh_task_;
+            break;
+        case UpdateState::SLEEP_PREPARE:
+            task = &sleep_task_;
+            break;
+        default:
+            return;
+    }
+    
+    // No nested transition from here - the state's handler sees the
+    // cancelled task and reports it
+    if (!executor_.spawn(task)) {
+        task->cancel();
+    }
+}
+
+void WebInkController::run_state_handler() {
+    switch (current_state_) {
+        case UpdateState::IDLE:
+            handle_idle_state();
+            break;
+        case UpdateState::WIFI_WAIT:
+            handle_wifi_wait_state();
+            break;
+        case UpdateState::HASH_CHECK:
+            handle_hash_check_state();
+            break;
+        case UpdateState::HASH_REQUEST:
+            handle_hash_request_state();
+            break;
+        case UpdateState::HASH_PARSE:
+            handle_hash_parse_state();
+            break;
+        case UpdateState::IMAGE_REQUEST:
+            handle_image_request_state();
+            break;
+        case UpdateState::IMAGE_DOWNLOAD:
+            handle_image_download_state();
+            break;
+        case UpdateState::IMAGE_PARSE:
+            handle_image_parse_state();
+            break;
+        case UpdateState::IMAGE_DISPLAY:
+            handle_image_display_state();
+            break;
+        case UpdateState::DISPLAY_UPDATE:
+            handle_display_update_state();
+            break;
+        case UpdateState::ERROR_DISPLAY:
+            handle_error_display_state();
+            break;
+        case UpdateState::SLEEP_PREPARE:
+            handle_sleep_prepare_state();
+            break;
+        case UpdateState::COMPLETE:
+            handle_complete_state();
+            break;
+    }
+}
+
+bool WebInkController::has_loop_budget() const {
+    return (micros() - loop_start_us_) < loop_budget_us_;
+}
+
+bool WebInkController::begin_blocking_operation() {
+    // esp_http_client_perform() and the e-paper refresh can't be split into
+    // quanta, so they only start on a fresh loop() budget
+    return quanta_this_loop_ == 0;
+}
+
+void WebInkController::record_loop_latency(uint32_t elapsed_us) {
+    loop_latency_last_us_ = elapsed_us;
+    loop_count_++;
     
-    if (now - last_yield_time_ >= YIELD_INTERVAL_MS) {
-        last_yield_time_ = now;
-        return true;
+    if (elapsed_us > loop_latency_max_us_) {
+        loop_latency_max_us_ = elapsed_us;
     }
     
-    return false;
+    // Integer moving average with 1/8 weight for the new sample
+    if (loop_count_ == 1) {
+        loop_latency_avg_us_ = elapsed_us;
+    } else {
+        loop_latency_avg_us_ = loop_latency_avg_us_ - (loop_latency_avg_us_ >> 3) + (elapsed_us >> 3);
+    }
+    
+    if (elapsed_us > loop_budget_us_) {
+        loop_over_budget_count_++;
+        WEBINK_LOGD(TAG, "[SCHED] loop() took %u us in %s (budget %u us, %d quanta)",
+                    (unsigned) elapsed_us, update_state_to_string(current_state_),
+                    (unsigned) loop_budget_us_, quanta_this_loop_);
+    }
+}
+
+void WebInkController::report_loop_latency() {
+    WEBINK_LOGI(TAG, "[SCHED] %u loops, latency avg %u us, max %u us, %u over %u us budget",
+                (unsigned) loop_count_, (unsigned) loop_latency_avg_us_,
+                (unsigned) loop_latency_max_us_, (unsigned) loop_over_budget_count_,
+                (unsigned) loop_budget_us_);
+    
+    loop_count_ = 0;
+    loop_latency_max_us_ = 0;
+    loop_over_budget_count_ = 0;
+}
+
+void WebInkController::report_memory_warnings(UpdateState state, uint8_t warnings) {
+    const StateMemory& memory = telemetry_.get_state_memory(state);
+    if (warnings & MEMORY_WARN_HEAP) {
+        WEBINK_LOGW(TAG, "[MEMORY] Free heap down to %u bytes after %s (threshold %u)",
+                    (unsigned) memory.min_free_heap, update_state_to_string(state),
+                    (unsigned) WebInkTelemetry::MEMORY_WARN_HEAP_BYTES);
+    }
+    if (warnings & MEMORY_WARN_BLOCK) {
+        WEBINK_LOGW(TAG, "[MEMORY] Largest free block down to %u bytes after %s (threshold %u)",
+                    (unsigned) memory.min_largest_block, update_state_to_string(state),
+                    (unsigned) WebInkTelemetry::MEMORY_WARN_BLOCK_BYTES);
+    }
+    if (warnings & MEMORY_WARN_STACK) {
+        WEBINK_LOGW(TAG, "[MEMORY] Stack headroom down to %u bytes after %s (threshold %u)",
+                    (unsigned) memory.min_stack_free, update_state_to_string(state),
+                    (unsigned) WebInkTelemetry::MEMORY_WARN_STACK_BYTES);
+    }
+    
+    char message[96];
+    snprintf(message, sizeof(message), "Low memory after %s (heap %u, block %u, stack %u)",
+             update_state_to_string(state), (unsigned) memory.min_free_heap,
+             (unsigned) memory.min_largest_block, (unsigned) memory.min_stack_free);
+    log_buffer_.record(LogSeverity::WARNING, state_.wake_counter, message);
 }
 
 bool WebInkController::has_state_timed_out() {
@@ -380,19 +564,35 @@ void WebInkController::handle_idle_state() {
     if (manual_update_requested_) {
         should_start_update = true;
         manual_update_requested_ = false;
-        ESP_LOGI(TAG, "[IDLE] Starting manual update cycle");
+        WEBINK_LOGI(TAG, "[IDLE] Starting manual update cycle");
     } else if (state_.should_start_update_cycle(millis())) {
         should_start_update = true;
-        ESP_LOGI(TAG, "[IDLE] Starting scheduled update cycle");
+        WEBINK_LOGI(TAG, "[IDLE] Starting scheduled update cycle");
     }
     
     if (should_start_update) {
+        loop_count_ = 0;
+        loop_latency_max_us_ = 0;
+        loop_over_budget_count_ = 0;
         state_.increment_wake_counter();
         state_.record_update_time(millis());
+        server_address_ready_ = false;
+        servers_tried_mask_ = 0;
+        server_race_checked_ = false;
+        if (network_) {
+            network_->reset_statistics();  // Per-cycle counters for telemetry
+        }
         transition_to_state(UpdateState::WIFI_WAIT);
         
         update_progress(0.0f, "Starting update cycle");
-        // post_status_to_server disabled - string concat causes stack overflow
+        return;
+    }
+    
+    // Staying awake (boot protection, sleep disabled) - don't let the log
+    // ring overflow while WiFi is up
+    if (log_buffer_.is_nearly_full() && get_wifi_status && get_wifi_status() &&
+        millis() - last_log_flush_time_ > LOG_FLUSH_RETRY_MS && begin_blocking_operation()) {
+        flush_log_buffer();
     }
 }
 
@@ -408,44 +608,90 @@ void WebInkController::handle_wifi_wait_state() {
     static unsigned long last_wifi_log = 0;
     unsigned long now = millis();
     if (now - last_wifi_log > 2000) {
-        ESP_LOGD(TAG, "[WIFI] Status check: connected=%s, time_in_state=%lu ms", 
-                 wifi_connected ? "true" : "false", get_time_in_current_state());
+        WEBINK_LOGD(TAG, "[WIFI] Status check: connected=%s, time_in_state=%lu ms", 
+                    wifi_connected ? "true" : "false", get_time_in_current_state());
         last_wifi_log = now;
     }
     
     if (wifi_connected) {
-        ESP_LOGI(TAG, "[WIFI] WiFi connected, proceeding to hash check");
+        WEBINK_LOGI(TAG, "[WIFI] WiFi connected, proceeding to hash check");
         transition_to_state(UpdateState::HASH_REQUEST);
         update_progress(10.0f, "WiFi connected");
     } else {
         // Check for timeout - increased to 30 seconds for slow WiFi connections
         if (get_time_in_current_state() > 30000) {  // 30 second timeout
-            ESP_LOGW(TAG, "[WIFI] WiFi connection timeout after 30 seconds");
+            WEBINK_LOGW(TAG, "[WIFI] WiFi connection timeout after 30 seconds");
             handle_error(ErrorType::WIFI_TIMEOUT, "WiFi connection timeout after 30 seconds");
         }
     }
 }
 
 void WebInkController::handle_hash_request_state() {
-    if (!network_) {
-        handle_error(ErrorType::SERVER_UNREACHABLE, "Network client not available");
-        return;
+    // hash_task_ is spawned on entry and resumed by the executor in loop();
+    // it leaves this state itself, so a stopped task here never ran
+    if (!hash_task_.is_running()) {
+        handle_error(ErrorType::MEMORY_ERROR, "Failed to start hash request task");
     }
+}
+
+TaskStatus WebInkController::HashRequestTask::step() {
+    WebInkController* c = owner_;
     
-    std::string hash_url = config_->build_hash_url();
-    ESP_LOGI(TAG, "[HASH] Requesting hash from: %s", hash_url.c_str());
+    WEBINK_CO_BEGIN();
+    if (!c->network_) {
+        c->handle_error(ErrorType::SERVER_UNREACHABLE, "Network client not available");
+        WEBINK_CO_RETURN(TaskStatus::FAILED);
+    }
     
-    // Note: http_get_async is actually blocking - callback fires immediately
-    // The callback handles state transitions, so we don't transition here
-    bool request_started = network_->http_get_async(hash_url, 
-        [this](NetworkResult result) {
-            this->on_hash_response(result);
-        }, NETWORK_TIMEOUT_MS);
+    // The server race runs as its own task; wait for its winner before choosing
+    if (c->servers_tried_mask_ == 0 && c->start_server_race()) {
+        WEBINK_CO_AWAIT(!c->race_task_.is_running());
+    }
     
-    if (!request_started) {
-        handle_error(ErrorType::SERVER_UNREACHABLE, "Failed to start hash request");
+    // on_hash_response() leaves HASH_REQUEST, except on a retryable failure
+    // (stale cached address, failover) - then the request goes out again
+    while (c->current_state_ == UpdateState::HASH_REQUEST) {
+        WEBINK_CO_AWAIT(c->begin_blocking_operation());
+        
+        // Name resolution (when needed) blocks, so it shares this fresh budget
+        if (c->servers_tried_mask_ == 0) {
+            c->select_cycle_server();
+        }
+        if (!c->server_address_ready_) {
+            c->prepare_server_address();
+        }
+        
+        // Content that changes on nearly every wake makes the hash request pure
+        // overhead - fetch the image directly and let the server answer "unchanged"
+        c->hash_policy_ = c->state_.choose_hash_policy();
+        if (c->hash_policy_ == HashPolicy::CONDITIONAL_FETCH) {
+            WEBINK_LOGI(TAG, "[POLICY] Change rate %.2f - skipping hash request, conditional image fetch",
+                        c->state_.change_rate);
+            c->transition_to_state(UpdateState::IMAGE_REQUEST);
+            WEBINK_CO_RETURN(TaskStatus::DONE);
+        }
+        
+        // Let the image connection come up while the hash request blocks
+        c->start_connection_warmup();
+        
+        if (c->config_->build_hash_url(c->request_buffer_, sizeof(c->request_buffer_)) == 0) {
+            c->handle_error(ErrorType::MEMORY_ERROR, "Hash URL too long");
+            WEBINK_CO_RETURN(TaskStatus::FAILED);
+        }
+        WEBINK_LOGI(TAG, "[HASH] Requesting hash from: %s", c->request_buffer_);
+        
+        // Note: http_get_async is actually blocking - the callback fires
+        // before it returns and makes the state transition
+        if (!c->network_->http_get_async(c->request_buffer_,
+                [c](NetworkResult result) {
+                    c->on_hash_response(std::move(result));
+                }, NETWORK_TIMEOUT_MS)) {
+            c->handle_error(ErrorType::SERVER_UNREACHABLE, "Failed to start hash request");
+            WEBINK_CO_RETURN(TaskStatus::FAILED);
+        }
+        WEBINK_CO_AWAIT(!c->network_->is_operation_pending());
     }
-    // State transition happens in on_hash_response callback
+    WEBINK_CO_END();
 }
 
 void WebInkController::handle_hash_check_state() {
@@ -462,258 +708,647 @@ void WebInkController::handle_hash_parse_state() {
 }
 
 void WebInkController::handle_image_request_state() {
-    ESP_LOGI(TAG, "[IMAGE] Starting image request, socket_port=%d", config_->socket_mode_port);
+    WEBINK_LOGI(TAG, "[IMAGE] Starting image request, socket_port=%d", config_->socket_mode_port);
+    if (config_->socket_mode_port > 0) {
+        telemetry_.set_flag(TELEMETRY_FLAG_SOCKET_MODE);
+    }
     
     // Calculate image parameters
     calculate_image_parameters();
     
     // Initialize slice tracking
     rows_completed_ = 0;
+    content_unchanged_ = false;
+    for (int i = 0; i < WebInkState::BAND_COUNT; i++) {
+        band_hash_accum_[i] = 2166136261u;  // FNV-1a offset basis
+    }
     
     if (config_->get_network_mode() == NetworkMode::TCP_SOCKET) {
         // Use TCP socket mode for full image download
-        std::string host = config_->get_server_hostname();
+        char host[HOST_BUFFER_SIZE];
         int port = config_->socket_mode_port;
+        config_->get_server_connect_host(host, sizeof(host));
         
-        ESP_LOGI(TAG, "[IMAGE] Using socket mode: %s:%d", host.c_str(), port);
+        WEBINK_LOGI(TAG, "[IMAGE] Using socket mode: %s:%d", host, port);
         
-        if (network_->socket_connect_async(host, port)) {
-            transition_to_state(UpdateState::IMAGE_DOWNLOAD);
-        } else {
+        if (network_->socket_is_connected() || network_->socket_is_connecting()) {
+            WEBINK_LOGI(TAG, "[IMAGE] Reusing connection opened during hash request");
+        } else if (!network_->socket_connect_async(host, port)) {
             handle_error(ErrorType::SOCKET_ERROR, "Failed to connect to image server");
+            return;
         }
     } else {
-        // Use HTTP sliced mode - transition to IMAGE_DOWNLOAD which handles the loop
-        ESP_LOGI(TAG, "[IMAGE] Using HTTP sliced mode");
-        transition_to_state(UpdateState::IMAGE_DOWNLOAD);
+        WEBINK_LOGI(TAG, "[IMAGE] Using HTTP sliced mode");
+    }
+    
+    // The transfer itself runs as a coroutine; IMAGE_DOWNLOAD waits for it
+    if (!executor_.spawn(&download_task_)) {
+        handle_error(ErrorType::MEMORY_ERROR, "Failed to start image download task");
+        return;
     }
+    transition_to_state(UpdateState::IMAGE_DOWNLOAD);
 }
 
 void WebInkController::handle_image_download_state() {
-    // HTTP sliced mode - request current slice
-    if (config_->get_network_mode() == NetworkMode::HTTP_SLICED) {
-        // Check if all slices received
-        if (rows_completed_ >= total_image_rows_) {
-            ESP_LOGI(TAG, "[IMAGE] All %d rows received", rows_completed_);
-            transition_to_state(UpdateState::DISPLAY_UPDATE);
+    // download_task_ is resumed by the executor in loop(); this state only
+    // waits for it to finish. Failures inside the task call handle_error(),
+    // which leaves this state before we get here.
+    if (download_task_.is_running()) {
+        return;
+    }
+    
+    if (download_task_.get_status() == TaskStatus::DONE) {
+        if (content_unchanged_) {
+            WEBINK_LOGI(TAG, "[HASH] Content unchanged - skipping display update");
+            transition_to_state(UpdateState::SLEEP_PREPARE);
             return;
         }
+        state_.record_server_success(config_->get_active_server(), 0);
+        commit_band_hashes();
+        transition_to_state(UpdateState::DISPLAY_UPDATE);
+    } else {
+        handle_error(ErrorType::SERVER_UNREACHABLE, "Image download did not complete");
+    }
+}
+
+TaskStatus WebInkController::ImageDownloadTask::step() {
+    WebInkController* c = owner_;
+    
+    WEBINK_CO_BEGIN();
+    buffer_pos_ = 0;
+    
+    if (c->config_->get_network_mode() == NetworkMode::HTTP_SLICED) {
+        while (c->rows_completed_ < c->total_image_rows_) {
+            // Slice requests block in esp_http_client_perform()
+            WEBINK_CO_AWAIT(c->begin_blocking_operation());
+            if (!c->request_next_slice()) {
+                WEBINK_CO_RETURN(TaskStatus::FAILED);
+            }
+            if (c->content_unchanged_) {
+                WEBINK_CO_RETURN(TaskStatus::DONE);
+            }
+            
+            // Draw the slice in quanta before fetching the next one
+            while (c->slice_rows_pending_ > 0) {
+                c->draw_slice_quantum();
+                WEBINK_CO_YIELD();
+            }
+            
+            // A short slice leaves rows_completed_ at the last row drawn, so
+            // the next pass requests the missing rows again
+            if (c->short_slices_ > MAX_SHORT_SLICES) {
+                c->handle_error(ErrorType::INVALID_RESPONSE, "Image slices shorter than requested");
+                WEBINK_CO_RETURN(TaskStatus::FAILED);
+            }
+        }
+        
+        WEBINK_LOGI(TAG, "[IMAGE] All %d rows received", c->rows_completed_);
+        c->release_image_connection();
+        WEBINK_CO_RETURN(TaskStatus::DONE);
+    }
+    
+    // TCP socket mode - connect was started by handle_image_request_state()
+    // or by the warm-up during the hash request. Each pass requests the rows
+    // not received yet, so a failover continues where the last server stopped.
+    while (true) {
+        WEBINK_CO_AWAIT(!c->network_->socket_is_connecting());
+        if (!c->network_->socket_is_connected()) {
+            if (c->fail_over_socket_download("connect failed")) {
+                continue;
+            }
+            c->handle_error(ErrorType::SOCKET_ERROR, "Failed to connect to image server");
+            WEBINK_CO_RETURN(TaskStatus::FAILED);
+        }
         
-        // Request next slice
-        int remaining_rows = total_image_rows_ - rows_completed_;
-        int rows_to_request = std::min(config_->rows_per_slice, remaining_rows);
+        {
+            ImageRequest req;
+            req.rect = DisplayRect(0, c->rows_completed_, c->geometry_.width, c->total_image_rows_ - c->rows_completed_);
+            req.start_row = c->rows_completed_;
+            req.num_rows = c->total_image_rows_ - c->rows_completed_;
+            req.format = "pbm";
+            
+            // webInkV2: the server prefixes a status line carrying the hash
+            status_pending_ = (c->hash_policy_ == HashPolicy::CONDITIONAL_FETCH && c->rows_completed_ == 0);
+            status_len_ = 0;
+            if (status_pending_) {
+                req.set_if_none_match(c->state_.get_hash());
+            }
+            
+            size_t length = c->config_->build_socket_request(c->request_buffer_, sizeof(c->request_buffer_), req);
+            if (length == 0) {
+                c->handle_error(ErrorType::MEMORY_ERROR, "Socket request too long");
+                WEBINK_CO_RETURN(TaskStatus::FAILED);
+            }
+            WEBINK_LOGI(TAG, "[SOCKET] Sending request: %s", c->request_buffer_);
+            
+            if (!c->network_->socket_send(c->request_buffer_, length)) {
+                if (c->fail_over_socket_download("send failed")) {
+                    continue;
+                }
+                c->handle_error(ErrorType::SOCKET_ERROR, "Failed to send socket request");
+                WEBINK_CO_RETURN(TaskStatus::FAILED);
+            }
+        }
+        WEBINK_LOGI(TAG, "[SOCKET] Request sent, waiting for image data");
+        WEBINK_CO_YIELD();
         
-        current_image_request_.rect = DisplayRect(0, rows_completed_, 800, rows_to_request);
-        current_image_request_.start_row = rows_completed_;
-        current_image_request_.num_rows = rows_to_request;
-        current_image_request_.format = "pbm";
+        if (!c->network_->socket_receive_stream(
+                [c](const uint8_t* data, int length) {
+                    c->on_socket_data(data, length);
+                },
+                // Max bytes for the remaining rows; with a status line, read until the server closes
+                status_pending_ ? 0
+                                : webink_row_bytes<FIXED_PBM_ROW_BYTES>(c->geometry_.pbm_bytes_per_row()) *
+                                      (c->total_image_rows_ - c->rows_completed_),
+                NETWORK_TIMEOUT_MS)) {
+            if (c->fail_over_socket_download("receive failed")) {
+                continue;
+            }
+            c->handle_error(ErrorType::SOCKET_ERROR, "Failed to start socket receive");
+            WEBINK_CO_RETURN(TaskStatus::FAILED);
+        }
+        WEBINK_LOGI(TAG, "[SOCKET] Receive stream started");
         
-        std::string image_url = config_->build_image_url(current_image_request_);
-        ESP_LOGD(TAG, "[IMAGE] Requesting rows %d-%d of %d", rows_completed_, 
-                 rows_completed_ + rows_to_request, total_image_rows_);
+        // network_->update() feeds on_socket_data() one chunk per quantum
+        WEBINK_CO_AWAIT(!c->network_->is_operation_pending());
+        c->network_->socket_close();
         
-        bool request_started = network_->http_get_async(image_url,
-            [this](NetworkResult result) {
-                this->on_image_response(result);
-            }, NETWORK_TIMEOUT_MS);
+        if (c->rows_completed_ >= c->total_image_rows_ || c->content_unchanged_) {
+            break;
+        }
         
-        if (!request_started) {
-            handle_error(ErrorType::SERVER_UNREACHABLE, "Failed to request image slice");
+        // Stream ended early (server died or timed out) - resume on another server
+        if (!c->fail_over_socket_download("stream ended early")) {
+            break;
         }
-        // on_image_response will increment rows_completed_ and we'll be called again
-        return;
     }
     
-    // TCP Socket mode - send request and receive image
-    static bool socket_request_sent = false;
-    static bool socket_receive_started = false;
+    WEBINK_LOGI(TAG, "[SOCKET] Image transfer complete (%d of %d rows)", c->rows_completed_, c->total_image_rows_);
+    WEBINK_CO_END();
+}
+
+void WebInkController::start_connection_warmup() {
+    warmup_active_ = false;
     
-    // Check if socket is connected
-    if (!network_->socket_is_connected()) {
-        ESP_LOGD(TAG, "[SOCKET] Waiting for connection...");
+    if (network_->socket_is_connected()) {
+        // The server race handed over its winning connection - treat it as warm
+        warmup_active_ = true;
+        WEBINK_LOGI(TAG, "[WARMUP] Keeping the race winner's connection for the image");
         return;
     }
     
-    // Send request once connected
-    if (!socket_request_sent) {
-        // Build and send socket request
-        ImageRequest req;
-        req.rect = DisplayRect(0, 0, 800, total_image_rows_);
-        req.start_row = 0;
-        req.num_rows = total_image_rows_;
-        req.format = "pbm";
-        
-        std::string request = config_->build_socket_request(req);
-        ESP_LOGI(TAG, "[SOCKET] Sending request: %s", request.c_str());
-        
-        if (!network_->socket_send(request)) {
-            handle_error(ErrorType::SOCKET_ERROR, "Failed to send socket request");
-            socket_request_sent = false;
-            socket_receive_started = false;
+    if (!state_.should_speculate_image_connection()) {
+        WEBINK_LOGD(TAG, "[WARMUP] Skipped - change rate %.2f below %.2f",
+                    state_.change_rate, WebInkState::SPECULATION_THRESHOLD);
+        return;
+    }
+    
+    if (config_->get_network_mode() == NetworkMode::TCP_SOCKET) {
+        // Non-blocking connect: the handshake completes during the hash request
+        char host[HOST_BUFFER_SIZE];
+        if (!config_->get_server_connect_host(host, sizeof(host)) ||
+            !network_->socket_connect_async(host, config_->socket_mode_port)) {
+            WEBINK_LOGW(TAG, "[WARMUP] Speculative connect failed - connecting after hash check");
             return;
         }
-        socket_request_sent = true;
-        ESP_LOGI(TAG, "[SOCKET] Request sent, waiting for image data");
+    } else {
+        // Keep the hash request's connection open for the first slice
+        network_->set_http_keep_alive(true);
+    }
+    
+    warmup_active_ = true;
+    WEBINK_LOGI(TAG, "[WARMUP] Opening image connection during hash request (change rate %.2f)",
+                state_.change_rate);
+}
+
+void WebInkController::prepare_server_address() {
+    server_address_ready_ = true;
+    using_cached_address_ = false;
+    
+    // On the stack, not a std::string: a hostname past the small-string
+    // buffer would be a heap allocation every cycle
+    char host[HOST_BUFFER_SIZE];
+    uint32_t ipv4 = 0;
+    if (!config_->get_server_hostname(host, sizeof(host)) ||
+        WebInkNetworkClient::parse_ipv4(host, ipv4) ||
+        strncmp(config_->base_url, "https://", 8) == 0) {
+        // No host, already an address, or HTTPS (certificate validation needs the hostname)
+        config_->set_server_address(nullptr);
         return;
     }
     
-    // Start receive stream (only once)
-    if (!socket_receive_started) {
-        // Use static variables inside lambda for row buffering
-        bool started = network_->socket_receive_stream(
-            [this](const uint8_t* data, int length) {
-                // Static buffer to accumulate partial rows (persists across calls)
-                static const int BYTES_PER_ROW = 800 / 8;  // 100 bytes per row
-                static uint8_t row_buffer[BYTES_PER_ROW];
-                static int buffer_pos = 0;
-                
-                // Reset buffer at start of new image (when rows_completed_ is 0)
-                if (rows_completed_ == 0) {
-                    buffer_pos = 0;
-                }
-                
-                ESP_LOGD(TAG, "[SOCKET] Received %d bytes, buffer_pos=%d, rows=%d", 
-                         length, buffer_pos, rows_completed_);
-                
-                if (!display_ || length <= 0) return;
-                
-                int data_pos = 0;
-                
-                while (data_pos < length) {
-                    // Fill buffer with incoming data
-                    int bytes_needed = BYTES_PER_ROW - buffer_pos;
-                    int bytes_available = length - data_pos;
-                    int bytes_to_copy = std::min(bytes_needed, bytes_available);
-                    
-                    memcpy(row_buffer + buffer_pos, data + data_pos, bytes_to_copy);
-                    buffer_pos += bytes_to_copy;
-                    data_pos += bytes_to_copy;
-                    
-                    // If we have a complete row, draw it
-                    if (buffer_pos >= BYTES_PER_ROW) {
-                        display_->draw_progressive_pixels(0, rows_completed_, 800, 1,
-                                                         row_buffer, ColorMode::MONO_BLACK_WHITE);
-                        rows_completed_++;
-                        buffer_pos = 0;
-                    }
-                }
-            },
-            800 * total_image_rows_ / 8,  // Max bytes for full image
-            NETWORK_TIMEOUT_MS
-        );
-        
-        if (started) {
-            socket_receive_started = true;
-            ESP_LOGI(TAG, "[SOCKET] Receive stream started");
-        } else {
-            handle_error(ErrorType::SOCKET_ERROR, "Failed to start socket receive");
-            socket_request_sent = false;
-            socket_receive_started = false;
+    // System time keeps running through deep sleep (RTC timer), so the
+    // cache age is meaningful even without SNTP
+    uint32_t now_s = static_cast<uint32_t>(time(nullptr));
+    char ip_text[16];
+    
+    if (state_.has_valid_server_address(now_s)) {
+        WebInkNetworkClient::format_ipv4(state_.cached_server_ip, ip_text, sizeof(ip_text));
+        if (config_->set_server_address(ip_text)) {
+            using_cached_address_ = true;
+            WEBINK_LOGI(TAG, "[DNS] Using cached address %s for %s (age %u s)", ip_text, host,
+                        (unsigned) (now_s - state_.cached_server_ip_time));
         }
         return;
     }
     
-    // Let network update() handle the receive - check if operation completed
-    if (!network_->is_operation_pending()) {
-        ESP_LOGI(TAG, "[SOCKET] Image transfer complete");
-        socket_request_sent = false;
-        socket_receive_started = false;
-        network_->socket_close();
-        transition_to_state(UpdateState::DISPLAY_UPDATE);
+    if (!network_->resolve_host(host, ipv4)) {
+        WEBINK_LOGW(TAG, "[DNS] Falling back to hostname %s", host);
+        config_->set_server_address(nullptr);
+        return;
     }
     
-    // Update progress
-    if (total_image_rows_ > 0) {
-        float progress = 50.0f + (rows_completed_ * 30.0f) / total_image_rows_;
-        current_progress_ = progress;
-    }
+    state_.cache_server_address(ipv4, now_s);
+    WebInkNetworkClient::format_ipv4(ipv4, ip_text, sizeof(ip_text));
+    config_->set_server_address(ip_text);
 }
 
-void WebInkController::handle_image_parse_state() {
-    ESP_LOGI(TAG, "[IMAGE] Parsing image data");
-    update_progress(75.0f, "Processing image data");
+//=============================================================================
+// SERVER FAILOVER
+//=============================================================================
+
+bool WebInkController::start_server_race() {
+    if (server_race_checked_) {
+        return false;
+    }
+    server_race_checked_ = true;
+    race_winner_ = -1;
+    race_winner_ip_ = 0;
     
-    // In a full implementation, this would parse received image data
-    // For now, just transition to display
-    transition_to_state(UpdateState::IMAGE_DISPLAY);
+    if (!state_.needs_server_race(config_->get_server_count())) {
+        return false;
+    }
+    return executor_.spawn(&race_task_);
 }
 
-void WebInkController::handle_image_display_state() {
-    ESP_LOGI(TAG, "[IMAGE] Drawing image to display buffer");
-    update_progress(85.0f, "Drawing image to buffer");
+void WebInkController::select_cycle_server() {
+    int count = config_->get_server_count();
+    int chosen = race_winner_;
     
-    // In a full implementation, this would draw pixels to display buffer
-    // For now, just transition to display update
+    if (chosen < 0) {
+        chosen = state_.choose_server(count);
+    }
+    if (chosen < 0) {
+        chosen = 0;
+    }
+    
+    // The cached address belongs to the preferred server
+    if (chosen != state_.preferred_server) {
+        state_.invalidate_server_address();
+        state_.preferred_server = static_cast<uint8_t>(chosen);
+    }
+    if (race_winner_ == chosen && race_winner_ip_ != 0) {
+        state_.cache_server_address(race_winner_ip_, static_cast<uint32_t>(time(nullptr)));
+    }
+    
+    config_->select_server(chosen);
+    servers_tried_mask_ |= 1u << chosen;
+    
+    if (count > 1) {
+        WEBINK_LOGI(TAG, "[SERVER] Using server %d of %d: %s", chosen, count, config_->base_url);
+    }
+}
+
+TaskStatus WebInkController::ServerRaceTask::step() {
+    WebInkController* c = owner_;
+    
+    WEBINK_CO_BEGIN();
+    count_ = c->config_->get_server_count();
+    count_ = count_ < MAX_SERVERS ? count_ : MAX_SERVERS;
+    winner_ = -1;
+    failed_mask_ = 0;
+    
+    // Preferred server first, so it wins ties and delays the others by one stagger
+    next_ = 0;
+    order_[next_++] = c->state_.preferred_server < count_ ? c->state_.preferred_server : 0;
+    for (int i = 0; i < count_; i++) {
+        if (i != order_[0]) {
+            order_[next_++] = i;
+        }
+    }
+    
+    // Name lookups block, so each one gets a fresh loop budget
+    for (next_ = 0; next_ < count_; next_++) {
+        WEBINK_CO_AWAIT(c->begin_blocking_operation());
+        {
+            char host[HOST_BUFFER_SIZE];
+            ips_[next_] = 0;
+            connect_ms_[next_] = 0;
+            if (!c->config_->parse_server_host(order_[next_], host, sizeof(host), ports_[next_]) ||
+                !c->network_->resolve_host(host, ips_[next_])) {
+                ips_[next_] = 0;
+            }
+            if (c->config_->get_network_mode() == NetworkMode::TCP_SOCKET) {
+                ports_[next_] = c->config_->socket_mode_port;
+            }
+        }
+    }
+    
+    WEBINK_LOGI(TAG, "[SERVER] Racing %d servers", count_);
+    race_start_ = millis();
+    next_start_ = race_start_;
+    next_ = 0;
+    WEBINK_CO_AWAIT(!poll());
+    
+    for (int k = 0; k < count_; k++) {
+        if (failed_mask_ & (1u << k)) {
+            c->state_.record_server_failure(order_[k]);
+        }
+    }
+    if (winner_ < 0) {
+        WEBINK_LOGW(TAG, "[RACE] No server connected within %lu ms", RACE_TIMEOUT_MS);
+        close_all();
+        WEBINK_CO_RETURN(TaskStatus::DONE);
+    }
+    
+    WEBINK_LOGI(TAG, "[RACE] Server %d connected first in %u ms (%lu ms total)",
+                order_[winner_], (unsigned) connect_ms_[winner_], millis() - race_start_);
+    c->state_.record_server_success(order_[winner_], connect_ms_[winner_]);
+    c->race_winner_ = order_[winner_];
+    c->race_winner_ip_ = ips_[winner_];
+    
+    // Socket mode sends the image request on the winning connection.
+    // esp_http_client cannot take over a descriptor, so HTTP mode closes it.
+    if (c->config_->get_network_mode() == NetworkMode::TCP_SOCKET) {
+        c->network_->socket_adopt(sockets_[winner_]);
+    }
+    close_all();
+    WEBINK_CO_END();
+}
+
+bool WebInkController::ServerRaceTask::poll() {
+    unsigned long now = millis();
+    if (now - race_start_ >= RACE_TIMEOUT_MS) {
+        return false;
+    }
+    
+    // Check each connect in flight
+    bool in_flight = false;
+    for (int k = 0; k < next_; k++) {
+        if (!sockets_[k].is_open()) {
+            continue;
+        }
+        switch (sockets_[k].poll_connect()) {
+            case WebInkSocket::PollResult::CONNECTED: {
+                unsigned long elapsed = now - started_at_[k];
+                connect_ms_[k] = elapsed > 0 ? elapsed : 1;
+                winner_ = k;
+                return false;
+            }
+            case WebInkSocket::PollResult::FAILED:
+                failed_mask_ |= 1u << k;
+                sockets_[k].close();
+                break;
+            case WebInkSocket::PollResult::PENDING:
+            default:
+                in_flight = true;
+                break;
+        }
+    }
+    
+    // Start the next attempt when its stagger slot arrives (or nothing else is in flight)
+    while (next_ < count_ && (static_cast<long>(now - next_start_) >= 0 || !in_flight)) {
+        int k = next_++;
+        if (ips_[k] == 0) {
+            failed_mask_ |= 1u << k;
+            continue;
+        }
+        
+        started_at_[k] = now;
+        WebInkSocket::ConnectResult result = sockets_[k].connect(ips_[k], ports_[k]);
+        if (result == WebInkSocket::ConnectResult::CONNECTED) {
+            connect_ms_[k] = 1;  // Connected immediately - report the minimum
+            winner_ = k;
+            return false;
+        }
+        if (result == WebInkSocket::ConnectResult::FAILED) {
+            failed_mask_ |= 1u << k;
+            continue;
+        }
+        in_flight = true;
+        next_start_ = now + RACE_STAGGER_MS;
+        break;
+    }
+    
+    return in_flight || next_ < count_;
+}
+
+void WebInkController::ServerRaceTask::close_all() {
+    for (WebInkSocket& socket : sockets_) {
+        socket.close();
+    }
+}
+
+bool WebInkController::fail_over_server(const char* reason) {
+    int failed = config_->get_active_server();
+    state_.record_server_failure(failed);
+    
+    int next = state_.choose_server(config_->get_server_count(), servers_tried_mask_);
+    if (next < 0) {
+        return false;
+    }
+    
+    server_failovers_++;
+    WEBINK_LOGW(TAG, "[FAILOVER] Server %d failed (%s) - continuing on server %d (row %d of %d)",
+                failed, reason, next, rows_completed_, total_image_rows_);
+    
+    // Use the hostname for the rest of the cycle; resolving would block mid-transfer
+    state_.invalidate_server_address();
+    state_.preferred_server = static_cast<uint8_t>(next);
+    config_->select_server(next);
+    servers_tried_mask_ |= 1u << next;
+    using_cached_address_ = false;
+    server_address_ready_ = true;
+    return true;
+}
+
+bool WebInkController::fail_over_socket_download(const char* reason) {
+    network_->socket_close();
+    
+    while (fail_over_server(reason)) {
+        // The new server resends from rows_completed_, so drop any partial row
+        download_task_.buffer_pos_ = 0;
+        char host[HOST_BUFFER_SIZE];
+        if (config_->get_server_connect_host(host, sizeof(host)) &&
+            network_->socket_connect_async(host, config_->socket_mode_port)) {
+            return true;
+        }
+        reason = "connect failed";
+    }
+    return false;
+}
+
+void WebInkController::finish_connection_warmup(bool hash_changed) {
+    if (!warmup_active_) {
+        return;
+    }
+    warmup_active_ = false;
+    
+    if (hash_changed) {
+        // The image download takes over the connection
+        warmup_hits_++;
+        WEBINK_LOGI(TAG, "[WARMUP] Hit - image download reuses warm connection (%u hits, %u misses)",
+                    (unsigned) warmup_hits_, (unsigned) warmup_misses_);
+    } else {
+        warmup_misses_++;
+        WEBINK_LOGI(TAG, "[WARMUP] Miss - closing unused connection (%u hits, %u misses)",
+                    (unsigned) warmup_hits_, (unsigned) warmup_misses_);
+        release_image_connection();
+    }
+}
+
+void WebInkController::release_image_connection() {
+    warmup_active_ = false;
+    race_task_.close_all();
+    
+    if (!network_) {
+        return;
+    }
+    
+    if (network_->get_http_keep_alive()) {
+        network_->set_http_keep_alive(false);
+    }
+    
+    // Only close a socket nobody is streaming from
+    if (!network_->is_operation_pending()) {
+        network_->socket_close();
+    }
+}
+
+void WebInkController::handle_image_parse_state() {
+    WEBINK_LOGI(TAG, "[IMAGE] Parsing image data");
+    update_progress(75.0f, "Processing image data");
+    
+    // In a full implementation, this would parse received image data
+    // For now, just transition to display
+    transition_to_state(UpdateState::IMAGE_DISPLAY);
+}
+
+void WebInkController::handle_image_display_state() {
+    WEBINK_LOGI(TAG, "[IMAGE] Drawing image to display buffer");
+    update_progress(85.0f, "Drawing image to buffer");
+    
+    // In a full implementation, this would draw pixels to display buffer
+    // For now, just transition to display update
     transition_to_state(UpdateState::DISPLAY_UPDATE);
 }
 
 void WebInkController::handle_display_update_state() {
-    ESP_LOGI(TAG, "[DISPLAY] Updating physical display");
+    // refresh_task_ leaves this state itself once the panel is refreshed
+    if (!refresh_task_.is_running()) {
+        handle_error(ErrorType::MEMORY_ERROR, "Failed to start display refresh task");
+    }
+}
+
+TaskStatus WebInkController::DisplayRefreshTask::step() {
+    WebInkController* c = owner_;
     
-    if (display_) {
-        display_->update_display();
+    WEBINK_CO_BEGIN();
+    WEBINK_CO_AWAIT(c->begin_blocking_operation());
+    
+    WEBINK_LOGI(TAG, "[DISPLAY] Updating physical display");
+    
+    if (c->display_) {
+        unsigned long refresh_start = millis();
+        WebInkTraceScope trace(TraceEvent::REFRESH);
+        c->display_->update_display();
+        c->telemetry_.set_refresh_ms(millis() - refresh_start);
     }
+    c->telemetry_.set_flag(TELEMETRY_FLAG_CONTENT_UPDATED);
     
-    update_progress(95.0f, "Refreshing display");
+    c->update_progress(95.0f, "Refreshing display");
     
     // Display update is typically slow (several seconds for e-ink)
-    // In a full implementation, this would be non-blocking
-    transition_to_state(UpdateState::SLEEP_PREPARE);
+    c->transition_to_state(UpdateState::SLEEP_PREPARE);
+    WEBINK_CO_END();
 }
 
 void WebInkController::handle_sleep_prepare_state() {
-    static bool sleep_interval_requested = false;
+    // sleep_task_ either enters deep sleep (DONE, the state stays until the
+    // chip powers down) or moves on to COMPLETE
+    if (sleep_task_.is_running() || sleep_task_.get_status() == TaskStatus::DONE) {
+        return;
+    }
     
-    // Phase 1: Request sleep interval from server
-    if (!sleep_interval_requested) {
-        ESP_LOGI(TAG, "[SLEEP] Requesting sleep interval from server");
-        
-        if (!network_) {
-            ESP_LOGW(TAG, "[SLEEP] Network client not available - using default sleep duration");
-            sleep_interval_requested = true;  // Skip to phase 2
-            return;
+    // Not handle_error(): ERROR_DISPLAY would come straight back here
+    WEBINK_LOGE(TAG, "[SLEEP] Sleep task did not run - skipping deep sleep");
+    transition_to_state(UpdateState::COMPLETE);
+}
+
+TaskStatus WebInkController::SleepTask::step() {
+    WebInkController* c = owner_;
+    
+    WEBINK_CO_BEGIN();
+    {
+        // The hash or conditional response usually refreshed the interval already
+        uint32_t now_s = static_cast<uint32_t>(time(nullptr));
+        request_interval_ = !c->state_.has_fresh_sleep_interval(now_s);
+        if (!request_interval_) {
+            WEBINK_LOGI(TAG, "[SLEEP] Using server sleep interval %d s (age %u s) - no /get_sleep request",
+                        c->state_.sleep_duration_seconds, (unsigned) (now_s - c->state_.sleep_interval_time));
+        } else if (!c->network_) {
+            WEBINK_LOGW(TAG, "[SLEEP] Network client not available - using default sleep duration");
+            request_interval_ = false;
         }
+    }
+    
+    // Phase 1: Request sleep interval from server (blocking HTTP request)
+    if (request_interval_) {
+        WEBINK_CO_AWAIT(c->begin_blocking_operation());
+        WEBINK_LOGI(TAG, "[SLEEP] Requesting sleep interval from server");
         
-        std::string sleep_url = config_->build_sleep_url();
-        ESP_LOGI(TAG, "[SLEEP] Sleep URL: %s", sleep_url.c_str());
-        
-        bool request_started = network_->http_get_async(sleep_url,
-            [this](NetworkResult result) {
-                this->on_sleep_response(result);
-            }, NETWORK_TIMEOUT_MS);
+        request_interval_ = false;
+        if (c->config_->build_sleep_url(c->request_buffer_, sizeof(c->request_buffer_)) > 0) {
+            WEBINK_LOGI(TAG, "[SLEEP] Sleep URL: %s", c->request_buffer_);
+            request_interval_ = c->network_->http_get_async(c->request_buffer_,
+                [c](NetworkResult result) {
+                    c->on_sleep_response(std::move(result));
+                }, NETWORK_TIMEOUT_MS);
+        }
         
-        if (request_started) {
-            sleep_interval_requested = true;
-            update_progress(95.0f, "Getting sleep interval");
-            ESP_LOGD(TAG, "[SLEEP] Sleep interval request started");
+        if (request_interval_) {
+            c->update_progress(95.0f, "Getting sleep interval");
+            WEBINK_LOGD(TAG, "[SLEEP] Sleep interval request started");
         } else {
-            ESP_LOGW(TAG, "[SLEEP] Failed to request sleep interval - using default");
-            sleep_interval_requested = true;  // Skip to phase 2
+            WEBINK_LOGW(TAG, "[SLEEP] Failed to request sleep interval - using default");
         }
-        return;
+        WEBINK_CO_AWAIT(!request_interval_ || !c->network_->is_operation_pending());
     }
     
-    // Phase 2: Prepare for deep sleep (after sleep interval received)
-    ESP_LOGI(TAG, "[SLEEP] Preparing for deep sleep");
+    // Phase 2: Prepare for deep sleep - the log upload blocks as well
+    WEBINK_CO_AWAIT(c->begin_blocking_operation());
+    WEBINK_LOGI(TAG, "[SLEEP] Preparing for deep sleep");
     
-    update_progress(100.0f, "Update complete");
+    c->update_progress(100.0f, "Update complete");
     
-    post_status_to_server("Update complete - entering deep sleep for " + 
-                         std::to_string(state_.sleep_duration_seconds) + " seconds");
+    {
+        // Hash policy telemetry rides along with the completion status
+        const char* policy = c->state_.get_policy_string(c->hash_policy_);
+        WEBINK_LOGI(TAG, "[POLICY] %s", policy);
+        
+        c->log_buffer_.recordf(LogSeverity::INFO, c->state_.wake_counter,
+                               "Update complete - entering deep sleep for %lu seconds (%s)",
+                               c->state_.get_sleep_duration_ms() / 1000, policy);
+    }
     
-    if (should_enter_deep_sleep()) {
-        prepare_and_enter_deep_sleep();
-    } else {
-        ESP_LOGI(TAG, "[SLEEP] Skipping deep sleep - conditions not met");
-        transition_to_state(UpdateState::COMPLETE);
+    c->record_wake_telemetry();
+    
+    // The radio is still up - upload buffered logs if they are due
+    if (c->log_buffer_.is_flush_due(c->state_.wake_counter)) {
+        c->flush_log_buffer();
     }
     
-    // Reset for next cycle
-    sleep_interval_requested = false;
+    if (c->should_enter_deep_sleep()) {
+        c->prepare_and_enter_deep_sleep();
+    } else {
+        WEBINK_LOGI(TAG, "[SLEEP] Skipping deep sleep - conditions not met");
+        c->transition_to_state(UpdateState::COMPLETE);
+    }
+    WEBINK_CO_END();
 }
 
 void WebInkController::handle_complete_state() {
-    ESP_LOGI(TAG, "[COMPLETE] Update cycle complete");
+    WEBINK_LOGI(TAG, "[COMPLETE] Update cycle complete");
     
     reset_operation_state();
     transition_to_state(UpdateState::IDLE);
@@ -733,63 +1368,105 @@ void WebInkController::handle_error_display_state() {
 //=============================================================================
 
 void WebInkController::on_hash_response(NetworkResult result) {
+    WebInkAllocScope alloc_scope("hash_response");
+    if (!result.success && using_cached_address_) {
+        // The server may have moved - resolve again and retry from HASH_REQUEST
+        WEBINK_LOGW(TAG, "[DNS] Hash request to cached address failed - re-resolving");
+        network_->record_retry(NetOperation::HTTP_GET);
+        state_.invalidate_server_address();
+        release_image_connection();
+        server_address_ready_ = false;
+        return;
+    }
+    
+    if (!result.success && fail_over_server("hash request failed")) {
+        // Retry the hash request on the next server from HASH_REQUEST
+        network_->record_retry(NetOperation::HTTP_GET);
+        release_image_connection();
+        return;
+    }
+    
     if (!result.success) {
         handle_error(ErrorType::SERVER_UNREACHABLE, "Hash request failed: " + result.error_message);
         return;
     }
     
-    ESP_LOGI(TAG, "[HASH] Received response: %s", result.data.c_str());
+    state_.record_server_success(config_->get_active_server(), 0);
+    
+    WEBINK_LOGI(TAG, "[HASH] Received response: %s", result.data.c_str());
     
-    // Parse JSON response: {"hash":"abcd1234"}
-    std::string hash_response = result.data;
-    size_t hash_pos = hash_response.find("\"hash\":\"");
-    size_t value_offset = 8;  // length of "hash":"
-    if (hash_pos == std::string::npos) {
-        hash_pos = hash_response.find("\"hash\": \"");
-        value_offset = 9;  // length of "hash": " (with space)
+    // Parse JSON response: {"hash": "abcd1234", "sleep_seconds": 1800, ...}
+    char hash[17];
+    if (!json_parser_.parse(result.data.data(), result.data.size())) {
+        handle_error(ErrorType::PARSE_ERROR, "Malformed hash response");
+        return;
+    }
+    if (!json_parser_.get_string("hash", hash, sizeof(hash)) || hash[0] == '\0') {
+        handle_error(ErrorType::PARSE_ERROR, "Hash not found in server response");
+        return;
     }
     
-    if (hash_pos != std::string::npos) {
-        size_t start = hash_pos + value_offset;  // First char of hash value
-        size_t end = hash_response.find("\"", start);
+    current_hash_ = hash;
+    WEBINK_LOGI(TAG, "[HASH] Parsed hash: %s", hash);
+    
+    // Newer servers fold the sleep schedule into the hash response
+    int sleep_seconds = -1;
+    int next_change = -1;
+    json_parser_.get_int("sleep_seconds", sleep_seconds);
+    json_parser_.get_int("next_change_seconds", next_change);
+    apply_server_schedule(sleep_seconds, next_change);
+    
+    bool hash_changed = state_.has_hash_changed(hash);
+    state_.record_hash_check(hash_changed, HashPolicy::HASH_CHECK);
+    finish_connection_warmup(hash_changed);
+    
+    if (hash_changed) {
+        WEBINK_LOGI(TAG, "[HASH] Hash changed - starting image download");
         
-        if (end != std::string::npos && end > start) {
-            current_hash_ = hash_response.substr(start, end - start);
-            ESP_LOGI(TAG, "[HASH] Parsed hash: %s", current_hash_.c_str());
-            
-            if (state_.has_hash_changed(current_hash_.c_str())) {
-                ESP_LOGI(TAG, "[HASH] Hash changed - starting image download");
-                state_.update_hash(current_hash_.c_str());
-                transition_to_state(UpdateState::IMAGE_REQUEST);
-            } else {
-                ESP_LOGI(TAG, "[HASH] Hash unchanged - skipping update");
-                transition_to_state(UpdateState::SLEEP_PREPARE);
-            }
-        } else {
-            handle_error(ErrorType::PARSE_ERROR, "Failed to extract hash from response");
-        }
+        prepare_display();
+        state_.update_hash(hash);
+        transition_to_state(UpdateState::IMAGE_REQUEST);
     } else {
-        handle_error(ErrorType::PARSE_ERROR, "Hash not found in server response");
+        WEBINK_LOGI(TAG, "[HASH] Hash unchanged - skipping update");
+        transition_to_state(UpdateState::SLEEP_PREPARE);
     }
 }
 
 void WebInkController::on_image_response(NetworkResult result) {
+    WebInkAllocScope alloc_scope("image_response");
+    if (current_image_request_.is_conditional()) {
+        apply_server_schedule(result.sleep_seconds, result.next_change_seconds);
+        if (result.status_code == 304) {
+            on_conditional_unchanged();
+            return;
+        }
+        if (result.success) {
+            accept_conditional_hash(result.content_hash.c_str());
+        }
+    }
+    
+    if (!result.success && fail_over_server("image slice failed")) {
+        // Nothing queued, so the download task requests this slice again
+        release_image_connection();
+        return;
+    }
+    
     if (!result.success) {
         handle_error(ErrorType::SERVER_UNREACHABLE, "Image request failed: " + result.error_message);
         return;
     }
     
-    ESP_LOGI(TAG, "[IMAGE] Received %d bytes of image data (rows %d-%d)", 
-             result.bytes_received, rows_completed_, 
-             rows_completed_ + current_image_request_.num_rows);
+    WEBINK_LOGI_RATE(TAG, LOG_RATE_INTERVAL_MS, "[IMAGE] Received %d bytes of image data (rows %d-%d)",
+                     result.bytes_received, rows_completed_,
+                     rows_completed_ + current_image_request_.num_rows);
     
     if (result.bytes_received > 0) {
-        // Parse PBM and render to display
-        const uint8_t* data = reinterpret_cast<const uint8_t*>(result.data.data());
-        size_t data_size = result.data.size();
+        WebInkTraceScope trace(TraceEvent::DECODE, result.bytes_received);
         
         // Skip PBM header to find pixel data
         // PBM P4 format: "P4\n<width> <height>\n<binary data>"
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(result.data.data());
+        size_t data_size = result.data.size();
         size_t pixel_start = 0;
         int newline_count = 0;
         for (size_t i = 0; i < data_size && newline_count < 2; i++) {
@@ -802,104 +1479,324 @@ void WebInkController::on_image_response(NetworkResult result) {
             }
         }
         
-        // Render pixels to display if we have display manager and pixel data
-        if (display_ && pixel_start < data_size) {
-            int width = 800;  // TODO: get from config
-            int height = current_image_request_.num_rows;
-            const uint8_t* pixel_data = data + pixel_start;
-            
-            // Draw this slice to the display buffer
-            display_->draw_progressive_pixels(0, rows_completed_, width, height,
-                                             pixel_data, ColorMode::MONO_BLACK_WHITE);
-            
-            ESP_LOGD(TAG, "[IMAGE] Rendered rows %d-%d to display buffer", 
-                     rows_completed_, rows_completed_ + height);
-        }
-        
-        // Increment rows completed
-        rows_completed_ += current_image_request_.num_rows;
+        // Queue the slice; handle_image_download_state() draws it in quanta
+        slice_data_ = std::move(result.data);
+        slice_offset_ = pixel_start;
+        slice_start_row_ = rows_completed_;
+        slice_rows_pending_ = current_image_request_.num_rows;
         
-        ESP_LOGD(TAG, "[IMAGE] Progress: %d/%d rows complete", 
-                 rows_completed_, total_image_rows_);
+        if (!display_) {
+            // Headless - account for the rows and move on
+            rows_completed_ += slice_rows_pending_;
+            slice_rows_pending_ = 0;
+            release_slice_data();
+        } else if (pixel_start >= slice_data_.size()) {
+            // Header only - no rows drawn; the download task requests them again
+            WEBINK_LOGW(TAG, "[IMAGE] Slice at row %d has no pixel data", rows_completed_);
+            short_slices_++;
+            slice_rows_pending_ = 0;
+            release_slice_data();
+        }
     } else {
         handle_error(ErrorType::PARSE_ERROR, "Empty image data received");
     }
 }
 
+bool WebInkController::request_next_slice() {
+    int remaining_rows = total_image_rows_ - rows_completed_;
+    int rows_to_request = std::min(config_->rows_per_slice, remaining_rows);
+    
+    current_image_request_.rect = DisplayRect(0, rows_completed_, geometry_.width, rows_to_request);
+    current_image_request_.start_row = rows_completed_;
+    current_image_request_.num_rows = rows_to_request;
+    current_image_request_.format = "pbm";
+    
+    // Only the first slice is conditional; a 304 ends the download
+    bool conditional = (hash_policy_ == HashPolicy::CONDITIONAL_FETCH && rows_completed_ == 0);
+    current_image_request_.set_if_none_match(conditional ? state_.get_hash() : nullptr);
+    
+    // The previous slice is drawn and released - reuse its arena space
+    if (rows_completed_ == 0) {
+        slice_arena_mark_ = WebInkArena::mark();
+    } else {
+        WebInkArena::rewind(slice_arena_mark_);
+    }
+    
+    // The URL head is fixed for the download; per slice only the numbers are rewritten
+    if (rows_completed_ == 0 || image_url_prefix_length_ == 0) {
+        image_url_prefix_length_ = config_->build_image_url_prefix(image_url_, sizeof(image_url_),
+                                                                   current_image_request_.format);
+    }
+    if (config_->build_image_url_slice(image_url_, sizeof(image_url_), image_url_prefix_length_,
+                                       current_image_request_) == 0) {
+        image_url_prefix_length_ = 0;
+        handle_error(ErrorType::MEMORY_ERROR, "Image URL too long");
+        return false;
+    }
+    WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS, "[IMAGE] Requesting rows %d-%d of %d",
+                     rows_completed_, rows_completed_ + rows_to_request, total_image_rows_);
+    
+    // Blocking - on_image_response queues the slice before this returns
+    bool request_started = network_->http_get_async(image_url_,
+        [this](NetworkResult result) {
+            this->on_image_response(std::move(result));
+        }, NETWORK_TIMEOUT_MS);
+    
+    if (!request_started) {
+        handle_error(ErrorType::SERVER_UNREACHABLE, "Failed to request image slice");
+        return false;
+    }
+    
+    // on_image_response() reports failures through handle_error()
+    return current_state_ == UpdateState::IMAGE_DOWNLOAD;
+}
+
+void WebInkController::draw_slice_quantum() {
+    WebInkAllocScope alloc_scope("draw_slice");
+    // PBM rows; a compile-time constant with a fixed geometry
+    int width = geometry_.width;
+    int bytes_per_row = webink_row_bytes<FIXED_PBM_ROW_BYTES>(geometry_.pbm_bytes_per_row());
+    int rows = std::min(ROWS_PER_QUANTUM, slice_rows_pending_);
+    
+    // Clamp to the rows actually present in a short response
+    int rows_available = static_cast<int>((slice_data_.size() - slice_offset_) / bytes_per_row);
+    int rows_to_draw = std::min(rows, rows_available);
+    
+    if (rows_to_draw > 0) {
+        const uint8_t* pixel_data = reinterpret_cast<const uint8_t*>(slice_data_.data()) + slice_offset_;
+        WebInkTraceScope trace(TraceEvent::BLIT, rows_to_draw);
+        WebInkMemory::record_access(pixel_data, rows_to_draw * bytes_per_row);
+        display_->draw_progressive_pixels(0, rows_completed_, width, rows_to_draw,
+                                         pixel_data, ColorMode::MONO_BLACK_WHITE);
+        fold_band_hash(rows_completed_, pixel_data, rows_to_draw, bytes_per_row);
+        slice_offset_ += rows_to_draw * bytes_per_row;
+    }
+    
+    rows_completed_ += rows_to_draw;
+    slice_rows_pending_ -= rows_to_draw;
+    quantum_progress_ = true;
+    
+    if (rows_to_draw < rows) {
+        // Response ended early - drop the rest; the download task re-requests it
+        WEBINK_LOGW(TAG, "[IMAGE] Slice from row %d ended after %d of %d rows", slice_start_row_,
+                    rows_completed_ - slice_start_row_, rows_completed_ - slice_start_row_ + slice_rows_pending_);
+        short_slices_++;
+        slice_rows_pending_ = 0;
+    }
+    
+    if (slice_rows_pending_ == 0) {
+        WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS, "[IMAGE] Rendered rows %d-%d, %d/%d rows complete",
+                         slice_start_row_, rows_completed_, rows_completed_, total_image_rows_);
+        release_slice_data();
+    }
+}
+
+void WebInkController::release_slice_data() {
+    // swap() rather than clear() so the buffer itself goes back to the arena
+    ArenaString().swap(slice_data_);
+    slice_offset_ = 0;
+}
+
 void WebInkController::on_sleep_response(NetworkResult result) {
     if (!result.success) {
-        ESP_LOGW(TAG, "[SLEEP] Sleep interval request failed: %s - using default", result.error_message.c_str());
-        ESP_LOGW(TAG, "[SLEEP] Using default sleep duration: %d seconds", state_.sleep_duration_seconds);
+        WEBINK_LOGW(TAG, "[SLEEP] Sleep interval request failed: %s - using default", result.error_message.c_str());
+        WEBINK_LOGW(TAG, "[SLEEP] Using default sleep duration: %d seconds", state_.sleep_duration_seconds);
         return;
     }
     
-    ESP_LOGI(TAG, "[SLEEP] Received sleep interval response: %s", result.data.c_str());
+    WEBINK_LOGI(TAG, "[SLEEP] Received sleep interval response: %s", result.data.c_str());
     
-    // Parse JSON response: {"sleep": 1800} or {"sleep_duration": 1800} or {"sleep_seconds": 1800}
-    std::string sleep_response = result.data;
-    size_t sleep_pos = sleep_response.find("\"sleep_seconds\":");
-    if (sleep_pos == std::string::npos) {
-        sleep_pos = sleep_response.find("\"sleep\":");
+    // Parse JSON response: {"sleep_seconds": 1800, "next_change_seconds": 1750}
+    // (older servers: {"sleep": 1800} or {"sleep_duration": 1800})
+    int new_sleep_duration = 0;
+    if (!json_parser_.parse(result.data.data(), result.data.size()) ||
+        (!json_parser_.get_int("sleep_seconds", new_sleep_duration) &&
+         !json_parser_.get_int("sleep", new_sleep_duration) &&
+         !json_parser_.get_int("sleep_duration", new_sleep_duration))) {
+        WEBINK_LOGW(TAG, "[SLEEP] Sleep duration not found in server response");
+        return;
     }
-    if (sleep_pos == std::string::npos) {
-        sleep_pos = sleep_response.find("\"sleep_duration\":");
+    
+    if (new_sleep_duration <= 0) {
+        WEBINK_LOGW(TAG, "[SLEEP] Invalid sleep duration from server: %d - using default", 
+                    new_sleep_duration);
+        return;
     }
     
-    if (sleep_pos != std::string::npos) {
-        // Find the colon and skip whitespace
-        size_t colon_pos = sleep_response.find(":", sleep_pos);
-        if (colon_pos != std::string::npos) {
-            size_t start = colon_pos + 1;
-            
-            // Skip whitespace
-            while (start < sleep_response.length() && 
-                   (sleep_response[start] == ' ' || sleep_response[start] == '\t')) {
-                start++;
-            }
-            
-            // Extract number (until non-digit character)
-            size_t end = start;
-            while (end < sleep_response.length() && isdigit(sleep_response[end])) {
-                end++;
-            }
-            
-            if (end > start) {
-                std::string sleep_str = sleep_response.substr(start, end - start);
-                int new_sleep_duration = std::atoi(sleep_str.c_str());
-                
-                if (new_sleep_duration > 0) {
-                    ESP_LOGI(TAG, "[SLEEP] Server set sleep duration: %d seconds", new_sleep_duration);
-                    state_.sleep_duration_seconds = new_sleep_duration;
-                } else {
-                    ESP_LOGW(TAG, "[SLEEP] Invalid sleep duration from server: %d - using default", 
-                             new_sleep_duration);
-                }
-            } else {
-                ESP_LOGW(TAG, "[SLEEP] Failed to parse sleep duration number");
-            }
+    int next_change = -1;
+    json_parser_.get_int("next_change_seconds", next_change);
+    apply_server_schedule(new_sleep_duration, next_change);
+}
+
+void WebInkController::apply_server_schedule(int sleep_seconds, int next_change_seconds) {
+    if (sleep_seconds < 0 && next_change_seconds < 0) {
+        return;  // Older server - /get_sleep stays the source
+    }
+    state_.record_server_schedule(sleep_seconds, next_change_seconds, static_cast<uint32_t>(time(nullptr)));
+}
+
+void WebInkController::on_socket_data(const uint8_t* data, int length) {
+    WebInkAllocScope alloc_scope("socket_data");
+    const int bytes_per_row = webink_row_bytes<FIXED_PBM_ROW_BYTES>(geometry_.pbm_bytes_per_row());
+    uint8_t* row_buffer = download_task_.row_buffer_;
+    int& buffer_pos = download_task_.buffer_pos_;
+    
+    WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS, "[SOCKET] Received %d bytes, buffer_pos=%d, rows=%d",
+                     length, buffer_pos, rows_completed_);
+    
+    // Late chunks after an error or an "unchanged" status are dropped
+    if (!display_ || length <= 0) return;
+    if (current_state_ != UpdateState::IMAGE_DOWNLOAD || content_unchanged_) return;
+    
+    quantum_progress_ = true;
+    
+    // One span per chunk - per-row blits would flood the trace ring
+    WebInkTraceScope trace(TraceEvent::DECODE, length);
+    
+    if (download_task_.status_pending_) {
+        int consumed = consume_socket_status_line(data, length);
+        if (consumed < 0 || content_unchanged_) {
+            return;
+        }
+        data += consumed;
+        length -= consumed;
+    }
+    int data_pos = 0;
+    
+    while (data_pos < length) {
+        // Fill buffer with incoming data
+        int bytes_needed = bytes_per_row - buffer_pos;
+        int bytes_available = length - data_pos;
+        int bytes_to_copy = std::min(bytes_needed, bytes_available);
+        
+        memcpy(row_buffer + buffer_pos, data + data_pos, bytes_to_copy);
+        buffer_pos += bytes_to_copy;
+        data_pos += bytes_to_copy;
+        
+        // If we have a complete row, draw it
+        if (buffer_pos >= bytes_per_row) {
+            display_->draw_progressive_pixels(0, rows_completed_, geometry_.width, 1,
+                                             row_buffer, ColorMode::MONO_BLACK_WHITE);
+            fold_band_hash(rows_completed_, row_buffer, 1, bytes_per_row);
+            rows_completed_++;
+            buffer_pos = 0;
+        }
+    }
+    
+    // Update progress
+    if (total_image_rows_ > 0) {
+        current_progress_ = 50.0f + (rows_completed_ * 30.0f) / total_image_rows_;
+    }
+}
+
+//=============================================================================
+// ADAPTIVE HASH POLICY
+//=============================================================================
+
+void WebInkController::accept_conditional_hash(const char* hash) {
+    prepare_display();
+    
+    if (hash[0] == '\0') {
+        // Old server: it ignored the condition and sent the image anyway
+        state_.disable_conditional_fetch();
+        return;
+    }
+    
+    current_hash_ = hash;
+    WEBINK_LOGI(TAG, "[POLICY] Conditional fetch returned new content, hash %s", hash);
+    state_.record_hash_check(true, HashPolicy::CONDITIONAL_FETCH);
+    state_.update_hash(hash);
+}
+
+void WebInkController::on_conditional_unchanged() {
+    WEBINK_LOGI(TAG, "[POLICY] Conditional fetch: content unchanged (%s)", state_.get_hash());
+    content_unchanged_ = true;
+    quantum_progress_ = true;
+    state_.record_hash_check(false, HashPolicy::CONDITIONAL_FETCH);
+}
+
+int WebInkController::consume_socket_status_line(const uint8_t* data, int length) {
+    char* line = download_task_.status_line_;
+    int& line_len = download_task_.status_len_;
+    
+    int consumed = 0;
+    while (consumed < length) {
+        char ch = static_cast<char>(data[consumed++]);
+        if (ch == '\n') {
+            line[line_len] = '\0';
+            download_task_.status_pending_ = false;
+            break;
+        }
+        if (line_len >= ImageDownloadTask::STATUS_LINE_MAX - 1) {
+            handle_error(ErrorType::INVALID_RESPONSE, "Socket status line too long");
+            return -1;
+        }
+        line[line_len++] = ch;
+    }
+    
+    if (download_task_.status_pending_) {
+        return consumed;  // Line continues in the next chunk
+    }
+    
+    // "UNCHANGED <hash> [<sleep> <next_change>]" or "OK <hash> [...]"; anything
+    // else (e.g. "ERROR: ...") means the server does not speak webInkV2
+    bool unchanged = (strncmp(line, "UNCHANGED ", 10) == 0);
+    bool ok = (strncmp(line, "OK ", 3) == 0);
+    if (unchanged || ok) {
+        char hash[17] = "";
+        int sleep_seconds = -1;
+        int next_change = -1;
+        sscanf(line + (unchanged ? 10 : 3), "%16s %d %d", hash, &sleep_seconds, &next_change);
+        apply_server_schedule(sleep_seconds, next_change);
+        
+        if (unchanged) {
+            on_conditional_unchanged();
         } else {
-            ESP_LOGW(TAG, "[SLEEP] Failed to find colon in sleep response");
+            accept_conditional_hash(hash);
         }
     } else {
-        ESP_LOGW(TAG, "[SLEEP] Sleep duration not found in server response");
+        WEBINK_LOGW(TAG, "[SOCKET] Unexpected status line: %s", line);
+        state_.disable_conditional_fetch();
+        handle_error(ErrorType::INVALID_RESPONSE, "Server rejected conditional fetch");
+        return -1;
     }
+    return consumed;
 }
 
-
-void WebInkController::on_socket_data(const uint8_t* data, int length) {
-    ESP_LOGD(TAG, "[SOCKET] Received %d bytes of data", length);
+void WebInkController::fold_band_hash(int first_row, const uint8_t* data, int rows, int bytes_per_row) {
+    if (total_image_rows_ <= 0) {
+        return;
+    }
+    
+    // Constant with a fixed geometry, so the row loop has a known trip count
+    const int row_bytes = webink_row_bytes<FIXED_PBM_ROW_BYTES>(bytes_per_row);
     
-    // Process socket data for full image download mode
-    // This would be used in TCP socket mode for streaming image data
-    // For now, just log the data receipt
-    if (current_state_ == UpdateState::IMAGE_DOWNLOAD) {
-        ESP_LOGD(TAG, "[SOCKET] Processing image data chunk");
+    for (int r = 0; r < rows; r++) {
+        int band = ((first_row + r) * WebInkState::BAND_COUNT) / total_image_rows_;
+        if (band >= WebInkState::BAND_COUNT) {
+            band = WebInkState::BAND_COUNT - 1;
+        }
         
-        // In a full implementation, this would:
-        // 1. Accumulate the received data
-        // 2. Check if we have received the complete image
-        // 3. Transition to IMAGE_PARSE state when complete
+        // FNV-1a over the row's pixel bytes
+        uint32_t hash = band_hash_accum_[band];
+        const uint8_t* row = data + r * row_bytes;
+        for (int i = 0; i < row_bytes; i++) {
+            hash = (hash ^ row[i]) * 16777619u;
+        }
+        band_hash_accum_[band] = hash;
+    }
+}
+
+void WebInkController::commit_band_hashes() {
+    int changed = 0;
+    for (int i = 0; i < WebInkState::BAND_COUNT; i++) {
+        if (state_.band_hashes[i] != band_hash_accum_[i]) {
+            changed++;
+        }
+        state_.band_hashes[i] = band_hash_accum_[i];
     }
+    
+    WEBINK_LOGI(TAG, "[IMAGE] %d of %d bands changed since last image", changed, WebInkState::BAND_COUNT);
 }
 
 //=============================================================================
@@ -907,9 +1804,20 @@ void WebInkController::on_socket_data(const uint8_t* data, int length) {
 //=============================================================================
 
 void WebInkController::handle_error(ErrorType error_type, const std::string& details) {
-    ESP_LOGE(TAG, "[ERROR] %s: %s", error_type_to_string(error_type), details.c_str());
+    WEBINK_LOGE(TAG, "[ERROR] %s: %s", error_type_to_string(error_type), details.c_str());
     
     state_.set_error(error_type, details.c_str());
+    telemetry_.set_error(error_type);
+    
+    // A stale cached address must not outlive the cycle it failed in
+    if (using_cached_address_ &&
+        (error_type == ErrorType::SOCKET_ERROR || error_type == ErrorType::SERVER_UNREACHABLE)) {
+        state_.invalidate_server_address();
+    }
+    
+    // Stop any in-flight transfer; safe even when called from inside a task
+    executor_.cancel_all();
+    release_image_connection();
     
     if (on_error_occurred) {
         on_error_occurred(error_type, details);
@@ -919,16 +1827,33 @@ void WebInkController::handle_error(ErrorType error_type, const std::string& det
 }
 
 void WebInkController::display_error_and_sleep(ErrorType error_type, const std::string& details) {
+    prepare_display();
     if (display_) {
         display_->draw_error_message(error_type, details);
     }
     
-    // DISABLED: String concatenation causes stack overflow on ESP32C3
-    // post_status_to_server("ERROR: " + std::string(error_type_to_string(error_type)) + " - " + details);
+    // Formatted into the ring's static buffer; uploaded on a later wake
+    log_buffer_.recordf(LogSeverity::ERROR, state_.wake_counter, "ERROR: %s - %s",
+                        error_type_to_string(error_type), details.c_str());
     
     transition_to_state(UpdateState::ERROR_DISPLAY);
 }
 
+void WebInkController::prepare_display() {
+    if (display_prepared_ || !display_) {
+        return;
+    }
+    display_prepared_ = true;
+    
+    // Shown on status and error screens; the IP is set later
+    char host[HOST_BUFFER_SIZE];
+    int port;
+    if (config_->parse_server_host(host, sizeof(host), port)) {
+        display_->set_network_info(config_->base_url, "");
+    }
+    WEBINK_LOGD(TAG, "[DISPLAY] First drawing this boot");
+}
+
 //=============================================================================
 // UTILITY METHODS
 //=============================================================================
@@ -937,7 +1862,7 @@ void WebInkController::initialize_components() {
     // Create network client if not provided
     if (!network_) {
         network_ = std::make_shared<WebInkNetworkClient>(config_.get(),
-            [this](const std::string& msg) {
+            [this](const char* msg) {
                 if (on_log_message) on_log_message(msg);
             });
     }
@@ -945,12 +1870,12 @@ void WebInkController::initialize_components() {
     // Create image processor if not provided
     if (!image_processor_) {
         image_processor_ = std::make_shared<WebInkImageProcessor>(
-            [this](const std::string& msg) {
+            [this](const char* msg) {
                 if (on_log_message) on_log_message(msg);
             });
     }
     
-    ESP_LOGD(TAG, "Components initialized");
+    WEBINK_LOGD(TAG, "Components initialized");
 }
 
 bool WebInkController::validate_configuration() {
@@ -959,12 +1884,12 @@ bool WebInkController::validate_configuration() {
     error_buffer[0] = '\0';  // Initialize as empty
     
     if (!config_->validate_configuration(error_buffer, sizeof(error_buffer))) {
-        ESP_LOGE(TAG, "[CONFIG] Configuration validation failed: %s", error_buffer);
+        WEBINK_LOGE(TAG, "[CONFIG] Configuration validation failed: %s", error_buffer);
         return false;
     }
     
     if (!display_) {
-        ESP_LOGE(TAG, "[CONFIG] Display manager not configured");
+        WEBINK_LOGE(TAG, "[CONFIG] Display manager not configured");
         return false;
     }
     
@@ -972,16 +1897,29 @@ bool WebInkController::validate_configuration() {
 }
 
 void WebInkController::calculate_image_parameters() {
-    int width, height, bits;
-    ColorMode mode;
+    geometry_ = config_->get_geometry();
+    if (!geometry_.is_valid()) {
+        WEBINK_LOGW(TAG, "[IMAGE] Failed to parse display mode");
+        geometry_ = DisplayGeometry(800, 480, 1, ColorMode::MONO_BLACK_WHITE);  // Default fallback
+    }
     
-    if (config_->parse_display_mode(width, height, bits, mode)) {
-        total_image_rows_ = height;
-        ESP_LOGD(TAG, "[IMAGE] Calculated parameters: %dx%d, %d total rows",
-                 width, height, total_image_rows_);
-    } else {
-        ESP_LOGW(TAG, "[IMAGE] Failed to parse display mode");
-        total_image_rows_ = 480; // Default fallback
+    total_image_rows_ = geometry_.height;
+    WEBINK_LOGD(TAG, "[IMAGE] Calculated parameters: %dx%d, %d total rows (%s geometry)",
+                geometry_.width, geometry_.height, total_image_rows_,
+                WEBINK_FIXED_GEOMETRY ? "compiled" : "runtime");
+}
+
+void WebInkController::configure_pixel_pool() {
+    // Widest pixel the decoders produce: RGB for PPM, 16-bit samples for deep PGM
+    int bytes_per_pixel = 1;
+    if (geometry_.mode == ColorMode::RGB_FULL_COLOR) {
+        bytes_per_pixel = 3;
+    } else if (geometry_.mode == ColorMode::GRAYSCALE_8BIT) {
+        bytes_per_pixel = 2;
+    }
+    
+    if (!WebInkPixelPool::configure(geometry_.width, config_->rows_per_slice, bytes_per_pixel)) {
+        WEBINK_LOGW(TAG, "[SETUP] Pixel pool unavailable - ASCII PGM/PPM slices will be rejected");
     }
 }
 
@@ -995,7 +1933,7 @@ bool WebInkController::validate_image_data(const uint8_t* data, int size) {
     return (data[0] == 'P' && (data[1] == '1' || data[1] == '4'));
 }
 
-void WebInkController::update_progress(float percentage, const std::string& status) {
+void WebInkController::update_progress(float percentage, const char* status) {
     current_progress_ = percentage;
     current_status_ = status;
     
@@ -1003,7 +1941,7 @@ void WebInkController::update_progress(float percentage, const std::string& stat
         on_progress_update(percentage, status);
     }
     
-    ESP_LOGD(TAG, "[PROGRESS] %.1f%% - %s", percentage, status.c_str());
+    WEBINK_LOGD(TAG, "[PROGRESS] %.1f%% - %s", percentage, status);
 }
 
 bool WebInkController::should_enter_deep_sleep() {
@@ -1016,33 +1954,127 @@ bool WebInkController::should_enter_deep_sleep() {
 }
 
 void WebInkController::prepare_and_enter_deep_sleep() {
-    ESP_LOGI(TAG, "[SLEEP] Entering deep sleep for %d seconds", state_.sleep_duration_seconds);
+    WEBINK_LOGI(TAG, "[SLEEP] Entering deep sleep for %lu seconds", state_.get_sleep_duration_ms() / 1000);
     
     if (deep_sleep_) {
+        // SLEEP_PREPARE never transitions out - close its sample before saving
+        state_.record_state_time(current_state_, millis() - state_start_time_);
+        state_.save_to_rtc();
+        WebInkTrace::instant(TraceEvent::SLEEP);
+        WebInkTrace::dump();
+#ifndef WEBINK_MAC_INTEGRATION_TEST
         deep_sleep_->set_sleep_duration(state_.get_sleep_duration_ms());
         deep_sleep_->begin_sleep();
+#endif
     } else {
-        ESP_LOGW(TAG, "[SLEEP] Deep sleep component not configured");
+        WEBINK_LOGW(TAG, "[SLEEP] Deep sleep component not configured");
         transition_to_state(UpdateState::COMPLETE);
     }
 }
 
-void WebInkController::post_status_to_server(const std::string& message) {
-    if (!network_) return;
+void WebInkController::queue_status_log(const std::string& message, LogSeverity severity) {
+    log_buffer_.record(severity, state_.wake_counter, message.c_str());
+}
+
+bool WebInkController::flush_log_buffer() {
+    if (!network_ || log_buffer_.get_record_count() == 0) {
+        return false;
+    }
+    
+    last_log_flush_time_ = millis();
+    WebInkAllocScope alloc_scope("log_flush");
+    
+    size_t body_length = log_buffer_.build_batch(log_batch_, sizeof(log_batch_));
+    
+    // Each upload carries the latest per-state timing summary and memory
+    // minima. They go into the body only: a retried upload rebuilds them
+    // instead of piling copies into the ring.
+    uint8_t timing[WebInkTelemetry::STATE_TIMING_SIZE];
+    size_t length = WebInkTelemetry::encode_state_timing(timing, sizeof(timing), state_.state_times);
+    body_length = WebInkLogBuffer::append_record(log_batch_, sizeof(log_batch_), body_length,
+                                                 LogSeverity::TIMING, state_.wake_counter, timing, length);
+    
+    uint8_t memory[WebInkTelemetry::STATE_MEMORY_SIZE];
+    length = telemetry_.encode_state_memory(memory, sizeof(memory));
+    body_length = WebInkLogBuffer::append_record(log_batch_, sizeof(log_batch_), body_length,
+                                                 LogSeverity::MEMORY, state_.wake_counter, memory, length);
+    
+    WEBINK_LOGI(TAG, "[LOG] Uploading %d buffered log records (%u bytes)",
+                log_buffer_.get_record_count(), (unsigned) body_length);
     
-    std::string log_url = config_->build_log_url();
-    network_->http_post_async(log_url, message, 
+    if (body_length == 0 || config_->build_log_batch_url(request_buffer_, sizeof(request_buffer_)) == 0) {
+        return false;
+    }
+    return network_->http_post_async(request_buffer_, reinterpret_cast<const char*>(log_batch_), body_length,
         [this](NetworkResult result) {
-            this->on_log_response(result);
-        });
+            this->on_log_response(std::move(result));
+        }, "application/octet-stream", NETWORK_TIMEOUT_MS);
+}
+
+void WebInkController::record_wake_telemetry() {
+    // SLEEP_PREPARE is still current - count it up to now
+    unsigned long now = millis();
+    telemetry_.add_phase_time(TelemetryPhase::SLEEP, now - state_start_time_);
+    telemetry_time_ = now;
+    
+    if (network_) {
+        telemetry_.set_network_counters(network_->get_bytes_received(), network_->get_bytes_sent(),
+                                        network_->get_request_count());
+    }
+    if (get_wifi_rssi) {
+        telemetry_.set_rssi(get_wifi_rssi());
+    }
+    telemetry_.sample_heap();
+    
+    uint8_t record[WebInkTelemetry::RECORD_SIZE];
+    size_t length = telemetry_.encode(record, sizeof(record), static_cast<uint32_t>(state_.wake_counter), now);
+    log_buffer_.record_data(LogSeverity::TELEMETRY, state_.wake_counter, record, length);
+    
+    WEBINK_LOGI(TAG, "[TELEMETRY] Wake #%d: wifi %u ms, hash %u ms, download %u ms, refresh %u ms",
+                state_.wake_counter,
+                (unsigned) telemetry_.get_phase_ms(TelemetryPhase::WIFI),
+                (unsigned) telemetry_.get_phase_ms(TelemetryPhase::HASH),
+                (unsigned) telemetry_.get_phase_ms(TelemetryPhase::DOWNLOAD),
+                (unsigned) telemetry_.get_phase_ms(TelemetryPhase::REFRESH));
+    
+    // Full network statistics for host-side comparison of transport changes
+    if (WebInkNetStats::ENABLED && network_) {
+        // Static to keep the export buffer off the loop task stack and the heap
+        static char json[WebInkNetStats::JSON_MAX_LENGTH];
+        network_->get_stats().to_json(json, sizeof(json));
+        WEBINK_LOGD(TAG, "[NETSTATS] %s", json);
+    }
+    
+    WEBINK_LOGI(TAG, "[ARENA] Cycle peak %u of %u bytes (high water %u)",
+                (unsigned) WebInkArena::get_cycle_peak(), (unsigned) WebInkArena::CAPACITY,
+                (unsigned) WebInkArena::get_high_water());
+    if (WebInkArena::get_heap_fallbacks() > 0) {
+        WEBINK_LOGW(TAG, "[ARENA] %u allocations fell back to the heap - raise arena_size",
+                    (unsigned) WebInkArena::get_heap_fallbacks());
+    }
+    
+    // Host builds: check the cycle against its allocation budget
+    if (WebInkAllocTrace::ENABLED) {
+        AllocCycle cycle = AllocCycle::HASH_UNCHANGED;
+        if (telemetry_.get_error() != ErrorType::NONE) {
+            cycle = AllocCycle::ERROR;
+        } else if (telemetry_.get_flags() & TELEMETRY_FLAG_CONTENT_UPDATED) {
+            cycle = AllocCycle::IMAGE;
+        }
+        WebInkAllocTrace::end_cycle(cycle);
+    }
+    
+    // An awake device starts its next cycle with a clean record
+    telemetry_.begin_wake(telemetry_.get_wake_reason());
 }
 
 void WebInkController::on_log_response(NetworkResult result) {
-    // Log response handling - typically just debug logging
     if (result.success) {
-        ESP_LOGD(TAG, "[LOG] Status posted to server successfully");
+        WEBINK_LOGD(TAG, "[LOG] Log batch posted to server successfully");
+        log_buffer_.clear();
     } else {
-        ESP_LOGW(TAG, "[LOG] Failed to post status to server: %s", result.error_message.c_str());
+        // Records stay in the ring for the next upload
+        WEBINK_LOGW(TAG, "[LOG] Failed to post log batch to server: %s", result.error_message.c_str());
     }
 }
 
@@ -1050,15 +2082,25 @@ void WebInkController::log_state_transition(UpdateState from_state, UpdateState
     // Simplified to avoid stack overflow - split into separate log calls
     const char* from_str = update_state_to_string(from_state);
     const char* to_str = update_state_to_string(to_state);
-    ESP_LOGI(TAG, "[STATE] %s -> %s", from_str, to_str);
+    WEBINK_LOGI(TAG, "[STATE] %s -> %s", from_str, to_str);
 }
 
 void WebInkController::reset_operation_state() {
+    executor_.cancel_all();
+    release_image_connection();
     current_hash_ = "";
     rows_completed_ = 0;
     total_image_rows_ = 0;
+    image_url_prefix_length_ = 0;            // Server may change before the next cycle
     current_progress_ = 0.0f;
     current_status_ = "";
+    release_slice_data();
+    slice_start_row_ = 0;
+    slice_rows_pending_ = 0;
+    short_slices_ = 0;
+    
+    // Nothing from this cycle is left in the arena - start the next one empty
+    WebInkArena::reset();
 }
 
 //=============================================================================
@@ -8,7 +8,7 @@
  * WebInk components into a cohesive system.
  * 
  * Key features:
- * - Non-blocking state machine with regular yield points
+ * - Time-budgeted state machine that works in small quanta per loop()
  * - Complete update cycle orchestration
  * - Deep sleep integration with safety checks
  * - Error recovery and retry logic
@@ -22,11 +22,18 @@
 #pragma once
 
 #include "webink_types.h"
+#include "webink_arena.h"
+#include "webink_delegate.h"
 #include "webink_state.h"
 #include "webink_config.h"
 #include "webink_network.h"
 #include "webink_image.h"
 #include "webink_display.h"
+#include "webink_coroutine.h"
+#include "webink_json.h"
+#include "webink_log_buffer.h"
+#include "webink_telemetry.h"
+#include "webink_trace.h"
 
 // Forward declare ESPHome deep sleep component
 namespace esphome {
@@ -34,11 +41,12 @@ namespace deep_sleep {
 class DeepSleepComponent;
 }
 }
+#ifndef WEBINK_MAC_INTEGRATION_TEST
 #include "esphome/core/component.h"
 #include "esphome/core/log.h"
 #include "esphome/components/deep_sleep/deep_sleep_component.h"
+#endif
 #include <memory>
-#include <functional>
 
 namespace esphome {
 namespace webink {
@@ -51,9 +59,10 @@ namespace webink {
  * implementing a sophisticated state machine that manages the complete
  * image update cycle from hash checking through display refresh to deep sleep.
  * 
- * The controller operates as a non-blocking state machine that regularly yields
- * control back to the ESPHome main loop, ensuring the device remains responsive
- * to other operations while processing images.
+ * The controller operates as a cooperative state machine. Each loop() call runs
+ * state handlers in quanta (a few rows of pixels, one socket read) until a
+ * microsecond budget is spent, then returns to the ESPHome main loop so the
+ * watchdog, WiFi stack and other components never starve.
  * 
  * State Machine Flow:
  * IDLE → WIFI_WAIT → HASH_REQUEST → HASH_PARSE → [IMAGE_REQUEST → 
@@ -64,7 +73,7 @@ namespace webink {
  * which provides user feedback and then transitions to SLEEP_PREPARE.
  * 
  * Features:
- * - Non-blocking execution with configurable yield intervals
+ * - Time-budgeted execution with per-loop latency statistics
  * - Comprehensive error handling and recovery
  * - Memory-efficient image processing coordination
  * - Deep sleep integration with safety checks
@@ -127,14 +136,28 @@ public:
     /**
      * @brief Main processing loop
      * 
-     * Called from WebInkESPHomeComponent::loop(). Executes the state machine
-     * with regular yield points to maintain system responsiveness.
+     * Called from WebInkESPHomeComponent::loop(). Runs state handlers one
+     * quantum at a time until the loop budget is spent or the current state
+     * has nothing more to do right now, then returns to ESPHome.
      * 
-     * This method is non-blocking and will yield control back to ESPHome
-     * regularly to allow other components to operate.
+     * Operations that cannot be split (a blocking HTTP request, an e-paper
+     * refresh) are only started at the beginning of a loop() call, so they
+     * never run on top of other work in the same pass.
      */
     void loop();
 
+    /**
+     * @brief Set the work budget for a single loop() call
+     * @param budget_us Budget in microseconds (default LOOP_BUDGET_US)
+     */
+    void set_loop_budget_us(uint32_t budget_us) { loop_budget_us_ = budget_us; }
+
+    /**
+     * @brief Sleep until the server's next planned content change
+     * @param follow True to follow the schedule, false to use the sleep interval
+     */
+    void set_follow_server_schedule(bool follow) { state_.follow_server_schedule = follow; }
+
     /**
      * @brief Get component name for ESPHome logging
      * @return Component name string
@@ -242,6 +265,13 @@ public:
      */
     const WebInkState& get_state() const;
 
+    /**
+     * @brief Persist state to RTC memory (call before entering deep sleep)
+     * 
+     * Also done automatically when a cycle completes.
+     */
+    void save_state();
+
     /**
      * @brief Get current configuration
      * @return Reference to configuration object
@@ -268,6 +298,58 @@ public:
      */
     unsigned long get_time_in_current_state() const;
 
+    /**
+     * @brief Consume the "cycle complete" event
+     * @return True exactly once for each update cycle that reached COMPLETE
+     * 
+     * The event is raised the moment the state machine enters COMPLETE, so the
+     * ESPHome wrapper can evaluate its sleep guards in the same loop() pass
+     * instead of polling for an idle state.
+     */
+    bool consume_cycle_complete();
+
+    /**
+     * @brief Get time at which the last update cycle reached COMPLETE
+     * @return millis() timestamp, 0 if no cycle has completed since boot
+     */
+    unsigned long get_cycle_complete_time() const { return cycle_complete_time_; }
+
+    /**
+     * @brief Set why the device is awake (reported in wake telemetry)
+     * @param reason Wake reason from the reset reason and wakeup cause
+     */
+    void set_wake_reason(WakeReason reason) { telemetry_.begin_wake(reason); }
+
+    /**
+     * @brief Get telemetry collected for the current wake
+     * @return Telemetry accumulator
+     */
+    const WebInkTelemetry& get_telemetry() const { return telemetry_; }
+
+    /**
+     * @brief Get duration of the last loop() call
+     * @return Latency in microseconds
+     */
+    uint32_t get_loop_latency_us() const { return loop_latency_last_us_; }
+
+    /**
+     * @brief Get longest loop() call of the current update cycle
+     * @return Latency in microseconds
+     */
+    uint32_t get_loop_latency_max_us() const { return loop_latency_max_us_; }
+
+    /**
+     * @brief Get moving average of loop() duration (1/8 weight per sample)
+     * @return Latency in microseconds
+     */
+    uint32_t get_loop_latency_avg_us() const { return loop_latency_avg_us_; }
+
+    /**
+     * @brief Get number of loop() calls in this cycle that exceeded the budget
+     * @return Over-budget loop count
+     */
+    uint32_t get_loop_over_budget_count() const { return loop_over_budget_count_; }
+
     /**
      * @brief Get wake counter (increments each deep sleep wake)
      * @return Wake counter value
@@ -356,23 +438,29 @@ public:
     // CALLBACK CONFIGURATION
     //=========================================================================
 
+    // Inline delegates (webink_delegate.h): no heap, fixed size, and a
+    // compile error for captures larger than two pointers
+
     /// Callback for log messages (called for important events)
-    std::function<void(const std::string&)> on_log_message;
+    LogCallback on_log_message;
 
     /// Callback for state changes (called on each state transition)
-    std::function<void(UpdateState, UpdateState)> on_state_change;
+    WebInkDelegate<void(UpdateState, UpdateState)> on_state_change;
 
     /// Callback for progress updates (called during long operations)
-    std::function<void(float, const std::string&)> on_progress_update;
+    WebInkDelegate<void(float, const char*)> on_progress_update;
 
     /// Callback for error events (called when errors occur)
-    std::function<void(ErrorType, const std::string&)> on_error_occurred;
+    WebInkDelegate<void(ErrorType, const std::string&)> on_error_occurred;
 
     /// Function to get WiFi connection status
-    std::function<bool()> get_wifi_status;
+    WebInkDelegate<bool()> get_wifi_status;
 
     /// Function to get BOOT button status
-    std::function<bool()> get_boot_button_status;
+    WebInkDelegate<bool()> get_boot_button_status;
+
+    /// Function to get WiFi signal strength in dBm (for wake telemetry)
+    WebInkDelegate<int()> get_wifi_rssi;
 
     //=========================================================================
     // ESPHOME INTEGRATION HELPERS
@@ -409,10 +497,14 @@ public:
     void set_socket_port(int port);
 
     /**
-     * @brief Post status message to server
+     * @brief Queue a status message for the next batched log upload
      * @param message Status message to log
+     * @param severity Record severity (ERROR makes an upload due)
+     *
+     * Messages go to the RTC log ring and are posted together when the radio
+     * is up anyway - see WebInkLogBuffer.
      */
-    void post_status_to_server(const std::string& message);
+    void queue_status_log(const std::string& message, LogSeverity severity = LogSeverity::INFO);
 
 private:
     //=========================================================================
@@ -424,6 +516,7 @@ private:
     std::shared_ptr<WebInkNetworkClient> network_;              ///< Network client
     std::shared_ptr<WebInkImageProcessor> image_processor_;     ///< Image processor
     deep_sleep::DeepSleepComponent* deep_sleep_;                ///< ESPHome deep sleep component
+    bool display_prepared_;                                     ///< A cycle has needed the panel since boot
 
     //=========================================================================
     // STATE MACHINE STATE
@@ -432,25 +525,248 @@ private:
     WebInkState state_;                                         ///< Persistent state manager
     UpdateState current_state_;                                 ///< Current state machine state
     unsigned long state_start_time_;                            ///< Time when current state started
-    unsigned long last_yield_time_;                             ///< Last time control was yielded
     bool manual_update_requested_;                              ///< Manual update flag
+    bool cycle_complete_pending_;                               ///< COMPLETE reached, not yet consumed
+    unsigned long cycle_complete_time_;                         ///< millis() when COMPLETE was reached
 
     //=========================================================================
     // CURRENT OPERATION CONTEXT
     //=========================================================================
 
     std::string current_hash_;                                  ///< Hash from current request
+    WebInkJsonParser json_parser_;                              ///< Tokenizer for hash/sleep responses
     ImageRequest current_image_request_;                        ///< Current image request parameters
+    char image_url_[URL_BUFFER_SIZE];                           ///< Slice URL; only the numbers change per slice
+    size_t image_url_prefix_length_;                            ///< Constant head of image_url_ (0 = not built)
+    char request_buffer_[URL_BUFFER_SIZE];                      ///< Hash/sleep/log URLs and socket request line
     int total_image_rows_;                                      ///< Total rows in current image
+    DisplayGeometry geometry_;                                  ///< Display geometry of the current cycle
     int rows_completed_;                                        ///< Rows completed in current operation
     float current_progress_;                                    ///< Current operation progress (0-100)
     std::string current_status_;                                ///< Current operation status message
 
+    // HTTP slice received but not yet drawn (drawn ROWS_PER_QUANTUM rows at a time)
+    ArenaString slice_data_;                                    ///< Raw slice response (PBM), in the wake arena
+    size_t slice_offset_;                                       ///< Offset of next undrawn row in slice_data_
+    size_t slice_arena_mark_;                                   ///< Arena level before the slice was requested
+    int slice_start_row_;                                       ///< First image row of the slice
+    int slice_rows_pending_;                                    ///< Rows left to draw from the slice
+    int short_slices_;                                          ///< Slices shorter than requested this cycle
+
+    //=========================================================================
+    // LOOP SCHEDULER
+    //=========================================================================
+
+    uint32_t loop_budget_us_;                                   ///< Work budget per loop() call
+    uint32_t loop_start_us_;                                    ///< micros() at start of current loop()
+    int quanta_this_loop_;                                      ///< Quanta executed in current loop()
+    bool quantum_progress_;                                     ///< Handler did work in current quantum
+    uint32_t loop_latency_last_us_;                             ///< Duration of last loop() call
+    uint32_t loop_latency_max_us_;                              ///< Longest loop() call this cycle
+    uint32_t loop_latency_avg_us_;                              ///< Moving average loop() duration
+    uint32_t loop_count_;                                       ///< loop() calls this cycle
+    uint32_t loop_over_budget_count_;                           ///< loop() calls over budget this cycle
+
+    //=========================================================================
+    // COROUTINE TASKS
+    //=========================================================================
+
+    /**
+     * @class ImageDownloadTask
+     * @brief Image transfer (HTTP slices or TCP stream) written as a coroutine
+     * 
+     * All transfer progress lives in this frame, which is embedded in the
+     * controller, so suspending between slices or socket chunks never
+     * allocates. Spawned by handle_image_request_state().
+     */
+    class ImageDownloadTask : public WebInkTask {
+    public:
+        explicit ImageDownloadTask(WebInkController* owner)
+            : WebInkTask("image_download"), owner_(owner), buffer_pos_(0),
+              status_pending_(false), status_len_(0) {}
+
+        static const int ROW_BYTES = MAX_PBM_ROW_BYTES;         ///< Exact row with a fixed geometry
+        static const int STATUS_LINE_MAX = 48;                  ///< Longest webInkV2 status line
+
+        WebInkController* owner_;                               ///< Controller that owns this task
+        uint8_t row_buffer_[ROW_BYTES];                         ///< Partial row carried across socket chunks
+        int buffer_pos_;                                        ///< Bytes filled in row_buffer_
+        bool status_pending_;                                   ///< Waiting for the webInkV2 status line
+        char status_line_[STATUS_LINE_MAX];                     ///< Status line collected across chunks
+        int status_len_;                                        ///< Bytes filled in status_line_
+
+    protected:
+        TaskStatus step() override;
+    };
+
+    /**
+     * @class ServerRaceTask
+     * @brief Connect race across the configured servers, written as a coroutine
+     * 
+     * Resolves each server (one blocking lookup per fresh loop budget), then
+     * starts non-blocking connects RACE_STAGGER_MS apart, preferred server
+     * first, and polls them once per resume. Spawned by hash_task_ when
+     * WebInkState::needs_server_race() says so; the hash request waits for it.
+     */
+    class ServerRaceTask : public WebInkTask {
+    public:
+        explicit ServerRaceTask(WebInkController* owner)
+            : WebInkTask("server_race"), owner_(owner), count_(0), next_(0), winner_(-1),
+              failed_mask_(0), race_start_(0), next_start_(0) {}
+
+        /**
+         * @brief Close the connects still open (the winner is handed over first)
+         */
+        void close_all();
+
+        WebInkController* owner_;                               ///< Controller that owns this task
+        int order_[MAX_SERVERS];                                ///< Server index per slot, preferred first
+        uint32_t ips_[MAX_SERVERS];                             ///< Resolved address per slot (0 = not resolved)
+        int ports_[MAX_SERVERS];                                ///< Connect port per slot
+        WebInkSocket sockets_[MAX_SERVERS];                     ///< Connect attempt per slot
+        unsigned long started_at_[MAX_SERVERS];                 ///< millis() each connect started
+        uint32_t connect_ms_[MAX_SERVERS];                      ///< Connect time per slot (0 = did not connect)
+        int count_;                                             ///< Servers racing
+        int next_;                                              ///< Next slot to resolve or start
+        int winner_;                                            ///< Slot that connected first (-1 = none yet)
+        uint32_t failed_mask_;                                  ///< Bit k = slot k refused or errored
+        unsigned long race_start_;                              ///< millis() the first connect started
+        unsigned long next_start_;                              ///< millis() the next connect may start
+
+    protected:
+        TaskStatus step() override;
+
+    private:
+        /**
+         * @brief Start due connects and check the ones in flight, without blocking
+         * @return True while the race goes on
+         */
+        bool poll();
+    };
+
+    /**
+     * @class HashRequestTask
+     * @brief HASH_REQUEST phase: server choice, server address, hash request
+     * 
+     * Waits for race_task_ if the cycle races, then sends the hash request
+     * on a fresh loop budget. A retryable failure (stale cached address,
+     * failover) leaves the state unchanged and the task sends it again;
+     * on_hash_response() otherwise moves the cycle on.
+     */
+    class HashRequestTask : public WebInkTask {
+    public:
+        explicit HashRequestTask(WebInkController* owner) : WebInkTask("hash_request"), owner_(owner) {}
+
+        WebInkController* owner_;                               ///< Controller that owns this task
+
+    protected:
+        TaskStatus step() override;
+    };
+
+    /**
+     * @class DisplayRefreshTask
+     * @brief DISPLAY_UPDATE phase: the panel refresh
+     * 
+     * update_display() blocks for the whole e-paper refresh, so the task
+     * waits for a fresh loop budget before calling it.
+     */
+    class DisplayRefreshTask : public WebInkTask {
+    public:
+        explicit DisplayRefreshTask(WebInkController* owner) : WebInkTask("display_refresh"), owner_(owner) {}
+
+        WebInkController* owner_;                               ///< Controller that owns this task
+
+    protected:
+        TaskStatus step() override;
+    };
+
+    /**
+     * @class SleepTask
+     * @brief SLEEP_PREPARE phase: sleep interval, telemetry, log upload, deep sleep
+     * 
+     * Requests /get_sleep unless the hash or conditional response already
+     * brought a fresh interval, then finishes the cycle on a new loop budget.
+     */
+    class SleepTask : public WebInkTask {
+    public:
+        explicit SleepTask(WebInkController* owner)
+            : WebInkTask("sleep_prepare"), owner_(owner), request_interval_(false) {}
+
+        WebInkController* owner_;                               ///< Controller that owns this task
+        bool request_interval_;                                 ///< /get_sleep request sent this cycle
+
+    protected:
+        TaskStatus step() override;
+    };
+
+    WebInkExecutor executor_;                                   ///< Runs coroutine tasks from loop()
+    ImageDownloadTask download_task_;                           ///< Image transfer coroutine
+    ServerRaceTask race_task_;                                  ///< Server connect race coroutine
+    HashRequestTask hash_task_;                                 ///< HASH_REQUEST phase coroutine
+    DisplayRefreshTask refresh_task_;                           ///< DISPLAY_UPDATE phase coroutine
+    SleepTask sleep_task_;                                      ///< SLEEP_PREPARE phase coroutine
+
+    //=========================================================================
+    // SPECULATIVE CONNECTION WARM-UP
+    //=========================================================================
+
+    bool warmup_active_;                                        ///< Image connection opened before hash was known
+    uint32_t warmup_hits_;                                      ///< Warm-ups used by an image download
+    uint32_t warmup_misses_;                                    ///< Warm-ups closed unused (hash unchanged)
+
+    //=========================================================================
+    // ADAPTIVE HASH POLICY
+    //=========================================================================
+
+    HashPolicy hash_policy_;                                    ///< How this cycle detects changes
+    bool content_unchanged_;                                    ///< Conditional fetch found nothing new
+
+    uint32_t band_hash_accum_[WebInkState::BAND_COUNT];         ///< Band hashes of the image being drawn
+
+    //=========================================================================
+    // SERVER ADDRESS CACHE
+    //=========================================================================
+
+    bool server_address_ready_;                                 ///< Server address chosen for this cycle
+    bool using_cached_address_;                                 ///< Requests go to an address from RTC state
+
+    //=========================================================================
+    // SERVER FAILOVER
+    //=========================================================================
+
+    uint32_t servers_tried_mask_;                               ///< Bit i = server i used this cycle (0 = none chosen yet)
+    uint32_t server_failovers_;                                 ///< Mid-cycle server switches since boot
+    bool server_race_checked_;                                  ///< Race started or found unneeded this cycle
+    int race_winner_;                                           ///< Server that won this cycle's race (-1 = none)
+    uint32_t race_winner_ip_;                                   ///< Address the winner connected to
+
+    static const unsigned long RACE_STAGGER_MS = 250;          ///< Delay between racing connect attempts
+    static const unsigned long RACE_TIMEOUT_MS = 3000;         ///< Give up on the race after 3 seconds
+
+    //=========================================================================
+    // BATCHED LOG UPLOAD
+    //=========================================================================
+
+    WebInkLogBuffer log_buffer_;                                ///< RTC log ring (survives deep sleep)
+    uint8_t log_batch_[WebInkLogBuffer::BATCH_CAPACITY];        ///< Batch body of the upload in flight
+    unsigned long last_log_flush_time_;                         ///< millis() of the last upload attempt
+
+    static const unsigned long LOG_FLUSH_RETRY_MS = 60000;     ///< Minimum gap between uploads while awake
+
+    //=========================================================================
+    // WAKE TELEMETRY
+    //=========================================================================
+
+    WebInkTelemetry telemetry_;                                 ///< Per-wake telemetry accumulator
+    unsigned long telemetry_time_;                              ///< millis() of the last encoded record
+
     //=========================================================================
     // TIMING AND CONTROL
     //=========================================================================
 
-    static const unsigned long YIELD_INTERVAL_MS = 50;         ///< Yield every 50ms
+    static const uint32_t LOOP_BUDGET_US = 8000;               ///< Default work budget per loop() (8 ms)
+    static constexpr int ROWS_PER_QUANTUM = 8;                 ///< Rows drawn per scheduler quantum
+    static const int MAX_SHORT_SLICES = 3;                     ///< Short slices re-requested before failing
     static const unsigned long STATE_TIMEOUT_MS = 30000;       ///< 30 second state timeout
     static const unsigned long NETWORK_TIMEOUT_MS = 10000;     ///< 10 second network timeout
 
@@ -467,10 +783,49 @@ private:
     void transition_to_state(UpdateState new_state);
 
     /**
-     * @brief Check if control should be yielded to ESPHome main loop
-     * @return True if control should be yielded
+     * @brief Spawn the task of a phase written as a coroutine
+     * @param state State just entered (HASH_REQUEST, DISPLAY_UPDATE, SLEEP_PREPARE)
+     * 
+     * The state's handler only waits for the task; the task leaves the state.
+     */
+    void start_state_task(UpdateState state);
+
+    /**
+     * @brief Dispatch one quantum of work to the current state's handler
+     */
+    void run_state_handler();
+
+    /**
+     * @brief Check whether the current loop() call still has budget left
+     * @return True if another quantum may run
+     */
+    bool has_loop_budget() const;
+
+    /**
+     * @brief Claim the loop() pass for an operation that cannot be split
+     * @return True if the operation may start now, false to retry next loop()
+     * 
+     * Only the first quantum of a loop() call may start a blocking operation.
+     */
+    bool begin_blocking_operation();
+
+    /**
+     * @brief Record the duration of a loop() call in the latency statistics
+     * @param elapsed_us Duration in microseconds
+     */
+    void record_loop_latency(uint32_t elapsed_us);
+
+    /**
+     * @brief Log and reset per-cycle loop latency statistics
      */
-    bool should_yield_control();
+    void report_loop_latency();
+
+    /**
+     * @brief Log low-memory warnings for a state and queue one for the server
+     * @param state State whose sample crossed a threshold
+     * @param warnings MEMORY_WARN_* bits from sample_state_memory()
+     */
+    void report_memory_warnings(UpdateState state, uint8_t warnings);
 
     /**
      * @brief Check if current state has timed out
@@ -513,7 +868,20 @@ private:
     void on_image_response(NetworkResult result);
 
     /**
-     * @brief Handle log post response
+     * @brief Upload the log ring in one blocking POST
+     * @return True if the request was issued
+     *
+     * Only call from a state that may block (begin_blocking_operation()).
+     */
+    bool flush_log_buffer();
+
+    /**
+     * @brief Encode this wake's telemetry into the log ring
+     */
+    void record_wake_telemetry();
+
+    /**
+     * @brief Handle log batch post response
      * @param result Network operation result
      */
     void on_log_response(NetworkResult result);
@@ -525,9 +893,18 @@ private:
     void on_sleep_response(NetworkResult result);
 
     /**
-     * @brief Handle socket data stream
+     * @brief Store the sleep schedule sent with a hash, conditional or sleep response
+     * @param sleep_seconds Sleep interval (-1 = not sent)
+     * @param next_change_seconds Seconds until the next content change (-1 = not sent)
+     */
+    void apply_server_schedule(int sleep_seconds, int next_change_seconds);
+
+    /**
+     * @brief Handle socket data stream, drawing each completed row
      * @param data Received data buffer
      * @param length Length of received data
+     * 
+     * Partial rows are carried across chunks in download_task_'s frame.
      */
     void on_socket_data(const uint8_t* data, int length);
 
@@ -549,15 +926,29 @@ private:
      */
     void display_error_and_sleep(ErrorType error_type, const std::string& details);
 
+    /**
+     * @brief First use of the display this boot
+     * 
+     * Nothing reaches the display manager before a response decides the
+     * cycle draws (changed hash, new conditional content, error screen), so
+     * unchanged wakes never touch the panel.
+     */
+    void prepare_display();
+
     //=========================================================================
     // IMAGE PROCESSING HELPERS
     //=========================================================================
 
     /**
-     * @brief Calculate image processing parameters
+     * @brief Take the cycle's display geometry (constant with fixed_geometry)
      */
     void calculate_image_parameters();
 
+    /**
+     * @brief Size WebInkPixelPool for geometry_ and rows_per_slice
+     */
+    void configure_pixel_pool();
+
     /**
      * @brief Validate received image data
      * @param data Image data buffer
@@ -574,6 +965,141 @@ private:
      */
     bool process_image_in_chunks(const uint8_t* data, int size);
 
+    /**
+     * @brief Draw up to ROWS_PER_QUANTUM rows of the pending HTTP slice
+     */
+    void draw_slice_quantum();
+
+    /**
+     * @brief Drop the pending slice and return its buffer to the arena
+     */
+    void release_slice_data();
+
+    /**
+     * @brief Request the next HTTP slice (blocking); response is queued for drawing
+     * @return True if the slice was received and the download can continue
+     */
+    bool request_next_slice();
+
+    //=========================================================================
+    // SPECULATIVE CONNECTION WARM-UP
+    //=========================================================================
+
+    /**
+     * @brief Open the image connection ahead of the hash request
+     * 
+     * Socket mode starts the non-blocking connect so the handshake completes
+     * while the (blocking) hash request runs; HTTP mode keeps the hash
+     * request's connection alive for the first slice. Skipped when the
+     * per-device change rate says the content rarely changes.
+     */
+    void start_connection_warmup();
+
+    /**
+     * @brief Resolve a pending warm-up once the hash check is known
+     * @param hash_changed True to hand the connection to the image download,
+     *                     false to close it
+     */
+    void finish_connection_warmup(bool hash_changed);
+
+    /**
+     * @brief Close any warm or kept-alive image connection
+     */
+    void release_image_connection();
+
+    //=========================================================================
+    // SERVER ADDRESS CACHE
+    //=========================================================================
+
+    /**
+     * @brief Point requests at the server's IP address for this cycle
+     * 
+     * Uses the address cached in RTC state while it is fresh; otherwise
+     * resolves the hostname (blocking) and caches the result. Falls back to
+     * the hostname if resolution fails. Called once per cycle, before the
+     * first request.
+     */
+    void prepare_server_address();
+
+    //=========================================================================
+    // SERVER FAILOVER
+    //=========================================================================
+
+    /**
+     * @brief Start the server race if this cycle needs one
+     * @return True if race_task_ was spawned (wait for it before selecting)
+     * 
+     * Races on the first wake, or when the preferred server failed last
+     * time. Checked once per cycle.
+     */
+    bool start_server_race();
+
+    /**
+     * @brief Pick the server for this cycle
+     * 
+     * Uses the race winner if there was a race, otherwise the best-scoring
+     * server from RTC state. Called once per cycle, after the race and
+     * before prepare_server_address().
+     */
+    void select_cycle_server();
+
+    /**
+     * @brief Switch to the next untried server after a failure
+     * @param reason Short description for the log
+     * @return True if another server was selected, false if all were tried
+     * 
+     * Only the server changes; transfer progress (rows_completed_) is kept,
+     * so the next request continues where the failed one stopped.
+     */
+    bool fail_over_server(const char* reason);
+
+    /**
+     * @brief Reconnect the socket download to the next untried server
+     * @param reason Short description for the log
+     * @return True if a connection to another server was started
+     */
+    bool fail_over_socket_download(const char* reason);
+
+    //=========================================================================
+    // ADAPTIVE HASH POLICY
+    //=========================================================================
+
+    /**
+     * @brief Adopt the hash reported with a conditional image fetch
+     * @param hash Hash from X-WebInk-Hash or the webInkV2 status line
+     * 
+     * An empty hash means the server ignored the condition; the download
+     * continues but the device falls back to hash checks.
+     */
+    void accept_conditional_hash(const char* hash);
+
+    /**
+     * @brief Record that a conditional fetch found the content unchanged
+     */
+    void on_conditional_unchanged();
+
+    /**
+     * @brief Consume the webInkV2 status line at the start of a socket stream
+     * @param data Received bytes
+     * @param length Number of bytes
+     * @return Bytes consumed, or -1 if the stream was rejected
+     */
+    int consume_socket_status_line(const uint8_t* data, int length);
+
+    /**
+     * @brief Fold drawn rows into the per-band content hashes
+     * @param first_row First image row in data
+     * @param data Packed pixel rows
+     * @param rows Number of rows
+     * @param bytes_per_row Bytes per row
+     */
+    void fold_band_hash(int first_row, const uint8_t* data, int rows, int bytes_per_row);
+
+    /**
+     * @brief Store the finished image's band hashes and log how many bands changed
+     */
+    void commit_band_hashes();
+
     //=========================================================================
     // DEEP SLEEP MANAGEMENT
     //=========================================================================
@@ -603,7 +1129,7 @@ private:
      * @param percentage Progress percentage
      * @param status Status message
      */
-    void update_progress(float percentage, const std::string& status);
+    void update_progress(float percentage, const char* status);
 
     /**
      * @brief Log state transition with timing information
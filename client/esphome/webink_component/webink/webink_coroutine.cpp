@@ -0,0 +1,127 @@
+/**
+ * @file webink_coroutine.cpp
+ * @brief Implementation of WebInkTask and WebInkExecutor
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_coroutine.h"
+#include "webink_log.h"
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkExecutor::TAG = "webink.task";
+
+//=============================================================================
+// WEBINKTASK
+//=============================================================================
+
+TaskStatus WebInkTask::resume() {
+    if (!is_running()) {
+        return status_;
+    }
+
+    TaskStatus result = step();
+
+    // A cancel() issued from inside step() (e.g. via an error handler) wins
+    if (is_running()) {
+        status_ = result;
+    }
+    return status_;
+}
+
+void WebInkTask::restart() {
+    resume_point_ = 0;
+    status_ = TaskStatus::PENDING;
+}
+
+void WebInkTask::cancel() {
+    resume_point_ = -1;
+    status_ = TaskStatus::FAILED;
+}
+
+//=============================================================================
+// WEBINKEXECUTOR
+//=============================================================================
+
+WebInkExecutor::WebInkExecutor() : task_count_(0) {
+    for (int i = 0; i < MAX_TASKS; i++) {
+        tasks_[i] = nullptr;
+    }
+}
+
+bool WebInkExecutor::spawn(WebInkTask* task) {
+    if (!task) {
+        return false;
+    }
+    if (task_count_ >= MAX_TASKS && !task->is_running()) {
+        WEBINK_LOGE(TAG, "[TASK] Cannot spawn %s - executor full", task->get_name());
+        return false;
+    }
+
+    task->restart();
+
+    // Respawning a scheduled task just rewinds it
+    for (int i = 0; i < task_count_; i++) {
+        if (tasks_[i] == task) {
+            return true;
+        }
+    }
+
+    tasks_[task_count_++] = task;
+    WEBINK_LOGD(TAG, "[TASK] Spawned %s (%d running)", task->get_name(), task_count_);
+    return true;
+}
+
+bool WebInkExecutor::run_once() {
+    bool progressed = false;
+
+    int i = 0;
+    while (i < task_count_) {
+        WebInkTask* task = tasks_[i];
+        int point_before = task->get_resume_point();
+        TaskStatus status = task->resume();
+
+        if (status != TaskStatus::PENDING || task->get_resume_point() != point_before) {
+            progressed = true;
+        }
+
+        // The task cancelled or rescheduled tasks from inside step() - the
+        // list changed under us, so continue on the next run_once()
+        if (i >= task_count_ || tasks_[i] != task) {
+            break;
+        }
+
+        if (task->is_running()) {
+            i++;
+            continue;
+        }
+
+        WEBINK_LOGD(TAG, "[TASK] %s finished: %s", task->get_name(),
+                    status == TaskStatus::DONE ? "done" : "failed");
+
+        // Drop the finished task, keeping spawn order for the rest
+        for (int j = i; j < task_count_ - 1; j++) {
+            tasks_[j] = tasks_[j + 1];
+        }
+        tasks_[--task_count_] = nullptr;
+    }
+
+    return progressed;
+}
+
+void WebInkExecutor::cancel_all() {
+    for (int i = 0; i < task_count_; i++) {
+        if (tasks_[i]->is_running()) {
+            WEBINK_LOGD(TAG, "[TASK] Cancelling %s", tasks_[i]->get_name());
+            tasks_[i]->cancel();
+        }
+        tasks_[i] = nullptr;
+    }
+    task_count_ = 0;
+}
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,211 @@
+/**
+ * @file webink_coroutine.h
+ * @brief Stackless coroutines and a fixed-size executor for WebInk tasks
+ *
+ * Multi-step operations (connect, send, stream, close) are written as
+ * sequential code inside a WebInkTask::step() body using the WEBINK_CO_*
+ * macros. A suspended task keeps only its resume point and its own member
+ * fields, so a suspension costs no stack and no heap: the "coroutine frame"
+ * is the task object itself, which callers embed by value.
+ *
+ * The component is built as C++17, so std::coroutine is not available; the
+ * macros implement the same stackless model with a switch on the resume
+ * point (the classic Duff's device / protothread technique).
+ *
+ * Rules for step() bodies:
+ * - Locals do not survive a suspension - keep state in task members
+ * - Do not place WEBINK_CO_* macros inside another switch statement
+ * - At most one suspension point per source line
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+// Mac integration test mode - use local declarations
+void ESP_LOGI(const char* tag, const char* format, ...);
+void ESP_LOGW(const char* tag, const char* format, ...);
+void ESP_LOGE(const char* tag, const char* format, ...);
+void ESP_LOGD(const char* tag, const char* format, ...);
+#else
+// Normal ESPHome mode
+#include "esphome/core/log.h"
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum TaskStatus
+ * @brief Result of resuming a task once
+ */
+enum class TaskStatus : uint8_t {
+    PENDING = 0,    ///< Suspended on an await whose condition is not met yet
+    YIELDED = 1,    ///< Did a quantum of work and can continue immediately
+    DONE = 2,       ///< Finished successfully
+    FAILED = 3      ///< Finished with an error (or was cancelled)
+};
+
+//=============================================================================
+// COROUTINE MACROS (use only inside WebInkTask::step())
+//=============================================================================
+
+/// Start of a coroutine body - must be the first statement in step()
+#define WEBINK_CO_BEGIN() switch (resume_point_) { case 0:
+
+/// Suspend after a quantum of work; resumes on the next line
+#define WEBINK_CO_YIELD() \
+    do { resume_point_ = __LINE__; return TaskStatus::YIELDED; case __LINE__:; } while (0)
+
+/// Suspend until cond is true (cond is re-evaluated on each resume; falls into its own case label)
+#define WEBINK_CO_AWAIT(cond) \
+    do { resume_point_ = __LINE__; [[fallthrough]]; case __LINE__: if (!(cond)) return TaskStatus::PENDING; } while (0)
+
+/// Finish the coroutine early with the given TaskStatus
+#define WEBINK_CO_RETURN(status) do { resume_point_ = -1; return (status); } while (0)
+
+/// End of a coroutine body - must be the last statement in step()
+#define WEBINK_CO_END() } resume_point_ = -1; return TaskStatus::DONE
+
+/**
+ * @class WebInkTask
+ * @brief Base class for a stackless coroutine run by WebInkExecutor
+ *
+ * @example Socket transfer as a task
+ * @code
+ * TaskStatus DownloadTask::step() {
+ *     WEBINK_CO_BEGIN();
+ *     WEBINK_CO_AWAIT(network_->socket_is_connected());
+ *     if (!network_->socket_send(request_, request_length_)) WEBINK_CO_RETURN(TaskStatus::FAILED);
+ *     network_->socket_receive_stream(on_data_, max_bytes_, timeout_ms_);
+ *     WEBINK_CO_AWAIT(!network_->is_operation_pending());
+ *     WEBINK_CO_END();
+ * }
+ * @endcode
+ */
+class WebInkTask {
+public:
+    /**
+     * @brief Constructor
+     * @param name Static task name used in log messages
+     */
+    explicit WebInkTask(const char* name) : name_(name) {}
+
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~WebInkTask() = default;
+
+    /**
+     * @brief Run the task until its next suspension point
+     * @return Status after this resume (finished tasks return their final status)
+     */
+    TaskStatus resume();
+
+    /**
+     * @brief Rewind the task to the start of its body
+     */
+    void restart();
+
+    /**
+     * @brief Stop the task; it reports FAILED until restarted
+     * 
+     * Safe to call from inside the task's own step(), e.g. from an error
+     * handler the task invoked; the cancellation overrides step()'s result.
+     */
+    void cancel();
+
+    /**
+     * @brief Check whether the task has been started and not yet finished
+     * @return True while PENDING or YIELDED
+     */
+    bool is_running() const { return status_ == TaskStatus::PENDING || status_ == TaskStatus::YIELDED; }
+
+    /**
+     * @brief Get status from the last resume
+     * @return Task status
+     */
+    TaskStatus get_status() const { return status_; }
+
+    /**
+     * @brief Get current resume point (0 = start, -1 = finished)
+     * @return Resume point
+     */
+    int get_resume_point() const { return resume_point_; }
+
+    /**
+     * @brief Get task name
+     * @return Static task name
+     */
+    const char* get_name() const { return name_; }
+
+protected:
+    /**
+     * @brief Coroutine body, written between WEBINK_CO_BEGIN() and WEBINK_CO_END()
+     * @return Status for this resume
+     */
+    virtual TaskStatus step() = 0;
+
+    int resume_point_{0};                                       ///< Line of last suspension (used by macros)
+
+private:
+    const char* name_;                                          ///< Task name for logging
+    TaskStatus status_{TaskStatus::DONE};                       ///< Status from last resume
+};
+
+/**
+ * @class WebInkExecutor
+ * @brief Single-threaded, fixed-capacity executor driven from loop()
+ *
+ * Tasks are owned by the caller (typically embedded in the controller) and
+ * only referenced here, so spawning never allocates. Each run_once() resumes
+ * every spawned task once; finished tasks are dropped.
+ */
+class WebInkExecutor {
+public:
+    static const int MAX_TASKS = 4;                             ///< Maximum concurrent tasks
+
+    /**
+     * @brief Constructor
+     */
+    WebInkExecutor();
+
+    /**
+     * @brief Restart a task and schedule it
+     * @param task Task to run (must outlive its execution)
+     * @return True if scheduled, false if the executor is full
+     */
+    bool spawn(WebInkTask* task);
+
+    /**
+     * @brief Resume each scheduled task once
+     * @return True if any task made progress (moved past an await, yielded or finished)
+     */
+    bool run_once();
+
+    /**
+     * @brief Cancel and drop all scheduled tasks
+     * 
+     * May be called from inside a running task; run_once() stops iterating.
+     */
+    void cancel_all();
+
+    /**
+     * @brief Check whether any task is scheduled
+     * @return True if no tasks are scheduled
+     */
+    bool is_idle() const { return task_count_ == 0; }
+
+private:
+    static const char* TAG;                                     ///< Logging tag
+
+    WebInkTask* tasks_[MAX_TASKS];                              ///< Scheduled tasks (not owned)
+    int task_count_;                                            ///< Number of scheduled tasks
+};
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,95 @@
+/**
+ * @file webink_delegate.h
+ * @brief Fixed-capacity callback type that never allocates
+ *
+ * std::function may heap-allocate its target, copies it on every pass by
+ * value and hides its size behind type erasure. WebInkDelegate stores the
+ * callable inline in a fixed buffer (two pointers by default) and calls it
+ * through a single function pointer, so heap and stack use are known at
+ * compile time. A callable that is too large or not trivially copyable is
+ * a compile error instead of a silent allocation.
+ *
+ * That covers every callback the component uses: lambdas capturing `this`
+ * or another pointer, captureless lambdas and plain functions.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace esphome {
+namespace webink {
+
+template<typename Signature, size_t Capacity = 2 * sizeof(void*)>
+class WebInkDelegate;
+
+/**
+ * @class WebInkDelegate
+ * @brief Inline, trivially copyable replacement for std::function
+ *
+ * Empty when default-constructed or assigned nullptr; test with
+ * `if (delegate)` before calling.
+ *
+ * @example Storing a member callback
+ * @code
+ * WebInkDelegate<void(NetworkResult)> done = [this](NetworkResult result) {
+ *     on_image_response(std::move(result));
+ * };
+ * if (done) done(std::move(result));
+ * @endcode
+ */
+template<typename R, typename... Args, size_t Capacity>
+class WebInkDelegate<R(Args...), Capacity> {
+public:
+    WebInkDelegate() = default;
+    WebInkDelegate(std::nullptr_t) {}
+
+    template<typename F,
+             typename = typename std::enable_if<
+                 !std::is_same<typename std::decay<F>::type, WebInkDelegate>::value &&
+                 !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value>::type>
+    WebInkDelegate(F&& callable) {
+        using Target = typename std::decay<F>::type;
+        static_assert(sizeof(Target) <= Capacity,
+                      "Callable too large for WebInkDelegate - capture less or raise Capacity");
+        static_assert(alignof(Target) <= alignof(void*),
+                      "Callable over-aligned for WebInkDelegate");
+        static_assert(std::is_trivially_copyable<Target>::value &&
+                      std::is_trivially_destructible<Target>::value,
+                      "WebInkDelegate callables may only capture pointers and plain values");
+
+        new (storage_) Target(std::forward<F>(callable));
+        invoke_ = [](void* storage, Args... args) -> R {
+            return (*static_cast<Target*>(storage))(std::forward<Args>(args)...);
+        };
+    }
+
+    WebInkDelegate& operator=(std::nullptr_t) {
+        invoke_ = nullptr;
+        return *this;
+    }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+    /**
+     * @brief Call the target (must not be empty)
+     */
+    R operator()(Args... args) const {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+private:
+    using Invoker = R (*)(void*, Args...);
+
+    alignas(void*) mutable unsigned char storage_[Capacity] = {};  ///< Callable, copied bytewise
+    Invoker invoke_ = nullptr;                                      ///< Calls storage_ as its type
+};
+
+} // namespace webink
+} // namespace esphome
@@ -8,6 +8,7 @@
 
 #include "webink_display.h"
 #include <algorithm>
+#include <cmath>
 #include <sstream>
 
 namespace esphome {
@@ -19,13 +20,16 @@ const char* WebInkDisplayManager::TAG = "webink.display";
 // CONSTRUCTOR
 //=============================================================================
 
-WebInkDisplayManager::WebInkDisplayManager(std::function<void(const std::string&)> log_callback)
+WebInkDisplayManager::WebInkDisplayManager(LogCallback log_callback)
     : log_callback_(log_callback),
-      error_screen_displayed_(false),
-      normal_font_(nullptr),
-      large_font_(nullptr) {
-    
-    ESP_LOGD(TAG, "WebInkDisplayManager initialized");
+      error_screen_displayed_(false)
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+      , normal_font_(nullptr),
+      large_font_(nullptr)
+#endif
+      {
+    
+    WEBINK_LOGD(TAG, "WebInkDisplayManager initialized");
 }
 
 //=============================================================================
@@ -34,7 +38,7 @@ WebInkDisplayManager::WebInkDisplayManager(std::function<void(const std::string&
 
 void WebInkDisplayManager::draw_text(int x, int y, const std::string& text, bool large, int alignment) {
     // Default implementation - subclasses should override with actual font rendering
-    log_message("draw_text called: '" + text + "' at (" + std::to_string(x) + "," + std::to_string(y) + ")");
+    log_message("draw_text called: '%s' at (%d,%d)", text.c_str(), x, y);
     
     // This is a placeholder - actual implementation would use ESPHome font components
     // For now, just draw a rectangle where text would be
@@ -134,9 +138,10 @@ void WebInkDisplayManager::draw_pixel_block(int start_x, int start_y, const Pixe
         return;
     }
     
-    ESP_LOGD(TAG, "Drawing pixel block: %dx%d at (%d,%d), mode=%s, stride=%d, offset=%d",
-             pixels.width, pixels.height, start_x, start_y, 
-             color_mode_to_string(pixels.mode), pixels.data_stride, pixels.start_offset);
+    WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS,
+                     "Drawing pixel block: %dx%d at (%d,%d), mode=%s, stride=%d, offset=%d",
+                     pixels.width, pixels.height, start_x, start_y,
+                     color_mode_to_string(pixels.mode), pixels.data_stride, pixels.start_offset);
     
     for (int y = 0; y < pixels.height; y++) {
         // Get pointer to start of this row using the new helper method
@@ -177,7 +182,7 @@ void WebInkDisplayManager::draw_pixel_block(int start_x, int start_y, const Pixe
         }
     }
     
-    log_message("Pixel block drawn successfully (zero-copy)");
+    WEBINK_LOGV(TAG, "Pixel block drawn successfully (zero-copy)");
 }
 
 void WebInkDisplayManager::draw_progressive_pixels(int start_x, int start_y, int width, int height,
@@ -187,7 +192,18 @@ void WebInkDisplayManager::draw_progressive_pixels(int start_x, int start_y, int
         return;
     }
     
-    ESP_LOGD(TAG, "Drawing progressive pixels: %dx%d at (%d,%d)", width, height, start_x, start_y);
+    WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS, "Drawing progressive pixels: %dx%d at (%d,%d)",
+                     width, height, start_x, start_y);
+    
+    // Full-width PBM rows of a fixed geometry take the constant-stride path
+    if (color_mode == ColorMode::MONO_BLACK_WHITE) {
+        if (FIXED_PBM_ROW_BYTES > 0 && (width + 7) / 8 == FIXED_PBM_ROW_BYTES) {
+            draw_mono_rows<FIXED_PBM_ROW_BYTES>(start_x, start_y, width, height, pixel_data);
+        } else {
+            draw_mono_rows<0>(start_x, start_y, width, height, pixel_data);
+        }
+        return;
+    }
     
     // Calculate proper bytes per pixel and stride based on color mode
     int bytes_per_pixel = 1;
@@ -224,7 +240,7 @@ void WebInkDisplayManager::draw_progressive_pixels(int start_x, int start_y, int
 
 void WebInkDisplayManager::draw_error_message(ErrorType error_type, const std::string& details,
                                              bool show_network_info) {
-    log_message("Displaying error message: " + std::string(error_type_to_string(error_type)));
+    log_message("Displaying error message: %s", error_type_to_string(error_type));
     
     int width, height;
     get_display_size(width, height);
@@ -321,7 +337,7 @@ void WebInkDisplayManager::draw_wifi_setup_message() {
 
 void WebInkDisplayManager::draw_progress_indicator(float percentage, const std::string& status,
                                                   bool show_details) {
-    log_message("Displaying progress: " + std::to_string((int)percentage) + "% - " + status);
+    log_message("Displaying progress: %d%% - %s", (int)percentage, status.c_str());
     
     int width, height;
     get_display_size(width, height);
@@ -481,6 +497,28 @@ int WebInkDisplayManager::get_line_spacing(bool large) {
 // COLOR AND PIXEL UTILITIES
 //=============================================================================
 
+template<int FixedRowBytes>
+void WebInkDisplayManager::draw_mono_rows(int start_x, int start_y, int width, int height,
+                                          const uint8_t* pixel_data) {
+    const int stride = webink_row_bytes<FixedRowBytes>((width + 7) / 8);
+    const uint32_t colors[2] = {
+        convert_pixel_color(0, ColorMode::MONO_BLACK_WHITE),
+        convert_pixel_color(1, ColorMode::MONO_BLACK_WHITE)
+    };
+    
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = pixel_data + y * stride;
+        int x = start_x;
+        for (int i = 0; i < stride; i++) {
+            uint8_t bits = row[i];
+            int count = (i == stride - 1 && (width & 7)) ? (width & 7) : 8;
+            for (int bit = 0; bit < count; bit++) {
+                draw_pixel(x++, start_y + y, colors[(bits >> (7 - bit)) & 1]);
+            }
+        }
+    }
+}
+
 uint32_t WebInkDisplayManager::convert_pixel_color(uint32_t pixel_value, ColorMode color_mode) {
     switch (color_mode) {
         case ColorMode::MONO_BLACK_WHITE:
@@ -513,25 +551,35 @@ void WebInkDisplayManager::set_network_info(const std::string& server_url, const
     server_url_ = server_url;
     device_ip_ = device_ip;
     
-    ESP_LOGD(TAG, "Network info set - Server: %s, IP: %s", server_url.c_str(), device_ip.c_str());
+    WEBINK_LOGD(TAG, "Network info set - Server: %s, IP: %s", server_url.c_str(), device_ip.c_str());
 }
 
+#ifndef WEBINK_MAC_INTEGRATION_TEST
 void WebInkDisplayManager::set_fonts(font::Font* normal_font, font::Font* large_font) {
     normal_font_ = normal_font;
     large_font_ = large_font;
     
-    ESP_LOGD(TAG, "Fonts configured");
+    WEBINK_LOGD(TAG, "Fonts configured");
 }
+#endif
 
 //=============================================================================
 // PROTECTED HELPER METHODS
 //=============================================================================
 
-void WebInkDisplayManager::log_message(const std::string& message) {
+void WebInkDisplayManager::log_message(const char* format, ...) {
+    if (!log_callback_ && !WEBINK_LOG_ENABLED(WEBINK_LOG_LEVEL_DEBUG)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    const char* message = log_vformat(format, args);
+    va_end(args);
+
     if (log_callback_) {
         log_callback_(message);
     }
-    ESP_LOGD(TAG, "%s", message.c_str());
+    WEBINK_LOGD(TAG, "%s", message);
 }
 
 std::string WebInkDisplayManager::get_error_title(ErrorType error_type) {
@@ -23,7 +23,6 @@
 
 #include <string>
 #include <cstdint>
-#include <functional>
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
 // Mac integration test mode - use local declarations
@@ -36,6 +35,8 @@ void ESP_LOGD(const char* tag, const char* format, ...);
 #include "esphome/core/log.h"
 #endif
 
+#include "webink_geometry.h"
+#include "webink_log.h"
 #include "webink_types.h"
 
 #ifndef WEBINK_MAC_INTEGRATION_TEST
@@ -101,7 +102,7 @@ public:
      * @brief Constructor with optional logging callback
      * @param log_callback Function for logging messages (optional)
      */
-    WebInkDisplayManager(std::function<void(const std::string&)> log_callback = nullptr);
+    WebInkDisplayManager(LogCallback log_callback = nullptr);
 
     /**
      * @brief Virtual destructor for proper inheritance
@@ -352,6 +353,16 @@ public:
      */
     virtual uint32_t convert_pixel_color(uint32_t pixel_value, ColorMode color_mode);
 
+    /**
+     * @brief Draw bit-packed monochrome rows a byte at a time
+     * @tparam FixedRowBytes Compile-time stride (FIXED_PBM_ROW_BYTES), 0 to use width
+     *
+     * Converts the two colors once instead of per pixel. With a fixed
+     * geometry the stride and the byte loop bound are constants.
+     */
+    template<int FixedRowBytes>
+    void draw_mono_rows(int start_x, int start_y, int width, int height, const uint8_t* pixel_data);
+
     /**
      * @brief Get foreground color (typically black)
      * @return Foreground color value
@@ -409,9 +420,9 @@ protected:
 
     /**
      * @brief Log message through callback or ESP_LOG
-     * @param message Message to log
+     * @param format printf format of the message
      */
-    void log_message(const std::string& message);
+    void log_message(const char* format, ...) __attribute__((format(printf, 2, 3)));
 
     /**
      * @brief Get error type title string
@@ -442,7 +453,7 @@ protected:
 private:
     static const char* TAG;                                     ///< Logging tag
     
-    std::function<void(const std::string&)> log_callback_;      ///< Logging callback
+    LogCallback log_callback_;                                  ///< Logging callback
     std::string server_url_;                                    ///< Server URL for error displays
     std::string device_ip_;                                     ///< Device IP for error displays
     bool error_screen_displayed_;                               ///< Error screen state flag
@@ -4,8 +4,10 @@
  */
 
 #include "webink_esphome.h"
+#include "webink_log.h"
 #include "esphome/core/log.h"
 #include "esphome/components/wifi/wifi_component.h"
+#include <cmath>
 
 namespace esphome {
 namespace webink {
@@ -89,6 +91,7 @@ WebInkESPHomeComponent::WebInkESPHomeComponent()
     , display_mode_("800x480x1xB")
     , socket_port_(8091)
     , rows_per_slice_(8)
+    , sleep_schedule_(false)
     , display_component_(nullptr)
     , normal_font_(nullptr)
     , large_font_(nullptr)
@@ -96,14 +99,16 @@ WebInkESPHomeComponent::WebInkESPHomeComponent()
     , boot_button_(nullptr)
     , setup_complete_(false)
     , is_wake_from_deep_sleep_(false)
+    , wake_reason_(WakeReason::UNKNOWN)
     , initial_boot_time_(0)
     , initial_boot_no_sleep_period_(true)
     , deep_sleep_allowed_(false)
+    , sleep_pending_(false)
     , last_error_time_(0) {
 }
 
 void WebInkESPHomeComponent::setup() {
-  ESP_LOGI(TAG, "Setting up WebInk component...");
+  WEBINK_LOGI(TAG, "Setting up WebInk component...");
   
   // Initialize deep sleep logic first (before WebInk controller)
   setup_deep_sleep_logic();
@@ -112,7 +117,7 @@ void WebInkESPHomeComponent::setup() {
   setup_esphome_callbacks();
   
   setup_complete_ = true;
-  ESP_LOGI(TAG, "WebInk component setup complete");
+  WEBINK_LOGI(TAG, "WebInk component setup complete");
   
   // DISABLED: This timeout callback causes stack overflow on ESP32C3
   // The string concatenation + HTTP POST in the lambda exceeds stack limits
@@ -120,7 +125,7 @@ void WebInkESPHomeComponent::setup() {
   //   std::string startup_log = std::string("STARTUP: Component initialized - Boot type: ") + 
   //                            (is_wake_from_deep_sleep_ ? "Deep sleep wake" : "Cold boot") +
   //                            ", Wake #" + std::to_string(controller_ ? controller_->get_state().wake_counter : 0);
-  //   post_critical_log_to_server(startup_log);
+  //   queue_critical_log(startup_log);
   // });
 }
 
@@ -132,7 +137,7 @@ void WebInkESPHomeComponent::loop() {
   // Let the WebInk controller handle its state machine
   controller_->loop();
   
-  // Check deep sleep trigger occasionally (not every loop)
+  // Enter deep sleep as soon as the controller reports a completed cycle
   check_deep_sleep_trigger();
 }
 
@@ -140,11 +145,14 @@ void WebInkESPHomeComponent::initialize_webink_controller() {
   // Create configuration
   config_ = std::make_shared<WebInkConfig>();
   config_->set_server_url(server_url_.c_str());
+  for (const auto& url : fallback_servers_) {
+    config_->add_server_url(url.c_str());
+  }
   config_->set_device_id(device_id_.c_str());
   config_->set_api_key(api_key_.c_str());
   config_->set_display_mode(display_mode_.c_str());
   config_->set_socket_port(socket_port_);
-  ESP_LOGI(TAG, "Socket port set to: %d (from YAML: %d)", config_->socket_mode_port, socket_port_);
+  WEBINK_LOGI(TAG, "Socket port set to: %d (from YAML: %d)", config_->socket_mode_port, socket_port_);
   
   // Create display manager
   display_manager_ = std::make_shared<ESPHomeWebInkDisplay>(display_component_, normal_font_, large_font_);
@@ -152,22 +160,24 @@ void WebInkESPHomeComponent::initialize_webink_controller() {
   // Create controller
   controller_ = create_webink_controller();
   if (!controller_) {
-    ESP_LOGE(TAG, "Failed to create WebInk controller!");
+    WEBINK_LOGE(TAG, "Failed to create WebInk controller!");
     // Cannot post to server yet since controller is needed
     return;
   }
   
   controller_->set_config(config_);
   controller_->set_display(display_manager_);
+  controller_->set_follow_server_schedule(sleep_schedule_);
+  controller_->set_wake_reason(wake_reason_);
   
   // Deep sleep integration is handled by setup_deep_sleep_logic() in setup()
   if (deep_sleep_component_) {
-    ESP_LOGD(TAG, "Deep sleep component will be managed by WebInk logic");
+    WEBINK_LOGD(TAG, "Deep sleep component will be managed by WebInk logic");
   } else {
-    ESP_LOGW(TAG, "No deep sleep component configured - device will stay awake");
+    WEBINK_LOGW(TAG, "No deep sleep component configured - device will stay awake");
   }
   
-  ESP_LOGI(TAG, "WebInk controller initialized with server: %s", server_url_.c_str());
+  WEBINK_LOGI(TAG, "WebInk controller initialized with server: %s", server_url_.c_str());
 }
 
 void WebInkESPHomeComponent::setup_esphome_callbacks() {
@@ -180,12 +190,17 @@ void WebInkESPHomeComponent::setup_esphome_callbacks() {
     static unsigned long last_log = 0;
     unsigned long now = millis();
     if (now - last_log > 5000) {
-      ESP_LOGD(TAG, "[WIFI-CB] ESPHome WiFi is_connected()=%s", connected ? "true" : "false");
+      WEBINK_LOGD(TAG, "[WIFI-CB] ESPHome WiFi is_connected()=%s", connected ? "true" : "false");
       last_log = now;
     }
     return connected;
   };
   
+  // Signal strength for wake telemetry
+  controller_->get_wifi_rssi = []() {
+    return static_cast<int>(wifi::global_wifi_component->wifi_rssi());
+  };
+  
   // Boot button status callback  
   controller_->get_boot_button_status = [this]() {
     if (boot_button_) {
@@ -195,22 +210,24 @@ void WebInkESPHomeComponent::setup_esphome_callbacks() {
   };
   
   // Logging callback
-  controller_->on_log_message = [](const std::string& msg) {
-    ESP_LOGI(TAG, "%s", msg.c_str());
+  controller_->on_log_message = [](const char* msg) {
+    WEBINK_LOGI(TAG, "%s", msg);
   };
   
-  // State change callback
+  // State change callback (the controller itself logs [STATE] at INFO)
   controller_->on_state_change = [](UpdateState from, UpdateState to) {
-    ESP_LOGI(TAG, "State transition: %s -> %s", 
-             update_state_to_string(from),
-             update_state_to_string(to));
+    WEBINK_LOGD(TAG, "State transition: %s -> %s", 
+                update_state_to_string(from),
+                update_state_to_string(to));
   };
   
-  // Error callback
-  controller_->on_error_occurred = [](ErrorType error, const std::string& details) {
-    ESP_LOGE(TAG, "WebInk Error [%s]: %s", 
-             error_type_to_string(error),
-             details.c_str());
+  // Error callback - also arms the error recovery sleep guard, since with
+  // event-driven sleep the guards are never sampled while in ERROR_DISPLAY
+  controller_->on_error_occurred = [this](ErrorType error, const std::string& details) {
+    WEBINK_LOGE(TAG, "WebInk Error [%s]: %s", 
+                error_type_to_string(error),
+                details.c_str());
+    last_error_time_ = millis();
   };
 }
 
@@ -369,84 +386,121 @@ void WebInkESPHomeComponent::setup_deep_sleep_logic() {
     case ESP_SLEEP_WAKEUP_ULP:
       is_wake_from_deep_sleep_ = true;
       initial_boot_no_sleep_period_ = false;  // Skip 5-minute rule for wake
-      ESP_LOGI(TAG, "Woke from deep sleep (cause: %d)", wakeup_reason);
+      wake_reason_ = (wakeup_reason == ESP_SLEEP_WAKEUP_TIMER) ? WakeReason::TIMER : WakeReason::EXTERNAL;
+      WEBINK_LOGI(TAG, "Woke from deep sleep (cause: %d)", wakeup_reason);
       break;
       
     case ESP_SLEEP_WAKEUP_UNDEFINED:
     default:
       is_wake_from_deep_sleep_ = false;
       initial_boot_no_sleep_period_ = true;   // Enforce 5-minute rule for cold boot
-      ESP_LOGI(TAG, "Cold boot detected - 5-minute no-sleep period active");
+      WEBINK_LOGI(TAG, "Cold boot detected - 5-minute no-sleep period active");
       break;
   }
+  
+  if (!is_wake_from_deep_sleep_) {
+    switch (esp_reset_reason()) {
+      case ESP_RST_POWERON:
+        wake_reason_ = WakeReason::POWER_ON;
+        break;
+      case ESP_RST_SW:
+        wake_reason_ = WakeReason::SOFTWARE;
+        break;
+      case ESP_RST_PANIC:
+      case ESP_RST_INT_WDT:
+      case ESP_RST_TASK_WDT:
+      case ESP_RST_WDT:
+        wake_reason_ = WakeReason::CRASH;
+        break;
+      default:
+        wake_reason_ = WakeReason::UNKNOWN;
+        break;
+    }
+  }
 #else
   // Non-ESP32 platforms - always treat as cold boot
   is_wake_from_deep_sleep_ = false;
   initial_boot_no_sleep_period_ = true;
-  ESP_LOGI(TAG, "Non-ESP32 platform - deep sleep disabled");
+  WEBINK_LOGI(TAG, "Non-ESP32 platform - deep sleep disabled");
 #endif
 
   deep_sleep_allowed_ = !initial_boot_no_sleep_period_;
   
-  ESP_LOGI(TAG, "Deep sleep setup: wake=%s, no_sleep_period=%s, allowed=%s",
-           is_wake_from_deep_sleep_ ? "true" : "false",
-           initial_boot_no_sleep_period_ ? "true" : "false", 
-           deep_sleep_allowed_ ? "true" : "false");
+  WEBINK_LOGI(TAG, "Deep sleep setup: wake=%s, no_sleep_period=%s, allowed=%s",
+              is_wake_from_deep_sleep_ ? "true" : "false",
+              initial_boot_no_sleep_period_ ? "true" : "false", 
+              deep_sleep_allowed_ ? "true" : "false");
 }
 
 void WebInkESPHomeComponent::check_deep_sleep_trigger() {
-  if (!deep_sleep_component_) {
+  if (!deep_sleep_component_ || !controller_) {
     return; // No deep sleep component configured
   }
   
-  // Only check periodically (not every loop cycle)
-  static unsigned long last_check_time = 0;
-  unsigned long now = millis();
-  if (now - last_check_time < 10000) { // Check every 10 seconds
+  // Sleep is event-driven: the controller raises "cycle complete" when it
+  // reaches COMPLETE and we act on it in the same loop() pass. If a guard
+  // blocks sleep at that moment the request stays pending and the (cheap)
+  // guards are re-evaluated every loop until they pass or a new cycle starts.
+  if (controller_->consume_cycle_complete()) {
+    sleep_pending_ = true;
+  }
+  if (!sleep_pending_) {
+    return;
+  }
+  
+  // A new cycle supersedes the pending request; its own COMPLETE re-raises it
+  UpdateState current = controller_->get_current_state();
+  if (current != UpdateState::IDLE && current != UpdateState::COMPLETE) {
+    sleep_pending_ = false;
     return;
   }
-  last_check_time = now;
   
   bool prev_allowed = deep_sleep_allowed_;
   deep_sleep_allowed_ = can_enter_deep_sleep();
   
   if (deep_sleep_allowed_ != prev_allowed) {
-    ESP_LOGI(TAG, "Deep sleep state changed: %s -> %s", 
-             prev_allowed ? "ALLOWED" : "BLOCKED",
-             deep_sleep_allowed_ ? "ALLOWED" : "BLOCKED");
+    WEBINK_LOGI(TAG, "Deep sleep state changed: %s -> %s", 
+                prev_allowed ? "ALLOWED" : "BLOCKED",
+                deep_sleep_allowed_ ? "ALLOWED" : "BLOCKED");
   }
   
   // Trigger deep sleep if conditions are met
   if (deep_sleep_allowed_) {
-    // Check if WebInk operations have completed
-    if (controller_) {
-      UpdateState state = controller_->get_current_state();
-      if (state == UpdateState::IDLE || state == UpdateState::COMPLETE) {
-        // Get sleep duration from server (stored in WebInk state)
-        unsigned long sleep_duration_ms = controller_->get_state().get_sleep_duration_ms();
-        int sleep_duration_sec = controller_->get_state().sleep_duration_seconds;
-        
-        ESP_LOGI(TAG, "WebInk operations complete - entering deep sleep for %d seconds", sleep_duration_sec);
-        
-        // 🚀 CRITICAL LOG: Entering deep sleep
-        std::string sleep_log = "DEEP_SLEEP: Entering " + std::to_string(sleep_duration_sec) + 
-                               "s sleep after wake #" + std::to_string(controller_->get_state().wake_counter) +
-                               " (state: " + std::string(update_state_to_string(state)) + ")";
-        post_critical_log_to_server(sleep_log);
-        
-        prepare_for_deep_sleep();
-        
-        // Enter deep sleep with server-provided duration
-        // Note: ESPHome deep sleep API may vary - this uses the most common pattern
-        #ifdef USE_ESP32
-        deep_sleep_component_->begin_sleep(sleep_duration_ms);
-        #else
-        // For non-ESP32 or if the above API doesn't exist, fall back to default
-        deep_sleep_component_->begin_sleep();
-        #endif
-        // Execution stops here - device enters deep sleep
-      }
-    }
+    UpdateState state = current;
+    unsigned long now = millis();
+    
+    // Get sleep duration from server (stored in WebInk state)
+    unsigned long sleep_duration_ms = controller_->get_state().get_sleep_duration_ms();
+    int sleep_duration_sec = static_cast<int>(sleep_duration_ms / 1000);
+    
+    // Awake time for this wake: millis() restarts at every boot/wake, and the
+    // tail is the gap between cycle completion and the sleep decision (this
+    // used to be up to 10 s with the polled trigger)
+    unsigned long awake_ms = now;
+    unsigned long tail_ms = now - controller_->get_cycle_complete_time();
+    
+    WEBINK_LOGI(TAG, "WebInk operations complete - entering deep sleep for %d seconds", sleep_duration_sec);
+    WEBINK_LOGI(TAG, "[SLEEP] Awake %lu ms this wake (%lu ms from cycle complete to sleep)", awake_ms, tail_ms);
+    
+    // 🚀 CRITICAL LOG: Entering deep sleep
+    std::string sleep_log = "DEEP_SLEEP: Entering " + std::to_string(sleep_duration_sec) + 
+                           "s sleep after wake #" + std::to_string(controller_->get_state().wake_counter) +
+                           " (state: " + std::string(update_state_to_string(state)) +
+                           ", awake " + std::to_string(awake_ms) + "ms, tail " + std::to_string(tail_ms) + "ms)";
+    queue_critical_log(sleep_log);
+    
+    prepare_for_deep_sleep();
+    sleep_pending_ = false;
+    
+    // Enter deep sleep with server-provided duration
+    // Note: ESPHome deep sleep API may vary - this uses the most common pattern
+    #ifdef USE_ESP32
+    deep_sleep_component_->begin_sleep(sleep_duration_ms);
+    #else
+    // For non-ESP32 or if the above API doesn't exist, fall back to default
+    deep_sleep_component_->begin_sleep();
+    #endif
+    // Execution stops here - device enters deep sleep
   } else {
     // 🚨 CRITICAL LOG: Deep sleep blocked
     static unsigned long last_blocked_log_time = 0;
@@ -470,19 +524,19 @@ void WebInkESPHomeComponent::check_deep_sleep_trigger() {
       }
       
       std::string blocked_log = "DEEP_SLEEP: BLOCKED - " + reason;
-      post_critical_log_to_server(blocked_log);
+      queue_critical_log(blocked_log);
       last_blocked_log_time = now;
     }
   }
 }
 
-void WebInkESPHomeComponent::post_critical_log_to_server(const std::string& message) {
+void WebInkESPHomeComponent::queue_critical_log(const std::string& message) {
   if (!controller_) {
-    ESP_LOGW(TAG, "Cannot post log - controller not initialized: %s", message.c_str());
+    WEBINK_LOGW(TAG, "Cannot queue log - controller not initialized: %s", message.c_str());
     return;
   }
   
-  controller_->post_status_to_server(message);
+  controller_->queue_status_log(message);
 }
 
 bool WebInkESPHomeComponent::can_enter_deep_sleep() const {
@@ -546,17 +600,16 @@ void WebInkESPHomeComponent::prepare_for_deep_sleep() {
     return;
   }
   
-  ESP_LOGI(TAG, "Preparing for deep sleep...");
+  WEBINK_LOGI(TAG, "Preparing for deep sleep...");
   
-  // Perform any necessary cleanup before deep sleep
+  // Persist hash, counters and estimates to RTC memory for the next wake
   if (controller_) {
-    // The WebInk controller will automatically save state
-    // No explicit prepare_for_sleep() method needed
-    ESP_LOGD(TAG, "WebInk controller state preserved");
+    controller_->save_state();
+    WEBINK_LOGD(TAG, "WebInk controller state preserved");
   }
   
   // Additional cleanup can be added here
-  ESP_LOGI(TAG, "Ready for deep sleep");
+  WEBINK_LOGI(TAG, "Ready for deep sleep");
 }
 
 // Public methods for YAML template sensors
@@ -616,6 +669,20 @@ bool WebInkESPHomeComponent::get_progress_info(float& percentage, std::string& s
   return controller_->get_progress_info(percentage, status);
 }
 
+float WebInkESPHomeComponent::get_state_time_ms(UpdateState state, int percentile) const {
+  if (!controller_) {
+    return NAN;
+  }
+  const Log2Histogram& times = controller_->get_state().get_state_times(state);
+  if (times.total() == 0) {
+    return NAN;  // Reported as "unknown" until the state has been visited
+  }
+  if (percentile >= 100) {
+    return (float)times.max_ms;
+  }
+  return (float)times.percentile(percentile);
+}
+
 bool WebInkESPHomeComponent::is_deep_sleep_enabled_state() const {
   if (!controller_) {
     return true; // Default to enabled
@@ -17,6 +17,8 @@
 #include "esphome/components/font/font.h"
 #include "esphome/components/binary_sensor/binary_sensor.h"
 
+#include <vector>
+
 #ifdef USE_ESP32
 #include "esp_sleep.h"
 #include "esp_system.h"
@@ -69,11 +71,13 @@ class WebInkESPHomeComponent : public Component {
 
   // Configuration setters (called from Python codegen)
   void set_server_url(const std::string& url) { server_url_ = url; }
+  void add_fallback_server(const std::string& url) { fallback_servers_.push_back(url); }
   void set_device_id(const std::string& id) { device_id_ = id; }
   void set_api_key(const std::string& key) { api_key_ = key; }
   void set_display_mode(const std::string& mode) { display_mode_ = mode; }
   void set_socket_port(int port) { socket_port_ = port; }
   void set_rows_per_slice(int rows) { rows_per_slice_ = rows; }
+  void set_sleep_schedule(bool follow) { sleep_schedule_ = follow; }
 
   // Component references (called from Python codegen)
   void set_display_component(display::Display* display) { display_component_ = display; }
@@ -116,6 +120,8 @@ class WebInkESPHomeComponent : public Component {
   float get_boot_cycles() const;
   float get_progress_percentage() const;
   bool get_progress_info(float& percentage, std::string& status) const;
+  // Per-state timing from the persisted histograms: percentile 50, 95 or 100 (= max)
+  float get_state_time_ms(UpdateState state, int percentile) const;
   
   // Deep sleep status/control
   bool is_deep_sleep_enabled_state() const;
@@ -132,11 +138,13 @@ class WebInkESPHomeComponent : public Component {
 
   // Configuration
   std::string server_url_;
+  std::vector<std::string> fallback_servers_;  ///< Tried after server_url_ (see WebInkConfig::add_server_url)
   std::string device_id_;
   std::string api_key_;
   std::string display_mode_;
   int socket_port_;
   int rows_per_slice_;
+  bool sleep_schedule_;                    ///< Sleep until the server's next planned change
 
   // ESPHome component references
   display::Display* display_component_;
@@ -153,9 +161,11 @@ class WebInkESPHomeComponent : public Component {
   // Deep sleep state management
   bool setup_complete_;
   bool is_wake_from_deep_sleep_;           ///< True if this boot was from deep sleep wake
+  WakeReason wake_reason_;                 ///< Why the device is awake (for telemetry)
   unsigned long initial_boot_time_;        ///< Time of initial boot (millis)
   bool initial_boot_no_sleep_period_;      ///< True during 5-minute no-sleep window
   bool deep_sleep_allowed_;                ///< True if deep sleep is currently allowed
+  bool sleep_pending_;                     ///< Cycle completed, waiting for sleep guards to pass
   unsigned long last_error_time_;          ///< Time of last error (prevents deep sleep)
   
   static constexpr unsigned long INITIAL_BOOT_NO_SLEEP_MS = 5 * 60 * 1000;  // 5 minutes
@@ -168,8 +178,8 @@ private:
   void prepare_for_deep_sleep();
   bool can_enter_deep_sleep() const;
 
-  // Critical logging
-  void post_critical_log_to_server(const std::string& message);
+  // Critical logging (queued for the next batched upload)
+  void queue_critical_log(const std::string& message);
 };
 
 } // namespace webink
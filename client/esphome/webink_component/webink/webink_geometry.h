@@ -0,0 +1,160 @@
+/**
+ * @file webink_geometry.h
+ * @brief Display geometry as a constexpr value, fixed at compile time from YAML
+ *
+ * The display mode string ("800x480x1xB") used to be parsed again by every
+ * caller that needed a width or a row size, and the slice and socket paths
+ * hardcoded 800 pixels. DisplayGeometry holds the parsed values and derives
+ * row sizes from them; its parser is constexpr, so the same code runs at
+ * compile time and at runtime.
+ *
+ * The ESPHome codegen (`webink/__init__.py`) parses `display_mode` and emits
+ * it as build flags, unless `fixed_geometry: false`:
+ * @code
+ * -DWEBINK_DISPLAY_WIDTH=800 -DWEBINK_DISPLAY_HEIGHT=480
+ * -DWEBINK_DISPLAY_BITS=1 -DWEBINK_DISPLAY_COLOR=0      // ColorMode value
+ * @endcode
+ * COMPILED_GEOMETRY then is a constant, WEBINK_FIXED_GEOMETRY is 1 and the
+ * FIXED_* row sizes below are non-zero. Hot loops take the row size as a
+ * template argument (webink_row_bytes<FIXED_...>()): with a fixed geometry
+ * it is a constant, the loop bounds are known and the compiler unrolls;
+ * with a runtime geometry the argument is 0 and the value passed at runtime
+ * is used. Static buffers (the socket row buffer) are sized exactly.
+ *
+ * Runtime geometry (`fixed_geometry: false`, or no flags at all) keeps the
+ * display mode changeable through set_display_mode(), up to
+ * WEBINK_MAX_DISPLAY_WIDTH pixels per row.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include "webink_types.h"
+
+#ifndef WEBINK_MAX_DISPLAY_WIDTH
+#define WEBINK_MAX_DISPLAY_WIDTH 800
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @struct DisplayGeometry
+ * @brief Width, height, bit depth and color mode of the display
+ *
+ * A default-constructed or failed-to-parse geometry is all zero and
+ * is_valid() returns false.
+ */
+struct DisplayGeometry {
+    int width = 0;                                              ///< Pixels per row
+    int height = 0;                                             ///< Rows
+    int bits = 0;                                               ///< Bits per pixel (1, 2, 8 or 24)
+    ColorMode mode = ColorMode::MONO_BLACK_WHITE;               ///< Color mode
+
+    constexpr DisplayGeometry() = default;
+    constexpr DisplayGeometry(int w, int h, int b, ColorMode m) : width(w), height(h), bits(b), mode(m) {}
+
+    /**
+     * @brief Values a display mode may have
+     */
+    constexpr bool is_valid() const {
+        return width > 0 && height > 0 && (bits == 1 || bits == 2 || bits == 8 || bits == 24);
+    }
+
+    /**
+     * @brief Bytes per row in the geometry's color mode
+     */
+    constexpr int bytes_per_row() const {
+        return mode == ColorMode::MONO_BLACK_WHITE ? (width + 7) / 8    // 1-bit packed
+             : mode == ColorMode::GRAYSCALE_8BIT   ? width              // 1 byte per pixel
+             : mode == ColorMode::RGBB_4COLOR      ? (width + 3) / 4    // 2 bits per pixel
+             : width * 3;                                                // 3 bytes per pixel
+    }
+
+    constexpr int pbm_bytes_per_row() const { return (width + 7) / 8; }      ///< Row of a 1-bit PBM slice
+    constexpr int image_bytes() const { return bytes_per_row() * height; }   ///< Whole image in color mode
+
+    constexpr bool operator==(const DisplayGeometry& other) const {
+        return width == other.width && height == other.height && bits == other.bits && mode == other.mode;
+    }
+    constexpr bool operator!=(const DisplayGeometry& other) const { return !(*this == other); }
+
+    /**
+     * @brief Parse "WIDTHxHEIGHTxBITSxMODE" (e.g. "800x480x1xB")
+     * @param text Display mode string
+     * @return Parsed geometry, or an invalid (all zero) one
+     *
+     * Usable in constant expressions. Does not log; WebInkConfig reports
+     * why a mode was rejected.
+     */
+    static constexpr DisplayGeometry parse(const char* text) {
+        int values[3] = {0, 0, 0};
+        const char* p = text;
+        for (int& value : values) {
+            if (p == nullptr || *p < '0' || *p > '9') {
+                return DisplayGeometry();
+            }
+            while (*p >= '0' && *p <= '9') {
+                if (value > 100000) {
+                    return DisplayGeometry();
+                }
+                value = value * 10 + (*p++ - '0');
+            }
+            if (*p++ != 'x') {
+                return DisplayGeometry();
+            }
+        }
+
+        ColorMode mode = ColorMode::MONO_BLACK_WHITE;
+        switch (p[0]) {
+            case 'B': mode = ColorMode::MONO_BLACK_WHITE; break;
+            case 'G': mode = ColorMode::GRAYSCALE_8BIT; break;
+            case 'R': mode = ColorMode::RGBB_4COLOR; break;
+            case 'C': mode = ColorMode::RGB_FULL_COLOR; break;
+            default: return DisplayGeometry();
+        }
+        if (p[1] != '\0') {
+            return DisplayGeometry();
+        }
+
+        DisplayGeometry geometry(values[0], values[1], values[2], mode);
+        return geometry.is_valid() ? geometry : DisplayGeometry();
+    }
+};
+
+static_assert(DisplayGeometry::parse("800x480x1xB") == DisplayGeometry(800, 480, 1, ColorMode::MONO_BLACK_WHITE),
+              "DisplayGeometry::parse must accept the default mode at compile time");
+
+#ifdef WEBINK_DISPLAY_WIDTH
+#define WEBINK_FIXED_GEOMETRY 1
+
+/// Geometry from the YAML display_mode (fixed_geometry: true)
+static constexpr DisplayGeometry COMPILED_GEOMETRY(WEBINK_DISPLAY_WIDTH, WEBINK_DISPLAY_HEIGHT, WEBINK_DISPLAY_BITS,
+                                                   static_cast<ColorMode>(WEBINK_DISPLAY_COLOR));
+static_assert(COMPILED_GEOMETRY.is_valid(), "WEBINK_DISPLAY_* flags do not form a valid display mode");
+
+static constexpr int FIXED_ROW_BYTES = COMPILED_GEOMETRY.bytes_per_row();        ///< Color-mode row
+static constexpr int FIXED_PBM_ROW_BYTES = COMPILED_GEOMETRY.pbm_bytes_per_row();  ///< PBM slice row
+static constexpr int MAX_PBM_ROW_BYTES = FIXED_PBM_ROW_BYTES;                   ///< Exact
+#else
+#define WEBINK_FIXED_GEOMETRY 0
+
+static constexpr int FIXED_ROW_BYTES = 0;                                       ///< Runtime geometry
+static constexpr int FIXED_PBM_ROW_BYTES = 0;                                   ///< Runtime geometry
+static constexpr int MAX_PBM_ROW_BYTES = (WEBINK_MAX_DISPLAY_WIDTH + 7) / 8;    ///< Widest row supported
+#endif
+
+/**
+ * @brief Row size for a hot loop: the compile-time value when there is one
+ * @tparam FixedBytes FIXED_ROW_BYTES or FIXED_PBM_ROW_BYTES (0 = runtime geometry)
+ * @param runtime_bytes Row size from the runtime geometry
+ */
+template<int FixedBytes>
+constexpr int webink_row_bytes(int runtime_bytes) {
+    return FixedBytes > 0 ? FixedBytes : runtime_bytes;
+}
+
+} // namespace webink
+} // namespace esphome
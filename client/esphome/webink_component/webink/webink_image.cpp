@@ -7,9 +7,9 @@
  */
 
 #include "webink_image.h"
+#include "webink_memory.h"
 #include <algorithm>
 #include <cstring>
-#include <new>
 
 namespace esphome {
 namespace webink {
@@ -20,9 +20,9 @@ const char* WebInkImageProcessor::TAG = "webink.image";
 // CONSTRUCTOR
 //=============================================================================
 
-WebInkImageProcessor::WebInkImageProcessor(std::function<void(const std::string&)> log_callback)
+WebInkImageProcessor::WebInkImageProcessor(LogCallback log_callback)
     : log_callback_(log_callback) {
-    ESP_LOGD(TAG, "WebInkImageProcessor initialized");
+    WEBINK_LOGD(TAG, "WebInkImageProcessor initialized");
 }
 
 //=============================================================================
@@ -56,7 +56,7 @@ bool WebInkImageProcessor::parse_header(const uint8_t* data, int data_size, Imag
     header.format[2] = '\0';
     cur += 2;
 
-    ESP_LOGD(TAG, "Parsing format %s", header.format);
+    WEBINK_LOGD(TAG, "Parsing format %s", header.format);
 
     // Parse format-specific headers
     bool success = false;
@@ -74,7 +74,7 @@ bool WebInkImageProcessor::parse_header(const uint8_t* data, int data_size, Imag
             success = parse_ppm_header(cur, end, header);
             break;
         default:
-            log_message("Unsupported format: P" + std::string(1, format_char));
+            log_message("Unsupported format: P%c", format_char);
             return false;
     }
 
@@ -82,9 +82,9 @@ bool WebInkImageProcessor::parse_header(const uint8_t* data, int data_size, Imag
         header.header_bytes = cur - data;
         header.valid = true;
         
-        ESP_LOGI(TAG, "Parsed header: %dx%d %s, %d header bytes, %d data bytes",
-                 header.width, header.height, header.format,
-                 header.header_bytes, header.data_bytes);
+        WEBINK_LOGI(TAG, "Parsed header: %dx%d %s, %d header bytes, %d data bytes",
+                    header.width, header.height, header.format,
+                    header.header_bytes, header.data_bytes);
     }
 
     return success;
@@ -142,8 +142,8 @@ bool WebInkImageProcessor::parse_rows(const uint8_t* data, int data_size, const
     // Adjust num_rows if it extends beyond image
     int actual_rows = std::min(num_rows, header.height - start_row);
     
-    ESP_LOGD(TAG, "Parsing %d rows starting at row %d (format: %s)",
-             actual_rows, start_row, header.format);
+    WEBINK_LOGD(TAG, "Parsing %d rows starting at row %d (format: %s)",
+                actual_rows, start_row, header.format);
 
     // Skip to pixel data (after header)
     const uint8_t* pixel_data = data + header.header_bytes;
@@ -165,8 +165,8 @@ bool WebInkImageProcessor::parse_rows(const uint8_t* data, int data_size, const
     }
 
     if (success) {
-        ESP_LOGD(TAG, "Successfully parsed %d rows (%d bytes)",
-                 actual_rows, actual_rows * calculate_bytes_per_row(header.width, header.color_mode));
+        WEBINK_LOGD(TAG, "Successfully parsed %d rows (%d bytes)",
+                    actual_rows, actual_rows * calculate_bytes_per_row(header.width, header.color_mode));
     }
 
     return success;
@@ -203,8 +203,8 @@ bool WebInkImageProcessor::parse_pbm_data(const uint8_t* data, const ImageHeader
         start_row * bytes_per_row      // Offset to start of our rows
     );
 
-    ESP_LOGD(TAG, "Parsed PBM data (zero-copy): %d rows, %d bytes/row, offset=%d",
-             num_rows, bytes_per_row, start_row * bytes_per_row);
+    WEBINK_LOGD(TAG, "Parsed PBM data (zero-copy): %d rows, %d bytes/row, offset=%d",
+                num_rows, bytes_per_row, start_row * bytes_per_row);
 
     return true;
 }
@@ -227,15 +227,13 @@ bool WebInkImageProcessor::parse_pgm_data(const uint8_t* data, const ImageHeader
             start_row * bytes_per_row      // Offset to start of our rows
         );
 
-        ESP_LOGD(TAG, "Parsed PGM data (zero-copy): %d rows, %d bytes/row, offset=%d",
-                 num_rows, bytes_per_row, start_row * bytes_per_row);
+        WEBINK_LOGD(TAG, "Parsed PGM data (zero-copy): %d rows, %d bytes/row, offset=%d",
+                    num_rows, bytes_per_row, start_row * bytes_per_row);
     } else {
-        // ASCII PGM - unfortunately must allocate and parse text values
-        // This is unavoidable since ASCII format requires text-to-binary conversion
-        int total_bytes = bytes_per_row * num_rows;
-        uint8_t* allocated_data = new(std::nothrow) uint8_t[total_bytes];
-        if (!allocated_data) {
-            log_message("Failed to allocate " + std::to_string(total_bytes) + " bytes for ASCII PGM data");
+        // ASCII PGM - text values must be converted, into a pooled band buffer
+        PixelLease band = WebInkPixelPool::lease_band(header.width, num_rows, bytes_per_pixel);
+        if (!band) {
+            log_message("No pixel pool buffer for %d ASCII PGM rows", num_rows);
             return false;
         }
 
@@ -247,7 +245,6 @@ bool WebInkImageProcessor::parse_pgm_data(const uint8_t* data, const ImageHeader
             for (int x = 0; x < header.width; x++) {
                 int value;
                 if (!parse_integer(cur, end, value)) {
-                    delete[] allocated_data;
                     return false;
                 }
             }
@@ -258,28 +255,26 @@ bool WebInkImageProcessor::parse_pgm_data(const uint8_t* data, const ImageHeader
             for (int x = 0; x < header.width; x++) {
                 int value;
                 if (!parse_integer(cur, end, value)) {
-                    delete[] allocated_data;
                     return false;
                 }
                 
                 // Store pixel value (scale to 8-bit if needed)
                 if (bytes_per_pixel == 1) {
-                    allocated_data[y * header.width + x] = 
-                        (value * 255) / header.max_value;
+                    band.row(y)[x] = (value * 255) / header.max_value;
                 } else {
-                    // 16-bit storage
-                    uint16_t* pixel_16 = reinterpret_cast<uint16_t*>(allocated_data);
-                    pixel_16[y * header.width + x] = value;
+                    // 16-bit storage (rows are ALIGNMENT-aligned)
+                    uint16_t* pixel_16 = reinterpret_cast<uint16_t*>(band.row(y));
+                    pixel_16[x] = value;
                 }
             }
         }
 
-        // Set up PixelData with owned allocated data
-        pixels = PixelData(allocated_data, header.width, num_rows, bytes_per_pixel, 
-                          bytes_per_row, ColorMode::GRAYSCALE_8BIT, 0);
-        pixels.owns_data = true; // We own this data and must clean it up
+        // PixelData holds the lease; the buffer returns to the pool with it
+        WebInkMemory::record_access(band.data(), num_rows * band.stride());
+        pixels = PixelData(std::move(band), header.width, num_rows, bytes_per_pixel,
+                           ColorMode::GRAYSCALE_8BIT);
 
-        ESP_LOGD(TAG, "Parsed PGM data (ASCII, allocated): %d rows, %d bytes", num_rows, total_bytes);
+        WEBINK_LOGD(TAG, "Parsed PGM data (ASCII, pooled): %d rows, stride %d", num_rows, pixels.data_stride);
     }
 
     return true;
@@ -303,14 +298,13 @@ bool WebInkImageProcessor::parse_ppm_data(const uint8_t* data, const ImageHeader
             start_row * bytes_per_row      // Offset to start of our rows
         );
 
-        ESP_LOGD(TAG, "Parsed PPM data (zero-copy): %d rows, %d bytes/row, offset=%d",
-                 num_rows, bytes_per_row, start_row * bytes_per_row);
+        WEBINK_LOGD(TAG, "Parsed PPM data (zero-copy): %d rows, %d bytes/row, offset=%d",
+                    num_rows, bytes_per_row, start_row * bytes_per_row);
     } else {
-        // ASCII PPM - must allocate and parse text RGB triplets
-        int total_bytes = bytes_per_row * num_rows;
-        uint8_t* allocated_data = new(std::nothrow) uint8_t[total_bytes];
-        if (!allocated_data) {
-            log_message("Failed to allocate " + std::to_string(total_bytes) + " bytes for ASCII PPM data");
+        // ASCII PPM - text RGB triplets are converted into a pooled band buffer
+        PixelLease band = WebInkPixelPool::lease_band(header.width, num_rows, bytes_per_pixel);
+        if (!band) {
+            log_message("No pixel pool buffer for %d ASCII PPM rows", num_rows);
             return false;
         }
 
@@ -324,7 +318,6 @@ bool WebInkImageProcessor::parse_ppm_data(const uint8_t* data, const ImageHeader
                 if (!parse_integer(cur, end, r) ||
                     !parse_integer(cur, end, g) ||
                     !parse_integer(cur, end, b)) {
-                    delete[] allocated_data;
                     return false;
                 }
             }
@@ -337,23 +330,22 @@ bool WebInkImageProcessor::parse_ppm_data(const uint8_t* data, const ImageHeader
                 if (!parse_integer(cur, end, r) ||
                     !parse_integer(cur, end, g) ||
                     !parse_integer(cur, end, b)) {
-                    delete[] allocated_data;
                     return false;
                 }
                 
-                int pixel_idx = (y * header.width + x) * 3;
-                allocated_data[pixel_idx + 0] = (r * 255) / header.max_value;
-                allocated_data[pixel_idx + 1] = (g * 255) / header.max_value;
-                allocated_data[pixel_idx + 2] = (b * 255) / header.max_value;
+                uint8_t* pixel = band.row(y) + x * 3;
+                pixel[0] = (r * 255) / header.max_value;
+                pixel[1] = (g * 255) / header.max_value;
+                pixel[2] = (b * 255) / header.max_value;
             }
         }
 
-        // Set up PixelData with owned allocated data
-        pixels = PixelData(allocated_data, header.width, num_rows, bytes_per_pixel,
-                          bytes_per_row, ColorMode::RGB_FULL_COLOR, 0);
-        pixels.owns_data = true; // We own this data and must clean it up
+        // PixelData holds the lease; the buffer returns to the pool with it
+        WebInkMemory::record_access(band.data(), num_rows * band.stride());
+        pixels = PixelData(std::move(band), header.width, num_rows, bytes_per_pixel,
+                           ColorMode::RGB_FULL_COLOR);
 
-        ESP_LOGD(TAG, "Parsed PPM data (ASCII, allocated): %d rows, %d bytes", num_rows, total_bytes);
+        WEBINK_LOGD(TAG, "Parsed PPM data (ASCII, pooled): %d rows, stride %d", num_rows, pixels.data_stride);
     }
 
     return true;
@@ -388,8 +380,8 @@ int WebInkImageProcessor::calculate_max_rows_for_memory(int width, ColorMode mod
     max_rows = std::max(1, max_rows);      // Always allow at least 1 row
     max_rows = std::min(max_rows, 128);    // Cap at reasonable maximum
     
-    ESP_LOGD(TAG, "Memory calc: %d bytes available, %d bytes/row -> %d rows max",
-             available_bytes, bytes_per_row, max_rows);
+    WEBINK_LOGD(TAG, "Memory calc: %d bytes available, %d bytes/row -> %d rows max",
+                available_bytes, bytes_per_row, max_rows);
     
     return max_rows;
 }
@@ -419,8 +411,8 @@ bool WebInkImageProcessor::get_memory_allocation_recommendation(int width, int h
     
     total_chunks = (height + recommended_rows - 1) / recommended_rows; // Ceiling division
     
-    ESP_LOGD(TAG, "Memory recommendation: %d rows/chunk, %d chunks for %dx%d image",
-             recommended_rows, total_chunks, width, height);
+    WEBINK_LOGD(TAG, "Memory recommendation: %d rows/chunk, %d chunks for %dx%d image",
+                recommended_rows, total_chunks, width, height);
     
     return true;
 }
@@ -496,8 +488,8 @@ bool WebInkImageProcessor::parse_pbm_header(const uint8_t*& data, const uint8_t*
         header.data_bytes = header.width * header.height * 2; // Conservative estimate
     }
 
-    ESP_LOGD(TAG, "PBM header: %dx%d, data_bytes=%d", 
-             header.width, header.height, header.data_bytes);
+    WEBINK_LOGD(TAG, "PBM header: %dx%d, data_bytes=%d", 
+                header.width, header.height, header.data_bytes);
 
     return header.width > 0 && header.height > 0;
 }
@@ -536,8 +528,8 @@ bool WebInkImageProcessor::parse_pgm_header(const uint8_t*& data, const uint8_t*
         header.data_bytes = header.width * header.height * 4; // Conservative estimate
     }
 
-    ESP_LOGD(TAG, "PGM header: %dx%d, max=%d, data_bytes=%d", 
-             header.width, header.height, header.max_value, header.data_bytes);
+    WEBINK_LOGD(TAG, "PGM header: %dx%d, max=%d, data_bytes=%d", 
+                header.width, header.height, header.max_value, header.data_bytes);
 
     return header.width > 0 && header.height > 0 && header.max_value > 0;
 }
@@ -576,8 +568,8 @@ bool WebInkImageProcessor::parse_ppm_header(const uint8_t*& data, const uint8_t*
         header.data_bytes = header.width * header.height * bytes_per_pixel * 4; // Conservative
     }
 
-    ESP_LOGD(TAG, "PPM header: %dx%d, max=%d, data_bytes=%d", 
-             header.width, header.height, header.max_value, header.data_bytes);
+    WEBINK_LOGD(TAG, "PPM header: %dx%d, max=%d, data_bytes=%d", 
+                header.width, header.height, header.max_value, header.data_bytes);
 
     return header.width > 0 && header.height > 0 && header.max_value > 0;
 }
@@ -621,15 +613,23 @@ bool WebInkImageProcessor::parse_integer(const uint8_t*& data, const uint8_t* en
 void WebInkImageProcessor::skip_utf8_bom(const uint8_t*& data, const uint8_t* end) {
     if ((end - data) >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
         data += 3;
-        ESP_LOGD(TAG, "Skipped UTF-8 BOM");
+        WEBINK_LOGD(TAG, "Skipped UTF-8 BOM");
     }
 }
 
-void WebInkImageProcessor::log_message(const std::string& message) {
+void WebInkImageProcessor::log_message(const char* format, ...) {
+    if (!log_callback_ && !WEBINK_LOG_ENABLED(WEBINK_LOG_LEVEL_DEBUG)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    const char* message = log_vformat(format, args);
+    va_end(args);
+
     if (log_callback_) {
         log_callback_(message);
     }
-    ESP_LOGD(TAG, "%s", message.c_str());
+    WEBINK_LOGD(TAG, "%s", message);
 }
 
 } // namespace webink
@@ -23,7 +23,6 @@
 
 #include <string>
 #include <cstdint>
-#include <functional>
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
 // Mac integration test mode - use local declarations
@@ -36,6 +35,7 @@ void ESP_LOGD(const char* tag, const char* format, ...);
 #include "esphome/core/log.h"
 #endif
 
+#include "webink_log.h"
 #include "webink_types.h"
 
 namespace esphome {
@@ -97,7 +97,7 @@ public:
      * @brief Constructor with optional logging callback
      * @param log_callback Function for logging messages (optional)
      */
-    WebInkImageProcessor(std::function<void(const std::string&)> log_callback = nullptr);
+    WebInkImageProcessor(LogCallback log_callback = nullptr);
 
     /**
      * @brief Default destructor
@@ -315,7 +315,7 @@ public:
     static std::string get_format_description(const ImageHeader& header);
 
 private:
-    std::function<void(const std::string&)> log_callback_;  ///< Logging callback
+    LogCallback log_callback_;                      ///< Logging callback
     static const char* TAG;                                 ///< Logging tag
 
     //=========================================================================
@@ -410,9 +410,9 @@ private:
 
     /**
      * @brief Log parsing progress
-     * @param message Progress message
+     * @param format printf format of the message
      */
-    void log_message(const std::string& message);
+    void log_message(const char* format, ...) __attribute__((format(printf, 2, 3)));
 };
 
 } // namespace webink
@@ -0,0 +1,265 @@
+/**
+ * @file webink_json.cpp
+ * @brief Implementation of WebInkJsonParser
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_json.h"
+
+#include <climits>
+#include <cstring>
+
+namespace esphome {
+namespace webink {
+
+//=============================================================================
+// CONSTRUCTOR
+//=============================================================================
+
+WebInkJsonParser::WebInkJsonParser() : json_(nullptr), token_count_(0) {}
+
+//=============================================================================
+// TOKENIZER
+//=============================================================================
+
+bool WebInkJsonParser::parse(const char* json, size_t length) {
+    json_ = json;
+    token_count_ = 0;
+
+    if (!json || length == 0 || length > MAX_LENGTH) {
+        return false;
+    }
+
+    int parent = -1;  // Innermost open object/array
+
+    for (size_t pos = 0; pos < length; pos++) {
+        char c = json[pos];
+
+        switch (c) {
+            case '\0':
+                length = pos;  // Trailing terminator from a string buffer
+                break;
+
+            case ' ': case '\t': case '\r': case '\n': case ':': case ',':
+                break;
+
+            case '{': case '[': {
+                JsonType type = (c == '{') ? JsonType::OBJECT : JsonType::ARRAY;
+                int index = add_token(type, parent, pos, pos);
+                if (index < 0) {
+                    return false;
+                }
+                parent = index;
+                break;
+            }
+
+            case '}': case ']': {
+                JsonType type = (c == '}') ? JsonType::OBJECT : JsonType::ARRAY;
+                if (parent < 0 || tokens_[parent].type != type) {
+                    token_count_ = 0;
+                    return false;
+                }
+                tokens_[parent].end = static_cast<uint16_t>(pos + 1);
+                parent = tokens_[parent].parent;
+                break;
+            }
+
+            case '"': {
+                size_t start = pos + 1;
+                for (pos = start; pos < length && json[pos] != '"'; pos++) {
+                    if (json[pos] == '\\') {
+                        pos++;  // Skip the escaped character
+                    } else if (static_cast<unsigned char>(json[pos]) < 0x20) {
+                        token_count_ = 0;
+                        return false;
+                    }
+                }
+                if (pos >= length) {
+                    token_count_ = 0;  // Unterminated string
+                    return false;
+                }
+                if (add_token(JsonType::STRING, parent, start, pos) < 0) {
+                    return false;
+                }
+                break;
+            }
+
+            default: {
+                if (c != '-' && (c < '0' || c > '9') && c != 't' && c != 'f' && c != 'n') {
+                    token_count_ = 0;
+                    return false;
+                }
+                size_t start = pos;
+                while (pos < length && json[pos] != ',' && json[pos] != ']' && json[pos] != '}' &&
+                       json[pos] != ' ' && json[pos] != '\t' && json[pos] != '\r' &&
+                       json[pos] != '\n' && json[pos] != ':' && json[pos] != '\0') {
+                    pos++;
+                }
+                if (add_token(JsonType::PRIMITIVE, parent, start, pos) < 0) {
+                    return false;
+                }
+                pos--;  // Re-examine the delimiter
+                break;
+            }
+        }
+    }
+
+    if (parent >= 0 || token_count_ == 0) {
+        token_count_ = 0;  // Unclosed object/array or empty document
+        return false;
+    }
+    return true;
+}
+
+int WebInkJsonParser::add_token(JsonType type, int parent, size_t start, size_t end) {
+    // Only one top-level value per document
+    if (token_count_ >= MAX_TOKENS || (parent < 0 && token_count_ > 0)) {
+        token_count_ = 0;
+        return -1;
+    }
+
+    JsonToken& token = tokens_[token_count_];
+    token.type = type;
+    token.parent = static_cast<int16_t>(parent);
+    token.start = static_cast<uint16_t>(start);
+    token.end = static_cast<uint16_t>(end);
+    return token_count_++;
+}
+
+//=============================================================================
+// ACCESSORS
+//=============================================================================
+
+int WebInkJsonParser::find(const char* key) const {
+    if (token_count_ == 0 || tokens_[0].type != JsonType::OBJECT || !key) {
+        return -1;
+    }
+
+    // Direct children of the root alternate key, value; nested tokens have
+    // another parent and are passed over
+    bool at_key = true;
+    int key_index = -1;
+    for (int i = 1; i < token_count_; i++) {
+        if (tokens_[i].parent != 0) {
+            continue;
+        }
+        if (at_key) {
+            key_index = i;
+        } else if (tokens_[key_index].type == JsonType::STRING && token_equals(key_index, key)) {
+            return i;
+        }
+        at_key = !at_key;
+    }
+    return -1;
+}
+
+bool WebInkJsonParser::token_equals(int index, const char* key) const {
+    const JsonToken& token = tokens_[index];
+    size_t length = token.end - token.start;
+    return strlen(key) == length && memcmp(json_ + token.start, key, length) == 0;
+}
+
+bool WebInkJsonParser::get_string(const char* key, char* out, size_t out_size) const {
+    if (!out || out_size == 0) {
+        return false;
+    }
+    out[0] = '\0';
+
+    int index = find(key);
+    if (index < 0 || tokens_[index].type != JsonType::STRING) {
+        return false;
+    }
+
+    const JsonToken& token = tokens_[index];
+    size_t written = 0;
+    for (size_t pos = token.start; pos < token.end; pos++) {
+        char c = json_[pos];
+
+        if (c == '\\' && pos + 1 < token.end) {
+            char escaped = json_[++pos];
+            switch (escaped) {
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u': {
+                    unsigned int code = 0;
+                    for (int i = 0; i < 4 && pos + 1 < token.end; i++) {
+                        char h = json_[++pos];
+                        code <<= 4;
+                        if (h >= '0' && h <= '9') code |= h - '0';
+                        else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+                        else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+                    }
+                    c = (code > 0 && code < 0x80) ? static_cast<char>(code) : '?';
+                    break;
+                }
+                default: c = escaped; break;  // \" \\ \/
+            }
+        }
+
+        if (written + 1 >= out_size) {
+            out[written] = '\0';
+            return false;  // Does not fit
+        }
+        out[written++] = c;
+    }
+
+    out[written] = '\0';
+    return true;
+}
+
+bool WebInkJsonParser::get_int(const char* key, int& value) const {
+    int index = find(key);
+    if (index < 0 || tokens_[index].type != JsonType::PRIMITIVE) {
+        return false;
+    }
+
+    const JsonToken& token = tokens_[index];
+    size_t pos = token.start;
+    bool negative = (json_[pos] == '-');
+    if (negative) {
+        pos++;
+    }
+    if (pos >= token.end || json_[pos] < '0' || json_[pos] > '9') {
+        return false;  // true/false/null
+    }
+
+    // Clamp before multiplying: long is 32 bits on the ESP32, so an
+    // over-long number must never reach INT_MAX * 10
+    int parsed = 0;
+    for (; pos < token.end && json_[pos] >= '0' && json_[pos] <= '9'; pos++) {
+        int digit = json_[pos] - '0';
+        if (parsed > (INT_MAX - digit) / 10) {
+            parsed = INT_MAX;
+        } else {
+            parsed = parsed * 10 + digit;
+        }
+    }
+
+    value = negative ? -parsed : parsed;
+    return true;
+}
+
+bool WebInkJsonParser::get_bool(const char* key, bool& value) const {
+    int index = find(key);
+    if (index < 0 || tokens_[index].type != JsonType::PRIMITIVE) {
+        return false;
+    }
+
+    if (token_equals(index, "true")) {
+        value = true;
+        return true;
+    }
+    if (token_equals(index, "false")) {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+} // namespace webink
+} // namespace esphome
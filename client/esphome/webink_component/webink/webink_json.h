@@ -0,0 +1,159 @@
+/**
+ * @file webink_json.h
+ * @brief Zero-allocation JSON tokenizer for server responses
+ *
+ * A jsmn-style tokenizer: one pass over the response buffer fills a fixed
+ * token array with offsets into that buffer. Nothing is copied or allocated
+ * while parsing; typed accessors read values straight out of the buffer and
+ * copy strings only into caller-provided storage.
+ *
+ * Any whitespace and key order is accepted. Server responses are small flat
+ * objects ({"hash": "abcd1234", "sleep_seconds": 1800}), so the accessors
+ * look up keys of the top-level object; nested values are tokenized and
+ * skipped.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum JsonType
+ * @brief Kind of a JSON token
+ */
+enum class JsonType : uint8_t {
+    UNDEFINED = 0,
+    OBJECT = 1,
+    ARRAY = 2,
+    STRING = 3,     ///< Offsets exclude the quotes; escapes are left in place
+    PRIMITIVE = 4   ///< Number, true, false or null
+};
+
+/**
+ * @struct JsonToken
+ * @brief Position of one JSON value in the parsed buffer (8 bytes)
+ */
+struct JsonToken {
+    JsonType type;
+    int16_t parent;     ///< Index of the enclosing object/array (-1 = top level)
+    uint16_t start;     ///< Offset of the first byte
+    uint16_t end;       ///< Offset one past the last byte
+};
+
+/**
+ * @class WebInkJsonParser
+ * @brief Fixed-capacity JSON tokenizer with typed accessors
+ *
+ * The parser keeps a pointer into the buffer passed to parse(), which must
+ * stay alive and unchanged while accessors are used. Keep one instance as a
+ * member and reuse it; it holds MAX_TOKENS tokens (256 bytes).
+ *
+ * @example Parsing a hash response
+ * @code
+ * char hash[17];
+ * int sleep_seconds = -1;
+ * if (json.parse(result.data.data(), result.data.size()) &&
+ *     json.get_string("hash", hash, sizeof(hash))) {
+ *     json.get_int("sleep_seconds", sleep_seconds);  // optional field
+ * }
+ * @endcode
+ */
+class WebInkJsonParser {
+public:
+    static const int MAX_TOKENS = 32;                           ///< Tokens per response
+    static const size_t MAX_LENGTH = 65535;                     ///< Largest buffer offsets can address
+
+    /**
+     * @brief Constructor
+     */
+    WebInkJsonParser();
+
+    /**
+     * @brief Tokenize a JSON document
+     * @param json Buffer holding the document (need not be null-terminated)
+     * @param length Number of bytes in json
+     * @return True if the document is well-formed and fits in MAX_TOKENS
+     */
+    bool parse(const char* json, size_t length);
+
+    /**
+     * @brief Get number of tokens from the last successful parse()
+     * @return Token count (0 after a failed parse)
+     */
+    int get_token_count() const { return token_count_; }
+
+    /**
+     * @brief Get a token
+     * @param index Token index (0 = root)
+     * @return Token at index
+     */
+    const JsonToken& get_token(int index) const { return tokens_[index]; }
+
+    /**
+     * @brief Find a value in the top-level object
+     * @param key Key to look for
+     * @return Index of the value token, or -1 if absent (or the root is not an object)
+     */
+    int find(const char* key) const;
+
+    /**
+     * @brief Check whether the top-level object has a key
+     * @param key Key to look for
+     * @return True if present
+     */
+    bool has(const char* key) const { return find(key) >= 0; }
+
+    /**
+     * @brief Copy a string value into caller storage, resolving escapes
+     * @param key Key in the top-level object
+     * @param out Output buffer (always null-terminated when size > 0)
+     * @param out_size Size of out
+     * @return True if the key holds a string that fits in out
+     *
+     * \\uXXXX escapes outside ASCII are replaced with '?'.
+     */
+    bool get_string(const char* key, char* out, size_t out_size) const;
+
+    /**
+     * @brief Read an integer value
+     * @param key Key in the top-level object
+     * @param[out] value Parsed value (unchanged on failure)
+     * @return True if the key holds a number; a fraction is truncated and
+     *         a magnitude beyond INT_MAX is clamped to it
+     */
+    bool get_int(const char* key, int& value) const;
+
+    /**
+     * @brief Read a boolean value
+     * @param key Key in the top-level object
+     * @param[out] value Parsed value (unchanged on failure)
+     * @return True if the key holds true or false
+     */
+    bool get_bool(const char* key, bool& value) const;
+
+private:
+    /**
+     * @brief Claim the next token slot
+     * @return Token index, or -1 if MAX_TOKENS are in use
+     */
+    int add_token(JsonType type, int parent, size_t start, size_t end);
+
+    /**
+     * @brief Compare a string token with a key
+     */
+    bool token_equals(int index, const char* key) const;
+
+    const char* json_;                                          ///< Buffer from the last parse() (not owned)
+    JsonToken tokens_[MAX_TOKENS];                              ///< Token array
+    int token_count_;                                           ///< Tokens in use
+};
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,63 @@
+/**
+ * @file webink_log.cpp
+ * @brief Implementation of the log rate limiter and fixed-buffer formatter
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_log.h"
+
+#include <cstdio>
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esphome/core/helpers.h"
+#else
+unsigned long millis();
+#endif
+
+namespace esphome {
+namespace webink {
+
+//=============================================================================
+// RATE LIMITING
+//=============================================================================
+
+bool WebInkLogRate::allow(uint32_t interval_ms) {
+    uint32_t now = millis();
+    if (started_ && (now - last_ms_) < interval_ms) {
+        suppressed_++;
+        return false;
+    }
+    started_ = true;
+    last_ms_ = now;
+    return true;
+}
+
+uint32_t WebInkLogRate::take_suppressed() {
+    uint32_t suppressed = suppressed_;
+    suppressed_ = 0;
+    return suppressed;
+}
+
+//=============================================================================
+// FORMATTING
+//=============================================================================
+
+const char* log_format(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const char* text = log_vformat(format, args);
+    va_end(args);
+    return text;
+}
+
+const char* log_vformat(const char* format, va_list args) {
+    // Static so log_message() paths neither allocate nor grow the loop task stack
+    static char buffer[LOG_FORMAT_BUFFER_SIZE];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    return buffer;
+}
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,179 @@
+/**
+ * @file webink_log.h
+ * @brief Compile-time log level gating and rate-limited hot-path logging
+ *
+ * The WEBINK_LOGx macros wrap ESP_LOGx behind a component log level,
+ * WEBINK_LOG_LEVEL (the `log_level` YAML option, defaulting to the ESPHome
+ * logger level). A level above WEBINK_LOG_LEVEL expands to an `if (false)`
+ * branch: the arguments are never evaluated and the optimizer drops the
+ * call, format string included.
+ *
+ * Per-chunk and per-slice messages use the _RATE variants, which print at
+ * most once per interval from each call site and report how many messages
+ * were suppressed since the last one printed.
+ *
+ * log_format() formats into a fixed static buffer, for the log_message()
+ * helpers that also forward text to a callback and previously built it
+ * with std::string concatenation.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esphome/core/log.h"
+#else
+// Mac integration test mode - the test harness defines these
+void ESP_LOGE(const char* tag, const char* format, ...);
+void ESP_LOGW(const char* tag, const char* format, ...);
+void ESP_LOGI(const char* tag, const char* format, ...);
+void ESP_LOGD(const char* tag, const char* format, ...);
+void ESP_LOGV(const char* tag, const char* format, ...);
+#endif
+
+#define WEBINK_LOG_LEVEL_NONE 0
+#define WEBINK_LOG_LEVEL_ERROR 1
+#define WEBINK_LOG_LEVEL_WARN 2
+#define WEBINK_LOG_LEVEL_INFO 3
+#define WEBINK_LOG_LEVEL_CONFIG 4
+#define WEBINK_LOG_LEVEL_DEBUG 5
+#define WEBINK_LOG_LEVEL_VERBOSE 6
+
+#ifndef WEBINK_LOG_LEVEL
+#ifdef ESPHOME_LOG_LEVEL
+#define WEBINK_LOG_LEVEL ESPHOME_LOG_LEVEL
+#else
+#define WEBINK_LOG_LEVEL WEBINK_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+/// True when messages of `level` are compiled in (usable in `if` and `#if`)
+#define WEBINK_LOG_ENABLED(level) (WEBINK_LOG_LEVEL >= (level))
+
+/// Disabled level: arguments stay referenced (no unused warnings) but are never evaluated
+#define WEBINK_LOG_NOTHING_(...) do { if (false) { ::esphome::webink::log_discard(__VA_ARGS__); } } while (0)
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_ERROR
+#define WEBINK_LOGE(tag, ...) ESP_LOGE(tag, __VA_ARGS__)
+#else
+#define WEBINK_LOGE(tag, ...) WEBINK_LOG_NOTHING_(tag, __VA_ARGS__)
+#endif
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_WARN
+#define WEBINK_LOGW(tag, ...) ESP_LOGW(tag, __VA_ARGS__)
+#else
+#define WEBINK_LOGW(tag, ...) WEBINK_LOG_NOTHING_(tag, __VA_ARGS__)
+#endif
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_INFO
+#define WEBINK_LOGI(tag, ...) ESP_LOGI(tag, __VA_ARGS__)
+#else
+#define WEBINK_LOGI(tag, ...) WEBINK_LOG_NOTHING_(tag, __VA_ARGS__)
+#endif
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_DEBUG
+#define WEBINK_LOGD(tag, ...) ESP_LOGD(tag, __VA_ARGS__)
+#else
+#define WEBINK_LOGD(tag, ...) WEBINK_LOG_NOTHING_(tag, __VA_ARGS__)
+#endif
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_VERBOSE
+#define WEBINK_LOGV(tag, ...) ESP_LOGV(tag, __VA_ARGS__)
+#else
+#define WEBINK_LOGV(tag, ...) WEBINK_LOG_NOTHING_(tag, __VA_ARGS__)
+#endif
+
+/**
+ * Print through `log_macro` at most once per `interval_ms` from this call
+ * site; the first message after a quiet period carries the number dropped.
+ */
+#define WEBINK_LOG_RATE_(log_macro, tag, interval_ms, format, ...)                          \
+    do {                                                                                    \
+        static ::esphome::webink::WebInkLogRate webink_log_rate_;                           \
+        if (webink_log_rate_.allow(interval_ms)) {                                          \
+            uint32_t webink_log_suppressed_ = webink_log_rate_.take_suppressed();           \
+            if (webink_log_suppressed_ > 0) {                                               \
+                log_macro(tag, format " (+%u suppressed)", ##__VA_ARGS__,                  \
+                          (unsigned) webink_log_suppressed_);                               \
+            } else {                                                                        \
+                log_macro(tag, format, ##__VA_ARGS__);                                      \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_INFO
+#define WEBINK_LOGI_RATE(tag, interval_ms, format, ...) \
+    WEBINK_LOG_RATE_(ESP_LOGI, tag, interval_ms, format, ##__VA_ARGS__)
+#else
+#define WEBINK_LOGI_RATE(tag, interval_ms, format, ...) \
+    WEBINK_LOG_NOTHING_(tag, interval_ms, format, ##__VA_ARGS__)
+#endif
+
+#if WEBINK_LOG_LEVEL >= WEBINK_LOG_LEVEL_DEBUG
+#define WEBINK_LOGD_RATE(tag, interval_ms, format, ...) \
+    WEBINK_LOG_RATE_(ESP_LOGD, tag, interval_ms, format, ##__VA_ARGS__)
+#else
+#define WEBINK_LOGD_RATE(tag, interval_ms, format, ...) \
+    WEBINK_LOG_NOTHING_(tag, interval_ms, format, ##__VA_ARGS__)
+#endif
+
+namespace esphome {
+namespace webink {
+
+static const uint32_t LOG_RATE_INTERVAL_MS = 1000;             ///< Default interval of the _RATE macros
+static const size_t LOG_FORMAT_BUFFER_SIZE = 160;               ///< log_format() output, including NUL
+
+/**
+ * @class WebInkLogRate
+ * @brief Interval limiter with a suppressed-message counter
+ *
+ * One instance per call site (the _RATE macros declare a function-local
+ * static). The first message always passes.
+ */
+class WebInkLogRate {
+public:
+    /**
+     * @brief Decide whether a message may be printed now
+     * @param interval_ms Minimum time between printed messages
+     * @return True to print; false counts the message as suppressed
+     */
+    bool allow(uint32_t interval_ms);
+
+    /**
+     * @brief Get and clear the number of suppressed messages
+     * @return Messages suppressed since the last call
+     */
+    uint32_t take_suppressed();
+
+private:
+    uint32_t last_ms_ = 0;                                      ///< Time of the last printed message
+    uint32_t suppressed_ = 0;                                   ///< Messages dropped since then
+    bool started_ = false;                                      ///< A message has been printed
+};
+
+/**
+ * @brief Sink of the disabled log macros (only referenced in dead code)
+ */
+template<typename... Args> inline void log_discard(Args&&...) {}
+
+/**
+ * @brief Format into the shared fixed log buffer
+ * @param format printf format
+ * @return Formatted text, truncated to LOG_FORMAT_BUFFER_SIZE - 1 characters;
+ *         valid until the next call (main loop only)
+ */
+const char* log_format(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief va_list variant of log_format()
+ */
+const char* log_vformat(const char* format, va_list args);
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,288 @@
+/**
+ * @file webink_log_buffer.cpp
+ * @brief Implementation of WebInkLogBuffer
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_log_buffer.h"
+#include "webink_log.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esp_attr.h"
+#define WEBINK_RTC_NOINIT RTC_NOINIT_ATTR
+#else
+unsigned long millis();
+void ESP_LOGI(const char* tag, const char* format, ...);
+void ESP_LOGW(const char* tag, const char* format, ...);
+void ESP_LOGD(const char* tag, const char* format, ...);
+#define WEBINK_RTC_NOINIT
+#endif
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkLogBuffer::TAG = "webink.logbuf";
+
+namespace {
+
+/**
+ * Ring as stored in RTC memory. head is the offset of the oldest record;
+ * records are written at (head + used) and wrap at CAPACITY.
+ */
+struct __attribute__((packed)) RtcLogRing {
+    uint32_t magic;                     ///< RTC_LOG_MAGIC
+    uint16_t head;                      ///< Offset of the oldest record
+    uint16_t used;                      ///< Bytes in use
+    uint16_t records;                   ///< Records in use
+    uint16_t dropped;                   ///< Records dropped since the last upload
+    uint16_t errors;                    ///< ERROR records in use
+    uint16_t reserved;
+    uint8_t data[WebInkLogBuffer::CAPACITY];
+};
+
+const uint32_t RTC_LOG_MAGIC = 0x57494C47;  // "WILG"
+
+// Survives deep sleep; garbage after power loss (rejected by validate())
+WEBINK_RTC_NOINIT RtcLogRing rtc_log_ring;
+
+/**
+ * Record header for the current millis() (layout in webink_log_buffer.h)
+ */
+void encode_record_header(uint8_t* header, LogSeverity severity, int wake, size_t length) {
+    uint32_t uptime_ms = static_cast<uint32_t>(millis());
+    uint16_t wake16 = static_cast<uint16_t>(wake);
+    header[0] = static_cast<uint8_t>(severity);
+    header[1] = static_cast<uint8_t>(length);
+    header[2] = static_cast<uint8_t>(wake16 & 0xFF);
+    header[3] = static_cast<uint8_t>(wake16 >> 8);
+    header[4] = static_cast<uint8_t>(uptime_ms & 0xFF);
+    header[5] = static_cast<uint8_t>((uptime_ms >> 8) & 0xFF);
+    header[6] = static_cast<uint8_t>((uptime_ms >> 16) & 0xFF);
+    header[7] = static_cast<uint8_t>(uptime_ms >> 24);
+}
+
+} // namespace
+
+//=============================================================================
+// CONSTRUCTOR
+//=============================================================================
+
+WebInkLogBuffer::WebInkLogBuffer() {
+    if (rtc_log_ring.magic != RTC_LOG_MAGIC) {
+        WEBINK_LOGD(TAG, "[LOGBUF] No saved log ring (power-on) - starting empty");
+        clear();
+        rtc_log_ring.magic = RTC_LOG_MAGIC;
+    } else if (!validate()) {
+        WEBINK_LOGW(TAG, "[LOGBUF] Log ring corrupt - discarding");
+        clear();
+    } else {
+        WEBINK_LOGD(TAG, "[LOGBUF] Restored %u records (%u bytes)",
+                    (unsigned) rtc_log_ring.records, (unsigned) rtc_log_ring.used);
+    }
+}
+
+bool WebInkLogBuffer::validate() const {
+    const RtcLogRing& ring = rtc_log_ring;
+    if (ring.head >= CAPACITY || ring.used > CAPACITY) {
+        return false;
+    }
+
+    // Record lengths must add up to exactly `used` bytes and `records` records
+    size_t walked = 0;
+    int records = 0;
+    int errors = 0;
+    while (walked < ring.used) {
+        uint8_t header[RECORD_HEADER_SIZE];
+        if (ring.used - walked < RECORD_HEADER_SIZE) {
+            return false;
+        }
+        read_bytes(ring.head + walked, header, RECORD_HEADER_SIZE);
+        if (header[0] > static_cast<uint8_t>(LogSeverity::MEMORY) || header[1] > MAX_TEXT_LENGTH) {
+            return false;
+        }
+        if (header[0] == static_cast<uint8_t>(LogSeverity::ERROR)) {
+            errors++;
+        }
+        walked += RECORD_HEADER_SIZE + header[1];
+        records++;
+    }
+    return walked == ring.used && records == ring.records && errors == ring.errors;
+}
+
+//=============================================================================
+// RECORDING
+//=============================================================================
+
+void WebInkLogBuffer::record(LogSeverity severity, int wake, const char* text) {
+    size_t length = text ? strnlen(text, MAX_TEXT_LENGTH) : 0;
+    record_data(severity, wake, reinterpret_cast<const uint8_t*>(text), length);
+}
+
+void WebInkLogBuffer::record_data(LogSeverity severity, int wake, const uint8_t* data, size_t length) {
+    RtcLogRing& ring = rtc_log_ring;
+    if (!data || length > MAX_TEXT_LENGTH) {
+        length = data ? MAX_TEXT_LENGTH : 0;
+    }
+    size_t size = RECORD_HEADER_SIZE + length;
+
+    while (CAPACITY - ring.used < size) {
+        drop_oldest();
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE];
+    encode_record_header(header, severity, wake, length);
+
+    // Write the bytes before publishing them through used/records, so a reset
+    // mid-append leaves the ring consistent
+    size_t offset = ring.head + ring.used;
+    write_bytes(offset, header, RECORD_HEADER_SIZE);
+    write_bytes(offset + RECORD_HEADER_SIZE, data, length);
+    ring.used = static_cast<uint16_t>(ring.used + size);
+    ring.records++;
+    if (severity == LogSeverity::ERROR) {
+        ring.errors++;
+    }
+}
+
+void WebInkLogBuffer::recordf(LogSeverity severity, int wake, const char* format, ...) {
+    // Static to keep the formatting buffer off the loop task stack
+    static char text[MAX_TEXT_LENGTH + 1];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    record(severity, wake, text);
+}
+
+void WebInkLogBuffer::drop_oldest() {
+    RtcLogRing& ring = rtc_log_ring;
+    if (ring.records == 0) {
+        return;
+    }
+
+    uint8_t header[2];
+    read_bytes(ring.head, header, sizeof(header));
+    size_t size = RECORD_HEADER_SIZE + header[1];
+
+    ring.head = static_cast<uint16_t>((ring.head + size) % CAPACITY);
+    ring.used = static_cast<uint16_t>(ring.used - size);
+    ring.records--;
+    if (header[0] == static_cast<uint8_t>(LogSeverity::ERROR) && ring.errors > 0) {
+        ring.errors--;
+    }
+    if (ring.dropped < 0xFFFF) {
+        ring.dropped++;
+    }
+}
+
+//=============================================================================
+// UPLOAD
+//=============================================================================
+
+bool WebInkLogBuffer::is_nearly_full() const {
+    return rtc_log_ring.used * 100 >= CAPACITY * FLUSH_FILL_PERCENT;
+}
+
+bool WebInkLogBuffer::is_flush_due(int wake) const {
+    const RtcLogRing& ring = rtc_log_ring;
+    if (ring.records == 0) {
+        return false;
+    }
+    if (ring.errors > 0 || is_nearly_full()) {
+        return true;
+    }
+
+    uint8_t header[4];
+    read_bytes(ring.head, header, sizeof(header));
+    uint16_t oldest_wake = static_cast<uint16_t>(header[2] | (header[3] << 8));
+    return static_cast<uint16_t>(static_cast<uint16_t>(wake) - oldest_wake) >= FLUSH_MAX_WAKES;
+}
+
+size_t WebInkLogBuffer::build_batch(uint8_t* out, size_t size) const {
+    const RtcLogRing& ring = rtc_log_ring;
+    if (size < BATCH_HEADER_SIZE + ring.used) {
+        return 0;
+    }
+
+    memcpy(out, "WLOG", 4);
+    out[4] = BATCH_VERSION;
+    out[5] = 0;
+    out[6] = static_cast<uint8_t>(ring.dropped & 0xFF);
+    out[7] = static_cast<uint8_t>(ring.dropped >> 8);
+
+    // At most two contiguous spans
+    size_t first = CAPACITY - ring.head;
+    if (first > ring.used) {
+        first = ring.used;
+    }
+    memcpy(out + BATCH_HEADER_SIZE, ring.data + ring.head, first);
+    memcpy(out + BATCH_HEADER_SIZE + first, ring.data, ring.used - first);
+    return BATCH_HEADER_SIZE + ring.used;
+}
+
+size_t WebInkLogBuffer::append_record(uint8_t* out, size_t size, size_t used, LogSeverity severity,
+                                      int wake, const uint8_t* data, size_t length) {
+    if (!data || length > MAX_TEXT_LENGTH) {
+        length = data ? MAX_TEXT_LENGTH : 0;
+    }
+    if (used + RECORD_HEADER_SIZE + length > size) {
+        return used;
+    }
+    encode_record_header(out + used, severity, wake, length);
+    if (length > 0) {
+        memcpy(out + used + RECORD_HEADER_SIZE, data, length);
+    }
+    return used + RECORD_HEADER_SIZE + length;
+}
+
+void WebInkLogBuffer::clear() {
+    rtc_log_ring.head = 0;
+    rtc_log_ring.used = 0;
+    rtc_log_ring.records = 0;
+    rtc_log_ring.errors = 0;
+    rtc_log_ring.dropped = 0;
+}
+
+//=============================================================================
+// STATUS
+//=============================================================================
+
+int WebInkLogBuffer::get_record_count() const {
+    return rtc_log_ring.records;
+}
+
+size_t WebInkLogBuffer::get_used_bytes() const {
+    return rtc_log_ring.used;
+}
+
+int WebInkLogBuffer::get_dropped_count() const {
+    return rtc_log_ring.dropped;
+}
+
+//=============================================================================
+// RING ACCESS
+//=============================================================================
+
+void WebInkLogBuffer::read_bytes(size_t offset, uint8_t* out, size_t length) const {
+    for (size_t i = 0; i < length; i++) {
+        out[i] = rtc_log_ring.data[(offset + i) % CAPACITY];
+    }
+}
+
+void WebInkLogBuffer::write_bytes(size_t offset, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        rtc_log_ring.data[(offset + i) % CAPACITY] = data[i];
+    }
+}
+
+} // namespace webink
+} // namespace esphome
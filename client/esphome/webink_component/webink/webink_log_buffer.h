@@ -0,0 +1,199 @@
+/**
+ * @file webink_log_buffer.h
+ * @brief Batched server log upload via an RTC memory ring buffer
+ *
+ * Status and error messages used to be posted to /post_log one request at a
+ * time - including a "DEEP_SLEEP: BLOCKED" message every 30 s and one message
+ * per sleep entry. WebInkLogBuffer collects them instead in a fixed-size
+ * binary ring that lives in RTC memory, so it survives deep sleep, and the
+ * controller uploads the whole ring in one POST to /post_log_batch when the
+ * radio is up anyway and an upload is due.
+ *
+ * Record layout (little-endian, no padding):
+ * @code
+ * uint8_t  severity;     // LogSeverity
+ * uint8_t  length;       // Payload bytes that follow (<= MAX_TEXT_LENGTH)
+ * uint16_t wake;         // Low 16 bits of the wake counter
+ * uint32_t uptime_ms;    // millis() when recorded
+ * char     text[length]; // Not null-terminated (binary for TELEMETRY, TIMING, MEMORY)
+ * @endcode
+ *
+ * A batch body is an 8-byte header ("WLOG", uint8_t version, uint8_t 0,
+ * uint16_t dropped) followed by the records, oldest first.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdarg>
+#include <string>
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum LogSeverity
+ * @brief Severity of a buffered log record
+ */
+enum class LogSeverity : uint8_t {
+    INFO = 0,
+    WARNING = 1,
+    ERROR = 2,      ///< Makes the buffer due for upload at the next opportunity
+    TELEMETRY = 3,  ///< Binary WebInkTelemetry record instead of text
+    TIMING = 4,     ///< Binary per-state timing summary instead of text
+    MEMORY = 5      ///< Binary per-state memory minima instead of text
+};
+
+/**
+ * @class WebInkLogBuffer
+ * @brief Fixed-size log ring persisted in RTC memory across deep sleep
+ *
+ * There is one ring per device; every instance is a view of the same RTC
+ * storage. The ring is validated on construction (magic and a walk over the
+ * record lengths) and reset after power loss or corruption. When full, the
+ * oldest records are dropped and counted.
+ *
+ * @example Recording and flushing
+ * @code
+ * log_buffer.record(LogSeverity::INFO, state.wake_counter, "Update complete");
+ * if (log_buffer.is_flush_due(state.wake_counter)) {
+ *     static uint8_t body[WebInkLogBuffer::BATCH_CAPACITY];
+ *     size_t length = log_buffer.build_batch(body, sizeof(body));
+ *     // POST body, then log_buffer.clear() on success
+ * }
+ * @endcode
+ */
+class WebInkLogBuffer {
+public:
+    static const size_t CAPACITY = 1024;                        ///< Ring bytes in RTC memory
+    static const size_t RECORD_HEADER_SIZE = 8;                 ///< Bytes before the text of a record
+    static const size_t MAX_TEXT_LENGTH = 160;                  ///< Longer messages are truncated
+    static const size_t BATCH_HEADER_SIZE = 8;                  ///< Bytes before the records of a batch
+    static const size_t BATCH_CAPACITY = BATCH_HEADER_SIZE + CAPACITY +
+                                         2 * (RECORD_HEADER_SIZE + MAX_TEXT_LENGTH);  ///< Batch with two appended records
+    static const uint8_t BATCH_VERSION = 1;                     ///< Batch body layout version
+    static const int FLUSH_FILL_PERCENT = 75;                   ///< Upload when this full
+    static const int FLUSH_MAX_WAKES = 8;                       ///< Upload when the oldest record is this old
+
+    /**
+     * @brief Constructor - validates the RTC ring or resets it
+     */
+    WebInkLogBuffer();
+
+    //=========================================================================
+    // RECORDING
+    //=========================================================================
+
+    /**
+     * @brief Append a message, dropping the oldest records if needed
+     * @param severity Record severity
+     * @param wake Current wake counter
+     * @param text Message (truncated to MAX_TEXT_LENGTH)
+     */
+    void record(LogSeverity severity, int wake, const char* text);
+
+    /**
+     * @brief Append a binary payload, dropping the oldest records if needed
+     * @param severity Record severity (TELEMETRY for binary records)
+     * @param wake Current wake counter
+     * @param data Payload
+     * @param length Payload bytes (truncated to MAX_TEXT_LENGTH)
+     */
+    void record_data(LogSeverity severity, int wake, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Append a printf-style message (formatted into a static buffer)
+     * @param severity Record severity
+     * @param wake Current wake counter
+     * @param format printf format string
+     */
+    void recordf(LogSeverity severity, int wake, const char* format, ...)
+        __attribute__((format(printf, 4, 5)));
+
+    //=========================================================================
+    // UPLOAD
+    //=========================================================================
+
+    /**
+     * @brief Check whether the ring should be uploaded now
+     * @param wake Current wake counter
+     * @return True if an error is buffered, the ring is FLUSH_FILL_PERCENT
+     *         full, or the oldest record is FLUSH_MAX_WAKES wakes old
+     */
+    bool is_flush_due(int wake) const;
+
+    /**
+     * @brief Check whether the ring is FLUSH_FILL_PERCENT full
+     * @return True if nearly full
+     */
+    bool is_nearly_full() const;
+
+    /**
+     * @brief Serialize all buffered records as a batch body
+     * @param[out] out Batch header followed by the records, oldest first
+     * @param size Size of out (BATCH_CAPACITY always fits)
+     * @return Bytes written, or 0 if out is too small
+     */
+    size_t build_batch(uint8_t* out, size_t size) const;
+
+    /**
+     * @brief Append one record to a batch body without storing it in the ring
+     * @param[in,out] out Batch body from build_batch()
+     * @param size Size of out
+     * @param used Bytes of out already filled
+     * @param severity Record severity
+     * @param wake Current wake counter
+     * @param data Payload
+     * @param length Payload bytes (truncated to MAX_TEXT_LENGTH)
+     * @return New body length (unchanged if the record does not fit)
+     *
+     * For summaries that are rebuilt on every upload (TIMING, MEMORY), so a
+     * failed upload does not leave copies behind in the ring.
+     */
+    static size_t append_record(uint8_t* out, size_t size, size_t used, LogSeverity severity,
+                                int wake, const uint8_t* data, size_t length);
+
+    /**
+     * @brief Drop all records (after a successful upload)
+     */
+    void clear();
+
+    //=========================================================================
+    // STATUS
+    //=========================================================================
+
+    int get_record_count() const;                               ///< Buffered records
+    size_t get_used_bytes() const;                              ///< Buffered bytes
+    int get_dropped_count() const;                              ///< Records dropped since the last upload
+
+private:
+    /**
+     * @brief Check that the RTC ring is intact
+     * @return True if the header is sane and the records add up
+     */
+    bool validate() const;
+
+    /**
+     * @brief Drop the oldest record
+     */
+    void drop_oldest();
+
+    /**
+     * @brief Copy bytes out of the ring, wrapping at CAPACITY
+     */
+    void read_bytes(size_t offset, uint8_t* out, size_t length) const;
+
+    /**
+     * @brief Copy bytes into the ring, wrapping at CAPACITY
+     */
+    void write_bytes(size_t offset, const uint8_t* data, size_t length);
+
+    static const char* TAG;                                     ///< Logging tag
+};
+
+} // namespace webink
+} // namespace esphome
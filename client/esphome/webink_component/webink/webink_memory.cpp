@@ -0,0 +1,305 @@
+/**
+ * @file webink_memory.cpp
+ * @brief Implementation of WebInkMemory
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_memory.h"
+#include "webink_log.h"
+
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+#include <new>
+#else
+#include "esp_heap_caps.h"
+#endif
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkMemory::TAG = "webink.memory";
+
+namespace {
+
+struct TrackedBuffer {
+    const uint8_t* start;
+    size_t size;
+    size_t align;
+    MemoryRole role;
+    MemoryRegion region;
+    bool is_static;
+    bool in_use;
+};
+
+// Framebuffers and caches are large and touched once per refresh; rows
+// and decoder state are touched per pixel
+Placement role_placement[MEMORY_ROLE_COUNT] = {
+    Placement::PREFER_EXTERNAL,   // FRAMEBUFFER
+    Placement::PREFER_INTERNAL,   // SLICE
+    Placement::INTERNAL_ONLY,     // PIXEL_ROWS
+    Placement::INTERNAL_ONLY,     // DECOMPRESSOR
+    Placement::PREFER_EXTERNAL,   // CACHE
+};
+
+TrackedBuffer buffers[WebInkMemory::MAX_BUFFERS] = {};
+size_t region_used[MEMORY_REGION_COUNT] = {};
+size_t region_peak[MEMORY_REGION_COUNT] = {};
+uint32_t placement_fallbacks = 0;
+uint32_t allocation_failures = 0;
+
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+// Defaults: 320 KB SRAM at ~400 MB/s, 2 MB quad-SPI PSRAM at ~80 MB/s
+RegionModel region_model[MEMORY_REGION_COUNT] = {
+    {320 * 1024, 2500},
+    {2 * 1024 * 1024, 12500},
+};
+uint64_t access_bytes[MEMORY_REGION_COUNT] = {};
+uint64_t access_ns[MEMORY_REGION_COUNT] = {};
+#endif
+
+int index_of(MemoryRegion region) {
+    return static_cast<int>(region);
+}
+
+TrackedBuffer* find_buffer(const void* ptr) {
+    const uint8_t* p = static_cast<const uint8_t*>(ptr);
+    for (TrackedBuffer& buffer : buffers) {
+        if (buffer.in_use && p >= buffer.start && p < buffer.start + buffer.size) {
+            return &buffer;
+        }
+    }
+    return nullptr;
+}
+
+TrackedBuffer* free_slot() {
+    for (TrackedBuffer& buffer : buffers) {
+        if (!buffer.in_use) {
+            return &buffer;
+        }
+    }
+    return nullptr;
+}
+
+void* region_allocate(MemoryRegion region, size_t size, size_t align) {
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+    size_t capacity = region_model[index_of(region)].capacity;
+    size_t used = region_used[index_of(region)];
+    if (used > capacity || size > capacity - used) {
+        return nullptr;
+    }
+    return ::operator new(size, std::align_val_t(align), std::nothrow);
+#else
+    uint32_t caps = MALLOC_CAP_8BIT |
+                    (region == MemoryRegion::INTERNAL ? MALLOC_CAP_INTERNAL : MALLOC_CAP_SPIRAM);
+    return heap_caps_aligned_alloc(align, size, caps);
+#endif
+}
+
+void region_free(const TrackedBuffer& buffer) {
+    void* ptr = const_cast<uint8_t*>(buffer.start);
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+    ::operator delete(ptr, std::align_val_t(buffer.align));
+#else
+    heap_caps_free(ptr);
+#endif
+}
+
+void track(TrackedBuffer* slot, const void* ptr, size_t size, size_t align, MemoryRole role,
+           MemoryRegion region, bool is_static) {
+    *slot = {static_cast<const uint8_t*>(ptr), size, align, role, region, is_static, true};
+    size_t& used = region_used[index_of(region)];
+    used += size;
+    if (used > region_peak[index_of(region)]) {
+        region_peak[index_of(region)] = used;
+    }
+}
+
+} // namespace
+
+//=============================================================================
+// ALLOCATION
+//=============================================================================
+
+void* WebInkMemory::allocate(size_t size, MemoryRole role, size_t align) {
+    TrackedBuffer* slot = free_slot();
+    if (slot == nullptr || size == 0) {
+        allocation_failures++;
+        WEBINK_LOGE(TAG, "[MEMORY] Cannot track another %s buffer (%u bytes)",
+                    role_name(role), (unsigned) size);
+        return nullptr;
+    }
+
+    Placement placement = get_placement(role);
+    MemoryRegion first = (placement == Placement::PREFER_EXTERNAL) ? MemoryRegion::EXTERNAL
+                                                                   : MemoryRegion::INTERNAL;
+    MemoryRegion region = first;
+    void* ptr = region_allocate(first, size, align);
+
+    if (ptr == nullptr && placement != Placement::INTERNAL_ONLY) {
+        region = (first == MemoryRegion::INTERNAL) ? MemoryRegion::EXTERNAL : MemoryRegion::INTERNAL;
+        ptr = region_allocate(region, size, align);
+        if (ptr != nullptr) {
+            placement_fallbacks++;
+            WEBINK_LOGD(TAG, "[MEMORY] %s: %u bytes placed in %s (no room in %s)", role_name(role),
+                        (unsigned) size, region_name(region), region_name(first));
+        }
+    }
+
+    if (ptr == nullptr) {
+        allocation_failures++;
+        WEBINK_LOGE(TAG, "[MEMORY] %s: no region could hold %u bytes", role_name(role), (unsigned) size);
+        return nullptr;
+    }
+
+    track(slot, ptr, size, align, role, region, false);
+    return ptr;
+}
+
+void WebInkMemory::release(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    TrackedBuffer* buffer = find_buffer(ptr);
+    if (buffer == nullptr || buffer->is_static || buffer->start != ptr) {
+        WEBINK_LOGE(TAG, "[MEMORY] release() of an address allocate() did not return");
+        return;
+    }
+
+    region_free(*buffer);
+    region_used[index_of(buffer->region)] -= buffer->size;
+    buffer->in_use = false;
+}
+
+void WebInkMemory::register_static(const void* ptr, size_t size, MemoryRole role, MemoryRegion region) {
+    if (find_buffer(ptr) != nullptr) {
+        return;  // Already registered (setup() ran again)
+    }
+
+    TrackedBuffer* slot = free_slot();
+    if (slot == nullptr) {
+        WEBINK_LOGW(TAG, "[MEMORY] Cannot track static %s buffer", role_name(role));
+        return;
+    }
+    track(slot, ptr, size, 1, role, region, true);
+}
+
+//=============================================================================
+// POLICY
+//=============================================================================
+
+void WebInkMemory::set_placement(MemoryRole role, Placement placement) {
+    role_placement[static_cast<int>(role)] = placement;
+}
+
+Placement WebInkMemory::get_placement(MemoryRole role) {
+    return role_placement[static_cast<int>(role)];
+}
+
+bool WebInkMemory::find_region(const void* ptr, MemoryRegion& region) {
+    const TrackedBuffer* buffer = find_buffer(ptr);
+    if (buffer == nullptr) {
+        return false;
+    }
+    region = buffer->region;
+    return true;
+}
+
+//=============================================================================
+// STATISTICS
+//=============================================================================
+
+size_t WebInkMemory::get_used(MemoryRegion region) {
+    return region_used[index_of(region)];
+}
+
+size_t WebInkMemory::get_peak(MemoryRegion region) {
+    return region_peak[index_of(region)];
+}
+
+size_t WebInkMemory::get_role_bytes(MemoryRole role) {
+    size_t bytes = 0;
+    for (const TrackedBuffer& buffer : buffers) {
+        if (buffer.in_use && buffer.role == role) {
+            bytes += buffer.size;
+        }
+    }
+    return bytes;
+}
+
+uint32_t WebInkMemory::get_fallbacks() {
+    return placement_fallbacks;
+}
+
+uint32_t WebInkMemory::get_failures() {
+    return allocation_failures;
+}
+
+void WebInkMemory::log_summary() {
+    WEBINK_LOGI(TAG, "[MEMORY] Internal %u bytes, PSRAM %u bytes (fallbacks %u, failures %u)",
+                (unsigned) region_used[0], (unsigned) region_used[1],
+                (unsigned) placement_fallbacks, (unsigned) allocation_failures);
+    for (const TrackedBuffer& buffer : buffers) {
+        if (buffer.in_use) {
+            WEBINK_LOGI(TAG, "[MEMORY]   %-12s %6u bytes in %s%s", role_name(buffer.role),
+                        (unsigned) buffer.size, region_name(buffer.region),
+                        buffer.is_static ? " (static)" : "");
+        }
+    }
+}
+
+const char* WebInkMemory::role_name(MemoryRole role) {
+    switch (role) {
+        case MemoryRole::FRAMEBUFFER: return "FRAMEBUFFER";
+        case MemoryRole::SLICE: return "SLICE";
+        case MemoryRole::PIXEL_ROWS: return "PIXEL_ROWS";
+        case MemoryRole::DECOMPRESSOR: return "DECOMPRESSOR";
+        case MemoryRole::CACHE: return "CACHE";
+    }
+    return "UNKNOWN";
+}
+
+const char* WebInkMemory::region_name(MemoryRegion region) {
+    return region == MemoryRegion::EXTERNAL ? "psram" : "internal";
+}
+
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+//=============================================================================
+// HOST EMULATION
+//=============================================================================
+
+void WebInkMemory::emulate_regions(const RegionModel& internal, const RegionModel& external) {
+    region_model[index_of(MemoryRegion::INTERNAL)] = internal;
+    region_model[index_of(MemoryRegion::EXTERNAL)] = external;
+    reset_access_counters();
+}
+
+void WebInkMemory::record_access(const void* ptr, size_t bytes) {
+    const TrackedBuffer* buffer = find_buffer(ptr);
+    if (buffer == nullptr) {
+        return;
+    }
+    int region = index_of(buffer->region);
+    access_bytes[region] += bytes;
+    access_ns[region] += (static_cast<uint64_t>(bytes) * region_model[region].ns_per_kib) / 1024;
+}
+
+uint64_t WebInkMemory::get_access_bytes(MemoryRegion region) {
+    return access_bytes[index_of(region)];
+}
+
+uint64_t WebInkMemory::get_access_ns(MemoryRegion region) {
+    return access_ns[index_of(region)];
+}
+
+void WebInkMemory::reset_access_counters() {
+    for (int i = 0; i < MEMORY_REGION_COUNT; i++) {
+        access_bytes[i] = 0;
+        access_ns[i] = 0;
+    }
+}
+#endif
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,179 @@
+/**
+ * @file webink_memory.h
+ * @brief Memory-region placement policy (internal SRAM vs PSRAM)
+ *
+ * On boards with PSRAM, large buffers that are touched rarely (framebuffer,
+ * caches) belong there, while buffers touched per pixel (decoded rows,
+ * decoder state) must stay in internal SRAM: PSRAM is several times slower
+ * and shares the cache with code fetches.
+ *
+ * Every long-lived buffer the component allocates goes through
+ * WebInkMemory::allocate() with a MemoryRole. The role's Placement decides
+ * which region is tried first and whether the other one is an acceptable
+ * fallback. Buffers placed at link time (the wake arena) are recorded with
+ * register_static() so the summary covers them too.
+ *
+ * Host builds (WEBINK_MAC_INTEGRATION_TEST) emulate both regions: each has
+ * a capacity limit and an access cost per KiB. Code that walks a buffer
+ * reports it with record_access(), which charges the emulated time to the
+ * buffer's region, so placements can be compared without hardware. On the
+ * device record_access() is an empty inline function.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum MemoryRegion
+ * @brief Physical memory a buffer lives in
+ */
+enum class MemoryRegion : uint8_t {
+    INTERNAL = 0,      ///< On-chip SRAM
+    EXTERNAL = 1       ///< PSRAM (SPI RAM)
+};
+
+static const int MEMORY_REGION_COUNT = 2;
+
+/**
+ * @enum Placement
+ * @brief Where a role's buffers may go
+ */
+enum class Placement : uint8_t {
+    INTERNAL_ONLY,     ///< Internal SRAM or fail - hot buffers
+    PREFER_INTERNAL,   ///< Internal SRAM, PSRAM when internal is exhausted
+    PREFER_EXTERNAL    ///< PSRAM, internal SRAM when there is none - large, cold buffers
+};
+
+/**
+ * @enum MemoryRole
+ * @brief What a buffer is used for (selects its Placement)
+ */
+enum class MemoryRole : uint8_t {
+    FRAMEBUFFER = 0,   ///< Full-screen pixel buffer
+    SLICE = 1,         ///< Response bodies and queued slices (wake arena)
+    PIXEL_ROWS = 2,    ///< Decoded band and row buffers (WebInkPixelPool)
+    DECOMPRESSOR = 3,  ///< Decompressor window and decoder state
+    CACHE = 4          ///< Content caches
+};
+
+static const int MEMORY_ROLE_COUNT = 5;
+
+/**
+ * @struct RegionModel
+ * @brief Emulated region on host builds
+ */
+struct RegionModel {
+    size_t capacity;       ///< Bytes that may be allocated from the region
+    uint32_t ns_per_kib;   ///< Emulated cost of accessing 1 KiB
+};
+
+/**
+ * @class WebInkMemory
+ * @brief Region-aware allocator and placement bookkeeping (static; one per device)
+ *
+ * Meant for a handful of long-lived buffers, not per-request allocations:
+ * at most MAX_BUFFERS are tracked at a time. Main loop only.
+ *
+ * @example Allocating by role
+ * @code
+ * void* rows = WebInkMemory::allocate(8000, MemoryRole::PIXEL_ROWS, 16);
+ * if (!rows) return false;   // INTERNAL_ONLY and internal SRAM is full
+ * // ...
+ * WebInkMemory::record_access(rows, 8000);   // Host builds: charge emulated time
+ * WebInkMemory::release(rows);
+ * @endcode
+ */
+class WebInkMemory {
+public:
+    static const int MAX_BUFFERS = 8;                           ///< Tracked buffers (allocated + static)
+
+    /**
+     * @brief Allocate a buffer according to its role's placement
+     * @param size Bytes to allocate
+     * @param role Buffer role
+     * @param align Alignment (power of two)
+     * @return Buffer, or nullptr if no permitted region could serve it
+     */
+    static void* allocate(size_t size, MemoryRole role, size_t align = alignof(std::max_align_t));
+
+    /**
+     * @brief Free a buffer from allocate() (nullptr is ignored)
+     */
+    static void release(void* ptr);
+
+    /**
+     * @brief Record a buffer placed at link time
+     * @param ptr Start of the buffer
+     * @param size Its size
+     * @param role Buffer role
+     * @param region Region the linker put it in
+     */
+    static void register_static(const void* ptr, size_t size, MemoryRole role,
+                                MemoryRegion region = MemoryRegion::INTERNAL);
+
+    /**
+     * @brief Change where a role's future buffers go
+     */
+    static void set_placement(MemoryRole role, Placement placement);
+    static Placement get_placement(MemoryRole role);            ///< Current placement of a role
+
+    /**
+     * @brief Look up the region of a tracked buffer
+     * @param ptr Any address inside the buffer
+     * @param region Receives the buffer's region
+     * @return False if ptr is not inside a tracked buffer
+     */
+    static bool find_region(const void* ptr, MemoryRegion& region);
+
+    static size_t get_used(MemoryRegion region);                ///< Tracked bytes in a region
+    static size_t get_peak(MemoryRegion region);                ///< Peak tracked bytes in a region
+    static size_t get_role_bytes(MemoryRole role);              ///< Tracked bytes of a role
+    static uint32_t get_fallbacks();                            ///< Buffers placed in the second-choice region
+    static uint32_t get_failures();                             ///< allocate() calls that returned nullptr
+
+    /**
+     * @brief Log tracked buffers by role and region ([MEMORY] lines)
+     */
+    static void log_summary();
+
+    static const char* role_name(MemoryRole role);              ///< "FRAMEBUFFER", "SLICE", ...
+    static const char* region_name(MemoryRegion region);        ///< "internal" or "psram"
+
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+    /**
+     * @brief Set the emulated regions (host builds)
+     * @param internal Model of internal SRAM
+     * @param external Model of PSRAM; capacity 0 emulates a board without it
+     *
+     * Call before allocating; resets the access counters.
+     */
+    static void emulate_regions(const RegionModel& internal, const RegionModel& external);
+
+    /**
+     * @brief Charge an access to the region of the buffer holding ptr (host builds)
+     * @param ptr Address inside a tracked buffer (untracked addresses are ignored)
+     * @param bytes Bytes read or written
+     */
+    static void record_access(const void* ptr, size_t bytes);
+
+    static uint64_t get_access_bytes(MemoryRegion region);      ///< Bytes charged to a region
+    static uint64_t get_access_ns(MemoryRegion region);         ///< Emulated access time of a region
+    static void reset_access_counters();                        ///< Clear get_access_*()
+#else
+    static void record_access(const void*, size_t) {}           ///< Host emulation only
+#endif
+
+private:
+    static const char* TAG;                                     ///< Logging tag
+};
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,153 @@
+/**
+ * @file webink_net_stats.cpp
+ * @brief Implementation of WebInkNetStats
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_net_stats.h"
+
+#if WEBINK_NET_STATS
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace esphome {
+namespace webink {
+
+namespace {
+
+const char* const OPERATION_NAMES[] = {"http_get", "http_post", "socket", "dns"};
+
+/**
+ * Buffer filled by successive snprintf() calls; stops at the end of the buffer
+ */
+struct JsonWriter {
+    char* out;
+    size_t size;
+    size_t length;
+
+    void appendf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (length + 1 >= size) {
+            return;
+        }
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(out + length, size - length, format, args);
+        va_end(args);
+        if (written > 0) {
+            length = std::min(length + static_cast<size_t>(written), size - 1);
+        }
+    }
+};
+
+void append_histogram(JsonWriter& json, const char* name, const Log2Histogram& histogram) {
+    json.appendf("\"%s\":{\"n\":%u,\"p50\":%u,\"p95\":%u,\"max\":%u}",
+                 name, (unsigned) histogram.total(), (unsigned) histogram.percentile(50),
+                 (unsigned) histogram.percentile(95), (unsigned) histogram.max_ms);
+}
+
+} // namespace
+
+//=============================================================================
+// CONSTRUCTOR
+//=============================================================================
+
+WebInkNetStats::WebInkNetStats() {
+    reset();
+}
+
+void WebInkNetStats::reset() {
+    for (NetOperationStats& stats : ops_) {
+        stats.requests = 0;
+        stats.succeeded = 0;
+        stats.failed = 0;
+        stats.timeouts = 0;
+        stats.retries = 0;
+        stats.bytes_sent = 0;
+        stats.bytes_received = 0;
+        stats.busy_ms = 0;
+        stats.connect_ms.clear();
+        stats.ttfb_ms.clear();
+        stats.total_ms.clear();
+    }
+    bytes_copied_ = 0;
+}
+
+//=============================================================================
+// RECORDING
+//=============================================================================
+
+void WebInkNetStats::record(NetOperation op, const NetTransfer& transfer) {
+    NetOperationStats& stats = ops_[static_cast<int>(op)];
+
+    stats.requests++;
+    if (transfer.success) {
+        stats.succeeded++;
+    } else {
+        stats.failed++;
+        if (transfer.timed_out) {
+            stats.timeouts++;
+        }
+    }
+    stats.bytes_sent += transfer.bytes_sent;
+    stats.bytes_received += transfer.bytes_received;
+    stats.busy_ms += transfer.total_ms;
+
+    if (transfer.connect_ms >= 0) {
+        stats.connect_ms.record(static_cast<uint32_t>(transfer.connect_ms));
+    }
+    if (transfer.ttfb_ms >= 0) {
+        stats.ttfb_ms.record(static_cast<uint32_t>(transfer.ttfb_ms));
+    }
+    stats.total_ms.record(transfer.total_ms);
+}
+
+void WebInkNetStats::record_retry(NetOperation op) {
+    ops_[static_cast<int>(op)].retries++;
+}
+
+uint32_t WebInkNetStats::throughput_bps(const NetOperationStats& stats) {
+    if (stats.busy_ms == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>(static_cast<uint64_t>(stats.bytes_received) * 1000 / stats.busy_ms);
+}
+
+//=============================================================================
+// EXPORT
+//=============================================================================
+
+size_t WebInkNetStats::to_json(char* out, size_t size) const {
+    if (size == 0) {
+        return 0;
+    }
+    JsonWriter json = {out, size, 0};
+    out[0] = '\0';
+
+    json.appendf("{");
+    for (int i = 0; i < static_cast<int>(NetOperation::COUNT); i++) {
+        const NetOperationStats& stats = ops_[i];
+        json.appendf("\"%s\":{\"requests\":%u,\"ok\":%u,\"failed\":%u,\"timeouts\":%u,\"retries\":%u,"
+                     "\"bytes_out\":%u,\"bytes_in\":%u,\"throughput_bps\":%u,",
+                     OPERATION_NAMES[i], (unsigned) stats.requests, (unsigned) stats.succeeded,
+                     (unsigned) stats.failed, (unsigned) stats.timeouts, (unsigned) stats.retries,
+                     (unsigned) stats.bytes_sent, (unsigned) stats.bytes_received,
+                     (unsigned) throughput_bps(stats));
+        append_histogram(json, "connect_ms", stats.connect_ms);
+        json.appendf(",");
+        append_histogram(json, "ttfb_ms", stats.ttfb_ms);
+        json.appendf(",");
+        append_histogram(json, "total_ms", stats.total_ms);
+        json.appendf("},");
+    }
+    json.appendf("\"bytes_copied\":%u}", (unsigned) bytes_copied_);
+    return json.length;
+}
+
+} // namespace webink
+} // namespace esphome
+
+#endif // WEBINK_NET_STATS
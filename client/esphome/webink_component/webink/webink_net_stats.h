@@ -0,0 +1,186 @@
+/**
+ * @file webink_net_stats.h
+ * @brief Structured network statistics with latency histograms
+ *
+ * WebInkNetStats replaces the old one-line statistics string of
+ * WebInkNetworkClient. For every operation type (HTTP GET, HTTP POST, socket
+ * stream, DNS lookup) it counts requests, successes, failures, timeouts and
+ * retries, bytes in and out, and keeps log2 histograms (Log2Histogram) of
+ * connect time, time to first byte and total time. It also counts payload
+ * bytes copied between buffers inside the client, so copy-avoiding transport
+ * changes can be measured.
+ *
+ * to_json() exports everything as one JSON object into a caller-supplied
+ * buffer (no heap); the controller logs it once per cycle as
+ * "[NETSTATS] {...}" so runs can be captured on the host and compared.
+ *
+ * Building with WEBINK_NET_STATS=0 (the `network_stats: false` YAML option)
+ * compiles the statistics out: every method becomes an empty inline function
+ * and the object holds no data.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "webink_types.h"
+
+#ifndef WEBINK_NET_STATS
+#define WEBINK_NET_STATS 1
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum NetOperation
+ * @brief Operation types tracked by WebInkNetStats
+ */
+enum class NetOperation : uint8_t {
+    HTTP_GET = 0,       ///< http_get_async()
+    HTTP_POST = 1,      ///< http_post_async()
+    SOCKET = 2,         ///< Socket connect + stream receive
+    DNS = 3,            ///< resolve_host()
+    COUNT = 4
+};
+
+/**
+ * @struct NetTransfer
+ * @brief Measurements of one finished operation
+ */
+struct NetTransfer {
+    bool success = false;
+    bool timed_out = false;
+    int32_t connect_ms = -1;     ///< TCP connect time (-1 = reused or not measured)
+    int32_t ttfb_ms = -1;        ///< Request start to first response byte (-1 = none)
+    uint32_t total_ms = 0;       ///< Request start to completion
+    uint32_t bytes_sent = 0;
+    uint32_t bytes_received = 0;
+};
+
+/**
+ * @struct NetOperationStats
+ * @brief Counters and latency histograms of one operation type
+ */
+struct NetOperationStats {
+    uint32_t requests;           ///< Operations finished
+    uint32_t succeeded;
+    uint32_t failed;             ///< Including timeouts
+    uint32_t timeouts;
+    uint32_t retries;            ///< Repeated by the caller after a failure
+    uint32_t bytes_sent;
+    uint32_t bytes_received;
+    uint32_t busy_ms;            ///< Sum of total times (throughput denominator)
+    Log2Histogram connect_ms;
+    Log2Histogram ttfb_ms;
+    Log2Histogram total_ms;
+};
+
+/**
+ * @class WebInkNetStats
+ * @brief Per-operation network counters and latency histograms
+ *
+ * @example Recording a request
+ * @code
+ * NetTransfer transfer;
+ * transfer.success = true;
+ * transfer.ttfb_ms = 180;
+ * transfer.total_ms = 240;
+ * transfer.bytes_received = 4096;
+ * stats.record(NetOperation::HTTP_GET, transfer);
+ *
+ * static char json[WebInkNetStats::JSON_MAX_LENGTH];
+ * stats.to_json(json, sizeof(json));  // {"http_get":{"requests":1,...},...}
+ * @endcode
+ */
+class WebInkNetStats {
+public:
+    static const bool ENABLED = WEBINK_NET_STATS != 0;          ///< False when compiled out
+    static const size_t JSON_MAX_LENGTH = 1792;                 ///< to_json() buffer that never truncates
+
+#if WEBINK_NET_STATS
+    /**
+     * @brief Constructor - starts with all counters cleared
+     */
+    WebInkNetStats();
+
+    /**
+     * @brief Record a finished operation
+     * @param op Operation type
+     * @param transfer Its measurements
+     */
+    void record(NetOperation op, const NetTransfer& transfer);
+
+    /**
+     * @brief Count an operation the caller repeats after a failure
+     * @param op Operation type
+     */
+    void record_retry(NetOperation op);
+
+    /**
+     * @brief Count payload bytes copied from one buffer to another
+     * @param bytes Bytes copied
+     */
+    void add_bytes_copied(uint32_t bytes) { bytes_copied_ += bytes; }
+
+    /**
+     * @brief Clear all counters and histograms
+     */
+    void reset();
+
+    /**
+     * @brief Get the statistics of one operation type
+     * @param op Operation type
+     * @return Counters and histograms
+     */
+    const NetOperationStats& get(NetOperation op) const { return ops_[static_cast<int>(op)]; }
+
+    uint32_t get_bytes_copied() const { return bytes_copied_; }  ///< Bytes copied inside the client
+
+    /**
+     * @brief Export all statistics as one JSON object
+     * @param[out] out Buffer for the null-terminated JSON text (no trailing newline)
+     * @param size Buffer size (JSON_MAX_LENGTH always fits)
+     * @return Length of the text, truncated to size - 1
+     */
+    size_t to_json(char* out, size_t size) const;
+
+    /**
+     * @brief Average receive throughput of an operation type
+     * @param stats Operation statistics
+     * @return Bytes per second over the time spent in operations (0 if none)
+     */
+    static uint32_t throughput_bps(const NetOperationStats& stats);
+
+private:
+    NetOperationStats ops_[static_cast<int>(NetOperation::COUNT)];  ///< Per operation type
+    uint32_t bytes_copied_;                                     ///< Payload bytes copied inside the client
+#else
+    void record(NetOperation, const NetTransfer&) {}
+    void record_retry(NetOperation) {}
+    void add_bytes_copied(uint32_t) {}
+    void reset() {}
+    const NetOperationStats& get(NetOperation) const {
+        static const NetOperationStats empty{};
+        return empty;
+    }
+    uint32_t get_bytes_copied() const { return 0; }
+    size_t to_json(char* out, size_t size) const {
+        if (size < 3) {
+            return 0;
+        }
+        out[0] = '{';
+        out[1] = '}';
+        out[2] = '\0';
+        return 2;
+    }
+    static uint32_t throughput_bps(const NetOperationStats&) { return 0; }
+#endif
+};
+
+} // namespace webink
+} // namespace esphome
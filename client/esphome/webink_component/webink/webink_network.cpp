@@ -18,43 +18,81 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <sys/select.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <cstdarg>
 #include <cstdio>
 #include <chrono>
-
-// Mock ESPHome logging for Mac
-namespace esphome {
 #else
 // Normal ESPHome mode  
 #include "esphome.h"
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
-#include "esphome/components/socket/socket.h"
 #include "esp_http_client.h"
 #include <sys/socket.h>
+#include <sys/select.h>
 #include <netdb.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <strings.h>
+#include <cstdlib>
 
 // ESPHome millis() is available via helpers
 using namespace esphome;
 #endif
 
-#include <regex>
+#include <cctype>
+#include <cstring>
 
 #ifndef WEBINK_MAC_INTEGRATION_TEST
 // Static pointer for event handler to access response buffer (declared early for visibility)
-static std::string* s_http_response_buffer = nullptr;
+static esphome::webink::ArenaString* s_http_response_buffer = nullptr;
+static esphome::webink::ArenaString* s_http_content_hash = nullptr;  // Receives the X-WebInk-Hash header
+static int* s_http_sleep_seconds = nullptr;         // Receives the X-WebInk-Sleep header
+static int* s_http_next_change_seconds = nullptr;   // Receives the X-WebInk-Next-Change header
+static unsigned long* s_http_connected_time = nullptr;   // Receives millis() of the TCP connect
+static unsigned long* s_http_first_byte_time = nullptr;  // Receives millis() of the first response byte
 
 // Event handler for ESP-IDF HTTP client - captures response body
 static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
     switch(evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            // Not raised when a kept-alive connection is reused
+            if (s_http_connected_time != nullptr) {
+                *s_http_connected_time = millis();
+            }
+            break;
         case HTTP_EVENT_ON_DATA:
+            if (s_http_first_byte_time != nullptr && *s_http_first_byte_time == 0) {
+                *s_http_first_byte_time = millis();
+            }
             // Append received data to response buffer
             if (s_http_response_buffer != nullptr && evt->data_len > 0) {
                 s_http_response_buffer->append((char*)evt->data, evt->data_len);
             }
             break;
+        case HTTP_EVENT_ON_HEADER:
+            if (s_http_first_byte_time != nullptr && *s_http_first_byte_time == 0) {
+                *s_http_first_byte_time = millis();
+            }
+            // Server reports the image hash with conditional image fetches
+            if (s_http_content_hash != nullptr && evt->header_key && evt->header_value &&
+                strcasecmp(evt->header_key, "X-WebInk-Hash") == 0) {
+                s_http_content_hash->assign(evt->header_value);
+            }
+            // Server schedule rides along with hash and conditional responses
+            if (s_http_sleep_seconds != nullptr && evt->header_key && evt->header_value &&
+                strcasecmp(evt->header_key, "X-WebInk-Sleep") == 0) {
+                *s_http_sleep_seconds = atoi(evt->header_value);
+            }
+            if (s_http_next_change_seconds != nullptr && evt->header_key && evt->header_value &&
+                strcasecmp(evt->header_key, "X-WebInk-Next-Change") == 0) {
+                *s_http_next_change_seconds = atoi(evt->header_value);
+            }
+            break;
         default:
             break;
     }
@@ -62,115 +100,125 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
 }
 #endif
 
-#ifdef WEBINK_MAC_INTEGRATION_TEST
+namespace esphome {
+namespace webink {
+
+const char* WebInkNetworkClient::TAG = "webink.network";
+
 //=============================================================================
-// MAC SOCKET WRAPPER (POSIX implementation for testing)
+// SOCKET WRAPPER
 //=============================================================================
 
-class MacSocket {
-private:
-    int sockfd_;
-    bool connected_;
+WebInkSocket::ConnectResult WebInkSocket::connect(uint32_t ipv4, int port) {
+    close();
     
-public:
-    MacSocket() : sockfd_(-1), connected_(false) {}
-    
-    ~MacSocket() {
-        close();
+    fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        return ConnectResult::FAILED;
     }
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK);
     
-    bool create_tcp() {
-        sockfd_ = socket(AF_INET, SOCK_STREAM, 0);
-        return sockfd_ != -1;
-    }
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = ipv4;
     
-    bool setblocking(bool blocking) {
-        int flags = fcntl(sockfd_, F_GETFL, 0);
-        if (flags == -1) return false;
-        
-        if (blocking) {
-            flags &= ~O_NONBLOCK;
-        } else {
-            flags |= O_NONBLOCK;
-        }
-        
-        return fcntl(sockfd_, F_SETFL, flags) == 0;
+    if (::connect(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        connected_ = true;
+        return ConnectResult::CONNECTED;
     }
-    
-    int connect(const std::string& host, int port) {
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        
-        // Try to convert IP address directly
-        if (inet_aton(host.c_str(), &addr.sin_addr) == 0) {
-            // Not an IP, resolve hostname
-            struct hostent* he = gethostbyname(host.c_str());
-            if (!he) return -1;
-            memcpy(&addr.sin_addr, he->h_addr_list[0], he->h_length);
-        }
-        
-        int result = ::connect(sockfd_, (struct sockaddr*)&addr, sizeof(addr));
-        if (result == 0) {
-            connected_ = true;
-        } else if (errno == EINPROGRESS) {
-            // Non-blocking connect in progress
-            return -2; // Special return for in-progress
-        }
-        
-        return result;
+    if (errno == EINPROGRESS) {
+        return ConnectResult::IN_PROGRESS;
     }
-    
-    ssize_t write(const void* data, size_t len) {
-        if (!connected_) return -1;
-        return ::write(sockfd_, data, len);
+    close();
+    return ConnectResult::FAILED;
+}
+
+WebInkSocket::PollResult WebInkSocket::poll_connect() {
+    if (fd_ < 0) {
+        return PollResult::FAILED;
     }
-    
-    ssize_t read(void* buffer, size_t len) {
-        if (!connected_) return -1;
-        return ::read(sockfd_, buffer, len);
+    if (connected_) {
+        return PollResult::CONNECTED;
     }
     
-    bool ready() {
-        if (!connected_) return false;
-        
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(sockfd_, &readfds);
-        
-        struct timeval timeout;
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 0;
-        
-        int result = select(sockfd_ + 1, &readfds, nullptr, nullptr, &timeout);
-        return result > 0 && FD_ISSET(sockfd_, &readfds);
+    // Writable once the handshake finished, either way; SO_ERROR tells which
+    fd_set write_set;
+    FD_ZERO(&write_set);
+    FD_SET(fd_, &write_set);
+    struct timeval tv = {0, 0};
+    if (select(fd_ + 1, nullptr, &write_set, nullptr, &tv) <= 0) {
+        return PollResult::PENDING;
     }
-    
-    void close() {
-        if (sockfd_ != -1) {
-            ::close(sockfd_);
-            sockfd_ = -1;
-            connected_ = false;
-        }
+    if (error() != 0) {
+        return PollResult::FAILED;
     }
-    
-    bool is_connected() const { return connected_; }
-    int get_socket_fd() const { return sockfd_; }
-};
+    connected_ = true;
+    return PollResult::CONNECTED;
+}
 
-#endif // WEBINK_MAC_INTEGRATION_TEST
+void WebInkSocket::adopt(int fd) {
+    close();
+    fd_ = fd;
+    connected_ = fd >= 0;
+}
 
-namespace esphome {
-namespace webink {
+int WebInkSocket::release() {
+    int fd = fd_;
+    fd_ = -1;
+    connected_ = false;
+    return fd;
+}
 
-const char* WebInkNetworkClient::TAG = "webink.network";
+int WebInkSocket::read(uint8_t* buffer, size_t length) {
+    if (!connected_) {
+        return -1;
+    }
+    return static_cast<int>(::read(fd_, buffer, length));
+}
+
+int WebInkSocket::write(const char* data, size_t length) {
+    if (!connected_) {
+        return -1;
+    }
+    return static_cast<int>(::write(fd_, data, length));
+}
+
+bool WebInkSocket::readable() const {
+    if (!connected_) {
+        return false;
+    }
+    
+    fd_set read_set;
+    FD_ZERO(&read_set);
+    FD_SET(fd_, &read_set);
+    struct timeval tv = {0, 0};
+    return select(fd_ + 1, &read_set, nullptr, nullptr, &tv) > 0;
+}
+
+int WebInkSocket::error() const {
+    int so_error = 0;
+    socklen_t len = sizeof(so_error);
+    if (fd_ < 0 || getsockopt(fd_, SOL_SOCKET, SO_ERROR, &so_error, &len) < 0) {
+        return EBADF;
+    }
+    return so_error;
+}
+
+void WebInkSocket::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    connected_ = false;
+}
 
 //=============================================================================
 // CONSTRUCTOR AND DESTRUCTOR
 //=============================================================================
 
 WebInkNetworkClient::WebInkNetworkClient(WebInkConfig* config, 
-                                        std::function<void(const std::string&)> log_callback)
+                                        LogCallback log_callback)
     : config_(config), 
       log_callback_(log_callback),
       pending_operation_(false),
@@ -179,25 +227,36 @@ WebInkNetworkClient::WebInkNetworkClient(WebInkConfig* config,
       default_socket_timeout_ms_(30000),    // 30 seconds  
       current_timeout_ms_(0),
       http_operation_pending_(false),
+      http_keep_alive_(false),
       socket_operation_pending_(false),
       socket_connected_(false),
       socket_bytes_remaining_(0),
+      socket_connect_start_(0),
+      socket_request_time_(0),
+      socket_first_byte_time_(0),
+      socket_transfer_sent_(0),
+      socket_transfer_received_(0),
       http_requests_sent_(0),
-      http_requests_successful_(0),
       socket_connections_made_(0),
       socket_bytes_sent_(0),
-      socket_bytes_received_(0)
+      socket_bytes_received_(0),
+      http_bytes_sent_(0),
+      http_bytes_received_(0)
 #ifndef WEBINK_MAC_INTEGRATION_TEST
       , esp_http_client_(nullptr),
-      http_request_in_progress_(false)
+      http_sleep_seconds_(-1),
+      http_next_change_seconds_(-1),
+      http_request_in_progress_(false),
+      http_connected_time_(0),
+      http_first_byte_time_(0)
 #endif
       {
     
     init_http_client();
     
-    ESP_LOGD(TAG, "WebInkNetworkClient initialized");
-    ESP_LOGD(TAG, "HTTP timeout: %lu ms, Socket timeout: %lu ms", 
-             default_http_timeout_ms_, default_socket_timeout_ms_);
+    WEBINK_LOGD(TAG, "WebInkNetworkClient initialized");
+    WEBINK_LOGD(TAG, "HTTP timeout: %lu ms, Socket timeout: %lu ms", 
+                default_http_timeout_ms_, default_socket_timeout_ms_);
 }
 
 WebInkNetworkClient::~WebInkNetworkClient() {
@@ -212,50 +271,58 @@ WebInkNetworkClient::~WebInkNetworkClient() {
     }
 #endif
     
-    ESP_LOGD(TAG, "WebInkNetworkClient destroyed");
+    WEBINK_LOGD(TAG, "WebInkNetworkClient destroyed");
 }
 
 //=============================================================================
 // HTTP INTERFACE
 //=============================================================================
 
-bool WebInkNetworkClient::http_get_async(const std::string& url,
-                                         std::function<void(NetworkResult)> callback,
+bool WebInkNetworkClient::http_get_async(const char* url,
+                                         NetworkCallback callback,
                                          unsigned long timeout_ms) {
     if (!validate_url(url)) {
-        ESP_LOGW(TAG, "Invalid URL format");
+        WEBINK_LOGW(TAG, "Invalid URL format");
         callback(create_error_result(ErrorType::INVALID_RESPONSE, "Invalid URL format"));
         return false;
     }
     
     if (pending_operation_) {
-        ESP_LOGW(TAG, "HTTP operation already pending");
+        WEBINK_LOGW(TAG, "HTTP operation already pending");
         callback(create_error_result(ErrorType::SERVER_UNREACHABLE, "Operation already pending"));
         return false;
     }
     
     // Set up operation state
+    size_t url_length = strlen(url);
     pending_operation_ = true;
     http_operation_pending_ = true;
     operation_start_time_ = millis();
     current_timeout_ms_ = (timeout_ms > 0) ? timeout_ms : default_http_timeout_ms_;
     http_callback_ = callback;
     
-    ESP_LOGI(TAG, "[HTTP] GET %s (timeout: %lu ms)", url.c_str(), current_timeout_ms_);
+    WEBINK_LOGI(TAG, "[HTTP] GET %s (timeout: %lu ms)", url, current_timeout_ms_);
+    http_bytes_sent_ += url_length;
+    WebInkTrace::begin(TraceEvent::HTTP_GET);
     
 #ifdef WEBINK_MAC_INTEGRATION_TEST
-    // Mac integration test - use system curl immediately
-    NetworkResult result = perform_curl_request(url);
+    // Mac integration test - use the host handler or system curl immediately
+    NetworkResult result = host_http_handler_ != nullptr ? perform_host_request(url, nullptr, 0)
+                                                         : perform_curl_request(url);
+    record_http_transfer(NetOperation::HTTP_GET, result.success, url_length, result.bytes_received);
     pending_operation_ = false;
     http_operation_pending_ = false;
-    callback(result);
+    http_requests_sent_++;
+    callback(std::move(result));
+    return true;
 #else
     // ESP32 implementation using ESP-IDF HTTP client
     // Reinitialize client if needed (it may have been cleaned up after previous request)
     if (esp_http_client_ == nullptr) {
         init_http_client();
         if (esp_http_client_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to reinitialize HTTP client");
+            WEBINK_LOGE(TAG, "Failed to reinitialize HTTP client");
+            record_http_transfer(NetOperation::HTTP_GET, false, 0, 0);
             pending_operation_ = false;
             http_operation_pending_ = false;
             callback(create_error_result(ErrorType::SERVER_UNREACHABLE, "HTTP client init failed"));
@@ -264,25 +331,41 @@ bool WebInkNetworkClient::http_get_async(const std::string& url,
     }
     
     // Configure the HTTP client for this request
-    esp_http_client_set_url(esp_http_client_, url.c_str());
+    esp_http_client_set_url(esp_http_client_, url);
     esp_http_client_set_method(esp_http_client_, HTTP_METHOD_GET);
     esp_http_client_set_timeout_ms(esp_http_client_, current_timeout_ms_);
     
     // Clear response buffer and set up static pointer for event handler
-    http_response_buffer_.clear();
+    release_response_buffers();
+    http_sleep_seconds_ = -1;
+    http_next_change_seconds_ = -1;
     s_http_response_buffer = &http_response_buffer_;  // Event handler will append data here
+    s_http_content_hash = &http_content_hash_;
+    s_http_sleep_seconds = &http_sleep_seconds_;
+    s_http_next_change_seconds = &http_next_change_seconds_;
+    http_connected_time_ = 0;
+    http_first_byte_time_ = 0;
+    s_http_connected_time = &http_connected_time_;
+    s_http_first_byte_time = &http_first_byte_time_;
     
     // Perform the HTTP request (this is BLOCKING despite the "async" name)
     // Response body is captured by the event handler during perform()
     esp_err_t err = esp_http_client_perform(esp_http_client_);
     
-    // Clear static pointer after perform completes
+    // Clear static pointers after perform completes
     s_http_response_buffer = nullptr;
+    s_http_content_hash = nullptr;
+    s_http_sleep_seconds = nullptr;
+    s_http_next_change_seconds = nullptr;
+    s_http_connected_time = nullptr;
+    s_http_first_byte_time = nullptr;
     
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "HTTP client perform failed: %s", esp_err_to_name(err));
+        WEBINK_LOGE(TAG, "HTTP client perform failed: %s", esp_err_to_name(err));
+        record_http_transfer(NetOperation::HTTP_GET, false, url_length, 0);
         pending_operation_ = false;
         http_operation_pending_ = false;
+        release_response_buffers();
         callback(create_error_result(ErrorType::SERVER_UNREACHABLE, 
                                    "HTTP request failed"));
         return false;
@@ -292,44 +375,55 @@ bool WebInkNetworkClient::http_get_async(const std::string& url,
     int content_length = esp_http_client_get_content_length(esp_http_client_);
     int status_code = esp_http_client_get_status_code(esp_http_client_);
     
-    ESP_LOGD(TAG, "HTTP response: status=%d, content_length=%d, received=%zu bytes", 
-             status_code, content_length, http_response_buffer_.length());
+    WEBINK_LOGD(TAG, "HTTP response: status=%d, content_length=%d, received=%zu bytes", 
+                status_code, content_length, http_response_buffer_.length());
     
     // Build result and call callback immediately (since perform() is blocking)
     NetworkResult result;
     result.success = (status_code >= 200 && status_code < 300);
     result.status_code = status_code;
-    result.data = http_response_buffer_;
-    result.content = http_response_buffer_;
-    result.bytes_received = http_response_buffer_.length();
+    result.data.swap(http_response_buffer_);        // Hand the body over without copying
+    result.bytes_received = result.data.length();
+    http_bytes_received_ += result.bytes_received;
+    result.content_hash.swap(http_content_hash_);
+    result.sleep_seconds = http_sleep_seconds_;
+    result.next_change_seconds = http_next_change_seconds_;
     
     if (!result.success) {
         result.error_type = ErrorType::INVALID_RESPONSE;
         result.error_message = "HTTP error";
     }
     
-    // Clean up HTTP client to avoid stale connection state on next request
+    // The event handler copied the body once, into http_response_buffer_
+    record_http_transfer(NetOperation::HTTP_GET, result.success, url_length, result.bytes_received);
+    stats_.add_bytes_copied(result.bytes_received);
+    
+    // Clean up HTTP client to avoid stale connection state on next request,
+    // unless the caller asked to keep a good connection warm
     pending_operation_ = false;
     http_operation_pending_ = false;
-    http_response_buffer_.clear();
-    esp_http_client_cleanup(esp_http_client_);
-    esp_http_client_ = nullptr;  // Will be reinitialized on next request
+    release_response_buffers();
+    if (!http_keep_alive_ || !result.success) {
+        esp_http_client_cleanup(esp_http_client_);
+        esp_http_client_ = nullptr;  // Will be reinitialized on next request
+    }
     
     // Call callback with result
     http_requests_sent_++;
-    callback(result);
+    callback(std::move(result));
     
     return true;
 #endif
 }
 
-bool WebInkNetworkClient::http_post_async(const std::string& url,
-                                          const std::string& body,
-                                          std::function<void(NetworkResult)> callback,
-                                          const std::string& content_type,
+bool WebInkNetworkClient::http_post_async(const char* url,
+                                          const char* body,
+                                          size_t body_length,
+                                          NetworkCallback callback,
+                                          const char* content_type,
                                           unsigned long timeout_ms) {
     if (!validate_url(url)) {
-        log_message("Invalid URL format: " + url);
+        log_message("Invalid URL format: %s", url ? url : "NULL");
         callback(create_error_result(ErrorType::INVALID_RESPONSE, "Invalid URL format"));
         return false;
     }
@@ -341,29 +435,39 @@ bool WebInkNetworkClient::http_post_async(const std::string& url,
     }
     
     // Set up operation state
+    size_t url_length = strlen(url);
     pending_operation_ = true;
     http_operation_pending_ = true;
     operation_start_time_ = millis();
     current_timeout_ms_ = (timeout_ms > 0) ? timeout_ms : default_http_timeout_ms_;
     http_callback_ = callback;
     
-    ESP_LOGI(TAG, "[HTTP] POST %s (%zu bytes, %s, timeout: %lu ms)", 
-             url.c_str(), body.length(), content_type.c_str(), current_timeout_ms_);
-    log_message("HTTP POST: " + url + " (" + std::to_string(body.length()) + " bytes)");
+    WEBINK_LOGI(TAG, "[HTTP] POST %s (%zu bytes, %s, timeout: %lu ms)", 
+                url, body_length, content_type, current_timeout_ms_);
+    log_message("HTTP POST: %s (%zu bytes)", url, body_length);
+    http_bytes_sent_ += url_length + body_length;
+    WebInkTrace::begin(TraceEvent::HTTP_POST);
     
 #ifdef WEBINK_MAC_INTEGRATION_TEST
-    // Mac integration test - use system curl immediately  
-    NetworkResult result = perform_curl_post_request(url, body, content_type);
+    // Mac integration test - use the host handler or system curl immediately
+    NetworkResult result = host_http_handler_ != nullptr
+                         ? perform_host_request(url, body, body_length)
+                         : perform_curl_post_request(url, std::string(body, body_length), content_type);
+    record_http_transfer(NetOperation::HTTP_POST, result.success, url_length + body_length,
+                         result.bytes_received);
     pending_operation_ = false;
     http_operation_pending_ = false;
-    callback(result);
+    http_requests_sent_++;
+    callback(std::move(result));
+    return true;
 #else
     // ESP32 implementation using ESP-IDF HTTP client
     // Reinitialize client if needed (it may have been cleaned up after previous request)
     if (esp_http_client_ == nullptr) {
         init_http_client();
         if (esp_http_client_ == nullptr) {
-            ESP_LOGE(TAG, "Failed to reinitialize HTTP client for POST");
+            WEBINK_LOGE(TAG, "Failed to reinitialize HTTP client for POST");
+            record_http_transfer(NetOperation::HTTP_POST, false, 0, 0);
             pending_operation_ = false;
             http_operation_pending_ = false;
             callback(create_error_result(ErrorType::SERVER_UNREACHABLE, "HTTP client init failed"));
@@ -372,26 +476,37 @@ bool WebInkNetworkClient::http_post_async(const std::string& url,
     }
     
     // Configure the HTTP client for POST request
-    esp_http_client_set_url(esp_http_client_, url.c_str());
+    esp_http_client_set_url(esp_http_client_, url);
     esp_http_client_set_method(esp_http_client_, HTTP_METHOD_POST);
     esp_http_client_set_timeout_ms(esp_http_client_, current_timeout_ms_);
-    esp_http_client_set_post_field(esp_http_client_, body.c_str(), body.length());
-    esp_http_client_set_header(esp_http_client_, "Content-Type", content_type.c_str());
+    esp_http_client_set_post_field(esp_http_client_, body, body_length);
+    esp_http_client_set_header(esp_http_client_, "Content-Type", content_type);
     
     // Clear response buffer and set up static pointer for event handler
-    http_response_buffer_.clear();
+    release_response_buffers();
     s_http_response_buffer = &http_response_buffer_;
+    http_connected_time_ = 0;
+    http_first_byte_time_ = 0;
+    s_http_connected_time = &http_connected_time_;
+    s_http_first_byte_time = &http_first_byte_time_;
     
     // Perform the HTTP POST request (blocking)
     esp_err_t err = esp_http_client_perform(esp_http_client_);
     
-    // Clear static pointer after perform completes
+    // Clear static pointers after perform completes
     s_http_response_buffer = nullptr;
+    s_http_content_hash = nullptr;
+    s_http_sleep_seconds = nullptr;
+    s_http_next_change_seconds = nullptr;
+    s_http_connected_time = nullptr;
+    s_http_first_byte_time = nullptr;
     
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "HTTP POST perform failed: %s", esp_err_to_name(err));
+        WEBINK_LOGE(TAG, "HTTP POST perform failed: %s", esp_err_to_name(err));
+        record_http_transfer(NetOperation::HTTP_POST, false, url_length + body_length, 0);
         pending_operation_ = false;
         http_operation_pending_ = false;
+        release_response_buffers();
         esp_http_client_cleanup(esp_http_client_);
         esp_http_client_ = nullptr;
         callback(create_error_result(ErrorType::SERVER_UNREACHABLE, 
@@ -402,32 +517,36 @@ bool WebInkNetworkClient::http_post_async(const std::string& url,
     // Get response metadata
     int status_code = esp_http_client_get_status_code(esp_http_client_);
     
-    ESP_LOGD(TAG, "HTTP POST response: status=%d, received=%zu bytes", 
-             status_code, http_response_buffer_.length());
+    WEBINK_LOGD(TAG, "HTTP POST response: status=%d, received=%zu bytes", 
+                status_code, http_response_buffer_.length());
     
     // Build result
     NetworkResult result;
     result.success = (status_code >= 200 && status_code < 300);
     result.status_code = status_code;
-    result.data = http_response_buffer_;
-    result.content = http_response_buffer_;
-    result.bytes_received = http_response_buffer_.length();
+    result.data.swap(http_response_buffer_);
+    result.bytes_received = result.data.length();
+    http_bytes_received_ += result.bytes_received;
     
     if (!result.success) {
         result.error_type = ErrorType::INVALID_RESPONSE;
         result.error_message = "HTTP POST error";
     }
     
+    record_http_transfer(NetOperation::HTTP_POST, result.success, url_length + body_length,
+                         result.bytes_received);
+    stats_.add_bytes_copied(result.bytes_received);
+    
     // Clean up HTTP client
     pending_operation_ = false;
     http_operation_pending_ = false;
-    http_response_buffer_.clear();
+    release_response_buffers();
     esp_http_client_cleanup(esp_http_client_);
     esp_http_client_ = nullptr;
     
     // Call callback with result
     http_requests_sent_++;
-    callback(result);
+    callback(std::move(result));
     
     return true;
 #endif
@@ -437,15 +556,15 @@ bool WebInkNetworkClient::http_post_async(const std::string& url,
 // TCP SOCKET INTERFACE
 //=============================================================================
 
-bool WebInkNetworkClient::socket_connect_async(const std::string& host, int port,
+bool WebInkNetworkClient::socket_connect_async(const char* host, int port,
                                                unsigned long timeout_ms) {
     if (!validate_host(host)) {
-        log_message("Invalid hostname: " + host);
+        log_message("Invalid hostname: %s", host ? host : "NULL");
         return false;
     }
     
     if (port <= 0 || port > 65535) {
-        log_message("Invalid port: " + std::to_string(port));
+        log_message("Invalid port: %d", port);
         return false;
     }
     
@@ -454,118 +573,73 @@ bool WebInkNetworkClient::socket_connect_async(const std::string& host, int port
         return false;
     }
     
-    ESP_LOGI(TAG, "[SOCKET] Connecting to %s:%d", host.c_str(), port);
+    WEBINK_LOGI(TAG, "[SOCKET] Connecting to %s:%d", host, port);
     
     // Note: Don't set pending_operation_ here - connect is optimistic
     // The pending operation will be set when we start socket_receive_stream
     operation_start_time_ = millis();
-    current_timeout_ms_ = default_socket_timeout_ms_;
+    current_timeout_ms_ = (timeout_ms > 0) ? timeout_ms : default_socket_timeout_ms_;
+    socket_connect_start_ = operation_start_time_;
+    socket_request_time_ = operation_start_time_;
+    socket_first_byte_time_ = 0;
+    socket_transfer_sent_ = 0;
+    socket_transfer_received_ = 0;
+    socket_connected_ = false;
     
-    try {
-#ifdef WEBINK_MAC_INTEGRATION_TEST
-        // Mac integration test - use POSIX socket
-        socket_ = std::make_unique<MacSocket>();
-        
-        if (!socket_->create_tcp()) {
-            log_message("Failed to create Mac socket");
-            reset_operation_state();
-            return false;
-        }
-        
-        socket_->setblocking(false);
-        
-        // Attempt connection  
-        int result = socket_->connect(host, port);
-#else
-        // ESPHome mode - use ESPHome socket
-        socket_ = socket::socket_ip(SOCK_STREAM, 0);
-        if (!socket_) {
-            log_message("Failed to create ESPHome socket");
-            reset_operation_state();
-            return false;
-        }
-        
-        // Set up address
-        struct sockaddr_storage addr{};
-        socklen_t addrlen = socket::set_sockaddr(
-            reinterpret_cast<sockaddr *>(&addr),
-            sizeof(addr), host.c_str(), port);
-            
-        if (addrlen == 0) {
-            log_message("Failed to set socket address");
-            reset_operation_state();
-            return false;
-        }
-        
-        socket_->setblocking(false);
-        
-        // Attempt connection
-        int result = socket_->connect(reinterpret_cast<sockaddr *>(&addr), addrlen);
-#endif
-        if (result == 0) {
-            // Connected immediately
+    uint32_t ipv4 = 0;
+    if (!resolve_host(host, ipv4)) {
+        record_socket_transfer(false);
+        reset_operation_state();
+        return false;
+    }
+    
+    switch (socket_.connect(ipv4, port)) {
+        case WebInkSocket::ConnectResult::CONNECTED:
             socket_connected_ = true;
-            ESP_LOGI(TAG, "[SOCKET] Connected successfully");
+            socket_connections_made_++;
+            WEBINK_LOGI(TAG, "[SOCKET] Connected successfully");
             return true;
-#ifdef WEBINK_MAC_INTEGRATION_TEST
-        } else if (result == -2) {
-            // Mac socket: connection in progress (EINPROGRESS)
-            ESP_LOGI(TAG, "[SOCKET] Mac connection in progress");
+            
+        case WebInkSocket::ConnectResult::IN_PROGRESS:
+            // socket_is_connected() reports when the handshake finishes
             socket_connections_made_++;
+            WEBINK_LOGI(TAG, "[SOCKET] Connection initiated (async)");
             return true;
-        } else {
-            // Mac socket: connection failed
-            log_message("Mac socket connection failed");
+            
+        case WebInkSocket::ConnectResult::FAILED:
+        default:
+            log_message("Socket connection failed");
+            record_socket_transfer(false);
             socket_close();
             reset_operation_state();
             return false;
-#endif
-        }
-        
-        // ESPHome: Connection in progress - mark as connected optimistically
-        // The socket will fail on send/receive if not actually connected
-        socket_connected_ = true;
-        socket_connections_made_++;
-        ESP_LOGI(TAG, "[SOCKET] Connection initiated (async)");
-        return true;
-        
-    } catch (const std::exception& e) {
-        log_message("Socket connection error: " + std::string(e.what()));
-        log_message("Socket connection failed");
-        socket_close();
-        reset_operation_state();
-        return false;
     }
 }
 
-bool WebInkNetworkClient::socket_send(const std::string& data) {
-    if (!socket_connected_ || !socket_) {
+bool WebInkNetworkClient::socket_send(const char* data, size_t length) {
+    if (!socket_is_connected()) {
         log_message("Socket not connected for send");
         return false;
     }
     
-    try {
-        ssize_t sent = socket_->write(data.c_str(), data.length());
-        if (sent != static_cast<ssize_t>(data.length())) {
-            log_message("Socket send incomplete: " + std::to_string(sent) + "/" + std::to_string(data.length()));
-            return false;
-        }
-        
-        socket_bytes_sent_ += sent;
-        ESP_LOGD(TAG, "[SOCKET] Sent %zu bytes", data.length());
-        
-        return true;
-        
-    } catch (const std::exception& e) {
-        log_message("Socket send exception: " + std::string(e.what()));
+    int sent = socket_.write(data, length);
+    if (sent != static_cast<int>(length)) {
+        log_message("Socket send incomplete: %d/%zu", sent, length);
         return false;
     }
+    
+    socket_bytes_sent_ += sent;
+    socket_transfer_sent_ += sent;
+    socket_request_time_ = millis();
+    WEBINK_LOGD(TAG, "[SOCKET] Sent %zu bytes", length);
+    
+    return true;
 }
 
-bool WebInkNetworkClient::socket_receive_stream(std::function<void(const uint8_t*, int)> callback,
+bool WebInkNetworkClient::socket_receive_stream(SocketDataCallback callback,
                                                 int max_bytes,
                                                 unsigned long timeout_ms) {
-    if (!socket_connected_ || !socket_) {
+    if (!socket_is_connected()) {
         log_message("Socket not connected for receive");
         return false;
     }
@@ -583,28 +657,147 @@ bool WebInkNetworkClient::socket_receive_stream(std::function<void(const uint8_t
     socket_stream_callback_ = callback;
     socket_bytes_remaining_ = max_bytes;
     
-    ESP_LOGI(TAG, "[SOCKET] Starting stream receive (max: %d bytes, timeout: %lu ms)", 
-             max_bytes, current_timeout_ms_);
+    WEBINK_LOGI(TAG, "[SOCKET] Starting stream receive (max: %d bytes, timeout: %lu ms)", 
+                max_bytes, current_timeout_ms_);
+    WebInkTrace::begin(TraceEvent::SOCKET);
     
     return true;
 }
 
 void WebInkNetworkClient::socket_close() {
-    if (socket_) {
-        try {
-            socket_->close();
-        } catch (const std::exception& e) {
-            ESP_LOGW(TAG, "[SOCKET] Close exception: %s", e.what());
+    if (socket_.is_open()) {
+        socket_.close();
+        WEBINK_LOGD(TAG, "[SOCKET] Closed");
+    }
+    socket_connected_ = false;
+}
+
+bool WebInkNetworkClient::socket_is_connected() {
+    if (socket_connected_) {
+        return true;
+    }
+    if (!socket_.is_open()) {
+        return false;
+    }
+    
+    switch (socket_.poll_connect()) {
+        case WebInkSocket::PollResult::CONNECTED:
+            socket_connected_ = true;
+            WEBINK_LOGI(TAG, "[SOCKET] Connected after %lu ms", millis() - socket_connect_start_);
+            return true;
+            
+        case WebInkSocket::PollResult::PENDING:
+            if (millis() - socket_connect_start_ <= current_timeout_ms_) {
+                return false;
+            }
+            last_error_message_ = "Socket connect timeout";
+            WEBINK_LOGW(TAG, "[SOCKET] Connect timeout after %lu ms", current_timeout_ms_);
+            break;
+            
+        case WebInkSocket::PollResult::FAILED:
+        default:
+            last_error_message_ = "Socket connect failed";
+            WEBINK_LOGW(TAG, "[SOCKET] Connect failed: %s", strerror(socket_.error()));
+            break;
+    }
+    
+    record_socket_transfer(false);
+    socket_close();
+    return false;
+}
+
+bool WebInkNetworkClient::socket_is_connecting() {
+    return !socket_is_connected() && socket_.is_open();
+}
+
+bool WebInkNetworkClient::socket_adopt(WebInkSocket& socket) {
+    if (!socket.is_connected()) {
+        return false;
+    }
+    
+    socket_close();
+    socket_.adopt(socket.release());
+    socket_connected_ = true;
+    socket_connections_made_++;
+    
+    // Transfer statistics start here, like a connect that finished at once
+    socket_connect_start_ = millis();
+    socket_request_time_ = socket_connect_start_;
+    socket_first_byte_time_ = 0;
+    socket_transfer_sent_ = 0;
+    socket_transfer_received_ = 0;
+    
+    WEBINK_LOGI(TAG, "[SOCKET] Using connection opened by the server race");
+    return true;
+}
+
+//=============================================================================
+// NAME RESOLUTION
+//=============================================================================
+
+bool WebInkNetworkClient::resolve_host(const char* host, uint32_t& ipv4) {
+    if (parse_ipv4(host, ipv4)) {
+        return true;
+    }
+    if (!validate_host(host)) {
+        log_message("Invalid hostname: %s", host ? host : "NULL");
+        return false;
+    }
+    
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+    if (host_resolver_ != nullptr) {
+        bool resolved = host_resolver_(host, ipv4);
+        WEBINK_LOGI(TAG, "[DNS] Host resolver %s %s", resolved ? "resolved" : "failed to resolve", host);
+        return resolved;
+    }
+#endif
+    
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    
+    unsigned long start_time = millis();
+    WebInkTrace::begin(TraceEvent::DNS);
+    int err = getaddrinfo(host, nullptr, &hints, &result);
+    WebInkTrace::end(TraceEvent::DNS);
+    unsigned long elapsed = millis() - start_time;
+    
+    NetTransfer transfer;
+    transfer.success = (err == 0 && result);
+    transfer.total_ms = elapsed;
+    stats_.record(NetOperation::DNS, transfer);
+    
+    if (err != 0 || !result) {
+        if (result) {
+            freeaddrinfo(result);
         }
-        socket_.reset();
+        WEBINK_LOGW(TAG, "[DNS] Failed to resolve %s after %lu ms (error %d)", host, elapsed, err);
+        return false;
     }
     
-    socket_connected_ = false;
-    ESP_LOGD(TAG, "[SOCKET] Closed");
+    ipv4 = reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(result);
+    
+    char ip_text[16];
+    format_ipv4(ipv4, ip_text, sizeof(ip_text));
+    WEBINK_LOGI(TAG, "[DNS] Resolved %s to %s in %lu ms", host, ip_text, elapsed);
+    return true;
+}
+
+bool WebInkNetworkClient::parse_ipv4(const char* text, uint32_t& ipv4) {
+    struct in_addr addr;
+    if (!text || inet_pton(AF_INET, text, &addr) != 1) {
+        return false;
+    }
+    ipv4 = addr.s_addr;
+    return true;
 }
 
-bool WebInkNetworkClient::socket_is_connected() const {
-    return socket_connected_ && socket_ != nullptr;
+void WebInkNetworkClient::format_ipv4(uint32_t ipv4, char* buffer, size_t buffer_size) {
+    // Network byte order: first octet is the lowest-addressed byte
+    const uint8_t* octets = reinterpret_cast<const uint8_t*>(&ipv4);
+    snprintf(buffer, buffer_size, "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
 }
 
 //=============================================================================
@@ -644,48 +837,50 @@ void WebInkNetworkClient::cancel_all_operations() {
     }
     
     if (socket_operation_pending_) {
-        complete_socket_operation();
+        complete_socket_operation(false);
     }
     
     reset_operation_state();
-    ESP_LOGD(TAG, "All operations cancelled");
+    WEBINK_LOGD(TAG, "All operations cancelled");
 }
 
 void WebInkNetworkClient::set_http_timeout(unsigned long timeout_ms) {
     default_http_timeout_ms_ = timeout_ms;
-    ESP_LOGD(TAG, "HTTP timeout set to %lu ms", timeout_ms);
+    WEBINK_LOGD(TAG, "HTTP timeout set to %lu ms", timeout_ms);
 }
 
 void WebInkNetworkClient::set_socket_timeout(unsigned long timeout_ms) {
     default_socket_timeout_ms_ = timeout_ms;
-    ESP_LOGD(TAG, "Socket timeout set to %lu ms", timeout_ms);
+    WEBINK_LOGD(TAG, "Socket timeout set to %lu ms", timeout_ms);
+}
+
+void WebInkNetworkClient::set_http_keep_alive(bool keep_alive) {
+    http_keep_alive_ = keep_alive;
+    
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+    // Turning keep-alive off closes any idle connection right away
+    if (!keep_alive && !http_operation_pending_ && esp_http_client_ != nullptr) {
+        esp_http_client_cleanup(esp_http_client_);
+        esp_http_client_ = nullptr;
+    }
+#endif
+    WEBINK_LOGD(TAG, "HTTP keep-alive %s", keep_alive ? "enabled" : "disabled");
 }
 
 //=============================================================================
 // STATISTICS AND MONITORING
 //=============================================================================
 
-std::string WebInkNetworkClient::get_statistics() const {
-    static char buffer[128];  // Much smaller static buffer instead of 512 byte stack allocation!
-    snprintf(buffer, sizeof(buffer),
-             "[STATS] HTTP: %d sent, %d successful; Socket: %d connections, %d sent, %d received bytes",
-             http_requests_sent_,
-             http_requests_successful_,
-             socket_connections_made_,
-             socket_bytes_sent_,
-             socket_bytes_received_);
-    
-    return std::string(buffer);
-}
-
 void WebInkNetworkClient::reset_statistics() {
+    stats_.reset();
     http_requests_sent_ = 0;
-    http_requests_successful_ = 0;
     socket_connections_made_ = 0;
     socket_bytes_sent_ = 0;
     socket_bytes_received_ = 0;
+    http_bytes_sent_ = 0;
+    http_bytes_received_ = 0;
     
-    ESP_LOGD(TAG, "Statistics reset");
+    WEBINK_LOGD(TAG, "Statistics reset");
 }
 
 std::string WebInkNetworkClient::get_last_error() const {
@@ -709,20 +904,28 @@ void WebInkNetworkClient::init_http_client() {
     
     esp_http_client_ = esp_http_client_init(&config);
     http_request_in_progress_ = false;
-    http_response_buffer_.clear();
+    release_response_buffers();
     
     if (esp_http_client_ == nullptr) {
-        ESP_LOGE(TAG, "Failed to initialize ESP32 HTTP client");
+        WEBINK_LOGE(TAG, "Failed to initialize ESP32 HTTP client");
         return;
     }
     
-    ESP_LOGD(TAG, "ESP32 HTTP client initialized successfully");
+    WEBINK_LOGD(TAG, "ESP32 HTTP client initialized successfully");
 #else
     // Mac integration test mode - HTTP client uses curl directly
-    ESP_LOGD(TAG, "HTTP client initialized (Mac integration test mode)");
+    WEBINK_LOGD(TAG, "HTTP client initialized (Mac integration test mode)");
 #endif
 }
 
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+void WebInkNetworkClient::release_response_buffers() {
+    // swap() rather than clear() so the buffers go back to the wake arena
+    ArenaString().swap(http_response_buffer_);
+    ArenaString().swap(http_content_hash_);
+}
+#endif
+
 void WebInkNetworkClient::process_http_operations() {
 #ifndef WEBINK_MAC_INTEGRATION_TEST
     // Real ESP32 HTTP client implementation
@@ -739,22 +942,22 @@ void WebInkNetworkClient::process_http_operations() {
         NetworkResult result;
         result.success = (status_code >= 200 && status_code < 300);
         result.status_code = status_code;
-        result.data = http_response_buffer_;
-        result.content = http_response_buffer_;  // Alias for compatibility
-        result.bytes_received = http_response_buffer_.length();
+        result.data.swap(http_response_buffer_);
+        result.bytes_received = result.data.length();
+        http_bytes_received_ += result.bytes_received;
         
         if (!result.success) {
             result.error_type = ErrorType::INVALID_RESPONSE;
             result.error_message = "HTTP request failed with status " + std::to_string(status_code);
-            ESP_LOGW(TAG, "HTTP request failed: %d", status_code);
+            WEBINK_LOGW(TAG, "HTTP request failed: %d", status_code);
         } else {
-            ESP_LOGD(TAG, "HTTP request completed: %d bytes, status %d", 
+            WEBINK_LOGD(TAG, "HTTP request completed: %d bytes, status %d", 
                     result.bytes_received, status_code);
         }
         
         // Clean up and complete operation
         http_request_in_progress_ = false;
-        http_response_buffer_.clear();
+        release_response_buffers();
         esp_http_client_cleanup(esp_http_client_);
         esp_http_client_ = nullptr;
         
@@ -778,7 +981,7 @@ void WebInkNetworkClient::process_http_operations() {
 }
 
 void WebInkNetworkClient::handle_http_timeout() {
-    ESP_LOGW(TAG, "[HTTP] Operation timeout after %lu ms", current_timeout_ms_);
+    WEBINK_LOGW(TAG, "[HTTP] Operation timeout after %lu ms", current_timeout_ms_);
     
 #ifndef WEBINK_MAC_INTEGRATION_TEST
     // Clean up ESP32 HTTP client on timeout
@@ -787,7 +990,7 @@ void WebInkNetworkClient::handle_http_timeout() {
         esp_http_client_ = nullptr;
     }
     http_request_in_progress_ = false;
-    http_response_buffer_.clear();
+    release_response_buffers();
 #endif
     
     NetworkResult result = create_error_result(ErrorType::SERVER_UNREACHABLE, 
@@ -795,15 +998,41 @@ void WebInkNetworkClient::handle_http_timeout() {
     complete_http_operation(result);
 }
 
+void WebInkNetworkClient::record_http_transfer(NetOperation op, bool success,
+                                               uint32_t bytes_sent, uint32_t bytes_received) {
+    // Every exit of http_get_async()/http_post_async() passes through here
+    WebInkTrace::end(op == NetOperation::HTTP_POST ? TraceEvent::HTTP_POST : TraceEvent::HTTP_GET,
+                     bytes_received);
+    
+    if (!WebInkNetStats::ENABLED) {
+        return;
+    }
+    
+    NetTransfer transfer;
+    transfer.success = success;
+    transfer.total_ms = millis() - operation_start_time_;
+    transfer.timed_out = !success && transfer.total_ms >= current_timeout_ms_;
+    transfer.bytes_sent = bytes_sent;
+    transfer.bytes_received = bytes_received;
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+    if (http_connected_time_ != 0) {
+        transfer.connect_ms = static_cast<int32_t>(http_connected_time_ - operation_start_time_);
+    }
+    if (http_first_byte_time_ != 0) {
+        transfer.ttfb_ms = static_cast<int32_t>(http_first_byte_time_ - operation_start_time_);
+    }
+#endif
+    stats_.record(op, transfer);
+}
+
 void WebInkNetworkClient::complete_http_operation(const NetworkResult& result) {
     if (http_callback_) {
         if (result.success) {
-            http_requests_successful_++;
-            ESP_LOGD(TAG, "[HTTP] Operation completed successfully (%d bytes)", 
-                     result.bytes_received);
+            WEBINK_LOGD(TAG, "[HTTP] Operation completed successfully (%d bytes)", 
+                        result.bytes_received);
         } else {
             last_error_message_ = result.error_message;
-            ESP_LOGW(TAG, "[HTTP] Operation failed: %s", result.error_message.c_str());
+            WEBINK_LOGW(TAG, "[HTTP] Operation failed: %s", result.error_message.c_str());
         }
         
         http_callback_(result);
@@ -819,7 +1048,7 @@ void WebInkNetworkClient::complete_http_operation(const NetworkResult& result) {
 //=============================================================================
 
 void WebInkNetworkClient::process_socket_operations() {
-    if (!socket_stream_callback_ || !socket_) {
+    if (!socket_stream_callback_) {
         return;
     }
     
@@ -833,99 +1062,88 @@ void WebInkNetworkClient::process_socket_operations() {
     static const int BUFFER_SIZE = 512;  // Reduced from 1024 to 512 bytes
     static uint8_t buffer[BUFFER_SIZE];   // Static to avoid stack allocation each call
     
-    try {
-        if (socket_->ready()) {
-            ssize_t bytes_read = socket_->read(buffer, BUFFER_SIZE);
-            if (bytes_read > 0) {
-                socket_bytes_received_ += bytes_read;
-                
-                // Call stream callback with received data
-                socket_stream_callback_(buffer, static_cast<int>(bytes_read));
-                
-                // Update remaining bytes if limit is set
-                if (socket_bytes_remaining_ > 0) {
-                    socket_bytes_remaining_ -= bytes_read;
-                    if (socket_bytes_remaining_ <= 0) {
-                        ESP_LOGI(TAG, "[SOCKET] Receive limit reached");
-                        complete_socket_operation();
-                    }
-                }
-                
-                ESP_LOGD(TAG, "[SOCKET] Received %zd bytes", bytes_read);
-            } else if (bytes_read == 0) {
-                // Connection closed by peer
-                ESP_LOGI(TAG, "[SOCKET] Connection closed by peer");
+    if (!socket_.readable()) {
+        return;
+    }
+    
+    int bytes_read = socket_.read(buffer, BUFFER_SIZE);
+    if (bytes_read > 0) {
+        socket_bytes_received_ += bytes_read;
+        socket_transfer_received_ += bytes_read;
+        stats_.add_bytes_copied(bytes_read);  // lwIP into the static buffer
+        if (socket_first_byte_time_ == 0) {
+            socket_first_byte_time_ = millis();
+        }
+        
+        // Call stream callback with received data
+        socket_stream_callback_(buffer, bytes_read);
+        
+        // Update remaining bytes if limit is set
+        if (socket_bytes_remaining_ > 0) {
+            socket_bytes_remaining_ -= bytes_read;
+            if (socket_bytes_remaining_ <= 0) {
+                WEBINK_LOGI(TAG, "[SOCKET] Receive limit reached");
                 complete_socket_operation();
             }
         }
         
-    } catch (const std::exception& e) {
-        ESP_LOGE(TAG, "[SOCKET] Receive exception: %s", e.what());
-        handle_socket_timeout();
+        WEBINK_LOGD_RATE(TAG, LOG_RATE_INTERVAL_MS, "[SOCKET] Received %d bytes", bytes_read);
+    } else if (bytes_read == 0) {
+        // Connection closed by peer
+        WEBINK_LOGI(TAG, "[SOCKET] Connection closed by peer");
+        complete_socket_operation();
     }
 }
 
 void WebInkNetworkClient::handle_socket_timeout() {
-    ESP_LOGW(TAG, "[SOCKET] Operation timeout after %lu ms", current_timeout_ms_);
+    WEBINK_LOGW(TAG, "[SOCKET] Operation timeout after %lu ms", current_timeout_ms_);
     last_error_message_ = "Socket operation timeout";
-    complete_socket_operation();
+    complete_socket_operation(false);
 }
 
-void WebInkNetworkClient::complete_socket_operation() {
-    ESP_LOGD(TAG, "[SOCKET] Operation completed (%d bytes received)", socket_bytes_received_);
+void WebInkNetworkClient::complete_socket_operation(bool success) {
+    WEBINK_LOGD(TAG, "[SOCKET] Operation completed (%d bytes received)", socket_bytes_received_);
+    
+    if (socket_operation_pending_) {
+        WebInkTrace::end(TraceEvent::SOCKET, socket_transfer_received_);
+        record_socket_transfer(success);
+    }
     
     socket_stream_callback_ = nullptr;
     socket_operation_pending_ = false;
     pending_operation_ = false;
 }
 
-bool WebInkNetworkClient::check_socket_errors() {
-    if (!socket_) {
-        return true;
-    }
-    
-    // Check socket for errors using appropriate system calls
-#ifdef WEBINK_MAC_INTEGRATION_TEST
-    // Mac integration test - check POSIX socket status
-    MacSocket* mac_socket = static_cast<MacSocket*>(socket_.get());
-    if (!mac_socket || !mac_socket->is_connected()) {
-        return true; // Error detected
+void WebInkNetworkClient::record_socket_transfer(bool success) {
+    if (!WebInkNetStats::ENABLED) {
+        return;
     }
     
-    // Use SO_ERROR to check for socket errors
-    int sock_fd = mac_socket->get_socket_fd();
-    if (sock_fd < 0) {
-        return true; // Invalid socket
+    unsigned long now = millis();
+    NetTransfer transfer;
+    transfer.success = success;
+    transfer.timed_out = !success && has_operation_timed_out();
+    transfer.total_ms = now - socket_connect_start_;
+    if (socket_first_byte_time_ != 0) {
+        transfer.ttfb_ms = static_cast<int32_t>(socket_first_byte_time_ - socket_request_time_);
     }
-    
-    int error = 0;
-    socklen_t len = sizeof(error);
-    if (getsockopt(sock_fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
-        ESP_LOGW(TAG, "[SOCKET] Failed to check socket status");
-        return true; // Error checking failed
+    transfer.bytes_sent = socket_transfer_sent_;
+    transfer.bytes_received = socket_transfer_received_;
+    stats_.record(NetOperation::SOCKET, transfer);
+}
+
+bool WebInkNetworkClient::check_socket_errors() {
+    if (!socket_connected_ || !socket_.is_open()) {
+        return true; // Disconnected
     }
     
+    // Use SO_ERROR to check for socket errors
+    int error = socket_.error();
     if (error != 0) {
-        ESP_LOGW(TAG, "[SOCKET] Socket error detected: %d (%s)", error, strerror(error));
+        WEBINK_LOGW(TAG, "[SOCKET] Socket error detected: %d (%s)", error, strerror(error));
         return true; // Socket has error
     }
     
-#else
-    // ESP32 - check ESPHome socket status
-    try {
-        // ESPHome sockets have error checking methods
-        if (!socket_connected_) {
-            return true; // Disconnected
-        }
-        
-        // Additional ESP32-specific socket error checks could be added here
-        
-    } catch (const std::exception& e) {
-        ESP_LOGW(TAG, "[SOCKET] Exception checking socket: %s", e.what());
-        return true; // Exception indicates error
-    }
-#endif
-    
     return false; // No errors detected
 }
 
@@ -937,11 +1155,19 @@ bool WebInkNetworkClient::has_operation_timed_out() const {
     return (millis() - operation_start_time_) > current_timeout_ms_;
 }
 
-void WebInkNetworkClient::log_message(const std::string& message) {
+void WebInkNetworkClient::log_message(const char* format, ...) {
+    if (!log_callback_ && !WEBINK_LOG_ENABLED(WEBINK_LOG_LEVEL_DEBUG)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    const char* message = log_vformat(format, args);
+    va_end(args);
+
     if (log_callback_) {
         log_callback_(message);
     }
-    ESP_LOGD(TAG, "%s", message.c_str());
+    WEBINK_LOGD(TAG, "%s", message);
 }
 
 NetworkResult WebInkNetworkClient::create_error_result(ErrorType error_type, 
@@ -966,22 +1192,55 @@ void WebInkNetworkClient::reset_operation_state() {
     socket_stream_callback_ = nullptr;
 }
 
-bool WebInkNetworkClient::validate_url(const std::string& url) const {
-    // Basic URL validation
-    std::regex url_pattern(R"(^https?://[a-zA-Z0-9.-]+(?::\d+)?(?:/.*)?$)");
-    return std::regex_match(url, url_pattern);
+bool WebInkNetworkClient::validate_url(const char* url) const {
+    // Basic URL validation: http(s)://host[:port][/path]
+    // Scanned by hand - a std::regex here was compiled on every request
+    if (url == nullptr) {
+        return false;
+    }
+    
+    const char* p;
+    if (strncmp(url, "http://", 7) == 0) {
+        p = url + 7;
+    } else if (strncmp(url, "https://", 8) == 0) {
+        p = url + 8;
+    } else {
+        return false;
+    }
+    
+    const char* host = p;
+    while (isalnum(static_cast<unsigned char>(*p)) || *p == '.' || *p == '-') {
+        p++;
+    }
+    if (p == host) {
+        return false;
+    }
+    
+    if (*p == ':') {
+        const char* port = ++p;
+        while (isdigit(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+        if (p == port) {
+            return false;
+        }
+    }
+    
+    return *p == '\0' || *p == '/';
 }
 
-bool WebInkNetworkClient::validate_host(const std::string& host) const {
-    if (host.empty() || host.length() > 253) {
+bool WebInkNetworkClient::validate_host(const char* host) const {
+    // Addresses and hostnames: letters, digits, dots and hyphens.
+    // Scanned by hand like validate_url() - std::regex compiled on every call
+    if (host == nullptr || host[0] == '\0') {
         return false;
     }
     
-    // Allow IP addresses and hostnames
-    std::regex ip_pattern(R"(^(\d{1,3}\.){3}\d{1,3}$)");
-    std::regex hostname_pattern(R"(^[a-zA-Z0-9.-]+$)");
-    
-    return std::regex_match(host, ip_pattern) || std::regex_match(host, hostname_pattern);
+    const char* p = host;
+    while (isalnum(static_cast<unsigned char>(*p)) || *p == '.' || *p == '-') {
+        p++;
+    }
+    return *p == '\0' && p - host <= 253;
 }
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
@@ -991,6 +1250,20 @@ bool WebInkNetworkClient::validate_host(const std::string& host) const {
 
 // HTTPResponse is now declared in header for Mac integration tests
 
+WebInkNetworkClient::HostHttpHandler WebInkNetworkClient::host_http_handler_ = nullptr;
+WebInkNetworkClient::HostResolver WebInkNetworkClient::host_resolver_ = nullptr;
+
+NetworkResult WebInkNetworkClient::perform_host_request(const char* url, const char* body, size_t body_length) {
+    NetworkResult result;
+    host_http_handler_(url, body, body_length, result);
+    result.bytes_received = static_cast<int>(result.data.size());
+    if (!result.success) {
+        result.error_type = result.status_code == 0 ? ErrorType::SERVER_UNREACHABLE : ErrorType::INVALID_RESPONSE;
+        result.error_message = "Host handler failed";
+    }
+    return result;
+}
+
 NetworkResult WebInkNetworkClient::perform_curl_request(const std::string& url) {
     NetworkResult result;
     
@@ -1020,7 +1293,9 @@ NetworkResult WebInkNetworkClient::perform_curl_request(const std::string& url)
     if (file.is_open()) {
         std::stringstream ss;
         ss << file.rdbuf();
-        result.content = ss.str();
+        std::string body = ss.str();
+        result.data.assign(body.data(), body.size());
+        result.bytes_received = static_cast<int>(body.size());
         file.close();
         unlink(temp_file.c_str()); // Delete temp file
     }
@@ -1082,7 +1357,9 @@ NetworkResult WebInkNetworkClient::perform_curl_post_request(const std::string&
     if (response_file.is_open()) {
         std::stringstream ss;
         ss << response_file.rdbuf();
-        result.content = ss.str();
+        std::string body = ss.str();
+        result.data.assign(body.data(), body.size());
+        result.bytes_received = static_cast<int>(body.size());
         response_file.close();
     }
     
@@ -1106,7 +1383,7 @@ bool WebInkNetworkClient::get_url_content(const std::string& url, HTTPResponse&
     NetworkResult result = perform_curl_request(url);
     
     response.status_code = result.status_code;
-    response.content = result.content;
+    response.content.assign(result.data.data(), result.data.size());
     response.success = result.success;
     
     return result.success;
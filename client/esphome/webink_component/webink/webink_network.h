@@ -23,8 +23,8 @@
 
 #include <string>
 #include <cstdint>
-#include <functional>
 #include <chrono>
+#include <memory>
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
 // Mac integration test mode - use local declarations
@@ -40,18 +40,11 @@ unsigned long millis();
 namespace http_request {
     class HttpRequestComponent {};
 }
-namespace esphome_socket {
-    class Socket {};
-}
-
-// Forward declare MacSocket for Mac builds
-class MacSocket;
 #else
 // Normal ESPHome mode
 #include "esphome/core/log.h"
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
-#include "esphome/components/socket/socket.h"
 #include "esphome/components/http_request/http_request.h"
 // ESP32 HTTP client for real implementation
 #include "esp_http_client.h"
@@ -59,11 +52,111 @@ class MacSocket;
 #endif
 
 #include "webink_config.h"
+#include "webink_delegate.h"
+#include "webink_log.h"
+#include "webink_net_stats.h"
+#include "webink_trace.h"
 #include "webink_types.h"
 
 namespace esphome {
 namespace webink {
 
+/// Completion callback of http_get_async() / http_post_async()
+using NetworkCallback = WebInkDelegate<void(NetworkResult)>;
+
+/// Chunk callback of socket_receive_stream()
+using SocketDataCallback = WebInkDelegate<void(const uint8_t*, int)>;
+
+/**
+ * @class WebInkSocket
+ * @brief Non-blocking IPv4 TCP socket held by value
+ * 
+ * A thin wrapper over the BSD socket calls, which lwIP provides on the
+ * ESP32 and the host provides natively. WebInkNetworkClient keeps one as a
+ * member, so connecting does not allocate a socket object.
+ */
+class WebInkSocket {
+public:
+    /// Outcome of connect()
+    enum class ConnectResult {
+        CONNECTED,      ///< Connected immediately (loopback, or a connect that raced the call)
+        IN_PROGRESS,    ///< Handshake under way - poll_connect() reports the result
+        FAILED          ///< Socket could not be created or the connect was refused at once
+    };
+
+    /// Outcome of poll_connect()
+    enum class PollResult {
+        CONNECTED,      ///< Handshake finished
+        PENDING,        ///< Still connecting
+        FAILED          ///< Handshake failed (refused, unreachable, not open)
+    };
+
+    WebInkSocket() : fd_(-1), connected_(false) {}
+    ~WebInkSocket() { close(); }
+    WebInkSocket(const WebInkSocket&) = delete;
+    WebInkSocket& operator=(const WebInkSocket&) = delete;
+
+    /**
+     * @brief Open a non-blocking socket and start connecting
+     * @param ipv4 Address in network byte order
+     * @param port Port number
+     * @return Connect outcome; closes any socket that was open before
+     */
+    ConnectResult connect(uint32_t ipv4, int port);
+
+    /**
+     * @brief Check a connect in progress without blocking
+     * @return Connect state; CONNECTED stays CONNECTED until close()
+     */
+    PollResult poll_connect();
+
+    /**
+     * @brief Take over a connected non-blocking socket
+     * @param fd Descriptor (closed by this object from now on)
+     */
+    void adopt(int fd);
+
+    /**
+     * @brief Give up the descriptor without closing it
+     * @return Descriptor, or -1 if none was open
+     */
+    int release();
+
+    /**
+     * @brief Read without blocking
+     * @return Bytes read, 0 when the peer closed, -1 on error or when nothing is waiting
+     */
+    int read(uint8_t* buffer, size_t length);
+
+    /**
+     * @brief Write without blocking
+     * @return Bytes written, or -1 on error
+     */
+    int write(const char* data, size_t length);
+
+    /**
+     * @brief Check for data (or a close) waiting to be read, without blocking
+     */
+    bool readable() const;
+
+    /**
+     * @brief Pending socket error (SO_ERROR), 0 if none
+     */
+    int error() const;
+
+    /**
+     * @brief Close the descriptor, if open
+     */
+    void close();
+
+    bool is_open() const { return fd_ >= 0; }
+    bool is_connected() const { return connected_; }
+
+private:
+    int fd_;            ///< Descriptor, -1 when closed
+    bool connected_;    ///< Handshake finished
+};
+
 /**
  * @class WebInkNetworkClient
  * @brief Defensive network client with timeout handling and error recovery
@@ -97,7 +190,8 @@ namespace webink {
  * @code
  * WebInkNetworkClient client(config);
  * if (client.socket_connect_async("server", 8091)) {
- *     client.socket_send("webInkV1 key device mode 0 0 800 480 pbm\n");
+ *     const char request[] = "webInkV1 key device mode 0 0 800 480 pbm\n";
+ *     client.socket_send(request, sizeof(request) - 1);
  *     client.socket_receive_stream([](uint8_t* data, int length) {
  *         // Process received data
  *     });
@@ -112,7 +206,7 @@ public:
      * @param log_callback Optional callback for logging messages
      */
     WebInkNetworkClient(WebInkConfig* config, 
-                       std::function<void(const std::string&)> log_callback = nullptr);
+                       LogCallback log_callback = nullptr);
 
     /**
      * @brief Destructor ensures cleanup of resources
@@ -125,7 +219,7 @@ public:
 
     /**
      * @brief Perform async HTTP GET request
-     * @param url Complete URL to request
+     * @param url Complete URL to request (copied; the buffer may be reused after the call)
      * @param callback Function called when request completes or times out
      * @param timeout_ms Timeout in milliseconds (0 = use default)
      * @return True if request was initiated successfully
@@ -133,23 +227,25 @@ public:
      * Performs non-blocking HTTP GET request with timeout handling.
      * The callback is called exactly once with the result.
      */
-    bool http_get_async(const std::string& url, 
-                       std::function<void(NetworkResult)> callback,
+    bool http_get_async(const char* url,
+                       NetworkCallback callback,
                        unsigned long timeout_ms = 0);
 
     /**
      * @brief Perform async HTTP POST request
-     * @param url Complete URL to post to
-     * @param body Request body data
+     * @param url Complete URL to post to (copied; the buffer may be reused after the call)
+     * @param body Request body data (must stay valid until the callback ran)
+     * @param body_length Request body bytes
      * @param callback Function called when request completes or times out
      * @param content_type Content-Type header value
      * @param timeout_ms Timeout in milliseconds (0 = use default)
      * @return True if request was initiated successfully
      */
-    bool http_post_async(const std::string& url,
-                        const std::string& body,
-                        std::function<void(NetworkResult)> callback,
-                        const std::string& content_type = "text/plain",
+    bool http_post_async(const char* url,
+                        const char* body,
+                        size_t body_length,
+                        NetworkCallback callback,
+                        const char* content_type = "text/plain",
                         unsigned long timeout_ms = 0);
 
     //=========================================================================
@@ -164,20 +260,22 @@ public:
      * @return True if connection attempt was initiated
      * 
      * Initiates non-blocking socket connection. Use socket_is_connected()
-     * to check connection status.
+     * to check connection status. A hostname is resolved first (blocking);
+     * pass a resolved address where blocking is not allowed.
      */
-    bool socket_connect_async(const std::string& host, int port, 
+    bool socket_connect_async(const char* host, int port, 
                              unsigned long timeout_ms = 0);
 
     /**
      * @brief Send data over connected socket
      * @param data Data to send
+     * @param length Bytes of data to send
      * @return True if data was sent successfully
      * 
      * Sends data over established socket connection. Returns false
      * if socket is not connected or send fails.
      */
-    bool socket_send(const std::string& data);
+    bool socket_send(const char* data, size_t length);
 
     /**
      * @brief Receive data from socket with streaming callback
@@ -189,7 +287,7 @@ public:
      * Receives data in chunks and calls callback for each chunk.
      * This allows for memory-efficient processing of large responses.
      */
-    bool socket_receive_stream(std::function<void(const uint8_t*, int)> callback,
+    bool socket_receive_stream(SocketDataCallback callback,
                               int max_bytes = 0,
                               unsigned long timeout_ms = 0);
 
@@ -201,8 +299,55 @@ public:
     /**
      * @brief Check if socket is connected
      * @return True if socket connection is active
+     * 
+     * Polls a connect in progress without blocking. A connect that failed
+     * or ran past its timeout closes the socket.
+     */
+    bool socket_is_connected();
+
+    /**
+     * @brief Check if a connect is still in progress
+     * @return True while the handshake has neither finished nor failed
+     */
+    bool socket_is_connecting();
+
+    /**
+     * @brief Use a socket connected elsewhere (the server race) as the connection
+     * @param socket Connected socket; left closed, its descriptor moves here
+     * @return True if the socket was connected
+     */
+    bool socket_adopt(WebInkSocket& socket);
+
+    //=========================================================================
+    // NAME RESOLUTION
+    //=========================================================================
+
+    /**
+     * @brief Resolve a hostname to an IPv4 address (blocking)
+     * @param host Hostname or dotted-quad address
+     * @param ipv4 Receives the address in network byte order
+     * @return True if resolved
+     * 
+     * Blocks for the DNS round trip; call it only where a blocking
+     * operation is allowed.
+     */
+    bool resolve_host(const char* host, uint32_t& ipv4);
+
+    /**
+     * @brief Parse a dotted-quad IPv4 address
+     * @param text Address text
+     * @param ipv4 Receives the address in network byte order
+     * @return True if text is an IPv4 literal
+     */
+    static bool parse_ipv4(const char* text, uint32_t& ipv4);
+
+    /**
+     * @brief Format an IPv4 address as dotted-quad
+     * @param ipv4 Address in network byte order
+     * @param buffer Output buffer (at least 16 bytes)
+     * @param buffer_size Size of buffer
      */
-    bool socket_is_connected() const;
+    static void format_ipv4(uint32_t ipv4, char* buffer, size_t buffer_size);
 
     //=========================================================================
     // OPERATION MANAGEMENT
@@ -242,21 +387,60 @@ public:
      */
     void set_socket_timeout(unsigned long timeout_ms);
 
+    /**
+     * @brief Keep the HTTP connection open between requests
+     * @param keep_alive True to reuse the connection, false to close it now
+     * 
+     * Lets the hash request leave a warm connection for the first image
+     * slice. A failed request still tears the connection down.
+     */
+    void set_http_keep_alive(bool keep_alive);
+
+    /**
+     * @brief Check if HTTP keep-alive is enabled
+     * @return True if connections are kept open between requests
+     */
+    bool get_http_keep_alive() const { return http_keep_alive_; }
+
     //=========================================================================
     // STATISTICS AND MONITORING
     //=========================================================================
 
     /**
-     * @brief Get network statistics
-     * @return Human-readable statistics string
+     * @brief Get structured network statistics
+     * @return Per-operation counters and latency histograms
      */
-    std::string get_statistics() const;
+    const WebInkNetStats& get_stats() const { return stats_; }
+
+    /**
+     * @brief Count a request the caller repeats after a failure
+     * @param op Operation type being retried
+     */
+    void record_retry(NetOperation op) { stats_.record_retry(op); }
 
     /**
      * @brief Reset network statistics
      */
     void reset_statistics();
 
+    /**
+     * @brief Get bytes received since the last reset (HTTP bodies and socket data)
+     * @return Byte count
+     */
+    uint32_t get_bytes_received() const { return http_bytes_received_ + socket_bytes_received_; }
+
+    /**
+     * @brief Get bytes sent since the last reset (HTTP URLs and bodies, socket data)
+     * @return Byte count
+     */
+    uint32_t get_bytes_sent() const { return http_bytes_sent_ + socket_bytes_sent_; }
+
+    /**
+     * @brief Get HTTP requests and socket connections since the last reset
+     * @return Request count
+     */
+    uint32_t get_request_count() const { return http_requests_sent_ + socket_connections_made_; }
+
     /**
      * @brief Get last error message
      * @return Description of last network error
@@ -269,7 +453,7 @@ private:
     //=========================================================================
 
     WebInkConfig* config_;                           ///< Configuration reference
-    std::function<void(const std::string&)> log_callback_;  ///< Logging callback
+    LogCallback log_callback_;                       ///< Logging callback
 
     // Operation state
     bool pending_operation_;                         ///< Any operation pending
@@ -282,33 +466,42 @@ private:
 
     // HTTP state
     std::unique_ptr<http_request::HttpRequestComponent> http_client_;
-    std::function<void(NetworkResult)> http_callback_;
+    NetworkCallback http_callback_;
     bool http_operation_pending_;
+    bool http_keep_alive_;                           ///< Reuse connection across requests
 
     // ESP32 HTTP client state (non-Mac mode)
 #ifndef WEBINK_MAC_INTEGRATION_TEST
     esp_http_client_handle_t esp_http_client_;
-    std::string http_response_buffer_;
+    ArenaString http_response_buffer_;               ///< Body of current response, swapped into the result
+    ArenaString http_content_hash_;                  ///< X-WebInk-Hash header of current response
+    int http_sleep_seconds_;                         ///< X-WebInk-Sleep header of current response (-1 = none)
+    int http_next_change_seconds_;                   ///< X-WebInk-Next-Change header of current response (-1 = none)
     bool http_request_in_progress_;
+    unsigned long http_connected_time_;              ///< millis() of HTTP_EVENT_ON_CONNECTED (0 = reused)
+    unsigned long http_first_byte_time_;             ///< millis() of the first response header or data (0 = none)
 #endif
 
     // Socket state
-#ifdef WEBINK_MAC_INTEGRATION_TEST
-    std::unique_ptr<MacSocket> socket_;
-#else
-    std::unique_ptr<esphome::socket::Socket> socket_;
-#endif
-    std::function<void(const uint8_t*, int)> socket_stream_callback_;
+    WebInkSocket socket_;                            ///< Reused by every connect
+    SocketDataCallback socket_stream_callback_;
     bool socket_operation_pending_;
     bool socket_connected_;
     int socket_bytes_remaining_;
 
     // Statistics
+    WebInkNetStats stats_;                           ///< Per-operation counters and histograms
+    unsigned long socket_connect_start_;             ///< millis() of the last socket connect
+    unsigned long socket_request_time_;              ///< millis() of the last socket_send()
+    unsigned long socket_first_byte_time_;           ///< millis() of the first streamed byte (0 = none yet)
+    uint32_t socket_transfer_sent_;                  ///< Bytes sent since the last connect
+    uint32_t socket_transfer_received_;              ///< Bytes received since the last connect
     int http_requests_sent_;
-    int http_requests_successful_;
     int socket_connections_made_;
     int socket_bytes_sent_;
     int socket_bytes_received_;
+    uint32_t http_bytes_sent_;                       ///< Request URLs and POST bodies
+    uint32_t http_bytes_received_;                   ///< Response bodies
 
     // Error tracking
     std::string last_error_message_;
@@ -324,6 +517,13 @@ private:
      */
     void init_http_client();
 
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+    /**
+     * @brief Return the response body and hash header buffers to the wake arena
+     */
+    void release_response_buffers();
+#endif
+
     /**
      * @brief Process pending HTTP operations
      */
@@ -340,6 +540,15 @@ private:
      */
     void complete_http_operation(const NetworkResult& result);
 
+    /**
+     * @brief Record a finished HTTP request in the statistics
+     * @param op HTTP_GET or HTTP_POST
+     * @param success True if the server answered with 2xx
+     * @param bytes_sent URL and body bytes
+     * @param bytes_received Response body bytes
+     */
+    void record_http_transfer(NetOperation op, bool success, uint32_t bytes_sent, uint32_t bytes_received);
+
     //=========================================================================
     // INTERNAL SOCKET METHODS
     //=========================================================================
@@ -356,8 +565,15 @@ private:
 
     /**
      * @brief Complete socket operation
+     * @param success False if the stream ended by timeout, error or cancel
      */
-    void complete_socket_operation();
+    void complete_socket_operation(bool success = true);
+
+    /**
+     * @brief Record a finished socket connection in the statistics
+     * @param success True if the stream completed
+     */
+    void record_socket_transfer(bool success);
 
     /**
      * @brief Check for socket errors
@@ -377,9 +593,9 @@ private:
 
     /**
      * @brief Log network operation
-     * @param message Log message
+     * @param format printf format of the message
      */
-    void log_message(const std::string& message);
+    void log_message(const char* format, ...) __attribute__((format(printf, 2, 3)));
 
     /**
      * @brief Create error result
@@ -397,17 +613,17 @@ private:
 
     /**
      * @brief Validate URL format
-     * @param url URL to validate
+     * @param url URL to validate (nullptr is invalid)
      * @return True if URL is valid
      */
-    bool validate_url(const std::string& url) const;
+    bool validate_url(const char* url) const;
 
     /**
      * @brief Validate hostname/IP address
-     * @param host Hostname or IP to validate
+     * @param host Hostname or IP to validate (nullptr is invalid)
      * @return True if host is valid
      */
-    bool validate_host(const std::string& host) const;
+    bool validate_host(const char* host) const;
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
 public:
@@ -430,7 +646,45 @@ public:
      */
     bool get_url_content(const std::string& url, HTTPResponse& response);
 
+    /**
+     * @brief Serves requests in place of curl (host test drivers)
+     * @param url Request URL
+     * @param body POST body, or nullptr for a GET
+     * @param body_length POST body length
+     * @param result Result to fill (data, status_code, success)
+     */
+    using HostHttpHandler = void (*)(const char* url, const char* body, size_t body_length, NetworkResult& result);
+
+    /**
+     * @brief Route GET and POST requests to a handler instead of curl
+     * @param handler Handler, or nullptr to use curl again
+     */
+    static void set_host_http_handler(HostHttpHandler handler) { host_http_handler_ = handler; }
+
+    /**
+     * @brief Resolves hostnames in place of getaddrinfo() (host test drivers)
+     * @param host Hostname (never an address literal)
+     * @param ipv4 Address to fill, in network byte order
+     * @return True if resolved
+     */
+    using HostResolver = bool (*)(const char* host, uint32_t& ipv4);
+
+    /**
+     * @brief Route name resolution to a resolver instead of getaddrinfo()
+     * @param resolver Resolver, or nullptr to use getaddrinfo() again
+     */
+    static void set_host_resolver(HostResolver resolver) { host_resolver_ = resolver; }
+
 private:
+    static HostHttpHandler host_http_handler_;                  ///< Replaces curl when set
+    static HostResolver host_resolver_;                         ///< Replaces getaddrinfo() when set
+
+    /**
+     * @brief Fill a result from the host handler
+     * @return Result with bytes_received set from the handler's body
+     */
+    NetworkResult perform_host_request(const char* url, const char* body, size_t body_length);
+
     /**
      * @brief Perform HTTP GET using system curl
      * @param url URL to request
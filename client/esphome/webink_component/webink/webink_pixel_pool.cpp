@@ -0,0 +1,188 @@
+/**
+ * @file webink_pixel_pool.cpp
+ * @brief Implementation of WebInkPixelPool and PixelLease
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_pixel_pool.h"
+#include "webink_log.h"
+#include "webink_memory.h"
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkPixelPool::TAG = "webink.pool";
+
+namespace {
+
+const int SLOT_COUNT = WebInkPixelPool::BAND_SLOTS + WebInkPixelPool::ROW_SLOTS;
+
+uint8_t* pool_allocation = nullptr;                             // From WebInkMemory, ALIGNMENT-aligned
+size_t pool_total_bytes = 0;
+int pool_band_rows = 0;
+int pool_max_stride = 0;
+uint8_t* pool_slots[SLOT_COUNT] = {};                           // Bands first, then rows
+bool pool_leased[SLOT_COUNT] = {};
+uint32_t pool_failures = 0;
+
+} // namespace
+
+//=============================================================================
+// LEASE
+//=============================================================================
+
+void PixelLease::reset() {
+    if (data_ != nullptr) {
+        WebInkPixelPool::release(data_);
+        data_ = nullptr;
+    }
+}
+
+//=============================================================================
+// CONFIGURATION
+//=============================================================================
+
+int WebInkPixelPool::stride_for(int width, int bytes_per_pixel) {
+    int bytes = width * bytes_per_pixel;
+    return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+bool WebInkPixelPool::configure(int width, int band_rows, int bytes_per_pixel) {
+    if (width <= 0 || band_rows <= 0 || bytes_per_pixel <= 0) {
+        WEBINK_LOGE(TAG, "[POOL] Invalid layout %d rows of %dx%d bytes", band_rows, width, bytes_per_pixel);
+        return false;
+    }
+
+    int stride = stride_for(width, bytes_per_pixel);
+    if (pool_allocation != nullptr && stride <= pool_max_stride && band_rows <= pool_band_rows) {
+        return true;  // Existing buffers already cover this layout
+    }
+
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        if (pool_leased[i]) {
+            WEBINK_LOGE(TAG, "[POOL] Cannot resize while buffers are leased");
+            return false;
+        }
+    }
+
+    size_t band_bytes = static_cast<size_t>(stride) * band_rows;
+    size_t total = band_bytes * BAND_SLOTS + static_cast<size_t>(stride) * ROW_SLOTS;
+
+    // Rows are touched per pixel - PIXEL_ROWS keeps them in internal SRAM
+    WebInkMemory::release(pool_allocation);
+    pool_allocation = static_cast<uint8_t*>(WebInkMemory::allocate(total, MemoryRole::PIXEL_ROWS, ALIGNMENT));
+    if (pool_allocation == nullptr) {
+        WEBINK_LOGE(TAG, "[POOL] Failed to allocate %u bytes", (unsigned) total);
+        pool_total_bytes = 0;
+        pool_band_rows = 0;
+        pool_max_stride = 0;
+        return false;
+    }
+
+    uint8_t* next = pool_allocation;
+    for (int i = 0; i < BAND_SLOTS; i++) {
+        pool_slots[i] = next;
+        next += band_bytes;
+    }
+    for (int i = BAND_SLOTS; i < SLOT_COUNT; i++) {
+        pool_slots[i] = next;
+        next += stride;
+    }
+
+    pool_total_bytes = total;
+    pool_band_rows = band_rows;
+    pool_max_stride = stride;
+    WEBINK_LOGI(TAG, "[POOL] %u bytes: %d band(s) of %d rows and %d row buffer(s), stride %d",
+                (unsigned) total, BAND_SLOTS, band_rows, ROW_SLOTS, stride);
+    return true;
+}
+
+//=============================================================================
+// LEASING
+//=============================================================================
+
+PixelLease WebInkPixelPool::lease_band(int width, int rows, int bytes_per_pixel) {
+    int stride = stride_for(width, bytes_per_pixel);
+    if (pool_allocation == nullptr || rows <= 0 || rows > pool_band_rows ||
+        stride <= 0 || stride > pool_max_stride) {
+        return refuse("band", width, rows, bytes_per_pixel);
+    }
+
+    for (int i = 0; i < BAND_SLOTS; i++) {
+        if (!pool_leased[i]) {
+            pool_leased[i] = true;
+            return PixelLease(pool_slots[i], stride, rows);
+        }
+    }
+    return refuse("band", width, rows, bytes_per_pixel);
+}
+
+PixelLease WebInkPixelPool::lease_row(int width, int bytes_per_pixel) {
+    int stride = stride_for(width, bytes_per_pixel);
+    if (pool_allocation == nullptr || stride <= 0 || stride > pool_max_stride) {
+        return refuse("row", width, 1, bytes_per_pixel);
+    }
+
+    for (int i = BAND_SLOTS; i < SLOT_COUNT; i++) {
+        if (!pool_leased[i]) {
+            pool_leased[i] = true;
+            return PixelLease(pool_slots[i], stride, 1);
+        }
+    }
+    return refuse("row", width, 1, bytes_per_pixel);
+}
+
+PixelLease WebInkPixelPool::refuse(const char* kind, int width, int rows, int bytes_per_pixel) {
+    pool_failures++;
+    WEBINK_LOGW(TAG, "[POOL] No %s buffer for %d rows of %dx%d bytes (configured: %d rows, stride %d)",
+                kind, rows, width, bytes_per_pixel, pool_band_rows, pool_max_stride);
+    return PixelLease();
+}
+
+void WebInkPixelPool::release(uint8_t* data) {
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        if (pool_slots[i] == data) {
+            pool_leased[i] = false;
+            return;
+        }
+    }
+}
+
+//=============================================================================
+// STATISTICS
+//=============================================================================
+
+bool WebInkPixelPool::is_configured() {
+    return pool_allocation != nullptr;
+}
+
+int WebInkPixelPool::get_band_rows() {
+    return pool_band_rows;
+}
+
+int WebInkPixelPool::get_max_stride() {
+    return pool_max_stride;
+}
+
+size_t WebInkPixelPool::get_total_bytes() {
+    return pool_total_bytes;
+}
+
+int WebInkPixelPool::get_leased() {
+    int leased = 0;
+    for (int i = 0; i < SLOT_COUNT; i++) {
+        if (pool_leased[i]) {
+            leased++;
+        }
+    }
+    return leased;
+}
+
+uint32_t WebInkPixelPool::get_failures() {
+    return pool_failures;
+}
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,176 @@
+/**
+ * @file webink_pixel_pool.h
+ * @brief Fixed pool of aligned pixel buffers leased by PixelData
+ *
+ * Decoded pixel data (ASCII PGM/PPM bands, converter scratch rows) used to
+ * come from new[] per call and be freed through PixelData's destructor.
+ * WebInkPixelPool instead allocates its buffers once, when the controller
+ * is set up, sized from the display mode (as MemoryRole::PIXEL_ROWS, so in
+ * internal SRAM on PSRAM boards):
+ *
+ * - BAND_SLOTS band buffers of rows_per_slice rows
+ * - ROW_SLOTS single-row buffers for converters
+ *
+ * Every buffer and every row starts on an ALIGNMENT boundary: rows are
+ * padded to a stride that is a multiple of ALIGNMENT, so word-wise and
+ * vector kernels never need an unaligned head or tail.
+ *
+ * lease_band() / lease_row() hand out a PixelLease, a move-only handle that
+ * returns the buffer to the pool when destroyed. PixelData keeps the lease
+ * next to its data pointer, so a decoded band goes back to the pool when
+ * the PixelData holding it does. A lease that cannot be served (pool
+ * exhausted or request larger than the configured band) is empty and
+ * counted in get_failures(); nothing falls back to the heap.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @class PixelLease
+ * @brief Move-only handle on a WebInkPixelPool buffer
+ *
+ * Returns the buffer to the pool on destruction or reset(). Empty when
+ * default-constructed or when the pool could not serve the request.
+ */
+class PixelLease {
+public:
+    PixelLease() = default;
+    ~PixelLease() { reset(); }
+
+    PixelLease(PixelLease&& other) noexcept
+        : data_(other.data_), stride_(other.stride_), rows_(other.rows_) {
+        other.data_ = nullptr;
+    }
+
+    PixelLease& operator=(PixelLease&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            stride_ = other.stride_;
+            rows_ = other.rows_;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    PixelLease(const PixelLease&) = delete;
+    PixelLease& operator=(const PixelLease&) = delete;
+
+    explicit operator bool() const { return data_ != nullptr; }
+
+    uint8_t* data() const { return data_; }                     ///< First row (ALIGNMENT-aligned)
+    int stride() const { return stride_; }                      ///< Bytes per row, padded to ALIGNMENT
+    int rows() const { return rows_; }                          ///< Rows leased
+    uint8_t* row(int index) const { return data_ + index * stride_; }  ///< Start of a row
+
+    /**
+     * @brief Return the buffer to the pool now (no-op when empty)
+     */
+    void reset();
+
+private:
+    friend class WebInkPixelPool;
+
+    PixelLease(uint8_t* data, int stride, int rows) : data_(data), stride_(stride), rows_(rows) {}
+
+    uint8_t* data_ = nullptr;                                   ///< Leased buffer, nullptr when empty
+    int stride_ = 0;                                            ///< Padded bytes per row
+    int rows_ = 0;                                              ///< Rows in the buffer
+};
+
+/**
+ * @class WebInkPixelPool
+ * @brief Process-wide pool of band and row buffers (static; one per device)
+ *
+ * Main loop only - not safe to use from other tasks.
+ *
+ * @example Decoding a band
+ * @code
+ * WebInkPixelPool::configure(800, 8, 3);          // Once, from the display mode
+ *
+ * PixelLease band = WebInkPixelPool::lease_band(800, 8, 3);
+ * if (!band) return false;                        // Pool busy or band too large
+ * for (int y = 0; y < 8; y++) {
+ *     decode_row(band.row(y));
+ * }
+ * pixels = PixelData(std::move(band), 800, 8, 3, ColorMode::RGB_FULL_COLOR);
+ * // Buffer returns to the pool when pixels is destroyed or reassigned
+ * @endcode
+ */
+class WebInkPixelPool {
+public:
+    static const int ALIGNMENT = 16;                            ///< Buffer and row alignment in bytes
+    static const int BAND_SLOTS = 1;                            ///< Band buffers (one slice decoded at a time)
+    static const int ROW_SLOTS = 2;                             ///< Row buffers (e.g. dither error rows)
+
+    /**
+     * @brief Size and allocate the pool (the only allocation it makes)
+     * @param width Pixels per row
+     * @param band_rows Rows per band buffer (rows_per_slice)
+     * @param bytes_per_pixel Largest decoded pixel size for the display mode
+     * @return True if the buffers are available
+     *
+     * Reconfiguring with the same or a smaller layout keeps the existing
+     * buffers; a larger one replaces them and requires no outstanding leases.
+     */
+    static bool configure(int width, int band_rows, int bytes_per_pixel);
+
+    /**
+     * @brief Lease a band buffer
+     * @param width Pixels per row
+     * @param rows Rows needed
+     * @param bytes_per_pixel Bytes per pixel
+     * @return Lease with stride_for(width, bytes_per_pixel), empty on failure
+     */
+    static PixelLease lease_band(int width, int rows, int bytes_per_pixel);
+
+    /**
+     * @brief Lease a single-row buffer
+     * @param width Pixels in the row
+     * @param bytes_per_pixel Bytes per pixel
+     * @return Lease of one row, empty on failure
+     */
+    static PixelLease lease_row(int width, int bytes_per_pixel);
+
+    /**
+     * @brief Row stride used for a width and pixel size
+     * @return width * bytes_per_pixel rounded up to ALIGNMENT
+     */
+    static int stride_for(int width, int bytes_per_pixel);
+
+    static bool is_configured();                                ///< configure() succeeded
+    static int get_band_rows();                                 ///< Rows per band buffer
+    static int get_max_stride();                                ///< Largest stride a lease may have
+    static size_t get_total_bytes();                            ///< Bytes allocated by configure()
+    static int get_leased();                                    ///< Buffers currently leased
+    static uint32_t get_failures();                             ///< Leases refused since boot
+
+private:
+    friend class PixelLease;
+
+    static const char* TAG;                                     ///< Logging tag
+
+    /**
+     * @brief Return a buffer (called by PixelLease)
+     * @param data Buffer from lease_band() or lease_row()
+     */
+    static void release(uint8_t* data);
+
+    /**
+     * @brief Count and log a lease that could not be served
+     * @return Empty lease
+     */
+    static PixelLease refuse(const char* kind, int width, int rows, int bytes_per_pixel);
+};
+
+} // namespace webink
+} // namespace esphome
@@ -7,12 +7,92 @@
  */
 
 #include "webink_state.h"
+#include "webink_log.h"
+
+#include <cstddef>
+#include <ctime>
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esp_attr.h"
+#define WEBINK_RTC_NOINIT RTC_NOINIT_ATTR
+#else
+#define WEBINK_RTC_NOINIT
+#endif
 
 namespace esphome {
 namespace webink {
 
 const char* WebInkState::TAG = "webink.state";
 
+namespace {
+
+/**
+ * Persistent state as stored in RTC memory. Packed so the layout is identical
+ * across compiler versions.
+ *
+ * Layout rules for later firmware:
+ * - Fields are append-only; never reorder, resize or remove a field
+ * - Bump RTC_STATE_VERSION whenever fields are appended
+ * - A blob written by older firmware has a smaller payload_size; the missing
+ *   tail keeps the in-memory defaults
+ */
+struct __attribute__((packed)) RtcStatePayload {
+    char last_hash[16];                 ///< WebInkState::last_hash
+    uint32_t wake_counter;
+    uint32_t cycles_since_boot;
+    int32_t sleep_duration_seconds;
+    uint8_t deep_sleep_enabled;
+    uint8_t conditional_fetch_supported;
+    uint8_t current_error;              ///< ErrorType of the last cycle
+    uint8_t reserved;
+    char error_message[64];             ///< Truncated WebInkState::error_message
+    uint32_t cached_server_ip;
+    float change_rate;
+    uint16_t policy_uses[2];
+    uint16_t policy_hits[2];
+    uint32_t band_hashes[WebInkState::BAND_COUNT];
+    uint32_t cached_server_ip_time;     ///< Seconds since epoch when cached_server_ip was resolved
+    uint8_t preferred_server;
+    uint8_t server_failures[MAX_SERVERS];
+    uint16_t server_latency_ms[MAX_SERVERS];
+    uint32_t sleep_interval_time;       ///< Seconds since epoch when the server sent the sleep interval
+    uint32_t next_change_time;          ///< Seconds since epoch of the next planned content change
+    uint8_t state_time_counts[UPDATE_STATE_COUNT][Log2Histogram::BUCKETS];
+    uint32_t state_time_max_ms[UPDATE_STATE_COUNT];
+};
+
+struct __attribute__((packed)) RtcStateBlob {
+    uint32_t magic;                     ///< RTC_STATE_MAGIC
+    uint16_t version;                   ///< Layout version that wrote the payload
+    uint16_t payload_size;              ///< Bytes of payload written
+    uint32_t crc32;                     ///< CRC32 of the first payload_size payload bytes
+    RtcStatePayload payload;
+};
+
+const uint32_t RTC_STATE_MAGIC = 0x57495253;  // "WIRS"
+const uint16_t RTC_STATE_VERSION = 1;
+
+// Not re-initialized on reset: survives deep sleep and software resets,
+// holds garbage after power loss (rejected by magic and CRC)
+WEBINK_RTC_NOINIT RtcStateBlob rtc_state_blob;
+
+/// CRC32 (IEEE 802.3, reflected), nibble table - small and fast enough for a few hundred bytes
+uint32_t crc32(const uint8_t* data, size_t length) {
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+} // namespace
+
 //=============================================================================
 // CONSTRUCTOR AND DESTRUCTOR
 //=============================================================================
@@ -22,7 +102,9 @@ WebInkState::WebInkState() {
     strcpy(last_hash, "00000000");  // Default hash value
     error_message[0] = '\0';        // Empty error message
     
-    ESP_LOGD(TAG, "WebInkState initialized with fixed arrays (no dynamic allocation)");
+    load_from_rtc();
+    
+    WEBINK_LOGD(TAG, "WebInkState initialized with fixed arrays (no dynamic allocation)");
 }
 
 //=============================================================================
@@ -33,23 +115,23 @@ void WebInkState::increment_wake_counter() {
     wake_counter++;
     cycles_since_boot++;
     
-    ESP_LOGI(TAG, "Wake counter: %d, Cycles since boot: %d", 
-             wake_counter, cycles_since_boot);
+    WEBINK_LOGI(TAG, "Wake counter: %d, Cycles since boot: %d", 
+                wake_counter, cycles_since_boot);
 }
 
 void WebInkState::record_boot_time(unsigned long time) {
     // Only update boot time on actual power-on (not deep sleep wake)
     if (!is_deep_sleep_wake()) {
         boot_time = time;
-        ESP_LOGI(TAG, "Boot time recorded: %lu ms (power-on detected)", boot_time);
+        WEBINK_LOGI(TAG, "Boot time recorded: %lu ms (power-on detected)", boot_time);
     } else {
-        ESP_LOGI(TAG, "Deep sleep wake detected, keeping existing boot time: %lu ms", boot_time);
+        WEBINK_LOGI(TAG, "Deep sleep wake detected, keeping existing boot time: %lu ms", boot_time);
     }
 }
 
 void WebInkState::record_update_time(unsigned long time) {
     last_update_time = time;
-    ESP_LOGD(TAG, "Update time recorded: %lu ms", last_update_time);
+    WEBINK_LOGD(TAG, "Update time recorded: %lu ms", last_update_time);
 }
 
 void WebInkState::clear_error_flags() {
@@ -58,7 +140,7 @@ void WebInkState::clear_error_flags() {
     current_error = ErrorType::NONE;
     error_message[0] = '\0';  // Clear error message array
     
-    ESP_LOGD(TAG, "Error flags cleared");
+    WEBINK_LOGD(TAG, "Error flags cleared");
 }
 
 void WebInkState::set_error(ErrorType error, const char* message) {
@@ -74,8 +156,8 @@ void WebInkState::set_error(ErrorType error, const char* message) {
     
     last_cycle_had_error = true;
     
-    ESP_LOGE(TAG, "Error set: %s - %s", 
-             error_type_to_string(error), error_message);
+    WEBINK_LOGE(TAG, "Error set: %s - %s", 
+                error_type_to_string(error), error_message);
 }
 
 //=============================================================================
@@ -85,38 +167,38 @@ void WebInkState::set_error(ErrorType error, const char* message) {
 bool WebInkState::can_deep_sleep(bool boot_button_pressed, unsigned long current_time) const {
     // Check deep sleep enabled flag
     if (!deep_sleep_enabled) {
-        ESP_LOGW(TAG, "[SLEEP] Deep sleep disabled via configuration");
+        WEBINK_LOGW(TAG, "[SLEEP] Deep sleep disabled via configuration");
         return false;
     }
     
     // Check sleep duration (server can disable by setting to 0)
     if (sleep_duration_seconds == 0) {
-        ESP_LOGW(TAG, "[SLEEP] Sleep interval is 0 - server signal to disable sleep");
+        WEBINK_LOGW(TAG, "[SLEEP] Sleep interval is 0 - server signal to disable sleep");
         return false;
     }
     
     // Check BOOT button (emergency override)
     if (boot_button_pressed) {
-        ESP_LOGW(TAG, "[SLEEP] BOOT button held - safety override");
+        WEBINK_LOGW(TAG, "[SLEEP] BOOT button held - safety override");
         return false;
     }
     
     // Check for recent errors
     if (last_cycle_had_error) {
-        ESP_LOGW(TAG, "[SLEEP] Last cycle had error - staying awake for troubleshooting");
+        WEBINK_LOGW(TAG, "[SLEEP] Last cycle had error - staying awake for troubleshooting");
         return false;
     }
     
     // Check boot protection period
     if (within_boot_protection_period(current_time)) {
         unsigned long remaining_ms = BOOT_PROTECTION_MS - time_since_boot(current_time);
-        ESP_LOGW(TAG, "[SLEEP] Within 5-minute boot protection period - %lu seconds remaining", 
-                 remaining_ms / 1000);
+        WEBINK_LOGW(TAG, "[SLEEP] Within 5-minute boot protection period - %lu seconds remaining", 
+                    remaining_ms / 1000);
         return false;
     }
     
-    ESP_LOGI(TAG, "[SLEEP] All safety checks passed - can enter deep sleep for %d seconds", 
-             sleep_duration_seconds);
+    WEBINK_LOGI(TAG, "[SLEEP] All safety checks passed - can enter deep sleep for %d seconds", 
+                sleep_duration_seconds);
     return true;
 }
 
@@ -151,8 +233,9 @@ bool WebInkState::is_deep_sleep_wake() const {
 //=============================================================================
 
 bool WebInkState::should_start_update_cycle(unsigned long current_time) const {
-    // Always start on first boot
-    if (wake_counter == 0) {
+    // Always start the first cycle after power-on or deep sleep wake;
+    // wake_counter is restored from RTC memory so it can't signal this
+    if (wake_counter == 0 || last_update_time == 0) {
         return true;
     }
     
@@ -183,7 +266,57 @@ std::string WebInkState::get_status_string() const {
 }
 
 unsigned long WebInkState::get_sleep_duration_ms() const {
-    return static_cast<unsigned long>(sleep_duration_seconds) * 1000;
+    int seconds = get_effective_sleep_seconds(static_cast<uint32_t>(time(nullptr)));
+    return static_cast<unsigned long>(seconds) * 1000;
+}
+
+//=============================================================================
+// SERVER SCHEDULE
+//=============================================================================
+
+void WebInkState::record_server_schedule(int sleep_seconds, int next_change_seconds, uint32_t now_s) {
+    if (sleep_seconds > 0) {
+        if (sleep_seconds != sleep_duration_seconds) {
+            WEBINK_LOGI(TAG, "[SLEEP] Server set sleep duration: %d seconds", sleep_seconds);
+        }
+        sleep_duration_seconds = sleep_seconds;
+        sleep_interval_time = now_s;
+    }
+    
+    if (next_change_seconds >= 0) {
+        next_change_time = now_s + static_cast<uint32_t>(next_change_seconds);
+        WEBINK_LOGD(TAG, "[SLEEP] Next content change in %d seconds", next_change_seconds);
+    }
+}
+
+void WebInkState::record_state_time(UpdateState state, uint32_t elapsed_ms) {
+    int index = static_cast<int>(state);
+    if (index >= 0 && index < UPDATE_STATE_COUNT) {
+        state_times[index].record(elapsed_ms);
+    }
+}
+
+bool WebInkState::has_fresh_sleep_interval(uint32_t now_s) const {
+    if (sleep_interval_time == 0 || now_s < sleep_interval_time) {
+        return false;
+    }
+    return (now_s - sleep_interval_time) < SLEEP_INTERVAL_TTL_S;
+}
+
+int WebInkState::get_effective_sleep_seconds(uint32_t now_s) const {
+    // 0 is the server's "stay awake" signal - never override it
+    if (!follow_server_schedule || sleep_duration_seconds <= 0 || next_change_time <= now_s) {
+        return sleep_duration_seconds;
+    }
+    
+    uint32_t until_change = next_change_time - now_s + SCHEDULE_MARGIN_S;
+    if (until_change < static_cast<uint32_t>(MIN_SCHEDULED_SLEEP_S)) {
+        return MIN_SCHEDULED_SLEEP_S;
+    }
+    if (until_change > static_cast<uint32_t>(MAX_SCHEDULED_SLEEP_S)) {
+        return MAX_SCHEDULED_SLEEP_S;
+    }
+    return static_cast<int>(until_change);
 }
 
 //=============================================================================
@@ -196,10 +329,10 @@ bool WebInkState::has_hash_changed(const char* new_hash) const {
     bool changed = (strcmp(new_hash, last_hash) != 0);
     
     if (changed) {
-        ESP_LOGI(TAG, "[HASH] Hash changed - Old: %s, New: %s", 
-                 last_hash, new_hash);
+        WEBINK_LOGI(TAG, "[HASH] Hash changed - Old: %s, New: %s", 
+                    last_hash, new_hash);
     } else {
-        ESP_LOGI(TAG, "[HASH] Hash unchanged: %s", last_hash);
+        WEBINK_LOGI(TAG, "[HASH] Hash unchanged: %s", last_hash);
     }
     
     return changed;
@@ -215,7 +348,7 @@ void WebInkState::update_hash(const char* new_hash) {
     strncpy(last_hash, new_hash, sizeof(last_hash) - 1);
     last_hash[sizeof(last_hash) - 1] = '\0';  // Ensure null termination
     
-    ESP_LOGI(TAG, "[HASH] Updated - Old: %s, New: %s", old_hash, last_hash);
+    WEBINK_LOGI(TAG, "[HASH] Updated - Old: %s, New: %s", old_hash, last_hash);
 }
 
 void WebInkState::clear_hash_force_update() {
@@ -223,8 +356,269 @@ void WebInkState::clear_hash_force_update() {
     strcpy(old_hash, last_hash);  // Save old value for logging
     strcpy(last_hash, "00000000");  // Reset to default value
     
-    ESP_LOGI(TAG, "[HASH] Cleared for forced update - Old: %s, New: %s", 
-             old_hash, last_hash);
+    WEBINK_LOGI(TAG, "[HASH] Cleared for forced update - Old: %s, New: %s", 
+                old_hash, last_hash);
+}
+
+//=============================================================================
+// CHANGE RATE ESTIMATION
+//=============================================================================
+
+void WebInkState::record_hash_check(bool changed, HashPolicy policy) {
+    change_rate += CHANGE_RATE_WEIGHT * ((changed ? 1.0f : 0.0f) - change_rate);
+    
+    int index = static_cast<int>(policy);
+    bool hit = (policy == HashPolicy::CONDITIONAL_FETCH) ? changed : !changed;
+    
+    // Halve both counters before they saturate so the hit rate stays meaningful
+    if (policy_uses[index] == UINT16_MAX) {
+        policy_uses[index] /= 2;
+        policy_hits[index] /= 2;
+    }
+    policy_uses[index]++;
+    if (hit) {
+        policy_hits[index]++;
+    }
+    
+    WEBINK_LOGD(TAG, "[HASH] Change rate estimate: %.2f (%s via %s)", 
+                change_rate, changed ? "changed" : "unchanged", hash_policy_to_string(policy));
+}
+
+bool WebInkState::should_speculate_image_connection() const {
+    return change_rate >= SPECULATION_THRESHOLD;
+}
+
+//=============================================================================
+// SERVER ADDRESS CACHE
+//=============================================================================
+
+void WebInkState::cache_server_address(uint32_t ipv4, uint32_t now_s) {
+    cached_server_ip = ipv4;
+    cached_server_ip_time = now_s;
+}
+
+void WebInkState::invalidate_server_address() {
+    if (cached_server_ip != 0) {
+        WEBINK_LOGI(TAG, "[DNS] Cached server address invalidated");
+    }
+    cached_server_ip = 0;
+    cached_server_ip_time = 0;
+}
+
+bool WebInkState::has_valid_server_address(uint32_t now_s) const {
+    if (cached_server_ip == 0 || now_s < cached_server_ip_time) {
+        return false;
+    }
+    return (now_s - cached_server_ip_time) < SERVER_ADDRESS_TTL_S;
+}
+
+//=============================================================================
+// SERVER HEALTH
+//=============================================================================
+
+void WebInkState::record_server_success(int index, uint32_t latency_ms) {
+    if (index < 0 || index >= MAX_SERVERS) {
+        return;
+    }
+    server_failures[index] = 0;
+    
+    if (latency_ms > 0) {
+        if (latency_ms > UINT16_MAX) {
+            latency_ms = UINT16_MAX;
+        }
+        // Same 1/4 weight as the change rate; first sample seeds the estimate
+        uint32_t old_latency = server_latency_ms[index];
+        server_latency_ms[index] = static_cast<uint16_t>(
+            old_latency == 0 ? latency_ms : old_latency - old_latency / 4 + latency_ms / 4);
+    }
+}
+
+void WebInkState::record_server_failure(int index) {
+    if (index < 0 || index >= MAX_SERVERS) {
+        return;
+    }
+    if (server_failures[index] < UINT8_MAX) {
+        server_failures[index]++;
+    }
+    WEBINK_LOGD(TAG, "[SERVER] Server %d failure #%u", index, (unsigned) server_failures[index]);
+}
+
+int WebInkState::choose_server(int server_count, uint32_t tried_mask) const {
+    int best = -1;
+    uint32_t best_score = UINT32_MAX;
+    
+    for (int i = 0; i < server_count && i < MAX_SERVERS; i++) {
+        if (tried_mask & (1u << i)) {
+            continue;
+        }
+        uint32_t score = server_latency_ms[i] ? server_latency_ms[i] : UNKNOWN_LATENCY_MS;
+        score += static_cast<uint32_t>(server_failures[i]) * FAILURE_PENALTY_MS;
+        
+        if (score < best_score || (score == best_score && i == preferred_server)) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+bool WebInkState::needs_server_race(int server_count) const {
+    if (server_count < 2) {
+        return false;
+    }
+    if (preferred_server >= server_count) {
+        return true;  // Server list changed since the preference was stored
+    }
+    return server_latency_ms[preferred_server] == 0 || server_failures[preferred_server] > 0;
+}
+
+HashPolicy WebInkState::choose_hash_policy() const {
+    if (conditional_fetch_supported && change_rate >= SKIP_HASH_THRESHOLD) {
+        return HashPolicy::CONDITIONAL_FETCH;
+    }
+    return HashPolicy::HASH_CHECK;
+}
+
+void WebInkState::disable_conditional_fetch() {
+    if (!conditional_fetch_supported) {
+        return;
+    }
+    
+    conditional_fetch_supported = false;
+    WEBINK_LOGW(TAG, "[POLICY] Server does not support conditional fetch - using hash checks");
+}
+
+const char* WebInkState::get_policy_string(HashPolicy policy) const {
+    static char buffer[128];  // Static to avoid stack allocation and a heap copy
+    
+    snprintf(buffer, sizeof(buffer),
+             "policy=%s change_rate=%.2f hash_check=%u/%u conditional_fetch=%u/%u",
+             hash_policy_to_string(policy),
+             change_rate,
+             (unsigned) policy_hits[0], (unsigned) policy_uses[0],
+             (unsigned) policy_hits[1], (unsigned) policy_uses[1]);
+    
+    return buffer;
+}
+
+//=============================================================================
+// RTC PERSISTENCE
+//=============================================================================
+
+bool WebInkState::load_from_rtc() {
+    unsigned long start_us = micros();
+    const RtcStateBlob& blob = rtc_state_blob;
+    
+    if (blob.magic != RTC_STATE_MAGIC) {
+        WEBINK_LOGI(TAG, "[RTC] No saved state (power-on) - starting with defaults");
+        return false;
+    }
+    
+    if (blob.payload_size == 0 || blob.payload_size > sizeof(RtcStatePayload) ||
+        blob.version > RTC_STATE_VERSION) {
+        WEBINK_LOGW(TAG, "[RTC] Unsupported state layout v%u (%u bytes) - starting with defaults",
+                    (unsigned) blob.version, (unsigned) blob.payload_size);
+        return false;
+    }
+    
+    const uint8_t* payload_bytes = reinterpret_cast<const uint8_t*>(&blob.payload);
+    if (crc32(payload_bytes, blob.payload_size) != blob.crc32) {
+        WEBINK_LOGW(TAG, "[RTC] State CRC mismatch - starting with defaults");
+        return false;
+    }
+    
+    // Start from current defaults so fields missing from an older layout keep them
+    // (static: the payload is a few hundred bytes, too much for the setup() stack)
+    static RtcStatePayload payload;
+    memset(&payload, 0, sizeof(payload));
+    payload.change_rate = change_rate;
+    payload.sleep_duration_seconds = sleep_duration_seconds;
+    payload.deep_sleep_enabled = deep_sleep_enabled ? 1 : 0;
+    payload.conditional_fetch_supported = conditional_fetch_supported ? 1 : 0;
+    strncpy(payload.last_hash, last_hash, sizeof(payload.last_hash));
+    memcpy(&payload, payload_bytes, blob.payload_size);
+    
+    memcpy(last_hash, payload.last_hash, sizeof(last_hash) - 1);
+    last_hash[sizeof(last_hash) - 1] = '\0';
+    wake_counter = static_cast<int>(payload.wake_counter);
+    cycles_since_boot = static_cast<int>(payload.cycles_since_boot);
+    sleep_duration_seconds = payload.sleep_duration_seconds;
+    deep_sleep_enabled = payload.deep_sleep_enabled != 0;
+    conditional_fetch_supported = payload.conditional_fetch_supported != 0;
+    cached_server_ip = payload.cached_server_ip;
+    change_rate = (payload.change_rate >= 0.0f && payload.change_rate <= 1.0f) ? payload.change_rate
+                                                                               : INITIAL_CHANGE_RATE;
+    for (int i = 0; i < 2; i++) {
+        policy_uses[i] = payload.policy_uses[i];
+        policy_hits[i] = payload.policy_hits[i];
+    }
+    memcpy(band_hashes, payload.band_hashes, sizeof(band_hashes));
+    cached_server_ip_time = payload.cached_server_ip_time;
+    preferred_server = payload.preferred_server < MAX_SERVERS ? payload.preferred_server : 0;
+    memcpy(server_failures, payload.server_failures, sizeof(server_failures));
+    memcpy(server_latency_ms, payload.server_latency_ms, sizeof(server_latency_ms));
+    sleep_interval_time = payload.sleep_interval_time;
+    next_change_time = payload.next_change_time;
+    for (int i = 0; i < UPDATE_STATE_COUNT; i++) {
+        memcpy(state_times[i].counts, payload.state_time_counts[i], sizeof(state_times[i].counts));
+        state_times[i].max_ms = payload.state_time_max_ms[i];
+    }
+    
+    WEBINK_LOGI(TAG, "[RTC] State restored in %lu us (v%u, %u bytes): wake #%d, hash %s, change rate %.2f",
+                micros() - start_us, (unsigned) blob.version, (unsigned) blob.payload_size,
+                wake_counter, last_hash, change_rate);
+    
+    // Error info is kept for diagnostics only; each cycle starts clean
+    if (payload.current_error != static_cast<uint8_t>(ErrorType::NONE)) {
+        payload.error_message[sizeof(payload.error_message) - 1] = '\0';
+        WEBINK_LOGW(TAG, "[RTC] Previous wake ended with %s: %s",
+                    error_type_to_string(static_cast<ErrorType>(payload.current_error)),
+                    payload.error_message);
+    }
+    return true;
+}
+
+void WebInkState::save_to_rtc() const {
+    unsigned long start_us = micros();
+    RtcStateBlob& blob = rtc_state_blob;
+    RtcStatePayload& payload = blob.payload;
+    
+    memset(&payload, 0, sizeof(payload));
+    memcpy(payload.last_hash, last_hash, sizeof(payload.last_hash));
+    payload.wake_counter = static_cast<uint32_t>(wake_counter);
+    payload.cycles_since_boot = static_cast<uint32_t>(cycles_since_boot);
+    payload.sleep_duration_seconds = sleep_duration_seconds;
+    payload.deep_sleep_enabled = deep_sleep_enabled ? 1 : 0;
+    payload.conditional_fetch_supported = conditional_fetch_supported ? 1 : 0;
+    payload.current_error = static_cast<uint8_t>(current_error);
+    // Truncated on purpose: the RTC field is half the size of error_message
+    snprintf(payload.error_message, sizeof(payload.error_message), "%.*s",
+             static_cast<int>(sizeof(payload.error_message) - 1), error_message);
+    payload.cached_server_ip = cached_server_ip;
+    payload.change_rate = change_rate;
+    for (int i = 0; i < 2; i++) {
+        payload.policy_uses[i] = policy_uses[i];
+        payload.policy_hits[i] = policy_hits[i];
+    }
+    memcpy(payload.band_hashes, band_hashes, sizeof(payload.band_hashes));
+    payload.cached_server_ip_time = cached_server_ip_time;
+    payload.preferred_server = preferred_server;
+    memcpy(payload.server_failures, server_failures, sizeof(payload.server_failures));
+    memcpy(payload.server_latency_ms, server_latency_ms, sizeof(payload.server_latency_ms));
+    payload.sleep_interval_time = sleep_interval_time;
+    payload.next_change_time = next_change_time;
+    for (int i = 0; i < UPDATE_STATE_COUNT; i++) {
+        memcpy(payload.state_time_counts[i], state_times[i].counts, sizeof(payload.state_time_counts[i]));
+        payload.state_time_max_ms[i] = state_times[i].max_ms;
+    }
+    
+    blob.version = RTC_STATE_VERSION;
+    blob.payload_size = sizeof(RtcStatePayload);
+    blob.crc32 = crc32(reinterpret_cast<const uint8_t*>(&payload), sizeof(RtcStatePayload));
+    blob.magic = RTC_STATE_MAGIC;
+    
+    WEBINK_LOGD(TAG, "[RTC] State saved in %lu us (%u bytes)",
+                micros() - start_us, (unsigned) sizeof(RtcStateBlob));
 }
 
 } // namespace webink
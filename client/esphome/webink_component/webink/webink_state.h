@@ -20,8 +20,9 @@
 #include <functional>
 
 #ifdef WEBINK_MAC_INTEGRATION_TEST
-// Mock millis() for Mac integration tests
+// Mock millis()/micros() for Mac integration tests
 unsigned long millis();
+unsigned long micros();
 #else
 // ESPHome millis() function - it's a global function in ESPHome
 #include "esphome/core/helpers.h"
@@ -61,7 +62,7 @@ namespace webink {
  * those that are reset on each boot.
  * 
  * Key features:
- * - Deep sleep state persistence using ESPHome restore_value mechanism
+ * - Deep sleep state persistence in a CRC32-validated RTC memory blob
  * - Boot time tracking for 5-minute OTA protection window
  * - Wake counter and cycle management
  * - Hash-based change detection
@@ -90,18 +91,30 @@ public:
     ~WebInkState() = default;
 
     //=========================================================================
-    // PERSISTENT STATE (survives deep sleep cycles)
+    // PERSISTENT STATE (survives deep sleep cycles via save_to_rtc())
     //=========================================================================
     
     /// Hash of last displayed content (used for change detection) - fixed size to avoid allocation
     char last_hash[16];         // Enough for typical hash (8-12 chars + null terminator)
     
-    /// All-time wake counter (increments on every wake, persists forever)
+    /// Wake counter (increments on every wake, reset only by power loss)
     int wake_counter{0};
     
     /// Sleep duration in seconds (fetched from server, default 60)
     int sleep_duration_seconds{60};
     
+    /// Wall-clock time (seconds since epoch) when the server last sent sleep_duration_seconds (0 = never)
+    uint32_t sleep_interval_time{0};
+    
+    /// Wall-clock time (seconds since epoch) of the server's next planned content change (0 = unknown)
+    uint32_t next_change_time{0};
+    
+    /// Sleep until next_change_time instead of for sleep_duration_seconds (from YAML, not persisted)
+    bool follow_server_schedule{false};
+    
+    /// Time spent per visit of each UpdateState (RTC-persisted, indexed by UpdateState)
+    Log2Histogram state_times[UPDATE_STATE_COUNT]{};
+    
     /// Global flag to enable/disable deep sleep (controllable via web UI)
     bool deep_sleep_enabled{true};
     
@@ -110,6 +123,37 @@ public:
     
     /// Flag to track if error screen is currently displayed
     bool error_screen_displayed{false};
+    
+    /// Estimated fraction of hash checks that find new content (moving average, 0-1, RTC-persisted)
+    float change_rate{INITIAL_CHANGE_RATE};
+    
+    /// Cached IPv4 address of the server in network byte order (0 = none)
+    uint32_t cached_server_ip{0};
+    
+    /// Wall-clock time (seconds since epoch) when cached_server_ip was resolved
+    uint32_t cached_server_ip_time{0};
+    
+    /// Horizontal bands tracked in band_hashes
+    static const int BAND_COUNT = 8;
+    
+    /// Per-band content hashes of the last displayed image (0 = unknown)
+    uint32_t band_hashes[BAND_COUNT]{};
+    
+    /// Server that answered fastest / most recently (index into the config's server list)
+    uint8_t preferred_server{0};
+    
+    /// Smoothed connect latency per server in ms (0 = never measured)
+    uint16_t server_latency_ms[MAX_SERVERS]{};
+    
+    /// Consecutive failed attempts per server
+    uint8_t server_failures[MAX_SERVERS]{};
+    
+    /// Per-policy telemetry (RTC-persisted, indexed by HashPolicy)
+    uint16_t policy_uses[2]{0, 0};
+    uint16_t policy_hits[2]{0, 0};  ///< Uses where the policy was the right call
+    
+    /// False once the server answered a conditional fetch without a hash (old server)
+    bool conditional_fetch_supported{true};
 
     //=========================================================================
     // SESSION STATE (reset on power-on, persists across deep sleep)
@@ -244,9 +288,64 @@ public:
     /**
      * @brief Get sleep duration in milliseconds for deep sleep component
      * @return Sleep duration converted to milliseconds
+     * 
+     * With follow_server_schedule, this is the time until the server's next
+     * planned content change (see get_effective_sleep_seconds()).
      */
     unsigned long get_sleep_duration_ms() const;
 
+    //=========================================================================
+    // SERVER SCHEDULE
+    //=========================================================================
+
+    /**
+     * @brief Store the sleep interval and next change time sent by the server
+     * @param sleep_seconds Sleep interval (0 = server disables sleep, <0 = not sent)
+     * @param next_change_seconds Seconds until the next content change (<0 = not sent)
+     * @param now_s Current wall-clock time in seconds
+     */
+    void record_server_schedule(int sleep_seconds, int next_change_seconds, uint32_t now_s);
+
+    /**
+     * @brief Check whether the stored sleep interval can be used without asking the server
+     * @param now_s Current wall-clock time in seconds
+     * @return True if the server sent it less than SLEEP_INTERVAL_TTL_S ago
+     */
+    bool has_fresh_sleep_interval(uint32_t now_s) const;
+
+    /**
+     * @brief Get the sleep time for this wake
+     * @param now_s Current wall-clock time in seconds
+     * @return Seconds until the next change plus SCHEDULE_MARGIN_S when following the
+     *         schedule and a change is known, otherwise sleep_duration_seconds
+     */
+    int get_effective_sleep_seconds(uint32_t now_s) const;
+
+    static const uint32_t SLEEP_INTERVAL_TTL_S = 6 * 3600;      ///< Ask /get_sleep at least every 6 hours
+    static const int SCHEDULE_MARGIN_S = 5;                     ///< Wake this long after the planned change
+    static const int MIN_SCHEDULED_SLEEP_S = 30;                ///< Never sleep less when following the schedule
+    static const int MAX_SCHEDULED_SLEEP_S = 24 * 3600;         ///< Cap for a far-away planned change
+
+    //=========================================================================
+    // STATE TIMING
+    //=========================================================================
+
+    /**
+     * @brief Record how long one visit of a state took
+     * @param state State that was left
+     * @param elapsed_ms Time spent in it
+     */
+    void record_state_time(UpdateState state, uint32_t elapsed_ms);
+
+    /**
+     * @brief Get the timing histogram of a state
+     * @param state Update state
+     * @return Histogram of visit durations
+     */
+    const Log2Histogram& get_state_times(UpdateState state) const {
+        return state_times[static_cast<int>(state)];
+    }
+
     //=========================================================================
     // HASH MANAGEMENT
     //=========================================================================
@@ -278,6 +377,148 @@ public:
      */
     const char* get_hash() const { return last_hash; }
 
+    //=========================================================================
+    // CHANGE RATE ESTIMATION
+    //=========================================================================
+
+    /**
+     * @brief Fold the outcome of a hash check into the change-rate estimate
+     * @param changed True if the hash check found new content
+     * @param policy Policy the cycle used to find out
+     * 
+     * A hit is a cycle where the policy paid off: an unchanged hash for
+     * HASH_CHECK (download avoided), new content for CONDITIONAL_FETCH
+     * (hash request avoided).
+     */
+    void record_hash_check(bool changed, HashPolicy policy = HashPolicy::HASH_CHECK);
+
+    /**
+     * @brief Choose how this cycle detects changes
+     * @return CONDITIONAL_FETCH when content changes on most wakes, else HASH_CHECK
+     */
+    HashPolicy choose_hash_policy() const;
+
+    /**
+     * @brief Mark conditional fetch as unusable with this server
+     * 
+     * Called when a conditional response carries no hash; the device then
+     * stays on HASH_CHECK so the stored hash keeps tracking the server.
+     */
+    void disable_conditional_fetch();
+
+    /**
+     * @brief Get hash policy telemetry for logging and server status posts
+     * @param policy Policy used by the current cycle
+     * @return Policy name, change rate and per-policy hit rates (static
+     *         buffer, valid until the next call)
+     */
+    const char* get_policy_string(HashPolicy policy) const;
+
+    //=========================================================================
+    // SERVER ADDRESS CACHE
+    //=========================================================================
+
+    /**
+     * @brief Remember the resolved server address
+     * @param ipv4 Address in network byte order
+     * @param now_s Current wall-clock time in seconds
+     */
+    void cache_server_address(uint32_t ipv4, uint32_t now_s);
+
+    /**
+     * @brief Forget the cached server address (next cycle resolves again)
+     */
+    void invalidate_server_address();
+
+    /**
+     * @brief Check whether the cached server address can be used
+     * @param now_s Current wall-clock time in seconds
+     * @return True if an address is cached and younger than SERVER_ADDRESS_TTL_S
+     * 
+     * A clock that went backwards (e.g. reset after power loss) counts as expired.
+     */
+    bool has_valid_server_address(uint32_t now_s) const;
+
+    static const uint32_t SERVER_ADDRESS_TTL_S = 3600;          ///< Re-resolve the server at least hourly
+
+    //=========================================================================
+    // SERVER HEALTH
+    //=========================================================================
+
+    /**
+     * @brief Record a successful connection or request
+     * @param index Server index
+     * @param latency_ms Measured connect latency (0 = not measured, keep estimate)
+     */
+    void record_server_success(int index, uint32_t latency_ms);
+
+    /**
+     * @brief Record a failed connection or request
+     * @param index Server index
+     */
+    void record_server_failure(int index);
+
+    /**
+     * @brief Pick the best server by latency and recent failures
+     * @param server_count Number of configured servers
+     * @param tried_mask Servers to skip (bit i = server i already tried this cycle)
+     * @return Server index, or -1 if every server has been tried
+     * 
+     * Score is the smoothed latency (UNKNOWN_LATENCY_MS if never measured)
+     * plus FAILURE_PENALTY_MS per consecutive failure; preferred_server wins ties.
+     */
+    int choose_server(int server_count, uint32_t tried_mask = 0) const;
+
+    /**
+     * @brief Decide whether this wake should race all servers
+     * @param server_count Number of configured servers
+     * @return True with several servers and no healthy measured preference
+     *         (first wake, or the preferred server failed last time)
+     */
+    bool needs_server_race(int server_count) const;
+
+    static const uint16_t UNKNOWN_LATENCY_MS = 1000;            ///< Score for a server never measured
+    static const uint16_t FAILURE_PENALTY_MS = 5000;            ///< Score added per consecutive failure
+
+    //=========================================================================
+    // RTC PERSISTENCE
+    //=========================================================================
+
+    /**
+     * @brief Restore persistent state from the RTC memory blob
+     * @return True if a valid blob was found
+     * 
+     * Called from the constructor. The blob lives in RTC memory that is not
+     * re-initialized on reset, so it survives deep sleep and software resets
+     * (including OTA reboots) but not power loss. A blob with a bad magic or
+     * CRC is ignored and the defaults stay in place; a shorter blob from an
+     * older firmware keeps the defaults for the fields it lacks (see
+     * RtcStatePayload in webink_state.cpp).
+     */
+    bool load_from_rtc();
+
+    /**
+     * @brief Write persistent state to the RTC memory blob
+     * 
+     * Cheap (a few hundred bytes plus a CRC32, no flash writes), so it is
+     * called at every cycle end and before deep sleep.
+     */
+    void save_to_rtc() const;
+
+    /**
+     * @brief Decide whether to open the image connection before the hash is known
+     * @return True if the estimated change rate makes warm-up worth its cost
+     * 
+     * A wasted warm-up costs one connect and close; a useful one saves the
+     * connection setup on the critical path of an update.
+     */
+    bool should_speculate_image_connection() const;
+
+    static constexpr float INITIAL_CHANGE_RATE = 0.5f;          ///< No history - assume a coin flip
+    static constexpr float CHANGE_RATE_WEIGHT = 0.25f;          ///< Weight of the newest hash check
+    static constexpr float SPECULATION_THRESHOLD = 0.2f;        ///< Minimum change rate to warm up
+    static constexpr float SKIP_HASH_THRESHOLD = 0.75f;         ///< Change rate above which the hash request is skipped
+
 private:
     static const char* TAG;  ///< Logging tag for this class
     static const unsigned long BOOT_PROTECTION_MS = 5 * 60 * 1000;  ///< 5 minutes
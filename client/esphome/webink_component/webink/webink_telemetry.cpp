@@ -0,0 +1,233 @@
+/**
+ * @file webink_telemetry.cpp
+ * @brief Implementation of WebInkTelemetry
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_telemetry.h"
+
+#include <cstring>
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+namespace esphome {
+namespace webink {
+
+namespace {
+
+void put_u16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void put_u32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    out[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+} // namespace
+
+//=============================================================================
+// CONSTRUCTOR
+//=============================================================================
+
+WebInkTelemetry::WebInkTelemetry() : memory_warnings_(0) {
+    begin_wake(WakeReason::UNKNOWN);
+    for (StateMemory& memory : state_memory_) {
+        memory = {UINT32_MAX, UINT32_MAX, UINT32_MAX};
+    }
+}
+
+void WebInkTelemetry::begin_wake(WakeReason reason) {
+    wake_reason_ = reason;
+    error_code_ = ErrorType::NONE;
+    rssi_dbm_ = 0;
+    flags_ = 0;
+    memset(phase_ms_, 0, sizeof(phase_ms_));
+    request_count_ = 0;
+    bytes_in_ = 0;
+    bytes_out_ = 0;
+    min_free_heap_ = 0;
+    largest_free_block_ = 0;
+    refresh_ms_ = 0;
+    min_stack_free_ = 0;
+}
+
+TelemetryPhase WebInkTelemetry::phase_for_state(UpdateState state) {
+    switch (state) {
+        case UpdateState::IDLE:
+            return TelemetryPhase::BOOT;
+        case UpdateState::WIFI_WAIT:
+            return TelemetryPhase::WIFI;
+        case UpdateState::HASH_CHECK:
+        case UpdateState::HASH_REQUEST:
+        case UpdateState::HASH_PARSE:
+            return TelemetryPhase::HASH;
+        case UpdateState::IMAGE_REQUEST:
+        case UpdateState::IMAGE_DOWNLOAD:
+        case UpdateState::IMAGE_PARSE:
+        case UpdateState::IMAGE_DISPLAY:
+            return TelemetryPhase::DOWNLOAD;
+        case UpdateState::DISPLAY_UPDATE:
+            return TelemetryPhase::REFRESH;
+        case UpdateState::ERROR_DISPLAY:
+            return TelemetryPhase::ERROR;
+        case UpdateState::SLEEP_PREPARE:
+        case UpdateState::COMPLETE:
+        default:
+            return TelemetryPhase::SLEEP;
+    }
+}
+
+//=============================================================================
+// RECORDING
+//=============================================================================
+
+void WebInkTelemetry::add_phase_time(TelemetryPhase phase, uint32_t elapsed_ms) {
+    uint16_t& slot = phase_ms_[static_cast<int>(phase)];
+    uint32_t total = slot + elapsed_ms;
+    slot = static_cast<uint16_t>(total > 0xFFFF ? 0xFFFF : total);
+}
+
+void WebInkTelemetry::set_rssi(int rssi_dbm) {
+    if (rssi_dbm < -128) {
+        rssi_dbm = -128;
+    } else if (rssi_dbm > 0) {
+        rssi_dbm = 0;  // Positive values are "not connected" markers
+    }
+    rssi_dbm_ = static_cast<int8_t>(rssi_dbm);
+}
+
+void WebInkTelemetry::set_network_counters(uint32_t bytes_in, uint32_t bytes_out, uint32_t requests) {
+    bytes_in_ = bytes_in;
+    bytes_out_ = bytes_out;
+    request_count_ = static_cast<uint16_t>(requests > 0xFFFF ? 0xFFFF : requests);
+}
+
+void WebInkTelemetry::sample_heap() {
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+    min_free_heap_ = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    largest_free_block_ = static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    // ESP-IDF reports the high-water mark in bytes (StackType_t is uint8_t)
+    min_stack_free_ = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(nullptr));
+#endif
+}
+
+uint8_t WebInkTelemetry::sample_state_memory(UpdateState state) {
+#ifdef WEBINK_MAC_INTEGRATION_TEST
+    (void) state;
+    return 0;
+#else
+    uint32_t free_heap = static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    uint32_t largest_block = static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    uint32_t stack_free = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(nullptr));
+
+    StateMemory& memory = state_memory_[static_cast<int>(state)];
+    if (free_heap < memory.min_free_heap) {
+        memory.min_free_heap = free_heap;
+    }
+    if (largest_block < memory.min_largest_block) {
+        memory.min_largest_block = largest_block;
+    }
+    if (stack_free < memory.min_stack_free) {
+        memory.min_stack_free = stack_free;
+    }
+
+    uint8_t crossed = 0;
+    if (free_heap < MEMORY_WARN_HEAP_BYTES) {
+        crossed |= MEMORY_WARN_HEAP;
+    }
+    if (largest_block < MEMORY_WARN_BLOCK_BYTES) {
+        crossed |= MEMORY_WARN_BLOCK;
+    }
+    if (stack_free < MEMORY_WARN_STACK_BYTES) {
+        crossed |= MEMORY_WARN_STACK;
+    }
+    crossed &= static_cast<uint8_t>(~memory_warnings_);
+    memory_warnings_ |= crossed;
+    return crossed;
+#endif
+}
+
+//=============================================================================
+// ENCODING
+//=============================================================================
+
+size_t WebInkTelemetry::encode(uint8_t* out, size_t out_size, uint32_t wake_counter, uint32_t awake_ms) const {
+    if (!out || out_size < RECORD_SIZE) {
+        return 0;
+    }
+
+    memset(out, 0, RECORD_SIZE);
+    out[0] = TELEMETRY_VERSION;
+    out[1] = static_cast<uint8_t>(wake_reason_);
+    out[2] = static_cast<uint8_t>(error_code_);
+    out[3] = static_cast<uint8_t>(rssi_dbm_);
+    put_u32(out + 4, wake_counter);
+    for (int i = 0; i < static_cast<int>(TelemetryPhase::COUNT); i++) {
+        put_u16(out + 8 + 2 * i, phase_ms_[i]);
+    }
+    put_u16(out + 22, request_count_);
+    put_u32(out + 24, awake_ms);
+    put_u32(out + 28, bytes_in_);
+    put_u32(out + 32, bytes_out_);
+    put_u32(out + 36, min_free_heap_);
+    put_u32(out + 40, largest_free_block_);
+    put_u32(out + 44, refresh_ms_);
+    out[48] = flags_;
+    put_u32(out + 52, min_stack_free_);
+    return RECORD_SIZE;
+}
+
+size_t WebInkTelemetry::encode_state_timing(uint8_t* out, size_t out_size, const Log2Histogram* histograms) {
+    if (!out || !histograms || out_size < STATE_TIMING_SIZE) {
+        return 0;
+    }
+
+    out[0] = STATE_TIMING_VERSION;
+    out[1] = static_cast<uint8_t>(UPDATE_STATE_COUNT);
+    for (int i = 0; i < UPDATE_STATE_COUNT; i++) {
+        const Log2Histogram& histogram = histograms[i];
+        uint32_t p50 = histogram.percentile(50);
+        uint32_t p95 = histogram.percentile(95);
+        uint8_t* entry = out + 2 + 8 * i;
+        put_u16(entry, static_cast<uint16_t>(p50 > 0xFFFF ? 0xFFFF : p50));
+        put_u16(entry + 2, static_cast<uint16_t>(p95 > 0xFFFF ? 0xFFFF : p95));
+        put_u32(entry + 4, histogram.max_ms);
+    }
+    return STATE_TIMING_SIZE;
+}
+
+size_t WebInkTelemetry::encode_state_memory(uint8_t* out, size_t out_size) const {
+    if (!out || out_size < STATE_MEMORY_SIZE) {
+        return 0;
+    }
+
+    out[0] = STATE_MEMORY_VERSION;
+    out[1] = static_cast<uint8_t>(UPDATE_STATE_COUNT);
+    for (int i = 0; i < UPDATE_STATE_COUNT; i++) {
+        const StateMemory& memory = state_memory_[i];
+        bool sampled = memory.min_free_heap != UINT32_MAX;
+        uint32_t stack_free = sampled ? memory.min_stack_free : 0;
+        uint8_t* entry = out + 2 + 10 * i;
+        put_u32(entry, sampled ? memory.min_free_heap : 0);
+        put_u32(entry + 4, sampled ? memory.min_largest_block : 0);
+        put_u16(entry + 8, static_cast<uint16_t>(stack_free > 0xFFFF ? 0xFFFF : stack_free));
+    }
+    return STATE_MEMORY_SIZE;
+}
+
+uint32_t WebInkTelemetry::get_phase_ms(TelemetryPhase phase) const {
+    return phase_ms_[static_cast<int>(phase)];
+}
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,250 @@
+/**
+ * @file webink_telemetry.h
+ * @brief Fixed-layout binary telemetry record, one per wake
+ *
+ * WebInkTelemetry accumulates what a wake cost - time per phase, bytes and
+ * requests, signal strength, heap headroom, refresh time and the error, if
+ * any - and encodes it as a 56-byte little-endian record. The record rides
+ * along with the batched log upload (a TELEMETRY record in WebInkLogBuffer),
+ * so it costs no extra request. server/decode_telemetry.py decodes records
+ * on the host for fleet analysis.
+ *
+ * Record layout, version 2 (little-endian, offsets in bytes):
+ * @code
+ *  0  uint8_t  version             // TELEMETRY_VERSION
+ *  1  uint8_t  wake_reason         // WakeReason
+ *  2  uint8_t  error_code          // ErrorType of the last error this wake
+ *  3  int8_t   rssi_dbm            // 0 = unknown
+ *  4  uint32_t wake_counter
+ *  8  uint16_t phase_ms[7]         // TelemetryPhase order, saturating
+ * 22  uint16_t request_count
+ * 24  uint32_t awake_ms
+ * 28  uint32_t bytes_in
+ * 32  uint32_t bytes_out
+ * 36  uint32_t min_free_heap       // Low-water mark since boot
+ * 40  uint32_t largest_free_block
+ * 44  uint32_t refresh_ms          // Physical display refresh
+ * 48  uint8_t  flags               // TELEMETRY_FLAG_*
+ * 49  uint8_t  reserved[3]
+ * 52  uint32_t min_stack_free      // Main task stack never used (version 2)
+ * @endcode
+ *
+ * Fields are append-only: bump TELEMETRY_VERSION and RECORD_SIZE when adding
+ * one, and teach the decoder the new size.
+ *
+ * Per-state timing histograms (WebInkState::state_times) are summarized in a
+ * separate TIMING record, sent with each log upload:
+ * @code
+ *  0  uint8_t  version             // STATE_TIMING_VERSION
+ *  1  uint8_t  state_count         // UPDATE_STATE_COUNT
+ *  2  struct { uint16_t p50_ms, p95_ms; uint32_t max_ms; } states[state_count]
+ * @endcode
+ * p50/p95 saturate at 65535 ms; states are in UpdateState order.
+ *
+ * Memory headroom is sampled on every state transition and charged to the
+ * state being left: free heap and largest free block at that moment, and
+ * the main task's stack high-water mark. The lowest values since boot are
+ * sent per state in a MEMORY record with each log upload:
+ * @code
+ *  0  uint8_t  version             // STATE_MEMORY_VERSION
+ *  1  uint8_t  state_count         // UPDATE_STATE_COUNT
+ *  2  struct { uint32_t min_free_heap, min_largest_block; uint16_t min_stack_free; } states[state_count]
+ * @endcode
+ * States that were never left are all zero. A sample below one of the
+ * MEMORY_WARN_*_BYTES thresholds is reported once per boot.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "webink_types.h"
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum WakeReason
+ * @brief Why the device is awake (from the reset reason and wakeup cause)
+ */
+enum class WakeReason : uint8_t {
+    UNKNOWN = 0,
+    POWER_ON = 1,       ///< Cold boot
+    TIMER = 2,          ///< Deep sleep timer
+    EXTERNAL = 3,       ///< Deep sleep GPIO/button wakeup
+    SOFTWARE = 4,       ///< Software reset (OTA, restart)
+    CRASH = 5           ///< Panic or watchdog reset
+};
+
+/**
+ * @enum TelemetryPhase
+ * @brief Groups of UpdateState that telemetry reports time for
+ */
+enum class TelemetryPhase : uint8_t {
+    BOOT = 0,           ///< IDLE before the cycle starts
+    WIFI = 1,           ///< WIFI_WAIT
+    HASH = 2,           ///< HASH_CHECK, HASH_REQUEST, HASH_PARSE
+    DOWNLOAD = 3,       ///< IMAGE_REQUEST .. IMAGE_DISPLAY
+    REFRESH = 4,        ///< DISPLAY_UPDATE
+    ERROR = 5,          ///< ERROR_DISPLAY
+    SLEEP = 6,          ///< SLEEP_PREPARE and COMPLETE
+    COUNT = 7
+};
+
+static const uint8_t TELEMETRY_FLAG_CONTENT_UPDATED = 0x01;  ///< New image drawn this wake
+static const uint8_t TELEMETRY_FLAG_SOCKET_MODE = 0x02;      ///< Image fetched over a raw socket
+
+static const uint8_t MEMORY_WARN_HEAP = 0x01;                ///< Free heap below MEMORY_WARN_HEAP_BYTES
+static const uint8_t MEMORY_WARN_BLOCK = 0x02;               ///< Largest block below MEMORY_WARN_BLOCK_BYTES
+static const uint8_t MEMORY_WARN_STACK = 0x04;               ///< Stack headroom below MEMORY_WARN_STACK_BYTES
+
+/**
+ * @struct StateMemory
+ * @brief Lowest memory headroom seen on leaving one update state
+ */
+struct StateMemory {
+    uint32_t min_free_heap;                                     ///< Free heap, UINT32_MAX until sampled
+    uint32_t min_largest_block;                                 ///< Largest free block, UINT32_MAX until sampled
+    uint32_t min_stack_free;                                    ///< Stack high-water mark, UINT32_MAX until sampled
+};
+
+/**
+ * @class WebInkTelemetry
+ * @brief Per-wake telemetry accumulator and encoder
+ *
+ * @example Recording a wake
+ * @code
+ * telemetry.begin_wake(WakeReason::TIMER);
+ * telemetry.add_phase_time(WebInkTelemetry::phase_for_state(old_state), elapsed_ms);
+ * telemetry.set_network_counters(bytes_in, bytes_out, requests);
+ * telemetry.sample_heap();
+ * uint8_t record[WebInkTelemetry::RECORD_SIZE];
+ * telemetry.encode(record, sizeof(record));
+ * @endcode
+ */
+class WebInkTelemetry {
+public:
+    static const uint8_t TELEMETRY_VERSION = 2;                 ///< Record layout version
+    static const size_t RECORD_SIZE = 56;                       ///< Encoded bytes (version 2)
+    static const uint8_t STATE_TIMING_VERSION = 1;              ///< Timing record layout version
+    static const size_t STATE_TIMING_SIZE = 2 + 8 * UPDATE_STATE_COUNT;  ///< Encoded timing record bytes
+    static const uint8_t STATE_MEMORY_VERSION = 1;              ///< Memory record layout version
+    static const size_t STATE_MEMORY_SIZE = 2 + 10 * UPDATE_STATE_COUNT;  ///< Encoded memory record bytes
+
+    static const uint32_t MEMORY_WARN_HEAP_BYTES = 16 * 1024;   ///< Free heap warning threshold
+    static const uint32_t MEMORY_WARN_BLOCK_BYTES = 8 * 1024;   ///< Largest free block warning threshold
+    static const uint32_t MEMORY_WARN_STACK_BYTES = 1024;       ///< Stack headroom warning threshold
+
+    /**
+     * @brief Constructor
+     */
+    WebInkTelemetry();
+
+    /**
+     * @brief Clear all fields for a new wake
+     * @param reason Why the device is awake
+     */
+    void begin_wake(WakeReason reason);
+
+    /**
+     * @brief Map an update state to the phase it is reported under
+     * @param state Update state
+     * @return Telemetry phase
+     */
+    static TelemetryPhase phase_for_state(UpdateState state);
+
+    //=========================================================================
+    // RECORDING
+    //=========================================================================
+
+    void add_phase_time(TelemetryPhase phase, uint32_t elapsed_ms);  ///< Add time spent in a phase
+    void set_error(ErrorType error) { error_code_ = error; }     ///< Record the latest error
+    void set_rssi(int rssi_dbm);                                ///< Record signal strength (dBm)
+    void set_refresh_ms(uint32_t refresh_ms) { refresh_ms_ = refresh_ms; }  ///< Record display refresh time
+    void set_flag(uint8_t flag) { flags_ |= flag; }             ///< Set a TELEMETRY_FLAG_*
+
+    /**
+     * @brief Record the network totals for this wake
+     * @param bytes_in Bytes received
+     * @param bytes_out Bytes sent
+     * @param requests HTTP requests and socket connections made
+     */
+    void set_network_counters(uint32_t bytes_in, uint32_t bytes_out, uint32_t requests);
+
+    /**
+     * @brief Record the heap low-water mark, largest free block and stack high-water mark now
+     */
+    void sample_heap();
+
+    /**
+     * @brief Sample heap and stack headroom on leaving a state
+     * @param state State being left
+     * @return MEMORY_WARN_* bits for thresholds crossed for the first time since boot
+     *
+     * Keeps the per-state minima reported by encode_state_memory(). No-op
+     * (returns 0) on host builds.
+     */
+    uint8_t sample_state_memory(UpdateState state);
+
+    //=========================================================================
+    // ENCODING
+    //=========================================================================
+
+    /**
+     * @brief Encode the record
+     * @param out Output buffer
+     * @param out_size Size of out (at least RECORD_SIZE)
+     * @param wake_counter Wake number to stamp into the record
+     * @param awake_ms Time awake so far
+     * @return RECORD_SIZE, or 0 if out is too small
+     */
+    size_t encode(uint8_t* out, size_t out_size, uint32_t wake_counter, uint32_t awake_ms) const;
+
+    /**
+     * @brief Encode the p50/p95/max summary of the per-state timing histograms
+     * @param out Output buffer
+     * @param out_size Size of out (at least STATE_TIMING_SIZE)
+     * @param histograms UPDATE_STATE_COUNT histograms in UpdateState order
+     * @return STATE_TIMING_SIZE, or 0 if out is too small
+     */
+    static size_t encode_state_timing(uint8_t* out, size_t out_size, const Log2Histogram* histograms);
+
+    /**
+     * @brief Encode the per-state memory minima
+     * @param out Output buffer
+     * @param out_size Size of out (at least STATE_MEMORY_SIZE)
+     * @return STATE_MEMORY_SIZE, or 0 if out is too small
+     */
+    size_t encode_state_memory(uint8_t* out, size_t out_size) const;
+
+    uint32_t get_phase_ms(TelemetryPhase phase) const;          ///< Time recorded for a phase
+    WakeReason get_wake_reason() const { return wake_reason_; } ///< Wake reason of this wake
+    ErrorType get_error() const { return error_code_; }         ///< Latest error this wake
+    uint8_t get_flags() const { return flags_; }                ///< TELEMETRY_FLAG_* bits set this wake
+    const StateMemory& get_state_memory(UpdateState state) const {  ///< Minima recorded for a state
+        return state_memory_[static_cast<int>(state)];
+    }
+
+private:
+    WakeReason wake_reason_;                                    ///< Why the device is awake
+    ErrorType error_code_;                                      ///< Latest error this wake
+    int8_t rssi_dbm_;                                           ///< Signal strength (0 = unknown)
+    uint8_t flags_;                                             ///< TELEMETRY_FLAG_* bits
+    uint16_t phase_ms_[static_cast<int>(TelemetryPhase::COUNT)];  ///< Time per phase (saturating)
+    uint16_t request_count_;                                    ///< HTTP requests and socket connections
+    uint32_t bytes_in_;                                         ///< Bytes received
+    uint32_t bytes_out_;                                        ///< Bytes sent
+    uint32_t min_free_heap_;                                    ///< Heap low-water mark since boot
+    uint32_t largest_free_block_;                               ///< Largest allocatable block
+    uint32_t refresh_ms_;                                       ///< Display refresh time
+    uint32_t min_stack_free_;                                   ///< Stack high-water mark
+    StateMemory state_memory_[UPDATE_STATE_COUNT];              ///< Per-state minima since boot
+    uint8_t memory_warnings_;                                   ///< MEMORY_WARN_* bits already reported
+};
+
+} // namespace webink
+} // namespace esphome
@@ -0,0 +1,115 @@
+/**
+ * @file webink_trace.cpp
+ * @brief Implementation of WebInkTrace
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#include "webink_trace.h"
+#include "webink_log.h"
+
+#if WEBINK_TRACE
+
+#ifndef WEBINK_MAC_INTEGRATION_TEST
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#else
+unsigned long micros();
+void ESP_LOGI(const char* tag, const char* format, ...);
+#endif
+
+namespace esphome {
+namespace webink {
+
+const char* WebInkTrace::TAG = "webink.trace";
+
+namespace {
+
+// Ring of encoded records; head is the oldest
+uint8_t trace_ring[WebInkTrace::CAPACITY * WebInkTrace::RECORD_SIZE];
+size_t trace_head = 0;
+size_t trace_count = 0;
+uint32_t trace_dropped = 0;
+
+const size_t RECORDS_PER_LINE = 16;
+
+} // namespace
+
+//=============================================================================
+// RECORDING
+//=============================================================================
+
+void WebInkTrace::record(TracePhase phase, TraceEvent event, uint32_t arg) {
+    size_t slot;
+    if (trace_count < CAPACITY) {
+        slot = (trace_head + trace_count) % CAPACITY;
+        trace_count++;
+    } else {
+        // Full - overwrite the oldest
+        slot = trace_head;
+        trace_head = (trace_head + 1) % CAPACITY;
+        trace_dropped++;
+    }
+
+    uint32_t time_us = static_cast<uint32_t>(micros());
+    uint16_t arg16 = static_cast<uint16_t>(arg > 0xFFFF ? 0xFFFF : arg);
+    uint8_t* out = trace_ring + slot * RECORD_SIZE;
+    out[0] = static_cast<uint8_t>(time_us & 0xFF);
+    out[1] = static_cast<uint8_t>((time_us >> 8) & 0xFF);
+    out[2] = static_cast<uint8_t>((time_us >> 16) & 0xFF);
+    out[3] = static_cast<uint8_t>(time_us >> 24);
+    out[4] = static_cast<uint8_t>(phase);
+    out[5] = static_cast<uint8_t>(event);
+    out[6] = static_cast<uint8_t>(arg16 & 0xFF);
+    out[7] = static_cast<uint8_t>(arg16 >> 8);
+}
+
+void WebInkTrace::clear() {
+    trace_head = 0;
+    trace_count = 0;
+    trace_dropped = 0;
+}
+
+size_t WebInkTrace::get_count() {
+    return trace_count;
+}
+
+uint32_t WebInkTrace::get_dropped() {
+    return trace_dropped;
+}
+
+//=============================================================================
+// EXPORT
+//=============================================================================
+
+void WebInkTrace::dump() {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    // Static to keep the line buffer off the loop task stack
+    static char line[RECORDS_PER_LINE * RECORD_SIZE * 2 + 1];
+
+    WEBINK_LOGI(TAG, "[TRACE] begin v1 records=%u dropped=%u",
+                (unsigned) trace_count, (unsigned) trace_dropped);
+
+    size_t pos = 0;
+    for (size_t i = 0; i < trace_count; i++) {
+        const uint8_t* record = trace_ring + ((trace_head + i) % CAPACITY) * RECORD_SIZE;
+        for (size_t b = 0; b < RECORD_SIZE; b++) {
+            line[pos++] = HEX_DIGITS[record[b] >> 4];
+            line[pos++] = HEX_DIGITS[record[b] & 0x0F];
+        }
+        if ((i + 1) % RECORDS_PER_LINE == 0 || i + 1 == trace_count) {
+            line[pos] = '\0';
+            WEBINK_LOGI(TAG, "[TRACE] %s", line);
+            pos = 0;
+        }
+    }
+
+    WEBINK_LOGI(TAG, "[TRACE] end");
+    clear();
+}
+
+} // namespace webink
+} // namespace esphome
+
+#endif // WEBINK_TRACE
@@ -0,0 +1,142 @@
+/**
+ * @file webink_trace.h
+ * @brief Lightweight event tracing of a wake cycle
+ *
+ * WebInkTrace records begin/end/instant events as fixed 8-byte records in a
+ * RAM ring: state transitions, HTTP requests, socket streams, DNS lookups,
+ * slice decodes, blits to the display buffer and the display refresh. At the
+ * end of a cycle the ring is dumped to the log as hex lines between
+ * "[TRACE] begin" and "[TRACE] end"; server/trace_to_chrome.py turns a
+ * captured log (device or host run) into Chrome trace JSON for
+ * chrome://tracing or Perfetto.
+ *
+ * Record layout (little-endian):
+ * @code
+ * uint32_t time_us;   // micros()
+ * uint8_t  phase;     // TracePhase
+ * uint8_t  event;     // TraceEvent
+ * uint16_t arg;       // Event argument (see TraceEvent), saturating
+ * @endcode
+ *
+ * Tracing is compiled out unless WEBINK_TRACE=1 (the `trace: true` YAML
+ * option); every call is then an empty inline function.
+ *
+ * @author WebInk Component Authors
+ * @version 1.0.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef WEBINK_TRACE
+#define WEBINK_TRACE 0
+#endif
+
+namespace esphome {
+namespace webink {
+
+/**
+ * @enum TracePhase
+ * @brief Kind of trace record
+ */
+enum class TracePhase : uint8_t {
+    BEGIN = 0,
+    END = 1,
+    INSTANT = 2
+};
+
+/**
+ * @enum TraceEvent
+ * @brief Traced operations (the exporter mirrors this order)
+ */
+enum class TraceEvent : uint8_t {
+    STATE = 0,          ///< UpdateState span, arg = state
+    HTTP_GET = 1,       ///< Blocking GET, END arg = bytes received
+    HTTP_POST = 2,      ///< Blocking POST, END arg = bytes received
+    SOCKET = 3,         ///< Socket stream receive, END arg = bytes received
+    DNS = 4,            ///< Name resolution
+    DECODE = 5,         ///< Slice header parse / socket row assembly, arg = bytes
+    BLIT = 6,           ///< Rows drawn to the display buffer, arg = rows
+    REFRESH = 7,        ///< Physical display refresh
+    SLEEP = 8           ///< INSTANT right before deep sleep
+};
+
+/**
+ * @class WebInkTrace
+ * @brief Process-wide trace ring (static; one per device)
+ *
+ * When the ring is full the oldest records are overwritten and counted.
+ *
+ * @example Tracing a blit
+ * @code
+ * {
+ *     WebInkTraceScope scope(TraceEvent::BLIT, rows);
+ *     display->draw_progressive_pixels(0, row, 800, rows, data, mode);
+ * }
+ * WebInkTrace::dump();  // Log the ring for trace_to_chrome.py
+ * @endcode
+ */
+class WebInkTrace {
+public:
+    static const size_t CAPACITY = 512;                         ///< Records in the ring (4 KB)
+    static const size_t RECORD_SIZE = 8;                        ///< Bytes per record
+    static const bool ENABLED = WEBINK_TRACE != 0;              ///< False when compiled out
+
+#if WEBINK_TRACE
+    static void begin(TraceEvent event, uint32_t arg = 0) { record(TracePhase::BEGIN, event, arg); }
+    static void end(TraceEvent event, uint32_t arg = 0) { record(TracePhase::END, event, arg); }
+    static void instant(TraceEvent event, uint32_t arg = 0) { record(TracePhase::INSTANT, event, arg); }
+
+    /**
+     * @brief Append a record, overwriting the oldest when full
+     * @param phase Record kind
+     * @param event Traced operation
+     * @param arg Event argument (saturates at 65535)
+     */
+    static void record(TracePhase phase, TraceEvent event, uint32_t arg);
+
+    /**
+     * @brief Log the ring as hex lines and clear it
+     */
+    static void dump();
+
+    static void clear();                                        ///< Drop all records
+    static size_t get_count();                                  ///< Records in the ring
+    static uint32_t get_dropped();                              ///< Records overwritten since clear()
+
+private:
+    static const char* TAG;                                     ///< Logging tag
+#else
+    static void begin(TraceEvent, uint32_t = 0) {}
+    static void end(TraceEvent, uint32_t = 0) {}
+    static void instant(TraceEvent, uint32_t = 0) {}
+    static void record(TracePhase, TraceEvent, uint32_t) {}
+    static void dump() {}
+    static void clear() {}
+    static size_t get_count() { return 0; }
+    static uint32_t get_dropped() { return 0; }
+#endif
+};
+
+/**
+ * @class WebInkTraceScope
+ * @brief Begin event on construction, end event on destruction
+ */
+class WebInkTraceScope {
+public:
+    WebInkTraceScope(TraceEvent event, uint32_t arg = 0) : event_(event) {
+        WebInkTrace::begin(event, arg);
+    }
+    ~WebInkTraceScope() { WebInkTrace::end(event_); }
+
+    WebInkTraceScope(const WebInkTraceScope&) = delete;
+    WebInkTraceScope& operator=(const WebInkTraceScope&) = delete;
+
+private:
+    TraceEvent event_;                                          ///< Event to end
+};
+
+} // namespace webink
+} // namespace esphome
@@ -63,6 +63,87 @@ const char* error_type_to_string(ErrorType error) {
     }
 }
 
+const char* hash_policy_to_string(HashPolicy policy) {
+    switch (policy) {
+        case HashPolicy::HASH_CHECK:        return "HASH_CHECK";
+        case HashPolicy::CONDITIONAL_FETCH: return "CONDITIONAL_FETCH";
+        default:                            return "UNKNOWN";
+    }
+}
+
+//=============================================================================
+// TIMING HISTOGRAM
+//=============================================================================
+
+void Log2Histogram::clear() {
+    memset(counts, 0, sizeof(counts));
+    max_ms = 0;
+}
+
+int Log2Histogram::bucket_for(uint32_t value_ms) {
+    int bucket = 0;
+    while (value_ms >= 2 && bucket < BUCKETS - 1) {
+        value_ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void Log2Histogram::record(uint32_t value_ms) {
+    int bucket = bucket_for(value_ms);
+    if (counts[bucket] == 255) {
+        for (int i = 0; i < BUCKETS; i++) {
+            counts[i] >>= 1;
+        }
+    }
+    counts[bucket]++;
+    
+    if (value_ms > max_ms) {
+        max_ms = value_ms;
+    }
+}
+
+uint32_t Log2Histogram::total() const {
+    uint32_t sum = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        sum += counts[i];
+    }
+    return sum;
+}
+
+uint32_t Log2Histogram::percentile(int percent) const {
+    uint32_t count = total();
+    if (count == 0) {
+        return 0;
+    }
+    
+    // Rank of the wanted sample, 1-based
+    uint32_t rank = (count * static_cast<uint32_t>(percent) + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+    
+    uint32_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        if (counts[i] == 0 || seen + counts[i] < rank) {
+            seen += counts[i];
+            continue;
+        }
+        
+        // Assume samples spread evenly over [low, high) of the bucket and
+        // take the middle of the wanted sample's share
+        uint32_t low = (i == 0) ? 0 : (1u << i);
+        uint32_t high = (i == BUCKETS - 1) ? max_ms : (2u << i);
+        if (high < low) {
+            high = low;
+        }
+        uint32_t estimate = low + static_cast<uint32_t>(
+            static_cast<uint64_t>(high - low) * (2 * (rank - seen) - 1) / (2u * counts[i]));
+        return estimate < max_ms ? estimate : max_ms;
+    }
+    return max_ms;
+}
+
 #ifdef TEST_TYPES_ONLY
 //=============================================================================
 // STANDALONE TEST (for types-only testing)
@@ -104,7 +185,7 @@ int main() {
     // Test PixelData zero-copy
     uint8_t test_data[16] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
     PixelData pixels(test_data, 4, 4, 1, 4, ColorMode::MONO_BLACK_WHITE, 0);
-    std::cout << "PixelData: " << pixels.width << "x" << pixels.height << ", owns_data=" << pixels.owns_data << std::endl;
+    std::cout << "PixelData: " << pixels.width << "x" << pixels.height << ", pooled=" << static_cast<bool>(pixels.lease) << std::endl;
     
     const uint8_t* row1 = pixels.get_row_ptr(1);
     std::cout << "Row 1 data: " << (int)row1[0] << "," << (int)row1[1] << "," << (int)row1[2] << "," << (int)row1[3] << std::endl;
@@ -14,7 +14,13 @@
 
 #include <string>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <utility>
+
+#include "webink_arena.h"
+#include "webink_delegate.h"
+#include "webink_pixel_pool.h"
 
 namespace esphome {
 namespace webink {
@@ -43,6 +49,9 @@ enum class UpdateState {
     COMPLETE          ///< Update cycle complete
 };
 
+/// Number of UpdateState values (for per-state arrays)
+static const int UPDATE_STATE_COUNT = static_cast<int>(UpdateState::COMPLETE) + 1;
+
 /**
  * @enum ColorMode
  * @brief Supported color modes for display and image processing
@@ -70,6 +79,34 @@ enum class NetworkMode {
     TCP_SOCKET         ///< Direct TCP socket for full image download (faster)
 };
 
+/// Maximum number of configured servers (primary plus fallbacks)
+static const int MAX_SERVERS = 3;
+
+/// Caller buffer for the WebInkConfig URL builders (longest: image URL with hash)
+static const size_t URL_BUFFER_SIZE = 384;
+
+/// Caller buffer for a hostname parsed from a server URL (URLs are at most 63 chars)
+static const size_t HOST_BUFFER_SIZE = 64;
+
+/// Caller buffer for WebInkConfig::build_socket_request()
+static const size_t SOCKET_REQUEST_BUFFER_SIZE = 192;
+
+/// Hash of a conditional request, including NUL (matches WebInkState::last_hash)
+static const size_t REQUEST_HASH_SIZE = 16;
+
+/**
+ * @enum HashPolicy
+ * @brief How an update cycle finds out whether the content changed
+ * 
+ * Chosen per wake from the device's content change history: a separate
+ * hash request is cheap when content is usually static, but pure overhead
+ * when it changes on nearly every wake.
+ */
+enum class HashPolicy {
+    HASH_CHECK,        ///< Request the hash first, download only if it changed
+    CONDITIONAL_FETCH  ///< Skip the hash request, fetch the image with if_none_match
+};
+
 /**
  * @enum ErrorType
  * @brief Categorized error types for structured error handling
@@ -115,11 +152,23 @@ struct DisplayRect {
 struct ImageRequest {
     DisplayRect rect;      ///< Target rectangle to fetch
     ColorMode mode;        ///< Requested color mode
-    std::string format;    ///< Image format ("pbm", "pgm", "ppm")
+    const char* format;    ///< Image format ("pbm", "pgm", "ppm"), string literal
     int start_row;         ///< Starting row for sliced requests
     int num_rows;          ///< Number of rows for sliced requests
+    char if_none_match[REQUEST_HASH_SIZE];  ///< Skip the data if the server hash equals this (empty = unconditional)
     
-    ImageRequest() : mode(ColorMode::MONO_BLACK_WHITE), format("pbm"), start_row(0), num_rows(0) {}
+    ImageRequest() : mode(ColorMode::MONO_BLACK_WHITE), format("pbm"), start_row(0), num_rows(0),
+                     if_none_match{} {}
+    
+    /**
+     * @brief Set or clear the conditional hash
+     * @param hash Hash to send, nullptr or "" for an unconditional request
+     */
+    void set_if_none_match(const char* hash) {
+        snprintf(if_none_match, sizeof(if_none_match), "%s", hash ? hash : "");
+    }
+    
+    bool is_conditional() const { return if_none_match[0] != '\0'; }  ///< if_none_match is set
 };
 
 /**
@@ -160,48 +209,44 @@ struct ImageHeader {
  * 
  * Holds pixel data using direct pointers to avoid memory copying.
  * For memory-constrained devices, this avoids doubling memory usage.
+ * Decoded data that cannot point into the source lives in a
+ * WebInkPixelPool buffer; the lease is returned with the PixelData.
  */
 struct PixelData {
-    const uint8_t* data;     ///< Pixel data pointer (not owned, points to original data)
+    const uint8_t* data;     ///< Pixel data pointer (source data or lease buffer)
     int width;               ///< Width in pixels
     int height;              ///< Height in pixels
     int bytes_per_pixel;     ///< Bytes per pixel (depends on color mode)
     int data_stride;         ///< Bytes per row in source data (for padding)
     int start_offset;        ///< Offset from data pointer to first pixel
     ColorMode mode;          ///< Color mode of pixel data
-    bool owns_data;          ///< True if this PixelData owns the data pointer
+    PixelLease lease;        ///< Pool buffer behind data, if any (returned on destruction)
     
     PixelData() : data(nullptr), width(0), height(0), bytes_per_pixel(0), 
-                 data_stride(0), start_offset(0), mode(ColorMode::MONO_BLACK_WHITE),
-                 owns_data(false) {}
+                 data_stride(0), start_offset(0), mode(ColorMode::MONO_BLACK_WHITE) {}
     
     /// @brief Constructor for direct pointer reference (zero-copy)
     PixelData(const uint8_t* data_ptr, int w, int h, int bpp, int stride, 
               ColorMode color_mode, int offset = 0) :
         data(data_ptr), width(w), height(h), bytes_per_pixel(bpp),
-        data_stride(stride), start_offset(offset), mode(color_mode), owns_data(false) {}
+        data_stride(stride), start_offset(offset), mode(color_mode) {}
     
-    /// @brief Destructor cleans up only if we own the data
-    ~PixelData() {
-        if (owns_data && data) {
-            delete[] data;
-        }
-        data = nullptr;
-    }
+    /// @brief Constructor taking over a pool buffer (stride from the lease)
+    PixelData(PixelLease&& buffer, int w, int h, int bpp, ColorMode color_mode) :
+        data(buffer.data()), width(w), height(h), bytes_per_pixel(bpp),
+        data_stride(buffer.stride()), start_offset(0), mode(color_mode), lease(std::move(buffer)) {}
     
     /// @brief Move constructor for efficient transfer
     PixelData(PixelData&& other) noexcept : 
         data(other.data), width(other.width), height(other.height),
         bytes_per_pixel(other.bytes_per_pixel), data_stride(other.data_stride),
-        start_offset(other.start_offset), mode(other.mode), owns_data(other.owns_data) {
+        start_offset(other.start_offset), mode(other.mode), lease(std::move(other.lease)) {
         other.data = nullptr;
-        other.owns_data = false;
     }
     
-    /// @brief Move assignment operator
+    /// @brief Move assignment operator (returns any lease held before)
     PixelData& operator=(PixelData&& other) noexcept {
         if (this != &other) {
-            if (owns_data && data) delete[] data;
             data = other.data;
             width = other.width;
             height = other.height;
@@ -209,9 +254,8 @@ struct PixelData {
             data_stride = other.data_stride;
             start_offset = other.start_offset;
             mode = other.mode;
-            owns_data = other.owns_data;
+            lease = std::move(other.lease);
             other.data = nullptr;
-            other.owns_data = false;
         }
         return *this;
     }
@@ -238,18 +282,62 @@ struct PixelData {
  * @brief Result of network operation (HTTP or socket)
  * 
  * Provides structured result information for both successful and failed
- * network operations, with detailed error reporting.
+ * network operations, with detailed error reporting. Response text lives in
+ * the wake arena (see webink_arena.h), so a result must not be kept past
+ * the cycle that produced it.
  */
 struct NetworkResult {
     bool success;
     ErrorType error_type;
     std::string error_message;
-    std::string content;  // HTTP response content
-    std::string data;     // Alias for content (for compatibility)
+    ArenaString data;     // HTTP response body (or socket payload)
     int status_code;
     int bytes_received;   // Number of bytes received
+    ArenaString content_hash;  // X-WebInk-Hash response header (empty if not sent)
+    int sleep_seconds;         // X-WebInk-Sleep response header (-1 if not sent)
+    int next_change_seconds;   // X-WebInk-Next-Change response header (-1 if not sent)
+    
+    NetworkResult() : success(false), error_type(ErrorType::SERVER_UNREACHABLE), status_code(0), bytes_received(0),
+                      sleep_seconds(-1), next_change_seconds(-1) {}
+};
+
+/// Log line callback of the component log_message() helpers
+using LogCallback = WebInkDelegate<void(const char*)>;
+
+/**
+ * @struct Log2Histogram
+ * @brief Millisecond timing histogram with power-of-two buckets (20 bytes)
+ * 
+ * Bucket 0 counts values below 2 ms, bucket i (i > 0) values in
+ * [2^i, 2^(i+1)) ms, and the last bucket everything from 2^15 ms up.
+ * Counts are 8-bit: when one would overflow, all counts are halved, so the
+ * histogram slowly forgets old samples. Plain data, safe to memcpy into
+ * RTC memory.
+ */
+struct Log2Histogram {
+    static const int BUCKETS = 16;
     
-    NetworkResult() : success(false), error_type(ErrorType::SERVER_UNREACHABLE), status_code(0), bytes_received(0) {}
+    uint8_t counts[BUCKETS];   ///< Samples per bucket (halved on overflow)
+    uint32_t max_ms;           ///< Largest sample since the last clear()
+    
+    /// @brief Drop all samples
+    void clear();
+    
+    /// @brief Add a sample
+    void record(uint32_t value_ms);
+    
+    /// @brief Get number of samples currently counted
+    uint32_t total() const;
+    
+    /**
+     * @brief Estimate a percentile, interpolating inside the bucket
+     * @param percent Percentile (0-100)
+     * @return Estimated value in ms (0 if empty, never above max_ms)
+     */
+    uint32_t percentile(int percent) const;
+    
+    /// @brief Get bucket index for a value
+    static int bucket_for(uint32_t value_ms);
 };
 
 /**
@@ -273,5 +361,12 @@ const char* color_mode_to_string(ColorMode mode);
  */
 const char* error_type_to_string(ErrorType error);
 
+/**
+ * @brief Convert HashPolicy enum to human-readable string
+ * @param policy The policy to convert
+ * @return String representation of the policy
+ */
+const char* hash_policy_to_string(HashPolicy policy);
+
 } // namespace webink
 } // namespace esphome
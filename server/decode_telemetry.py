@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Decoder for webInk device log batches and per-wake telemetry records
+
+Devices upload their RTC log ring to /post_log_batch. Besides text log lines
+the ring holds one binary telemetry record per wake, and a per-state timing
+summary and per-state memory minima per upload (see client/esphome/webink_component/webink/webink_telemetry.h
+for the layouts).
+The server uses the decoders below and appends every decoded telemetry
+record to data/telemetry.jsonl.
+
+Usage:
+  python decode_telemetry.py batch.bin            # Decode a captured batch body
+  python decode_telemetry.py --hex 0101000a...    # Decode one hex-encoded record
+  python decode_telemetry.py --csv data/telemetry.jsonl   # Fleet data as CSV
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+from typing import Any, Dict, List, Tuple
+
+LOG_SEVERITIES = ("INFO", "WARNING", "ERROR", "TELEMETRY", "TIMING", "MEMORY")
+TELEMETRY_SEVERITY = 3
+TIMING_SEVERITY = 4
+MEMORY_SEVERITY = 5
+
+# Version 1 record: 52 bytes, little-endian
+TELEMETRY_FORMAT = "<BBBbI7HHIIIIIIB3x"
+TELEMETRY_SIZE = struct.calcsize(TELEMETRY_FORMAT)
+
+# Version 2 appends u32 min_stack_free
+TELEMETRY_V2_FORMAT = "<I"
+TELEMETRY_V2_SIZE = TELEMETRY_SIZE + struct.calcsize(TELEMETRY_V2_FORMAT)
+
+# Version 1 timing record: u8 version, u8 count, then per state u16 p50, u16 p95, u32 max
+TIMING_ENTRY_FORMAT = "<HHI"
+TIMING_ENTRY_SIZE = struct.calcsize(TIMING_ENTRY_FORMAT)
+
+# Version 1 memory record: u8 version, u8 count, then per state
+# u32 min_free_heap, u32 min_largest_block, u16 min_stack_free
+MEMORY_ENTRY_FORMAT = "<IIH"
+MEMORY_ENTRY_SIZE = struct.calcsize(MEMORY_ENTRY_FORMAT)
+
+UPDATE_STATES = ("IDLE", "WIFI_WAIT", "HASH_CHECK", "HASH_REQUEST", "HASH_PARSE",
+                 "IMAGE_REQUEST", "IMAGE_DOWNLOAD", "IMAGE_PARSE", "IMAGE_DISPLAY",
+                 "DISPLAY_UPDATE", "ERROR_DISPLAY", "SLEEP_PREPARE", "COMPLETE")
+WAKE_REASONS = ("unknown", "power_on", "timer", "external", "software", "crash")
+PHASES = ("boot", "wifi", "hash", "download", "refresh", "error", "sleep")
+ERROR_TYPES = ("none", "wifi_timeout", "server_unreachable", "invalid_response",
+               "parse_error", "memory_error", "socket_error", "display_error")
+
+FLAG_CONTENT_UPDATED = 0x01
+FLAG_SOCKET_MODE = 0x02
+
+
+def _name(names: Tuple[str, ...], index: int) -> str:
+    return names[index] if 0 <= index < len(names) else str(index)
+
+
+def decode_wake_telemetry(data: bytes) -> Dict[str, Any]:
+    """Decode one binary per-wake telemetry record into a flat dict"""
+    if len(data) < 1 or data[0] not in (1, 2):
+        raise ValueError(f"unsupported telemetry version {data[0] if data else None}")
+    if len(data) < (TELEMETRY_V2_SIZE if data[0] >= 2 else TELEMETRY_SIZE):
+        raise ValueError(f"telemetry record too short ({len(data)} bytes)")
+
+    fields = struct.unpack_from(TELEMETRY_FORMAT, data)
+    (version, wake_reason, error_code, rssi, wake_counter) = fields[:5]
+    phase_ms = fields[5:12]
+    (request_count, awake_ms, bytes_in, bytes_out,
+     min_free_heap, largest_free_block, refresh_ms, flags) = fields[12:]
+
+    record = {
+        "version": version,
+        "wake": wake_counter,
+        "wake_reason": _name(WAKE_REASONS, wake_reason),
+        "error": _name(ERROR_TYPES, error_code),
+        "rssi_dbm": rssi if rssi != 0 else None,
+        "awake_ms": awake_ms,
+    }
+    for phase, ms in zip(PHASES, phase_ms):
+        record[f"{phase}_ms"] = ms
+    record.update({
+        "refresh_time_ms": refresh_ms,
+        "requests": request_count,
+        "bytes_in": bytes_in,
+        "bytes_out": bytes_out,
+        "min_free_heap": min_free_heap,
+        "largest_free_block": largest_free_block,
+        "content_updated": bool(flags & FLAG_CONTENT_UPDATED),
+        "socket_mode": bool(flags & FLAG_SOCKET_MODE),
+    })
+    if version >= 2:
+        record["min_stack_free"], = struct.unpack_from(TELEMETRY_V2_FORMAT, data, TELEMETRY_SIZE)
+    return record
+
+
+def decode_state_timing(data: bytes) -> Dict[str, Dict[str, int]]:
+    """Decode a per-state timing summary into {state: {p50_ms, p95_ms, max_ms}}
+
+    States that were never visited (all zero) are left out.
+    """
+    if len(data) < 2 or data[0] != 1:
+        raise ValueError(f"unsupported timing version {data[0] if data else None}")
+    count = data[1]
+    if len(data) < 2 + count * TIMING_ENTRY_SIZE:
+        raise ValueError(f"timing record too short ({len(data)} bytes)")
+
+    timing = {}
+    for i in range(count):
+        p50, p95, max_ms = struct.unpack_from(TIMING_ENTRY_FORMAT, data, 2 + i * TIMING_ENTRY_SIZE)
+        if max_ms:
+            timing[_name(UPDATE_STATES, i)] = {"p50_ms": p50, "p95_ms": p95, "max_ms": max_ms}
+    return timing
+
+
+def decode_state_memory(data: bytes) -> Dict[str, Dict[str, int]]:
+    """Decode per-state memory minima into {state: {min_free_heap, min_largest_block, min_stack_free}}
+
+    States that were never sampled (all zero) are left out.
+    """
+    if len(data) < 2 or data[0] != 1:
+        raise ValueError(f"unsupported memory version {data[0] if data else None}")
+    count = data[1]
+    if len(data) < 2 + count * MEMORY_ENTRY_SIZE:
+        raise ValueError(f"memory record too short ({len(data)} bytes)")
+
+    memory = {}
+    for i in range(count):
+        free_heap, largest_block, stack_free = struct.unpack_from(
+            MEMORY_ENTRY_FORMAT, data, 2 + i * MEMORY_ENTRY_SIZE)
+        if free_heap:
+            memory[_name(UPDATE_STATES, i)] = {"min_free_heap": free_heap,
+                                               "min_largest_block": largest_block,
+                                               "min_stack_free": stack_free}
+    return memory
+
+
+def decode_log_batch(data: bytes) -> Tuple[int, List[Dict[str, Any]]]:
+    """Decode a batched log upload from a device's RTC log ring
+
+    Layout (little-endian): b"WLOG", u8 version, u8 reserved, u16 dropped,
+    then records of u8 severity, u8 length, u16 wake, u32 uptime_ms and
+    `length` payload bytes (text, a telemetry record for severity 3, a
+    timing summary for severity 4, or memory minima for severity 5).
+    Returns (dropped, records).
+    """
+    if len(data) < 8 or data[:4] != b"WLOG" or data[4] != 1:
+        raise ValueError("not a version 1 log batch")
+
+    dropped, = struct.unpack_from("<H", data, 6)
+    records = []
+    offset = 8
+    while offset < len(data):
+        if offset + 8 > len(data):
+            raise ValueError("truncated record header")
+        severity, length, wake, uptime_ms = struct.unpack_from("<BBHI", data, offset)
+        offset += 8
+        if offset + length > len(data):
+            raise ValueError("truncated record payload")
+        payload = data[offset:offset + length]
+        offset += length
+
+        record = {
+            "severity": _name(LOG_SEVERITIES, severity),
+            "wake": wake,
+            "uptime_ms": uptime_ms,
+        }
+        if severity == TELEMETRY_SEVERITY:
+            record["telemetry"] = decode_wake_telemetry(payload)
+        elif severity == TIMING_SEVERITY:
+            record["timing"] = decode_state_timing(payload)
+        elif severity == MEMORY_SEVERITY:
+            record["memory"] = decode_state_memory(payload)
+        else:
+            record["message"] = payload.decode("utf-8", errors="replace")
+        records.append(record)
+    return dropped, records
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Decode webInk log batches and telemetry records")
+    parser.add_argument("input", nargs="?", help="Batch body file, or telemetry.jsonl with --csv")
+    parser.add_argument("--hex", help="Decode one hex-encoded telemetry record")
+    parser.add_argument("--csv", action="store_true", help="Write telemetry records from a JSONL file as CSV")
+    args = parser.parse_args()
+
+    if args.hex:
+        print(json.dumps(decode_wake_telemetry(bytes.fromhex(args.hex)), indent=2))
+        return 0
+
+    if not args.input:
+        parser.error("an input file or --hex is required")
+
+    if args.csv:
+        rows = []
+        with open(args.input) as f:
+            for line in f:
+                if line.strip():
+                    entry = json.loads(line)
+                    rows.append({"device": entry.get("device"), "received": entry.get("received"),
+                                 **entry["telemetry"]})
+        if rows:
+            writer = csv.DictWriter(sys.stdout, fieldnames=list(rows[0].keys()))
+            writer.writeheader()
+            writer.writerows(rows)
+        return 0
+
+    with open(args.input, "rb") as f:
+        dropped, records = decode_log_batch(f.read())
+    if dropped:
+        print(f"# {dropped} records dropped on the device (ring full)")
+    for record in records:
+        print(json.dumps(record))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
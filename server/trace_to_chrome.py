@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Convert webInk trace dumps into Chrome trace JSON
+
+Firmware built with `trace: true` (WEBINK_TRACE=1) logs its trace ring at the
+end of every cycle as hex lines between "[TRACE] begin" and "[TRACE] end"
+(see client/esphome/webink_component/webink/webink_trace.h for the record
+layout). This script reads a captured log - `esphome logs` output or the
+stdout of a host run - and writes a trace that chrome://tracing and Perfetto
+(ui.perfetto.dev) open directly. Each dumped cycle becomes its own process
+row; states, network operations and display work get separate tracks.
+
+Usage:
+  esphome logs webink.yaml > device.log
+  python trace_to_chrome.py device.log -o trace.json
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+from typing import Any, Dict, Iterable, List
+
+RECORD_FORMAT = "<IBBH"
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+PHASES = ("B", "E", "i")
+EVENTS = ("state", "http_get", "http_post", "socket", "dns", "decode", "blit", "refresh", "sleep")
+UPDATE_STATES = ("IDLE", "WIFI_WAIT", "HASH_CHECK", "HASH_REQUEST", "HASH_PARSE",
+                 "IMAGE_REQUEST", "IMAGE_DOWNLOAD", "IMAGE_PARSE", "IMAGE_DISPLAY",
+                 "DISPLAY_UPDATE", "ERROR_DISPLAY", "SLEEP_PREPARE", "COMPLETE")
+
+# Track (tid) per event: 1 = state machine, 2 = network, 3 = display
+TRACKS = {"state": 1, "http_get": 2, "http_post": 2, "socket": 2, "dns": 2,
+          "decode": 3, "blit": 3, "refresh": 3, "sleep": 1}
+TRACK_NAMES = {1: "state machine", 2: "network", 3: "display"}
+ARG_NAMES = {"http_get": "bytes", "http_post": "bytes", "socket": "bytes",
+             "decode": "bytes", "blit": "rows"}
+
+BEGIN_RE = re.compile(r"\[TRACE\] begin v1 records=(\d+) dropped=(\d+)")
+DATA_RE = re.compile(r"\[TRACE\] ([0-9a-f]+)\s*$")
+END_RE = re.compile(r"\[TRACE\] end")
+
+
+def _name(names, index: int) -> str:
+    return names[index] if 0 <= index < len(names) else str(index)
+
+
+def parse_dumps(lines: Iterable[str]) -> List[Dict[str, Any]]:
+    """Collect the raw records of every trace dump in a log"""
+    dumps = []
+    current = None
+    for line in lines:
+        match = BEGIN_RE.search(line)
+        if match:
+            current = {"dropped": int(match.group(2)), "data": bytearray()}
+            continue
+        if current is None:
+            continue
+        if END_RE.search(line):
+            dumps.append(current)
+            current = None
+            continue
+        match = DATA_RE.search(line)
+        if match:
+            current["data"].extend(bytes.fromhex(match.group(1)))
+    return dumps
+
+
+def dump_to_events(data: bytes, pid: int) -> List[Dict[str, Any]]:
+    """Turn one dump into Chrome trace events for process `pid`"""
+    events = []
+    open_spans: Dict[int, List[str]] = {}
+    last_raw = None
+    offset_us = 0
+    ts = 0
+    for pos in range(0, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+        time_us, phase, event, arg = struct.unpack_from(RECORD_FORMAT, data, pos)
+        # micros() wraps every ~71 minutes
+        if last_raw is not None and time_us < last_raw:
+            offset_us += 1 << 32
+        last_raw = time_us
+        ts = time_us + offset_us
+
+        event_name = _name(EVENTS, event)
+        name = _name(UPDATE_STATES, arg) if event_name == "state" else event_name
+        tid = TRACKS.get(event_name, 4)
+        entry = {"name": name, "cat": event_name, "ph": _name(PHASES, phase),
+                 "ts": ts, "pid": pid, "tid": tid}
+        if event_name in ARG_NAMES and arg:
+            entry["args"] = {ARG_NAMES[event_name]: arg}
+        if entry["ph"] == "i":
+            entry["s"] = "t"
+        elif entry["ph"] == "B":
+            open_spans.setdefault(tid, []).append(name)
+        elif entry["ph"] == "E":
+            stack = open_spans.get(tid)
+            if not stack:
+                continue  # Began before the oldest record in the ring
+            stack.pop()
+        events.append(entry)
+
+    # Close spans still open at dump time (the last state, usually)
+    for tid, stack in open_spans.items():
+        for name in reversed(stack):
+            events.append({"name": name, "ph": "E", "ts": ts, "pid": pid, "tid": tid})
+    return events
+
+
+def convert(lines: Iterable[str]) -> Dict[str, Any]:
+    """Build a Chrome trace object from a captured log"""
+    trace_events = []
+    for index, dump in enumerate(parse_dumps(lines)):
+        pid = index + 1
+        label = f"cycle {pid}" + (f" ({dump['dropped']} records dropped)" if dump["dropped"] else "")
+        trace_events.append({"name": "process_name", "ph": "M", "pid": pid, "args": {"name": label}})
+        for tid, track in TRACK_NAMES.items():
+            trace_events.append({"name": "thread_name", "ph": "M", "pid": pid, "tid": tid,
+                                 "args": {"name": track}})
+        trace_events.extend(dump_to_events(bytes(dump["data"]), pid))
+    return {"traceEvents": trace_events, "displayTimeUnit": "ms"}
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Convert webInk trace dumps to Chrome trace JSON")
+    parser.add_argument("log", help="Captured log file ('-' for stdin)")
+    parser.add_argument("-o", "--output", help="Output file (default: stdout)")
+    args = parser.parse_args()
+
+    if args.log == "-":
+        trace = convert(sys.stdin)
+    else:
+        with open(args.log, errors="replace") as f:
+            trace = convert(f)
+
+    cycles = sum(1 for e in trace["traceEvents"] if e.get("name") == "process_name")
+    if cycles == 0:
+        print("No trace dumps found - was the firmware built with trace: true?", file=sys.stderr)
+        return 1
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+        print(f"Wrote {cycles} cycle(s) to {args.output}", file=sys.stderr)
+    else:
+        json.dump(trace, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -30,6 +30,8 @@ from fastapi.staticfiles import StaticFiles
 import uvicorn
 from playwright.async_api import async_playwright
 
+from decode_telemetry import decode_log_batch
+
 # Configure logging
 logging.basicConfig(
     level=logging.INFO,
@@ -41,6 +43,7 @@ logger = logging.getLogger(__name__)
 CONFIG_FILE = "config.yaml"
 DATA_DIR = Path("data")
 CLIENT_DATA_FILE = DATA_DIR / "clients.json"
+TELEMETRY_FILE = DATA_DIR / "telemetry.jsonl"
 DEFAULT_REFRESH_INTERVAL = 600  # seconds
 SNAPSHOT_LEAD_TIME = 5  # seconds before refresh to take snapshot
 DEFAULT_SLEEP_CHECK_INTERVAL = 30  # seconds for no-sleep mode
@@ -164,6 +167,13 @@ class SocketServer:
     Format: webInkV1 <api_key> <device> <mode> <x> <y> <w> <h> <format>\n
     Response: Raw pixel data (PBM/PGM/PPM format without header)
     
+    Protocol: webInkV2 (conditional fetch)
+    Format: webInkV2 <api_key> <device> <mode> <x> <y> <w> <h> <format> <if_none_match>\n
+    Response: "UNCHANGED <hash> <sleep_seconds> <next_change_seconds>\n" if the
+              image hash equals <if_none_match>, otherwise
+              "OK <hash> <sleep_seconds> <next_change_seconds>\n" followed by raw
+              pixel data (next_change_seconds is -1 when unknown)
+    
     This allows embedded devices to:
     - Use a fixed-size buffer (request N pixels, get N pixels)
     - Avoid HTTP overhead and parsing
@@ -189,20 +199,23 @@ class SocketServer:
             logger.info(f"[SOCKET] Request from {addr}: {request}")
             
             # Parse request: webInkV1 <api_key> <device> <mode> <x> <y> <w> <h> <format>
+            #            or: webInkV2 <...same...> <if_none_match>
             parts = request.split()
             
-            if len(parts) != 9:
-                error_msg = f"ERROR: Invalid request format. Expected 9 parts, got {len(parts)}\n"
+            if len(parts) not in (9, 10):
+                error_msg = f"ERROR: Invalid request format. Expected 9 or 10 parts, got {len(parts)}\n"
                 writer.write(error_msg.encode('utf-8'))
                 await writer.drain()
                 logger.warning(f"[SOCKET] Invalid request from {addr}: wrong number of parameters")
                 return
             
-            protocol, api_key, device, mode, x_str, y_str, w_str, h_str, format_str = parts
+            protocol, api_key, device, mode, x_str, y_str, w_str, h_str, format_str = parts[:9]
+            if_none_match = parts[9] if len(parts) == 10 else None
             
-            # Validate protocol version
-            if protocol != "webInkV1":
-                error_msg = f"ERROR: Unsupported protocol '{protocol}'. Expected 'webInkV1'\n"
+            # Validate protocol version (V2 adds the if_none_match field)
+            expected_protocol = "webInkV2" if if_none_match is not None else "webInkV1"
+            if protocol != expected_protocol:
+                error_msg = f"ERROR: Unsupported protocol '{protocol}'. Expected '{expected_protocol}'\n"
                 writer.write(error_msg.encode('utf-8'))
                 await writer.drain()
                 logger.warning(f"[SOCKET] Invalid protocol from {addr}: {protocol}")
@@ -269,6 +282,18 @@ class SocketServer:
                 logger.warning(f"[SOCKET] Image not available: {filename}")
                 return
             
+            # Conditional fetch: answer with a status line before any pixels
+            if if_none_match is not None:
+                image_hash = self.snapshot_manager.get_image_hash(page_id, mode) or ""
+                schedule = get_device_schedule(device)
+                schedule_fields = f"{schedule['sleep_seconds']} {schedule['next_change_seconds']}"
+                if image_hash == if_none_match:
+                    writer.write(f"UNCHANGED {image_hash} {schedule_fields}\n".encode('utf-8'))
+                    await writer.drain()
+                    logger.info(f"[SOCKET] Image unchanged for {addr} (device={device}, hash={image_hash})")
+                    return
+                writer.write(f"OK {image_hash} {schedule_fields}\n".encode('utf-8'))
+            
             # Open and crop image
             img = Image.open(filename)
             
@@ -817,6 +842,19 @@ class SnapshotManager:
                 logger.error(f"Failed to parse suppress times: {e}")
         
         return refresh_interval
+    
+    def get_next_change_seconds(self, device_name: str) -> int:
+        """Seconds until the next snapshot of the device's page is ready (-1 if unknown)"""
+        device_info = self.config.devices.get(device_name, self.config.devices.get('default', {}))
+        page_id = device_info.get('page')
+        
+        if not page_id or page_id not in self.next_refresh_times:
+            return -1
+        
+        # The capture starts at the scheduled time; the image changes once it has rendered
+        render_duration = self.last_render_duration.get(page_id, 30.0)
+        ready_at = self.next_refresh_times[page_id] + timedelta(seconds=render_duration)
+        return max(0, int((ready_at - datetime.now()).total_seconds()))
 
 
 # Global instances
@@ -845,6 +883,25 @@ def snapshot_worker():
             time.sleep(5)  # Wait a bit on error
 
 
+def get_device_schedule(device: str) -> Dict[str, int]:
+    """Sleep interval and next expected content change for a device
+    
+    Sent with /get_hash, conditional /get_image and webInkV2 socket responses,
+    so devices rarely need a separate /get_sleep request.
+    """
+    sleep_seconds = snapshot_manager.get_sleep_seconds(device)
+    
+    # Update expected next refresh
+    if sleep_seconds > 0:
+        next_refresh = datetime.now() + timedelta(seconds=sleep_seconds)
+        client_manager.update_client(device, {'next_refresh': next_refresh.isoformat()})
+    
+    return {
+        "sleep_seconds": sleep_seconds,
+        "next_change_seconds": snapshot_manager.get_next_change_seconds(device),
+    }
+
+
 # API Endpoints
 
 @app.on_event("startup")
@@ -897,7 +954,7 @@ async def get_hash(
     if not image_hash:
         raise HTTPException(status_code=404, detail="Image not available yet")
     
-    return {"hash": image_hash}
+    return {"hash": image_hash, **get_device_schedule(device)}
 
 
 @app.post("/post_log")
@@ -924,6 +981,73 @@ async def post_log(
     return {"status": "ok"}
 
 
+@app.post("/post_log_batch")
+async def post_log_batch(
+    request: Request,
+    api_key: str = Query(...),
+    device: str = Query(...)
+):
+    """Receive buffered log records from device (one upload per several wakes)"""
+    # Verify API key
+    if api_key != config.api_key:
+        raise HTTPException(status_code=401, detail="Invalid API key")
+    
+    try:
+        dropped, records = decode_log_batch(await request.body())
+    except ValueError as e:
+        logger.error(f"Invalid log batch from {device}: {e}")
+        raise HTTPException(status_code=400, detail="Invalid log batch")
+    
+    if dropped:
+        logger.warning(f"Device log [{device}]: {dropped} records dropped (ring full)")
+    
+    received = datetime.now().isoformat()
+    last_log = None
+    last_telemetry = None
+    last_timing = None
+    last_memory = None
+    for record in records:
+        if "telemetry" in record:
+            # Per-wake telemetry: keep it for fleet analysis (decode_telemetry.py --csv)
+            last_telemetry = record["telemetry"]
+            with open(TELEMETRY_FILE, 'a') as f:
+                f.write(json.dumps({"device": device, "received": received,
+                                    "telemetry": last_telemetry}) + "\n")
+            logger.info(f"Device telemetry [{device}] wake {last_telemetry['wake']}: "
+                        f"awake {last_telemetry['awake_ms']}ms, {last_telemetry['requests']} requests, "
+                        f"{last_telemetry['bytes_in']} bytes in")
+        elif "timing" in record:
+            # Latest per-state p50/p95/max summary replaces the previous one
+            last_timing = record["timing"]
+            logger.info(f"Device timing [{device}]: " + ", ".join(
+                f"{state} p95 {t['p95_ms']}ms" for state, t in last_timing.items()))
+        elif "memory" in record:
+            # Per-state heap/stack minima since boot replace the previous ones
+            last_memory = record["memory"]
+            logger.info(f"Device memory [{device}]: " + ", ".join(
+                f"{state} heap {m['min_free_heap']} stack {m['min_stack_free']}"
+                for state, m in last_memory.items()))
+        else:
+            last_log = record["message"]
+            logger.info(f"Device log [{device}] wake {record['wake']} +{record['uptime_ms']}ms "
+                        f"{record['severity']}: {last_log}")
+    
+    # Update client info
+    updates = {}
+    if last_log is not None:
+        updates['last_log'] = last_log
+    if last_telemetry is not None:
+        updates['metrics'] = last_telemetry
+    if last_timing is not None:
+        updates['state_times'] = last_timing
+    if last_memory is not None:
+        updates['state_memory'] = last_memory
+    if updates:
+        client_manager.update_client(device, updates)
+    
+    return {"status": "ok", "records": len(records)}
+
+
 @app.post("/post_metrics")
 async def post_metrics(
     request: Request,
@@ -962,15 +1086,7 @@ async def get_sleep(
     # Update client info
     client_manager.update_client(device, {})
     
-    # Calculate sleep time
-    sleep_seconds = snapshot_manager.get_sleep_seconds(device)
-    
-    # Update expected next refresh
-    if sleep_seconds > 0:
-        next_refresh = datetime.now() + timedelta(seconds=sleep_seconds)
-        client_manager.update_client(device, {'next_refresh': next_refresh.isoformat()})
-    
-    return {"sleep_seconds": sleep_seconds}
+    return get_device_schedule(device)
 
 
 @app.get("/get_image")
@@ -982,9 +1098,15 @@ async def get_image(
     y: int = Query(...),
     w: int = Query(...),
     h: int = Query(...),
-    format: str = Query(default="png")
+    format: str = Query(default="png"),
+    if_none_match: Optional[str] = Query(default=None)
 ):
-    """Get a cropped chunk of the image"""
+    """Get a cropped chunk of the image
+    
+    The current image hash is returned in the X-WebInk-Hash header. If
+    if_none_match equals that hash, responds 304 with no body so a device can
+    skip the separate /get_hash request.
+    """
     # Verify API key
     if api_key != config.api_key:
         raise HTTPException(status_code=401, detail="Invalid API key")
@@ -1010,6 +1132,18 @@ async def get_image(
     if not filename.exists():
         raise HTTPException(status_code=500, detail=f"Image not available for {page_id} in mode {mode}")
     
+    image_hash = snapshot_manager.get_image_hash(page_id, mode)
+    hash_headers = {"X-WebInk-Hash": image_hash} if image_hash else {}
+    
+    # Conditional fetches replace /get_hash, so they carry the schedule too
+    if if_none_match is not None:
+        schedule = get_device_schedule(device)
+        hash_headers["X-WebInk-Sleep"] = str(schedule["sleep_seconds"])
+        hash_headers["X-WebInk-Next-Change"] = str(schedule["next_change_seconds"])
+    
+    if if_none_match is not None and image_hash == if_none_match:
+        return Response(status_code=304, headers=hash_headers)
+    
     try:
         # Open and crop image
         img = Image.open(filename)
@@ -1045,7 +1179,7 @@ async def get_image(
             raise HTTPException(status_code=500, detail=f"Unsupported format: {format}")
         
         output.seek(0)
-        return Response(content=output.read(), media_type=media_type)
+        return Response(content=output.read(), media_type=media_type, headers=hash_headers)
         
     except Exception as e:
         logger.error(f"Failed to process image: {e}")